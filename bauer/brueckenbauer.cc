@@ -1161,7 +1161,7 @@ const char *bridge_builder_t::remove(player_t *player, koord3d pos_start, waytyp
 			delete p;
 		}
 		// refresh map
-		minimap_t::get_instance()->calc_map_pixel(pos.get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(pos.get_2d());
 	}
 
 	// finally delete the bridge ends (all are kartenboden)
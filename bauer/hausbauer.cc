@@ -581,7 +581,7 @@ gebaeude_t* hausbauer_t::build(player_t* player, koord pos, int org_layout, cons
 				}
 			}
 			gr->calc_image();
-			minimap_t::get_instance()->calc_map_pixel(gr->get_pos().get_2d());
+			minimap_t::get_instance()->invalidate_map_pixel(gr->get_pos().get_2d());
 		}
 	}
 	// remove only once ...
@@ -864,7 +864,7 @@ gebaeude_t *hausbauer_t::build_station_extension_depot_with_complete_layout_bits
 	}
 
 	// update minimap
-	minimap_t::get_instance()->calc_map_pixel(gb->get_pos().get_2d());
+	minimap_t::get_instance()->invalidate_map_pixel(gb->get_pos().get_2d());
 
 	return gb;
 }
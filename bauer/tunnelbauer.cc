@@ -735,7 +735,7 @@ const char *tunnel_builder_t::remove(player_t *player, koord3d start, waytype_t
 		welt->access(pos.get_2d())->boden_entfernen(gr);
 		delete gr;
 
-		minimap_t::get_instance()->calc_map_pixel( pos.get_2d() );
+		minimap_t::get_instance()->invalidate_map_pixel( pos.get_2d() );
 	}
 
 	// And now we can delete the tunnel ends
@@ -1284,10 +1284,7 @@ sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const
 	get_mini_maxi( ziel, mini, maxi );
 
 	// memory in static list ...
-	if(route_t::nodes==NULL) {
-		route_t::MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		route_t::nodes = new route_t::ANode[route_t::MAX_STEP+4+1];
-	}
+	route_t::ANode *const nodes = route_t::init_nodes(welt, 0);
 
 	static binary_heap_tpl <route_t::ANode *> queue;
 
@@ -1313,7 +1310,7 @@ sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const
 			// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
 			continue;
 		}
-		tmp = &(route_t::nodes[step]);
+		tmp = &(nodes[step]);
 		step ++;
 
 		tmp->parent = NULL;
@@ -1501,7 +1498,7 @@ DBG_DEBUG("insert to close","(%i,%i,%i)  f=%i",gr->get_pos().x,gr->get_pos().y,g
 			}
 
 			// not in there or taken out => add new
-			route_t::ANode *k=&(route_t::nodes[step]);
+			route_t::ANode *k=&(nodes[step]);
 			step++;
 
 			k->parent = tmp;
@@ -1749,10 +1746,7 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 
 
 	// memory in static list ...
-	if(route_t::nodes==NULL) {
-		route_t::MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		route_t::nodes = new route_t::ANode[route_t::MAX_STEP+4+1];
-	}
+	route_t::ANode *const nodes = route_t::init_nodes(welt, 0);
 
 	static binary_heap_tpl <route_t::ANode *> queue;
 
@@ -1775,7 +1769,7 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 	sint32 dummy;
 	if( gr && is_allowed_step(gr,gr,&dummy) ) {
 		// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
-		tmp = &(route_t::nodes[step]);
+		tmp = &(nodes[step]);
 		step ++;
 		tmp->parent = NULL;
 		tmp->gr = gr;
@@ -1791,7 +1785,7 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 	gu = welt->lookup(start + koordup);
 	if( gu && is_allowed_step(gu,gu,&dummy, true) ) {
 		// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
-		tmp = &(route_t::nodes[step]);
+		tmp = &(nodes[step]);
 		step ++;
 		tmp->parent = NULL;
 		tmp->gr = gu;
@@ -2008,7 +2002,7 @@ DBG_DEBUG("insert to close","(%i,%i,%i)  f=%i",gr->get_pos().x,gr->get_pos().y,g
 			}
 
 			// not in there or taken out => add new
-			route_t::ANode *k=&(route_t::nodes[step]);
+			route_t::ANode *k=&(nodes[step]);
 			step++;
 
 			k->parent = tmp;
@@ -2690,7 +2684,7 @@ void way_builder_t::build_road()
 		//update ribi_mask_oneway if road is oneway_mode.
 		update_ribi_mask_oneway(str,i);
 		gr->calc_image();	// because it may be a crossing ...
-		minimap_t::get_instance()->calc_map_pixel(k);
+		minimap_t::get_instance()->invalidate_map_pixel(k);
 		player_t::book_construction_costs(player_builder, cost, k, road_wt);
 	} // for
 }
@@ -2802,7 +2796,7 @@ void way_builder_t::build_track()
 			}
 
 			gr->calc_image();
-			minimap_t::get_instance()->calc_map_pixel( gr->get_pos().get_2d() );
+			minimap_t::get_instance()->invalidate_map_pixel( gr->get_pos().get_2d() );
 			player_t::book_construction_costs(player_builder, cost, gr->get_pos().get_2d(), desc->get_finance_waytype());
 
 			if((i&3)==0) {
@@ -2854,7 +2848,7 @@ void way_builder_t::build_powerline()
 			player_t::book_construction_costs(player_builder, -desc->get_price(), gr->get_pos().get_2d(), powerline_wt);
 			// this adds maintenance
 			lt->leitung_t::finish_rd();
-			minimap_t::get_instance()->calc_map_pixel( gr->get_pos().get_2d() );
+			minimap_t::get_instance()->invalidate_map_pixel( gr->get_pos().get_2d() );
 		}
 
 		if((i&3)==0) {
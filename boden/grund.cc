@@ -673,6 +673,10 @@ void grund_t::set_halt(halthandle_t halt)
 		flags &= ~is_halt_flag;
 		flags |= dirty;
 	}
+	if(  hat_wege()  ) {
+		// block segments know about their stops
+		route_graph_t::tile_changed(pos);
+	}
 }
 
 
@@ -1960,7 +1964,7 @@ sint32 grund_t::weg_entfernen(waytype_t wegtyp, bool ribi_rem)
 		}
 
 		calc_image();
-		minimap_t::get_instance()->calc_map_pixel(get_pos().get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(get_pos().get_2d());
 
 		return costs;
 	}
@@ -418,11 +418,11 @@ public:
 	*/
 	inline const koord3d& get_pos() const { return pos; }
 
-	inline void set_pos(koord3d newpos) { pos = newpos;}
+	inline void set_pos(koord3d newpos) { pos = newpos; if(  hat_wege()  ) { route_graph_t::tile_changed(pos); } }
 
 	// slope are now maintained locally
 	slope_t::type get_grund_hang() const { return slope; }
-	void set_grund_hang(slope_t::type sl) { slope = sl; }
+	void set_grund_hang(slope_t::type sl) { slope = sl; if(  hat_wege()  ) { route_graph_t::tile_changed(pos); } }
 
 	/**
 	 * some ground tiles may be part of halts.
@@ -26,6 +26,7 @@ bool schiene_t::show_reservations = false;
 schiene_t::schiene_t() : weg_t()
 {
 	reserved = convoihandle_t();
+	waiting = convoihandle_t();
 
 	if (schiene_t::default_schiene) {
 		set_desc(schiene_t::default_schiene);
@@ -39,6 +40,7 @@ schiene_t::schiene_t() : weg_t()
 schiene_t::schiene_t(loadsave_t *file) : weg_t()
 {
 	reserved = convoihandle_t();
+	waiting = convoihandle_t();
 	rdwr(file);
 }
 
@@ -50,6 +52,7 @@ void schiene_t::cleanup(player_t *)
 		set_ribi(ribi_t::none);
 		reserved->suche_neue_route();
 	}
+	wake_waiting();
 }
 
 
@@ -112,12 +115,49 @@ bool schiene_t::unreserve(convoihandle_t c)
 		if(schiene_t::show_reservations) {
 			set_flag( obj_t::dirty );
 		}
+		if(  waiting.is_bound()  ) {
+			wake_waiting();
+		}
 		return true;
 	}
 	return false;
 }
 
 
+void schiene_t::add_waiting(convoihandle_t c)
+{
+	c->set_next_waiting( waiting );
+	waiting = c;
+}
+
+
+void schiene_t::remove_waiting(convoihandle_t c)
+{
+	if(  waiting == c  ) {
+		waiting = c->get_next_waiting();
+		return;
+	}
+	for(  convoihandle_t prev = waiting;  prev.is_bound();  prev = prev->get_next_waiting()  ) {
+		if(  prev->get_next_waiting() == c  ) {
+			prev->set_next_waiting( c->get_next_waiting() );
+			return;
+		}
+	}
+}
+
+
+void schiene_t::wake_waiting()
+{
+	convoihandle_t c = waiting;
+	waiting = convoihandle_t();
+	while(  c.is_bound()  ) {
+		const convoihandle_t next = c->get_next_waiting();
+		c->wake_up();
+		c = next;
+	}
+}
+
+
 
 void schiene_t::rdwr(loadsave_t *file)
 {
@@ -25,6 +25,16 @@ protected:
 	*/
 	convoihandle_t reserved;
 
+	/**
+	* First train waiting for this track to be released; the others are chained by convoi_t::get_next_waiting()
+	*/
+	convoihandle_t waiting;
+
+	/**
+	* wakes all waiting trains
+	*/
+	void wake_waiting();
+
 public:
 	static const way_desc_t *default_schiene;
 
@@ -69,6 +79,13 @@ public:
 	*/
 	bool unreserve( vehicle_t *) { return unreserve(reserved); }
 
+	/**
+	* convoi @p c will be woken, when this track is released
+	*/
+	void add_waiting(convoihandle_t c);
+
+	void remove_waiting(convoihandle_t c);
+
 	/* called before deletion;
 	 * last chance to unreserve tiles ...
 	 */
@@ -21,6 +21,11 @@ const way_desc_t *strasse_t::default_strasse=NULL;
 bool strasse_t::show_masked_ribi = false;
 bool strasse_t::show_reservations = false;
 
+/**
+ * directional statistics of all roads, MAX_WAY_STAT_DIRECTIONS columns per type
+ */
+static way_statistics_t directional_stats(MAX_WAY_STATISTICS*MAX_WAY_STAT_DIRECTIONS);
+
 
 void strasse_t::set_gehweg(bool janein)
 {
@@ -49,19 +54,24 @@ strasse_t::strasse_t() : weg_t()
 	overtaking_mode = twoway_mode;
 	street_flags = 0;
 	prior_direction_setting = 0;
-	for(uint8 type=0; type<MAX_WAY_STATISTICS; type++) {
-		for(uint8 month=0; month<MAX_WAY_STAT_MONTHS; month++) {
-			for(uint8 dir=0; dir<MAX_WAY_STAT_DIRECTIONS; dir++) {
-				directional_statistics[month][type][dir] = 0;
-			}
-		}
-	}
 	for(uint8 i=0; i<4; i++) {
 		reserved_by[i] = NULL;
 	}
 }
 
 
+strasse_t::~strasse_t()
+{
+	directional_stats.remove(this);
+}
+
+
+sint16 strasse_t::get_directional_stat(uint8 month, uint8 type, uint8 dir) const
+{
+	return directional_stats.get(this, month, type*MAX_WAY_STAT_DIRECTIONS+dir);
+}
+
+
 
 void strasse_t::rdwr(loadsave_t *file)
 {
@@ -85,21 +95,16 @@ void strasse_t::rdwr(loadsave_t *file)
 		for(uint8 type=0; type<MAX_WAY_STATISTICS; type++) {
 			for(uint8 month=0; month<MAX_WAY_STAT_MONTHS; month++) {
 				for(uint8 dir=0; dir<MAX_WAY_STAT_DIRECTIONS; dir++) {
-					sint16 w = directional_statistics[month][type][dir];
+					sint16 w = get_directional_stat(month, type, dir);
 					file->rdwr_short(w);
-					directional_statistics[month][type][dir] = w;
+					if(  file->is_loading()  ) {
+						directional_stats.set(this, month, type*MAX_WAY_STAT_DIRECTIONS+dir, w);
+					}
 				}
 			}
 		}
 	} else {
 		prior_direction_setting = 0;
-		for(uint8 type=0; type<MAX_WAY_STATISTICS; type++) {
-			for(uint8 month=0; month<MAX_WAY_STAT_MONTHS; month++) {
-				for(uint8 dir=0; dir<MAX_WAY_STAT_DIRECTIONS; dir++) {
-					directional_statistics[month][type][dir] = 0;
-				}
-			}
-		}
 	}
 
 	if(  (env_t::previous_OTRP_data  &&  file->is_version_atleast(120, 6))  ||  file->get_OTRP_version() >= 14  ) {
@@ -190,37 +195,14 @@ void strasse_t::rotate90() {
 	ribi_mask_oneway = ribi_t::rotate90( ribi_mask_oneway );
 }
 
-void strasse_t::init_statistics() {
-	weg_t::init_statistics();
-	for(uint8 type=0; type<MAX_WAY_STATISTICS; type++) {
-		for(uint8 month=0; month<MAX_WAY_STAT_MONTHS; month++) {
-			for(uint8 dir=0; dir<MAX_WAY_STAT_DIRECTIONS; dir++) {
-				directional_statistics[month][type][dir] = 0;
-			}
-		}
-	}
-}
-
 void strasse_t::book(int amount, way_statistics type, ribi_t::ribi dir) {
 	weg_t::book(amount, type);
 	if(  (dir&(ribi_t::north))!=0  ||  (dir&(ribi_t::south))!=0  ) {
 		// north-south traffic
-		directional_statistics[0][type][0] += amount;
+		directional_stats.book(this, type*MAX_WAY_STAT_DIRECTIONS+0, amount);
 	} else {
 		// east-west traffic
-		directional_statistics[0][type][1] += amount;
-	}
-}
-
-void strasse_t::new_month() {
-	weg_t::new_month();
-	for(uint8 type=0; type<MAX_WAY_STATISTICS; type++) {
-		for(uint8 dir=0; dir<MAX_WAY_STAT_DIRECTIONS; dir++) {
-			for(uint8 month=MAX_WAY_STAT_MONTHS-1; month>0; month--) {
-				directional_statistics[month][type][dir] = directional_statistics[month-1][type][dir];
-			}
-			directional_statistics[0][type][dir] = 0;
-		}
+		directional_stats.book(this, type*MAX_WAY_STAT_DIRECTIONS+1, amount);
 	}
 }
 
@@ -8,6 +8,7 @@
 
 
 #include "weg.h"
+#include "../../tpl/vector_tpl.h"
 
 // number of different traffic directions
 #define MAX_WAY_STAT_DIRECTIONS 2
@@ -56,13 +57,10 @@ private:
 	uint8 prior_direction_setting;
 
 	/**
-	* array for statistical values
-	* store directional statistics to calculate prior_direction
+	* directional statistics to calculate prior_direction
 	* direction: 0 = north-south, 1 = east-west
 	*/
-	sint16 directional_statistics[MAX_WAY_STAT_MONTHS][MAX_WAY_STATISTICS][MAX_WAY_STAT_DIRECTIONS];
-
-	void init_statistics() OVERRIDE;
+	sint16 get_directional_stat(uint8 month, uint8 type, uint8 dir) const;
 	
 	/**
 	* tile reservation system
@@ -83,11 +81,18 @@ private:
 	*/
 	vehicle_base_t* reserved_by[4];
 
+	/**
+	* road vehicles, city cars and other road bound moving objects on this tile,
+	* in the order of the object list of the ground; maintained by objlist_t
+	*/
+	vector_tpl<vehicle_base_t *> occupants;
+
 public:
 	static const way_desc_t *default_strasse;
 
 	strasse_t(loadsave_t *file);
 	strasse_t();
+	~strasse_t();
 
 	inline waytype_t get_waytype() const OVERRIDE {return road_wt;}
 
@@ -117,7 +122,6 @@ public:
 	virtual void rotate90() OVERRIDE;
 
 	void book(int amount, way_statistics type, ribi_t::ribi dir);
-	void new_month() OVERRIDE;
 
 	image_id get_front_image() const OVERRIDE;
 	
@@ -133,6 +137,12 @@ public:
 	bool unreserve(vehicle_base_t* r);
 	void unreserve_all();
 	bool is_reserved_by_others(vehicle_base_t* r, bool is_overtaking, koord3d pos_prev, koord3d pos_next);
+
+	// vehicles on this tile, for the lane checks without walking the object list
+	const vector_tpl<vehicle_base_t *> &get_occupants() const { return occupants; }
+	void insert_occupant(uint32 pos, vehicle_base_t *v) { occupants.insert_at( pos, v ); }
+	void remove_occupant(const vehicle_base_t *v) { occupants.remove( const_cast<vehicle_base_t *>(v) ); }
+	void clear_occupants() { occupants.clear(); }
 	
 	uint8 get_street_flag() const { return street_flags; }
 	void set_street_flag(uint8 s) { street_flags = s; }
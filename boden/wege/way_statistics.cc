@@ -0,0 +1,205 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include <string.h>
+
+#include "way_statistics.h"
+
+#include "../../simworld.h"
+#include "../../dataobj/environment.h"
+
+
+// marks removed entries, which are still needed to find the entries behind them
+static const char removed_entry = 0;
+#define REMOVED ((const void *)&removed_entry)
+
+// smallest table
+#define MIN_CAPACITY (1024)
+
+
+static inline uint32 hash_key(const void *key)
+{
+	// the lower bits are always zero due to alignment
+	return (uint32)(((size_t)key >> 4) * 2654435761u);
+}
+
+
+way_statistics_t::way_statistics_t(uint8 w) :
+	keys(NULL),
+	tags(NULL),
+	counters(NULL),
+	capacity(0),
+	used(0),
+	width(w)
+{
+}
+
+
+way_statistics_t::~way_statistics_t()
+{
+	delete [] keys;
+	delete [] tags;
+	delete [] counters;
+}
+
+
+uint16 way_statistics_t::get_month()
+{
+	return (uint16)world()->get_current_month();
+}
+
+
+uint32 way_statistics_t::find(const void *key) const
+{
+	if(  capacity == 0  ) {
+		return 0;
+	}
+	for(  uint32 i = hash_key(key) & (capacity-1);  keys[i] != NULL;  i = (i+1) & (capacity-1)  ) {
+		if(  keys[i] == key  ) {
+			return i;
+		}
+	}
+	return capacity;
+}
+
+
+void way_statistics_t::resize()
+{
+	const void **old_keys = keys;
+	uint16 *old_tags = tags;
+	sint16 *old_counters = counters;
+	const uint32 old_capacity = capacity;
+	const uint16 now = get_month();
+	const uint32 entry_size = MAX_WAY_STAT_MONTHS * width;
+
+	uint32 live = 0;
+	for(  uint32 i = 0;  i < old_capacity;  i++  ) {
+		if(  old_keys[i] != NULL  &&  old_keys[i] != REMOVED  &&  !(env_t::compact_way_statistics  &&  is_stale( old_tags[i], now ))  ) {
+			live++;
+		}
+	}
+	// at most half full afterwards
+	capacity = MIN_CAPACITY;
+	while(  capacity < live * 2 + 2  ) {
+		capacity *= 2;
+	}
+
+	keys = new const void *[capacity];
+	tags = new uint16[capacity];
+	counters = new sint16[capacity * entry_size];
+	memset( keys, 0, sizeof(const void *) * capacity );
+	used = 0;
+
+	for(  uint32 i = 0;  i < old_capacity;  i++  ) {
+		if(  old_keys[i] == NULL  ||  old_keys[i] == REMOVED  ||  (env_t::compact_way_statistics  &&  is_stale( old_tags[i], now ))  ) {
+			continue;
+		}
+		uint32 j = hash_key( old_keys[i] ) & (capacity-1);
+		while(  keys[j] != NULL  ) {
+			j = (j+1) & (capacity-1);
+		}
+		keys[j] = old_keys[i];
+		tags[j] = old_tags[i];
+		memcpy( counters + j * entry_size, old_counters + i * entry_size, sizeof(sint16) * entry_size );
+		used++;
+	}
+
+	delete [] old_keys;
+	delete [] old_tags;
+	delete [] old_counters;
+}
+
+
+uint32 way_statistics_t::insert(const void *key)
+{
+	if(  (used + 1) * 4 > capacity * 3  ) {
+		resize();
+	}
+
+	const uint16 now = get_month();
+	uint32 free_entry = capacity;
+	uint32 i = hash_key(key) & (capacity-1);
+	for(  ;  keys[i] != NULL;  i = (i+1) & (capacity-1)  ) {
+		if(  keys[i] == key  ) {
+			return i;
+		}
+		if(  free_entry == capacity  &&  (keys[i] == REMOVED  ||  (env_t::compact_way_statistics  &&  is_stale( tags[i], now )))  ) {
+			// can be taken over, if the key is not found further on
+			free_entry = i;
+		}
+	}
+	if(  free_entry == capacity  ) {
+		free_entry = i;
+		used++;
+	}
+
+	keys[free_entry] = key;
+	tags[free_entry] = now;
+	memset( counters + free_entry * MAX_WAY_STAT_MONTHS * width, 0, sizeof(sint16) * MAX_WAY_STAT_MONTHS * width );
+	return free_entry;
+}
+
+
+sint16 *way_statistics_t::roll(uint32 i, uint16 now)
+{
+	sint16 *c = counters + i * MAX_WAY_STAT_MONTHS * width;
+	const uint16 age = now - tags[i];
+	if(  age > 0  ) {
+		// clear the months since the last booking
+		for(  uint16 m = 1;  m <= age  &&  m <= MAX_WAY_STAT_MONTHS;  m++  ) {
+			memset( c + ((uint16)(tags[i] + m) % MAX_WAY_STAT_MONTHS) * width, 0, sizeof(sint16) * width );
+		}
+		tags[i] = now;
+	}
+	return c + (now % MAX_WAY_STAT_MONTHS) * width;
+}
+
+
+void way_statistics_t::book(const void *key, uint8 column, sint32 amount)
+{
+	const uint32 i = insert( key );
+	sint16 *c = roll( i, get_month() );
+	c[column] += amount;
+}
+
+
+sint16 way_statistics_t::get(const void *key, uint8 month, uint8 column) const
+{
+	const uint32 i = find( key );
+	if(  i >= capacity  ) {
+		return 0;
+	}
+	const uint16 now = get_month();
+	const uint16 age = now - tags[i];
+	if(  month < age  ||  month - age >= MAX_WAY_STAT_MONTHS  ) {
+		// no booking in that month
+		return 0;
+	}
+	return counters[ (i * MAX_WAY_STAT_MONTHS + (uint16)(now - month) % MAX_WAY_STAT_MONTHS) * width + column ];
+}
+
+
+void way_statistics_t::set(const void *key, uint8 month, uint8 column, sint16 value)
+{
+	uint32 i = find( key );
+	if(  i >= capacity  ) {
+		if(  value == 0  ) {
+			return;
+		}
+		i = insert( key );
+	}
+	sint16 *c = counters + i * MAX_WAY_STAT_MONTHS * width;
+	roll( i, get_month() );
+	c[ ((uint16)(get_month() - month) % MAX_WAY_STAT_MONTHS) * width + column ] = value;
+}
+
+
+void way_statistics_t::remove(const void *key)
+{
+	const uint32 i = find( key );
+	if(  i < capacity  ) {
+		keys[i] = REMOVED;
+	}
+}
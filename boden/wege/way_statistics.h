@@ -0,0 +1,75 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef BODEN_WEGE_WAY_STATISTICS_H
+#define BODEN_WEGE_WAY_STATISTICS_H
+
+
+#include "../../simtypes.h"
+
+
+// maximum number of months to store information
+#define MAX_WAY_STAT_MONTHS 2
+
+
+/**
+ * Traffic statistics of ways, stored apart from the ways in columns of keys (the ways),
+ * month tags and counters. Only ways with traffic have an entry.
+ *
+ * The counters of an entry are a ring buffer over the last MAX_WAY_STAT_MONTHS months,
+ * tagged with the month of the last booking. Months passed since then are cleared on the
+ * next booking, so nothing at all is done for ways at a new month.
+ * Reading does not change the table, so it is safe from several threads as long as nothing is booked.
+ *
+ * With env_t::compact_way_statistics, entries of ways without traffic in the stored months are
+ * dropped when their place is needed. Otherwise they are kept until the way is removed
+ * (saves adding them again for ways with rare traffic).
+ */
+class way_statistics_t
+{
+	const void **keys;  ///< NULL for empty entries
+	uint16 *tags;       ///< lower bits of the month of the last booking
+	sint16 *counters;   ///< MAX_WAY_STAT_MONTHS*width counters per entry
+	uint32 capacity;    ///< power of two (or zero)
+	uint32 used;        ///< entries in use (including removed ones)
+	const uint8 width;  ///< counters per month
+
+	/// @returns the index of @p key or capacity, if there is none
+	uint32 find(const void *key) const;
+
+	/// @returns the index of the entry for @p key, adds it if needed
+	uint32 insert(const void *key);
+
+	/// rehashes into a table large enough for the live entries
+	void resize();
+
+	/// true, if an entry has only months before the stored ones
+	static bool is_stale(uint16 tag, uint16 now) { return (uint16)(now - tag) >= MAX_WAY_STAT_MONTHS; }
+
+	/// @returns the counters of the current month of entry @p i, clears the months passed since its last booking
+	sint16 *roll(uint32 i, uint16 now);
+
+	static uint16 get_month();
+
+	way_statistics_t(const way_statistics_t &);
+	way_statistics_t &operator=(const way_statistics_t &);
+
+public:
+	explicit way_statistics_t(uint8 width);
+	~way_statistics_t();
+
+	void book(const void *key, uint8 column, sint32 amount);
+
+	/// @returns the counter of @p column for @p month months ago
+	sint16 get(const void *key, uint8 month, uint8 column) const;
+
+	/// sets the counter of @p column for @p month months ago (used during loading)
+	void set(const void *key, uint8 month, uint8 column, sint16 value);
+
+	/// removes all statistics of @p key
+	void remove(const void *key);
+};
+
+#endif
@@ -55,6 +55,12 @@ const slist_tpl <weg_t *> & weg_t::get_alle_wege()
 }
 
 
+/**
+ * traffic statistics of all ways
+ */
+static way_statistics_t way_stats(MAX_WAY_STATISTICS);
+
+
 // returns a way with matching waytype
 weg_t* weg_t::alloc(waytype_t wt)
 {
@@ -114,6 +120,7 @@ const char *weg_t::waytype_to_string(waytype_t wt)
 void weg_t::set_desc(const way_desc_t *b)
 {
 	desc = b;
+	route_graph_t::tile_changed(get_pos());
 
 	if(  hat_gehweg() &&  desc->get_wtyp() == road_wt  &&  desc->get_topspeed() > 50  ) {
 		max_speed = 50;
@@ -124,19 +131,6 @@ void weg_t::set_desc(const way_desc_t *b)
 }
 
 
-/**
- * initializes statistic array
- */
-void weg_t::init_statistics()
-{
-	for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
-		for(  int month=0;  month<MAX_WAY_STAT_MONTHS;  month++  ) {
-			statistics[month][type] = 0;
-		}
-	}
-}
-
-
 /**
  * Initializes all member variables
  */
@@ -145,7 +139,6 @@ void weg_t::init()
 	ribi = ribi_maske = ribi_t::none;
 	max_speed = 450;
 	desc = 0;
-	init_statistics();
 	alle_wege.insert(this);
 	flags = 0;
 	image = IMG_EMPTY;
@@ -156,7 +149,9 @@ void weg_t::init()
 
 weg_t::~weg_t()
 {
+	way_stats.remove(this);
 	alle_wege.remove(this);
+	route_graph_t::tile_changed(get_pos());
 	player_t *player=get_owner();
 	if(player) {
 		player_t::add_maintenance( player,  -desc->get_maintenance(), desc->get_finance_waytype() );
@@ -198,10 +193,11 @@ void weg_t::rdwr(loadsave_t *file)
 
 	for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
 		for(  int month=0;  month<MAX_WAY_STAT_MONTHS;  month++  ) {
-			sint32 w = statistics[month][type];
+			sint32 w = (sint32)get_stat(month, type);
 			file->rdwr_long(w);
-			statistics[month][type] = (sint16)w;
-			// DBG_DEBUG("weg_t::rdwr()", "statistics[%d][%d]=%d", month, type, statistics[month][type]);
+			if(  file->is_loading()  ) {
+				way_stats.set(this, month, type, (sint16)w);
+			}
 		}
 	}
 }
@@ -270,13 +266,13 @@ void weg_t::info(cbuffer_t & buf) const
 	}
 
 #if 1
-	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), statistics[1][1]);
+	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), get_statistics(WAY_STAT_CONVOIS));
 #else
 	// Debug - output stats
 	buf.append("\n");
 	for (int type=0; type<MAX_WAY_STATISTICS; type++) {
 		for (int month=0; month<MAX_WAY_STAT_MONTHS; month++) {
-			buf.printf("%d ", statistics[month][type]);
+			buf.printf("%d ", (int)get_stat(month, type));
 		}
 	buf.append("\n");
 	}
@@ -308,6 +304,7 @@ void weg_t::count_sign()
 {
 	// Either only sign or signal please ...
 	flags &= ~(HAS_SIGN|HAS_SIGNAL|HAS_CROSSING);
+	route_graph_t::tile_changed(get_pos());
 	const grund_t *gr=welt->lookup(get_pos());
 	if(gr) {
 		uint8 i = 1;
@@ -1005,17 +1002,16 @@ void weg_t::check_diagonal()
 }
 
 
-/**
- * new month
- */
-void weg_t::new_month()
+void weg_t::book(int amount, way_statistics type)
 {
-	for (int type=0; type<MAX_WAY_STATISTICS; type++) {
-		for (int month=MAX_WAY_STAT_MONTHS-1; month>0; month--) {
-			statistics[month][type] = statistics[month-1][type];
-		}
-		statistics[0][type] = 0;
-	}
+	way_stats.book(this, type, amount);
+}
+
+
+sint64 weg_t::get_stat(int month, int stat_type) const
+{
+	assert(stat_type<WAY_STAT_MAX  &&  0<=month  &&  month<MAX_WAY_STAT_MONTHS);
+	return way_stats.get(this, month, stat_type);
 }
 
 
@@ -12,7 +12,9 @@
 #include "../../obj/simobj.h"
 #include "../../descriptor/way_desc.h"
 #include "../../dataobj/koord3d.h"
+#include "../../dataobj/route_graph.h"
 #include "../../simskin.h"
+#include "way_statistics.h"
 
 
 class karte_t;
@@ -21,9 +23,6 @@ class cbuffer_t;
 template <class T> class slist_tpl;
 
 
-// maximum number of months to store information
-#define MAX_WAY_STAT_MONTHS 2
-
 // number of different statistics collected
 #define MAX_WAY_STATISTICS 2
 
@@ -64,13 +63,6 @@ public:
 	};
 
 private:
-	/**
-	* array for statistical values
-	* MAX_WAY_STAT_MONTHS: [0] = actual value; [1] = last month value
-	* MAX_WAY_STATISTICS: see #define at top of file
-	*/
-	sint16 statistics[MAX_WAY_STAT_MONTHS][MAX_WAY_STATISTICS];
-
 	/**
 	* Way type description
 	*/
@@ -110,11 +102,6 @@ private:
 	*/
 	void init();
 
-	/**
-	* initializes statistic array
-	*/
-	virtual void init_statistics();
-
 protected:
 
 public:
@@ -154,7 +141,7 @@ public:
 	 */
 	bool check_season(const bool calc_only_season_change) OVERRIDE;
 
-	void set_max_speed(sint32 s) { max_speed = s; }
+	void set_max_speed(sint32 s) { max_speed = s; route_graph_t::tile_changed(get_pos()); }
 	sint32 get_max_speed() const { return max_speed; }
 
 	/// @note Replaces max speed of the way by the max speed property of the descriptor.
@@ -195,7 +182,7 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void ribi_add(ribi_t::ribi ribi) { this->ribi |= (uint8)ribi;}
+	void ribi_add(ribi_t::ribi ribi) { this->ribi |= (uint8)ribi; route_graph_t::tile_changed(get_pos()); }
 
 	/**
 	* Remove direction bits (ribi) for a way.
@@ -203,7 +190,7 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void ribi_rem(ribi_t::ribi ribi) { this->ribi &= (uint8)~ribi;}
+	void ribi_rem(ribi_t::ribi ribi) { this->ribi &= (uint8)~ribi; route_graph_t::tile_changed(get_pos()); }
 
 	/**
 	* Set direction bits (ribi) for the way.
@@ -211,7 +198,7 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void set_ribi(ribi_t::ribi ribi) { this->ribi = (uint8)ribi;}
+	void set_ribi(ribi_t::ribi ribi) { this->ribi = (uint8)ribi; route_graph_t::tile_changed(get_pos()); }
 
 	/**
 	* Get the unmasked direction bits (ribi) for the way (without signals or other ribi changer).
@@ -229,7 +216,7 @@ public:
 	* For signals it is necessary to mask out certain ribi to prevent vehicles
 	* from driving the wrong way (e.g. oneway roads)
 	*/
-	void set_ribi_maske(ribi_t::ribi ribi) { ribi_maske = (uint8)ribi; }
+	void set_ribi_maske(ribi_t::ribi ribi) { ribi_maske = (uint8)ribi; route_graph_t::tile_changed(get_pos()); }
 	ribi_t::ribi get_ribi_maske() const { return (ribi_t::ribi)ribi_maske; }
 
 	/**
@@ -238,21 +225,19 @@ public:
 	virtual void rotate90() OVERRIDE;
 
 	/**
-	* book statistics - is called very often and therefore inline
+	* book statistics
+	* The statistics are kept in a way_statistics_t apart from the ways, so nothing is to be done at a new month.
 	*/
-	void book(int amount, way_statistics type) { statistics[0][type] += amount; }
+	void book(int amount, way_statistics type);
 
 	/**
 	* return statistics value
 	* always returns last month's value
 	*/
-	int get_statistics(int type) const { return statistics[1][type]; }
+	int get_statistics(int type) const { return get_stat(1, type); }
 
-	sint64 get_stat(int month, int stat_type) const { assert(stat_type<WAY_STAT_MAX  &&  0<=month  &&  month<MAX_WAY_STAT_MONTHS); return statistics[month][stat_type]; }
-	/**
-	* new month
-	*/
-	virtual void new_month();
+	/// @returns the statistics of @p month months ago (0 = this month)
+	sint64 get_stat(int month, int stat_type) const;
 
 	void check_diagonal();
 
@@ -262,7 +247,7 @@ public:
 	void set_gehweg(const bool yesno) { flags = (yesno ? flags | HAS_SIDEWALK : flags & ~HAS_SIDEWALK); }
 	inline bool hat_gehweg() const { return flags & HAS_SIDEWALK; }
 
-	void set_electrify(bool janein) {janein ? flags |= IS_ELECTRIFIED : flags &= ~IS_ELECTRIFIED;}
+	void set_electrify(bool janein) {janein ? flags |= IS_ELECTRIFIED : flags &= ~IS_ELECTRIFIED; route_graph_t::tile_changed(get_pos()); }
 	inline bool is_electrified() const {return flags&IS_ELECTRIFIED; }
 
 	inline bool has_sign() const {return flags&HAS_SIGN; }
@@ -279,7 +264,7 @@ public:
 	 * Clear the has-sign flag when roadsign or signal got deleted.
 	 * As there is only one of signal or roadsign on the way we can safely clear both flags.
 	 */
-	void clear_sign_flag() { flags &= ~(HAS_SIGN | HAS_SIGNAL); }
+	void clear_sign_flag() { flags &= ~(HAS_SIGN | HAS_SIGNAL); route_graph_t::tile_changed(get_pos()); }
 
 	inline void set_image( image_id b ) { image = b; }
 	image_id get_image() const OVERRIDE {return image;}
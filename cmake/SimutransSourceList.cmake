@@ -22,11 +22,14 @@ target_sources(simutrans PRIVATE
 		boden/wege/runway.cc
 		boden/wege/schiene.cc
 		boden/wege/strasse.cc
+		boden/wege/way_statistics.cc
 		boden/wege/weg.cc
+		dataobj/block_graph.cc
 		dataobj/crossing_logic.cc
 		dataobj/environment.cc
 		dataobj/freelist.cc
 		dataobj/gameinfo.cc
+		dataobj/halt_cargo.cc
 		dataobj/height_map_loader.cc
 		dataobj/koord.cc
 		dataobj/koord3d.cc
@@ -38,6 +41,7 @@ target_sources(simutrans PRIVATE
 		dataobj/rect.cc
 		dataobj/ribi.cc
 		dataobj/route.cc
+		dataobj/route_graph.cc
 		dataobj/scenario.cc
 		dataobj/schedule.cc
 		dataobj/settings.cc
@@ -191,6 +195,7 @@ target_sources(simutrans PRIVATE
 		gui/sound_frame.cc
 		gui/sprachen.cc
 		gui/station_building_select.cc
+		gui/step_profiler_frame.cc
 		gui/themeselector.cc
 		gui/tool_selector.cc
 		gui/trafficlight_info.cc
@@ -329,6 +334,7 @@ target_sources(simutrans PRIVATE
 		utils/simrandom.cc
 		utils/simstring.cc
 		utils/simthread.cc
+		utils/step_profiler.cc
 		vehicle/air_vehicle.cc
 		vehicle/movingobj.cc
 		vehicle/pedestrian.cc
@@ -337,5 +343,6 @@ target_sources(simutrans PRIVATE
 		vehicle/simroadtraffic.cc
 		vehicle/vehicle.cc
 		vehicle/vehicle_base.cc
+		vehicle/vehicle_cargo.cc
 		vehicle/water_vehicle.cc
 )
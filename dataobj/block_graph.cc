@@ -0,0 +1,136 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "block_graph.h"
+
+#include "route.h"
+#include "route_graph.h"
+#include "../simworld.h"
+#include "../boden/grund.h"
+#include "../boden/wege/schiene.h"
+
+
+// segment cache entries (must be a power of two)
+#define BLOCK_GRAPH_SEGMENTS (1<<12)
+
+// longer runs are split
+#define MAX_SEGMENT_LENGTH (1024)
+
+
+block_segment_t *block_graph_t::segments = NULL;
+
+
+void block_graph_t::free()
+{
+	delete [] segments;
+	segments = NULL;
+}
+
+
+void block_graph_t::trace(const grund_t *from, waytype_t wt, ribi_t::ribi dir, block_segment_t &seg)
+{
+	seg.start = from->get_pos();
+	seg.start_dir = dir;
+	seg.waytype = wt;
+	seg.has_sign = false;
+	seg.has_halt = false;
+	seg.bbox_min = seg.bbox_max = seg.start.get_2d();
+	seg.stamp = route_graph_t::get_change_counter();
+	seg.tiles.clear();
+
+	const grund_t *gr = from;
+	while(  true  ) {
+		block_segment_t::tile_t t;
+		t.pos = gr->get_pos();
+		t.sch = (schiene_t *)gr->get_weg(wt);
+		t.dir = ribi_t::none;
+		if(  seg.tiles.get_count() >= 2  ) {
+			// the previous tile is an inner one, and the route through it goes from its predecessor to here
+			block_segment_t::tile_t &inner = seg.tiles.back();
+			inner.dir = ribi_type( seg.tiles[seg.tiles.get_count()-2].pos, t.pos );
+		}
+		seg.tiles.append( t );
+		seg.bbox_min.clip_max( t.pos.get_2d() );
+		seg.bbox_max.clip_min( t.pos.get_2d() );
+		seg.has_halt |= gr->is_halt();
+
+		if(  t.sch == NULL  ||  t.sch->has_signal()  ||  t.sch->is_crossing()  ||  !route_graph_t::is_inner_tile( gr, wt )  ) {
+			// the block or the unique way ends here
+			return;
+		}
+		seg.has_sign |= t.sch->has_sign();
+		if(  seg.tiles.get_count() >= MAX_SEGMENT_LENGTH  ) {
+			return;
+		}
+
+		dir = gr->get_weg_ribi_unmasked(wt) & ~ribi_t::reverse_single(dir);
+		grund_t *to;
+		if(  !ribi_t::is_single(dir)  ||  !gr->get_neighbour( to, wt, dir )  ) {
+			return;
+		}
+		gr = to;
+	}
+}
+
+
+const block_segment_t *block_graph_t::get_segment(const grund_t *gr, waytype_t wt, ribi_t::ribi dir)
+{
+	if(  segments == NULL  ) {
+		segments = new block_segment_t[BLOCK_GRAPH_SEGMENTS];
+		for(  uint32 i = 0;  i < BLOCK_GRAPH_SEGMENTS;  i++  ) {
+			segments[i].start = koord3d::invalid;
+		}
+	}
+
+	const koord3d pos = gr->get_pos();
+	const uint32 hash = ((uint32)pos.x * 73856093u) ^ ((uint32)pos.y * 19349663u) ^ ((uint32)(uint8)pos.z * 83492791u) ^ ((uint32)dir << 8) ^ (uint32)wt;
+	block_segment_t &seg = segments[ hash & (BLOCK_GRAPH_SEGMENTS-1) ];
+	if(  seg.start != pos  ||  seg.start_dir != dir  ||  seg.waytype != wt  ||  !route_graph_t::is_unchanged( seg.bbox_min, seg.bbox_max, seg.stamp )  ) {
+		trace( gr, wt, dir, seg );
+	}
+	return &seg;
+}
+
+
+schiene_t *block_route_tracks_t::get(uint16 i)
+{
+	const koord3d &pos = route->at(i);
+	// the cache entry may have been traced again for another segment since
+	if(  seg  &&  seg->waytype == wt  &&  i >= seg_index  &&  (uint32)(i - seg_index) < seg->tiles.get_count()  ) {
+		const block_segment_t::tile_t &t = seg->tiles[i - seg_index];
+		if(  t.pos == pos  ) {
+			return t.sch;
+		}
+	}
+
+	// the route left the segment: start a new one here
+	seg = NULL;
+	const grund_t *gr = world()->lookup(pos);
+	if(  gr == NULL  ) {
+		return NULL;
+	}
+	const ribi_t::ribi dir = i > 0 ? ribi_type( route->at(i-1), pos ) : (ribi_t::ribi)ribi_t::none;
+	if(  ribi_t::is_single(dir)  ) {
+		seg = block_graph_t::get_segment( gr, wt, dir );
+		seg_index = i;
+		return seg->tiles[0].sch;
+	}
+	return (schiene_t *)gr->get_weg(wt);
+}
+
+
+uint16 block_route_tracks_t::get_inner_run(uint16 i, uint16 last, bool plain) const
+{
+	if(  seg == NULL  ||  seg->waytype != wt  ||  i < seg_index  ||  (plain  &&  (seg->has_sign  ||  seg->has_halt))  ) {
+		return 0;
+	}
+	// the last tile of a segment is not an inner one, and the route must go on to the next segment tile
+	const uint32 end = seg_index + seg->tiles.get_count() - 1;
+	uint16 j = i + 1;
+	while(  j < end  &&  j < last  &&  route->at(j) == seg->tiles[j - seg_index].pos  &&  route->at(j+1) == seg->tiles[j + 1 - seg_index].pos  ) {
+		j++;
+	}
+	return j - i - 1;
+}
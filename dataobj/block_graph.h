@@ -0,0 +1,104 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_BLOCK_GRAPH_H
+#define DATAOBJ_BLOCK_GRAPH_H
+
+
+#include "../simtypes.h"
+#include "../tpl/vector_tpl.h"
+#include "koord3d.h"
+#include "ribi.h"
+
+
+class grund_t;
+class route_t;
+class schiene_t;
+
+
+/**
+ * A run of track, which a train can only follow in one way:
+ * it starts at a tile entered in a given direction and ends at the first signal, crossing,
+ * junction or dead end (this tile included).
+ * All tiles but the first and the last are inner tiles: they have a track, but no signal or crossing.
+ */
+struct block_segment_t
+{
+	struct tile_t
+	{
+		koord3d pos;
+		schiene_t *sch;
+		ribi_t::ribi dir; ///< reservation direction through an inner tile
+	};
+
+	koord3d start;
+	ribi_t::ribi start_dir; ///< direction in which start is entered
+	uint8 waytype;
+	bool has_sign;          ///< a road sign (like the end of a choose area) on any tile
+	bool has_halt;          ///< a stop on any tile
+	koord bbox_min;         ///< bounding box of all tiles
+	koord bbox_max;
+	uint32 stamp;           ///< route_graph_t change counter, when the segment was traced
+	vector_tpl<tile_t> tiles;
+};
+
+
+/**
+ * The block segments of all rail networks.
+ * Segments are traced on first use and cached; they use the change tracking of route_graph_t,
+ * so any change of tracks or signals invalidates the segments touching it.
+ * Only to be used from the main thread.
+ */
+class block_graph_t
+{
+	static block_segment_t *segments;
+
+	static void trace(const grund_t *from, waytype_t wt, ribi_t::ribi dir, block_segment_t &seg);
+
+public:
+	/// frees all memory
+	static void free();
+
+	/**
+	 * The segment starting at @p gr, which is entered in direction @p dir.
+	 * Valid until the next call.
+	 */
+	static const block_segment_t *get_segment(const grund_t *gr, waytype_t wt, ribi_t::ribi dir);
+};
+
+
+/**
+ * Finds the tracks along a route, segment by segment instead of tile by tile.
+ * Tiles should be requested in increasing order; the tracks are the same as found by
+ * welt->lookup(route->at(i))->get_weg(wt).
+ * The inner tiles of a segment can be handled at once, see get_inner_run().
+ */
+class block_route_tracks_t
+{
+	const route_t *route;
+	const waytype_t wt;
+	const block_segment_t *seg;
+	uint16 seg_index; ///< route index of the first tile of seg
+
+public:
+	block_route_tracks_t(const route_t *r, waytype_t w) : route(r), wt(w), seg(NULL), seg_index(0) {}
+
+	/// @returns the track at route index @p i (or NULL, if there is none)
+	schiene_t *get(uint16 i);
+
+	/**
+	 * To be called after get(@p i): the number of route tiles following @p i, which are inner tiles
+	 * of the same segment, with the route going on along the segment after each of them.
+	 * So these tiles have neither signals nor crossings, and are reserved in the direction of get_inner().
+	 * @param last the last route index to include
+	 * @param plain only count, if there is no sign or stop on the segment
+	 */
+	uint16 get_inner_run(uint16 i, uint16 last, bool plain = false) const;
+
+	/// the inner tile at route index @p i of the last get_inner_run()
+	const block_segment_t::tile_t &get_inner(uint16 i) const { return seg->tiles[i - seg_index]; }
+};
+
+#endif
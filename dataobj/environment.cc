@@ -140,6 +140,7 @@ uint32 env_t::fps;
 uint32 env_t::ff_fps;
 sint16 env_t::max_acceleration;
 uint8 env_t::num_threads;
+bool env_t::compact_way_statistics;
 bool env_t::show_tooltips;
 uint32 env_t::tooltip_color_rgb;
 PIXVAL env_t::tooltip_color;
@@ -290,6 +291,8 @@ void env_t::init()
 	num_threads = 1;
 #endif
 
+	compact_way_statistics = false;
+
 	sound_distance_scaling = 10;
 
 	show_tooltips = true;
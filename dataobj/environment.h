@@ -412,6 +412,9 @@ public:
 	/// number of threads to use (if MULTI_THREAD defined)
 	static uint8 num_threads;
 
+	/// drop the statistics of ways without traffic in the last months (saves memory on large maps)
+	static bool compact_way_statistics;
+
 	/// false to quit the programs
 	static bool quit_simutrans;
 
@@ -6,9 +6,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 
 #include "../simtypes.h"
 #include "../simmem.h"
+#include "../simdebug.h"
+#include "../macros.h"
 #include "freelist.h"
 
 // define USE_VALGRIND_MEMCHECK to make
@@ -237,5 +240,266 @@ void freelist_t::free_all_nodes()
 	for( int i=0;  i<NUM_LIST;  i++  ) {
 		all_lists[i] = NULL;
 	}
+	freelist_pool_t::free_all_pools();
 	printf("freelist_t::free_all_nodes(): ok\n");
 }
+
+
+// size of a slab of a pool
+#define POOL_SLAB_SIZE (32768)
+
+// nodes exchanged at once between a thread cache and the shared list
+#define POOL_BATCH (32)
+
+static freelist_pool_t *all_pools = NULL;
+
+#ifdef MULTI_THREAD
+// protects the shared lists of all pools and all_pools
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// cache index of this thread (-1 not yet assigned, MAX_POOL_CACHES for none)
+static thread_local int pool_cache_index = -1;
+static int pool_cache_count = 0;
+
+// cache indices given back by ended threads
+static int pool_cache_free[MAX_POOL_CACHES];
+static int pool_cache_free_count = 0;
+
+/// gives the cache index of a thread back, when the thread ends
+struct pool_cache_owner_t
+{
+	int index;
+	pool_cache_owner_t() : index(-1) {}
+	~pool_cache_owner_t()
+	{
+		if(  index >= 0  &&  index < MAX_POOL_CACHES  ) {
+			freelist_pool_t::release_cache( index );
+		}
+	}
+};
+// only touched when the index is assigned, since the destructor makes each access more expensive
+static thread_local pool_cache_owner_t pool_cache_owner;
+
+static int get_pool_cache_index()
+{
+	if(  pool_cache_index < 0  ) {
+		pthread_mutex_lock( &pool_mutex );
+		if(  pool_cache_free_count > 0  ) {
+			pool_cache_index = pool_cache_free[--pool_cache_free_count];
+		}
+		else {
+			pool_cache_index = pool_cache_count < MAX_POOL_CACHES ? pool_cache_count++ : MAX_POOL_CACHES;
+		}
+		pthread_mutex_unlock( &pool_mutex );
+		pool_cache_owner.index = pool_cache_index;
+	}
+	return pool_cache_index;
+}
+
+#define POOL_LOCK() pthread_mutex_lock( &pool_mutex )
+#define POOL_UNLOCK() pthread_mutex_unlock( &pool_mutex )
+#else
+#define POOL_LOCK()
+#define POOL_UNLOCK()
+#endif
+
+
+freelist_pool_t::freelist_pool_t(const char *n, size_t s) :
+	name(n),
+	size(s),
+	free_list(NULL),
+	slabs(NULL),
+	outstanding(0),
+	peak(0),
+	bytes(0)
+{
+	// room for the pointer of the free list, aligned like the largest basic types
+	size = max( size, sizeof(node_t) );
+	size = (size + 7) & ~(size_t)7;
+#ifdef MULTI_THREAD
+	MEMZERON( caches, MAX_POOL_CACHES );
+	uncached_live = 0;
+#endif
+	POOL_LOCK();
+	next_pool = all_pools;
+	all_pools = this;
+	POOL_UNLOCK();
+}
+
+
+freelist_pool_t::node_t *freelist_pool_t::take_shared()
+{
+	if(  free_list == NULL  ) {
+		// new slab, the first node links the slabs
+		const size_t count = max( (size_t)2, POOL_SLAB_SIZE / size );
+		char *p = (char *)xmalloc( count * size );
+		bytes += count * size;
+		node_t *slab = (node_t *)p;
+		slab->next = slabs;
+		slabs = slab;
+		// in ascending order, so new objects follow each other in memory
+		for(  size_t i = count-1;  i > 0;  i--  ) {
+			node_t *n = (node_t *)(p + i * size);
+			n->next = free_list;
+			free_list = n;
+		}
+	}
+	node_t *n = free_list;
+	free_list = n->next;
+	outstanding++;
+	if(  outstanding > peak  ) {
+		peak = outstanding;
+	}
+	return n;
+}
+
+
+void *freelist_pool_t::gimme_node()
+{
+#ifdef MULTI_THREAD
+	const int index = get_pool_cache_index();
+	if(  index < MAX_POOL_CACHES  ) {
+		cache_t &c = caches[index];
+		if(  c.head == NULL  ) {
+			// refill the cache from the shared list
+			POOL_LOCK();
+			node_t **tail = &c.head;
+			for(  int i = 0;  i < POOL_BATCH;  i++  ) {
+				*tail = take_shared();
+				tail = &(*tail)->next;
+			}
+			*tail = NULL;
+			POOL_UNLOCK();
+			c.count = POOL_BATCH;
+		}
+		node_t *n = c.head;
+		c.head = n->next;
+		c.count--;
+		c.allocs++;
+		return n;
+	}
+#endif
+	POOL_LOCK();
+	node_t *n = take_shared();
+#ifdef MULTI_THREAD
+	uncached_live++;
+#endif
+	POOL_UNLOCK();
+	return n;
+}
+
+
+void freelist_pool_t::putback_node(void *p)
+{
+	if(  p == NULL  ) {
+		return;
+	}
+	node_t *n = (node_t *)p;
+#ifdef MULTI_THREAD
+	const int index = get_pool_cache_index();
+	if(  index < MAX_POOL_CACHES  ) {
+		cache_t &c = caches[index];
+		n->next = c.head;
+		c.head = n;
+		c.count++;
+		c.frees++;
+		if(  c.count >= 2 * POOL_BATCH  ) {
+			// give a batch back, so nodes freed by another thread than the allocating one do not pile up
+			POOL_LOCK();
+			for(  int i = 0;  i < POOL_BATCH;  i++  ) {
+				node_t *m = c.head;
+				c.head = m->next;
+				m->next = free_list;
+				free_list = m;
+			}
+			outstanding -= POOL_BATCH;
+			POOL_UNLOCK();
+			c.count -= POOL_BATCH;
+		}
+		return;
+	}
+#endif
+	POOL_LOCK();
+	n->next = free_list;
+	free_list = n;
+	outstanding--;
+#ifdef MULTI_THREAD
+	uncached_live--;
+#endif
+	POOL_UNLOCK();
+}
+
+
+#ifdef MULTI_THREAD
+void freelist_pool_t::release_cache(int index)
+{
+	POOL_LOCK();
+	for(  freelist_pool_t *pool = all_pools;  pool;  pool = pool->next_pool  ) {
+		cache_t &c = pool->caches[index];
+		while(  c.head  ) {
+			node_t *n = c.head;
+			c.head = n->next;
+			n->next = pool->free_list;
+			pool->free_list = n;
+		}
+		pool->outstanding -= c.count;
+		c.count = 0;
+		// allocs and frees stay, so the live objects are still counted right
+	}
+	pool_cache_free[pool_cache_free_count++] = index;
+	POOL_UNLOCK();
+}
+#endif
+
+
+uint32 freelist_pool_t::get_live() const
+{
+#ifdef MULTI_THREAD
+	// a thread may put back more than it took, so only the sum is meaningful
+	uint32 live = uncached_live;
+	for(  int i = 0;  i < MAX_POOL_CACHES;  i++  ) {
+		live += caches[i].allocs - caches[i].frees;
+	}
+	return live;
+#else
+	return outstanding;
+#endif
+}
+
+
+void freelist_pool_t::free_all()
+{
+	while(  slabs  ) {
+		node_t *p = slabs;
+		slabs = slabs->next;
+		free( p );
+	}
+	free_list = NULL;
+	outstanding = 0;
+	bytes = 0;
+#ifdef MULTI_THREAD
+	MEMZERON( caches, MAX_POOL_CACHES );
+	uncached_live = 0;
+#endif
+}
+
+
+void freelist_pool_t::dump_statistics()
+{
+	POOL_LOCK();
+	for(  const freelist_pool_t *pool = all_pools;  pool;  pool = pool->next_pool  ) {
+		dbg->message( "freelist_pool_t::dump_statistics()", "%s: size %u, live %u, peak %u, %u bytes",
+			pool->get_name() ? pool->get_name() : "?", (unsigned)pool->size, pool->get_live(), pool->get_peak(), (unsigned)pool->get_bytes() );
+	}
+	POOL_UNLOCK();
+}
+
+
+void freelist_pool_t::free_all_pools()
+{
+	POOL_LOCK();
+	for(  freelist_pool_t *pool = all_pools;  pool;  pool = pool->next_pool  ) {
+		pool->free_all();
+	}
+	POOL_UNLOCK();
+}
@@ -9,6 +9,9 @@
 
 #include <cstddef>
 
+#include "../simtypes.h"
+#include "../simconst.h"
+
 
 /**
  * Helper class to organize small memory objects i.e. nodes for linked lists
@@ -20,8 +23,86 @@ public:
 	static void *gimme_node( size_t size );
 	static void putback_node( size_t size, void *p );
 
-	// clears all list memories
+	// clears all list memories (also of the pools)
 	static void free_all_nodes();
 };
 
+
+// threads with a cache of their own in each pool (more threads use the shared list)
+#define MAX_POOL_CACHES (MAX_THREADS+4)
+
+
+/**
+ * Memory for the objects of one type, allocated in slabs, so these objects are
+ * close to each other in memory and not mixed with others of the same size.
+ * With MULTI_THREAD each thread keeps some free nodes of its own and exchanges them
+ * with the shared list (which needs the mutex) only in batches.
+ * Use freelist_tpl<T> instead of this class.
+ */
+class freelist_pool_t
+{
+	struct node_t
+	{
+		node_t *next;
+	};
+
+	const char *name;
+	size_t size;
+
+	node_t *free_list; ///< shared free nodes
+	node_t *slabs;     ///< all allocated memory
+
+	// statistics
+	uint32 outstanding; ///< nodes not in the shared list (live or in a thread cache)
+	uint32 peak;        ///< maximum of outstanding
+	size_t bytes;       ///< memory of all slabs
+
+#ifdef MULTI_THREAD
+	struct cache_t
+	{
+		node_t *head;
+		uint32 count;
+		// only changed by the owning thread
+		uint32 allocs;
+		uint32 frees;
+	};
+	cache_t caches[MAX_POOL_CACHES];
+	uint32 uncached_live; ///< nodes of threads without cache
+#endif
+
+	freelist_pool_t *next_pool;
+
+	/// takes a node from the shared list (caller must hold the mutex)
+	node_t *take_shared();
+
+	/// returns all nodes to the system
+	void free_all();
+
+	freelist_pool_t(const freelist_pool_t &);
+	freelist_pool_t &operator=(const freelist_pool_t &);
+
+public:
+	freelist_pool_t(const char *name, size_t size);
+
+	void *gimme_node();
+	void putback_node(void *p);
+
+	/// live objects (nodes handed out and not yet put back)
+	uint32 get_live() const;
+	uint32 get_peak() const { return peak; }
+	size_t get_bytes() const { return bytes; }
+	const char *get_name() const { return name; }
+
+#ifdef MULTI_THREAD
+	/// moves the nodes in the cache @p index of all pools to their shared lists (when its thread ends)
+	static void release_cache(int index);
+#endif
+
+	/// writes the statistics of all pools to the log
+	static void dump_statistics();
+
+	/// returns the memory of all pools to the system
+	static void free_all_pools();
+};
+
 #endif
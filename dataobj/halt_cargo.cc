@@ -0,0 +1,296 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include <assert.h>
+
+#include "halt_cargo.h"
+
+
+halt_cargo_t::halt_cargo_t() :
+	head(END),
+	tail(END),
+	count(0),
+	next_order(1)
+{
+}
+
+
+halt_cargo_t::~halt_cargo_t()
+{
+	clear_index( by_next );
+	clear_index( by_destination );
+	clear_index( by_zielpos );
+}
+
+
+void halt_cargo_t::clear_index(index_t &index)
+{
+	FOR(index_t, const& b, index) {
+		delete b.slots;
+	}
+	index.clear();
+}
+
+
+uint64 halt_cargo_t::destination_key(const ware_t &w)
+{
+	// same fields as ware_t::same_destination()
+#ifdef HANDLES_32BIT
+	// no room for all bits: the target position is folded, so different destinations may share a key
+	uint64 key = ((uint64)w.get_index() << 56) | ((uint64)w.to_factory << 55) | ((uint64)w.get_ziel().get_id() << 23);
+	if(  w.to_factory  ) {
+		key |= (((uint32)(uint16)w.get_zielpos().x << 11) ^ (uint16)w.get_zielpos().y) & 0x7FFFFF;
+	}
+#else
+	uint64 key = ((uint64)w.get_index() << 56) | ((uint64)w.to_factory << 48) | ((uint64)w.get_ziel().get_id() << 32);
+	if(  w.to_factory  ) {
+		key |= ((uint64)(uint16)w.get_zielpos().x << 16) | (uint16)w.get_zielpos().y;
+	}
+#endif
+	return key;
+}
+
+
+uint32 halt_cargo_t::bucket_pos(const index_t &index, uint64 key)
+{
+	uint32 low = 0, high = index.get_count();
+	while(  low < high  ) {
+		const uint32 mid = (low + high) / 2;
+		if(  index[mid].key < key  ) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+
+uint32 halt_cargo_t::slot_pos(const slot_list_t &slots, uint32 order) const
+{
+	uint32 low = 0, high = slots.get_count();
+	while(  low < high  ) {
+		const uint32 mid = (low + high) / 2;
+		if(  entries[slots[mid]].order < order  ) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+
+const halt_cargo_t::slot_list_t *halt_cargo_t::find(const index_t &index, uint64 key)
+{
+	const uint32 pos = bucket_pos( index, key );
+	return pos < index.get_count()  &&  index[pos].key == key ? index[pos].slots : NULL;
+}
+
+
+void halt_cargo_t::index_insert(index_t &index, uint64 key, slot_t slot)
+{
+	const uint32 low = bucket_pos( index, key );
+	if(  low == index.get_count()  ||  index[low].key != key  ) {
+		bucket_t b;
+		b.key = key;
+		b.slots = new slot_list_t();
+		index.insert_at( low, b );
+	}
+
+	// mostly the packet is the newest one, otherwise keep the arrival order
+	slot_list_t &slots = *index[low].slots;
+	const uint32 order = entries[slot].order;
+	uint32 pos = slots.get_count();
+	if(  pos > 0  &&  entries[slots[pos-1]].order > order  ) {
+		pos = slot_pos( slots, order );
+	}
+	slots.insert_at( pos, slot );
+}
+
+
+void halt_cargo_t::index_remove(index_t &index, uint64 key, slot_t slot)
+{
+	const uint32 low = bucket_pos( index, key );
+	assert( low < index.get_count()  &&  index[low].key == key );
+
+	slot_list_t &slots = *index[low].slots;
+	const uint32 l = slot_pos( slots, entries[slot].order );
+	assert( l < slots.get_count()  &&  slots[l] == slot );
+	slots.remove_at( l );
+
+	if(  slots.empty()  ) {
+		delete index[low].slots;
+		index.remove_at( low );
+	}
+}
+
+
+void halt_cargo_t::link_indices(slot_t slot)
+{
+	const ware_t &w = entries[slot].ware;
+	index_insert( by_next, next_key(w), slot );
+	index_insert( by_destination, destination_key(w), slot );
+	index_insert( by_zielpos, zielpos_key(w.get_index(), w.get_zielpos()), slot );
+}
+
+
+void halt_cargo_t::unlink_indices(slot_t slot)
+{
+	const ware_t &w = entries[slot].ware;
+	index_remove( by_next, next_key(w), slot );
+	index_remove( by_destination, destination_key(w), slot );
+	index_remove( by_zielpos, zielpos_key(w.get_index(), w.get_zielpos()), slot );
+}
+
+
+void halt_cargo_t::add_sum(const ware_t &w)
+{
+	while(  sums.get_count() <= w.get_index()  ) {
+		sums.append( 0 );
+	}
+	sums[w.get_index()] += w.menge;
+}
+
+
+void halt_cargo_t::sub_sum(const ware_t &w)
+{
+	sums[w.get_index()] -= w.menge;
+}
+
+
+void halt_cargo_t::renumber()
+{
+	uint32 order = 1;
+	for(  slot_t s = head;  s != END;  s = entries[s].next  ) {
+		entries[s].order = order++;
+	}
+	next_order = order;
+	// the relative order is unchanged, so are all slot lists
+}
+
+
+void halt_cargo_t::append(const ware_t &w)
+{
+	if(  next_order == 0xFFFFFFFFu  ) {
+		renumber();
+	}
+
+	slot_t slot;
+	if(  !free_slots.empty()  ) {
+		slot = free_slots.pop_back();
+	}
+	else {
+		slot = entries.get_count();
+		entries.append( entry_t() );
+	}
+
+	entry_t &e = entries[slot];
+	e.ware = w;
+	e.order = next_order++;
+	e.prev = tail;
+	e.next = END;
+	if(  tail != END  ) {
+		entries[tail].next = slot;
+	}
+	else {
+		head = slot;
+	}
+	tail = slot;
+	count++;
+
+	link_indices( slot );
+	add_sum( w );
+}
+
+
+halt_cargo_t::slot_t halt_cargo_t::remove(slot_t slot)
+{
+	unlink_indices( slot );
+	sub_sum( entries[slot].ware );
+
+	entry_t &e = entries[slot];
+	const slot_t next = e.next;
+	if(  e.prev != END  ) {
+		entries[e.prev].next = e.next;
+	}
+	else {
+		head = e.next;
+	}
+	if(  e.next != END  ) {
+		entries[e.next].prev = e.prev;
+	}
+	else {
+		tail = e.prev;
+	}
+	count--;
+
+	if(  count == 0  ) {
+		// start afresh
+		entries.clear();
+		free_slots.clear();
+		next_order = 1;
+	}
+	else {
+		free_slots.append( slot );
+	}
+	return next;
+}
+
+
+void halt_cargo_t::replace(slot_t slot, const ware_t &w)
+{
+	ware_t &old = entries[slot].ware;
+	sub_sum( old );
+	if(  next_key(old) != next_key(w)  ||  destination_key(old) != destination_key(w)  ||  old.get_index() != w.get_index()  ||  old.get_zielpos() != w.get_zielpos()  ) {
+		unlink_indices( slot );
+		old = w;
+		link_indices( slot );
+	}
+	else {
+		old = w;
+	}
+	add_sum( w );
+}
+
+
+void halt_cargo_t::extract(vector_tpl<ware_t> &out)
+{
+	out.resize( out.get_count() + count );
+	for(  slot_t s = head;  s != END;  s = entries[s].next  ) {
+		out.append( entries[s].ware );
+	}
+	clear_index( by_next );
+	clear_index( by_destination );
+	clear_index( by_zielpos );
+	entries.clear();
+	free_slots.clear();
+	sums.clear();
+	head = tail = END;
+	count = 0;
+	next_order = 1;
+}
+
+
+halt_cargo_t::slot_t halt_cargo_t::find_next(const vector_tpl<halthandle_t> &next_halts, uint32 order) const
+{
+	slot_t best = END;
+	uint32 best_order = 0xFFFFFFFFu;
+	FOR(vector_tpl<halthandle_t>, const h, next_halts) {
+		const slot_list_t *slots = get_by_next( h );
+		if(  !slots  ) {
+			continue;
+		}
+		// first packet after order
+		const uint32 l = slot_pos( *slots, order + 1 );
+		if(  l < slots->get_count()  &&  entries[(*slots)[l]].order < best_order  ) {
+			best = (*slots)[l];
+			best_order = entries[best].order;
+		}
+	}
+	return best;
+}
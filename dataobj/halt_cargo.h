@@ -0,0 +1,139 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_HALT_CARGO_H
+#define DATAOBJ_HALT_CARGO_H
+
+
+#include "../simtypes.h"
+#include "../simware.h"
+#include "../tpl/vector_tpl.h"
+
+
+/**
+ * The waiting goods of one category at a halt.
+ * Keeps the packets in arrival order and indexes them by next transfer stop, by destination
+ * (as in ware_t::same_destination()) and by target position, so loading, merging and the
+ * summaries only touch the packets in question.
+ *
+ * The indices are only updated by the methods of this class; hence packets are read-only
+ * and must be changed by replace().
+ */
+class halt_cargo_t
+{
+public:
+	/// storage position of a packet, valid until it is removed
+	typedef uint32 slot_t;
+	static const slot_t END = 0xFFFFFFFFu;
+
+	/// packets with the same key, in arrival order
+	typedef vector_tpl<slot_t> slot_list_t;
+
+private:
+	struct entry_t
+	{
+		ware_t ware;
+		uint32 order;   ///< increases with arrival
+		slot_t prev;    ///< in arrival order
+		slot_t next;
+	};
+
+	struct bucket_t
+	{
+		uint64 key;
+		slot_list_t *slots;
+	};
+
+	/// buckets sorted by key
+	typedef vector_tpl<bucket_t> index_t;
+
+	vector_tpl<entry_t> entries;
+	vector_tpl<slot_t> free_slots;
+	slot_t head, tail;
+	uint32 count;
+	uint32 next_order;
+
+	index_t by_next;
+	index_t by_destination;
+	index_t by_zielpos;
+
+	/// sum of all packets per goods index
+	vector_tpl<uint32> sums;
+
+	static uint64 next_key(const ware_t &w) { return w.get_zwischenziel().get_id(); }
+	static uint64 destination_key(const ware_t &w);
+	static uint64 zielpos_key(uint8 index, koord zielpos) { return ((uint64)index << 32) | ((uint64)(uint16)zielpos.x << 16) | (uint16)zielpos.y; }
+
+	/// @returns the position of the first bucket with a key not less than @p key
+	static uint32 bucket_pos(const index_t &index, uint64 key);
+	/// @returns the position of the first packet in @p slots, which arrived not before @p order
+	uint32 slot_pos(const slot_list_t &slots, uint32 order) const;
+
+	static const slot_list_t *find(const index_t &index, uint64 key);
+	void index_insert(index_t &index, uint64 key, slot_t slot);
+	void index_remove(index_t &index, uint64 key, slot_t slot);
+
+	void link_indices(slot_t slot);
+	void unlink_indices(slot_t slot);
+
+	void add_sum(const ware_t &w);
+	void sub_sum(const ware_t &w);
+
+	/// numbers the packets anew, when the order counter would overflow
+	void renumber();
+
+	static void clear_index(index_t &index);
+
+	halt_cargo_t(const halt_cargo_t &);
+	halt_cargo_t &operator=(const halt_cargo_t &);
+
+public:
+	halt_cargo_t();
+	~halt_cargo_t();
+
+	uint32 get_count() const { return count; }
+	bool empty() const { return count == 0; }
+
+	/// iteration in arrival order
+	slot_t first() const { return head; }
+	slot_t next(slot_t slot) const { return entries[slot].next; }
+
+	const ware_t &operator[](slot_t slot) const { return entries[slot].ware; }
+
+	/// position in arrival order, larger for later packets
+	uint32 get_order(slot_t slot) const { return entries[slot].order; }
+
+	/// adds @p w as the last packet
+	void append(const ware_t &w);
+
+	/// @returns the following packet in arrival order
+	slot_t remove(slot_t slot);
+
+	/// changes the packet at @p slot, it keeps its place in the arrival order
+	void replace(slot_t slot, const ware_t &w);
+
+	/// moves all packets in arrival order to @p out, leaving this empty
+	void extract(vector_tpl<ware_t> &out);
+
+	/// @returns the packets leaving at the next transfer stop @p next_halt (unbound: not routed yet), or NULL
+	const slot_list_t *get_by_next(halthandle_t next_halt) const { return find( by_next, next_halt.get_id() ); }
+
+	/// @returns the packets with ware_t::same_destination( @p w ) (with HANDLES_32BIT maybe also others), or NULL
+	const slot_list_t *get_by_destination(const ware_t &w) const { return find( by_destination, destination_key(w) ); }
+
+	/// @returns the packets of goods @p index for the target position @p zielpos, or NULL
+	const slot_list_t *get_by_zielpos(uint8 index, koord zielpos) const { return find( by_zielpos, zielpos_key(index, zielpos) ); }
+
+	/**
+	 * The first packet after @p order in arrival order, which leaves at one of @p next_halts.
+	 * @returns END, if there is none
+	 */
+	slot_t find_next(const vector_tpl<halthandle_t> &next_halts, uint32 order) const;
+
+	/// @returns the amount of all packets of goods @p index
+	uint32 get_sum(uint8 index) const { return index < sums.get_count() ? sums[index] : 0; }
+};
+
+#endif
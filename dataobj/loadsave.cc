@@ -26,6 +26,7 @@
 #include "../io/rdwr/zlib_file_rdwr_stream.h"
 #if USE_ZSTD
 #include "../io/rdwr/zstd_file_rdwr_stream.h"
+#include "../io/rdwr/zstd_chunked_file_rdwr_stream.h"
 #endif
 
 
@@ -227,9 +228,17 @@ void NORETURN loadsave_t::fatal(const char* who, const char* format, ...)
 }
 
 
+#ifdef HANDLES_32BIT
+#define DEFAULT_WIDE_HANDLES true
+#else
+#define DEFAULT_WIDE_HANDLES false
+#endif
+
+
 loadsave_t::loadsave_t() :
 	mode(binary),
 	buffered(false),
+	wide_handles(DEFAULT_WIDE_HANDLES),
 	stream(NULL)
 {
 	curr_buff = 0;
@@ -310,6 +319,7 @@ void loadsave_t::set_buffered(bool enable)
 loadsave_t::file_status_t loadsave_t::rd_open(const char *filename_utf8)
 {
 	close();
+	wide_handles = DEFAULT_WIDE_HANDLES;
 
 	const file_classify_status_t cl_status = classify_save_file(filename_utf8, &finfo);
 
@@ -348,6 +358,18 @@ loadsave_t::file_status_t loadsave_t::rd_open(const char *filename_utf8)
 		return FILE_STATUS_ERR_UNSUPPORTED_COMPRESSION;
 #endif
 
+	case file_info_t::TYPE_XML_ZSTD_CHUNKED:
+		mode = xml;
+		// fallthrough
+	case file_info_t::TYPE_ZSTD_CHUNKED:
+		mode |= zstd_chunked;
+#if USE_ZSTD
+		stream = new zstd_chunked_file_rdwr_stream_t(filename_utf8, false, 0); break;
+#else
+		dbg->warning("loadsave_t::rd_open", "Cannot read from '%s': Unsupported save file compression 'zstd'", filename_utf8);
+		return FILE_STATUS_ERR_UNSUPPORTED_COMPRESSION;
+#endif
+
 	case file_info_t::TYPE_XML_BZIP2:
 		mode = xml;
 		// fallthrough
@@ -403,10 +425,11 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 {
 	mode = m;
 	close();
+	wide_handles = DEFAULT_WIDE_HANDLES;
 
 #if !USE_ZSTD
-	if( mode & zstd ) {
-		mode &= ~zstd;
+	if( mode & (zstd | zstd_chunked) ) {
+		mode &= ~(zstd | zstd_chunked);
 		mode |= bzip2;
 		dbg->warning( "loadsave_t::wr_open", "Compiled without zstd support, using bzip2!" );
 	}
@@ -417,6 +440,7 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 	switch (mode & ~xml) {
 #if USE_ZSTD
 	case zstd: stream = new zstd_file_rdwr_stream_t(filename_utf8, true, level); break;
+	case zstd_chunked: stream = new zstd_chunked_file_rdwr_stream_t(filename_utf8, true, level); break;
 #endif
 	case bzip2:  stream = new bzip2_file_rdwr_stream_t(filename_utf8, true);       break;
 	case zipped: stream = new zlib_file_rdwr_stream_t(filename_utf8, true, level); break;
@@ -799,6 +823,28 @@ void loadsave_t::rdwr_long(uint32 &l)
 }
 
 
+void loadsave_t::rdwr_handle_id(uint32 &id)
+{
+	if(  wide_handles  ) {
+		rdwr_long(id);
+#ifndef HANDLES_32BIT
+		if(  is_loading()  &&  id > 0xFFFFu  ) {
+			dbg->fatal( "loadsave_t::rdwr_handle_id()", "Handle id %u needs a build with HANDLES_32BIT!", id );
+		}
+#endif
+		return;
+	}
+
+	uint16 short_id = (uint16)id;
+	if(  is_saving()  &&  id > 0xFFFFu  ) {
+		dbg->error( "loadsave_t::rdwr_handle_id()", "Handle id %u cannot be saved in this version!", id );
+		short_id = 0;
+	}
+	rdwr_short(short_id);
+	id = short_id;
+}
+
+
 void loadsave_t::rdwr_longlong(sint64 &ll)
 {
 	if(!is_xml()) {
@@ -47,9 +47,11 @@ public:
 		zipped     = 1 << 2,
 		bzip2      = 1 << 3,
 		zstd       = 1 << 4,
+		zstd_chunked = 1 << 5, ///< independent zstd frames, (de)compressed on several threads
 		xml_zipped = xml | zipped,
 		xml_bzip2  = xml | bzip2,
-		xml_zstd   = xml | zstd
+		xml_zstd   = xml | zstd,
+		xml_zstd_chunked = xml | zstd_chunked
 	};
 
 	enum file_status_t {
@@ -69,6 +71,7 @@ protected:
 
 	int indent;              // only for XML formatting
 	file_info_t finfo;
+	bool wide_handles;       ///< handle ids use 32 bits, see rdwr_handle_id()
 	std::string filename;
 
 	rdwr_stream_t *stream;
@@ -154,6 +157,14 @@ public:
 	void rdwr_bool(bool &i);
 	void rdwr_double(double &dbl);
 
+	/**
+	 * Handle ids of convoys, halts and lines use 16 bits, or 32 bits when built with HANDLES_32BIT.
+	 * New files are written with the width of the build; savegames store it (see karte_t::rdwr_gamestate).
+	 */
+	bool has_wide_handles() const { return wide_handles; }
+	void set_wide_handles(bool yesno) { wide_handles = yesno; }
+	void rdwr_handle_id(uint32 &id);
+
 	void wr_obj_id(short id);
 	short rd_obj_id();
 	void wr_obj_id(const char *id_text);
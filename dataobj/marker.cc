@@ -11,6 +11,7 @@
 
 marker_t marker_t::the_instance;
 marker_t marker_t::second_instance;
+marker_t marker_t::thread_instances[MAX_THREADS-1];
 
 
 void marker_t::init(int world_size_x, int world_size_y)
@@ -38,6 +39,16 @@ marker_t& marker_t::instance(int world_size_x, int world_size_y)
 	return the_instance;
 }
 
+marker_t& marker_t::instance(int world_size_x, int world_size_y, uint8 thread_num)
+{
+	if(  thread_num == 0  ) {
+		return instance(world_size_x, world_size_y);
+	}
+	marker_t &thread_instance = thread_instances[thread_num-1];
+	thread_instance.init(world_size_x, world_size_y);
+	return thread_instance;
+}
+
 marker_t& marker_t::instance_second(int world_size_x, int world_size_y)
 {
 	second_instance.init(world_size_x, world_size_y);
@@ -7,6 +7,7 @@
 #define DATAOBJ_MARKER_H
 
 
+#include "../simconst.h"
 #include "../tpl/ptrhashtable_tpl.h"
 
 class grund_t;
@@ -48,6 +49,9 @@ class marker_t {
 	/// the instance
 	static marker_t the_instance;
 	static marker_t second_instance;
+
+	/// instances for route searches in other threads than the main thread
+	static marker_t thread_instances[MAX_THREADS-1];
 public:
 	/**
 	 * Return handle to marker instance.
@@ -57,6 +61,16 @@ public:
 	 */
 	static marker_t& instance(int world_size_x, int world_size_y);
 
+	/**
+	 * Return handle to the marker instance of a thread.
+	 * Thread 0 shares the singleton instance, so must not run at the same time as the main thread.
+	 * @param world_size_x x-size of map
+	 * @param world_size_y y-size of map
+	 * @param thread_num number of the thread
+	 * @returns handle to the instance of this thread
+	 */
+	static marker_t& instance(int world_size_x, int world_size_y, uint8 thread_num);
+
 	/**
 	 * Return handle to marker instance.
 	 * @param world_size_x x-size of map
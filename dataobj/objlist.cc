@@ -34,6 +34,8 @@
 
 #include "../player/simplay.h"
 
+#include "../boden/wege/strasse.h"
+
 #include "../vehicle/simvehicle.h"
 #include "../vehicle/simroadtraffic.h"
 #include "../vehicle/pedestrian.h"
@@ -350,6 +352,7 @@ bool objlist_t::append(obj_t *new_obj)
 	}
 
 	intern_insert_at(new_obj, top);
+	add_occupant(top-1);
 	return true;
 }
 
@@ -375,43 +378,96 @@ bool objlist_t::intern_add_moving(obj_t* new_obj)
 	while(  end>start  &&  (!obj.some[end-1]->is_moving()  ||  ((vehicle_base_t*)obj.some[end-1])->get_disp_lane() > lane) ) {
 		end--;
 	}
-	if(start==end) {
-		intern_insert_at(new_obj, start);
-		return true;
-	}
 
-	const uint8 direction = ((vehicle_base_t*)new_obj)->get_direction();
+	uint8 pos = start;
+	if(start!=end) {
+		const uint8 direction = ((vehicle_base_t*)new_obj)->get_direction();
 
-	switch(lane) {
-		// pedestrians or road vehicles, back: either w/sw/s or n/ne/e
-		case 0:
-		case 1: {
-			// on right side to w,sw; on left to n: insert last
-			// on right side to s; on left to ne,e: insert first
-			if (direction == ribi_t::south  ||  (direction & ribi_t::east)) {
-				intern_insert_at(new_obj, start);
+		switch(lane) {
+			// pedestrians or road vehicles, back: either w/sw/s or n/ne/e
+			case 0:
+			case 1: {
+				// on right side to w,sw; on left to n: insert last
+				// on right side to s; on left to ne,e: insert first
+				if (direction != ribi_t::south  &&  (direction & ribi_t::east)==0) {
+					pos = end;
+				}
+				break;
 			}
-			else {
-				intern_insert_at(new_obj, end);
+			// middle land
+			case 2:
+			case 3:
+			// pedestrians, road vehicles, front lane
+			case 4: {
+				// going e/s: insert first, else last
+				if ( (direction & ribi_t::northwest)!=0 ) {
+					pos = end;
+				}
+				break;
 			}
-			return true;
+			default:
+				return false;
 		}
-		// middle land
-		case 2:
-		case 3:
-		// pedestrians, road vehicles, front lane
-		case 4: {
-			// going e/s: insert first, else last
-			if ( (direction & ribi_t::northwest)==0 ) {
-				intern_insert_at(new_obj, start);
+	}
+
+	intern_insert_at(new_obj, pos);
+	add_occupant(pos);
+	return true;
+}
+
+
+strasse_t *objlist_t::get_road() const
+{
+	// roads have the lowest waytype, hence are always first
+	if(  capacity>1  &&  top>0  &&  obj.some[0]->get_typ()==obj_t::way  &&  ((weg_t *)obj.some[0])->get_waytype()==road_wt  ) {
+		return (strasse_t *)obj.some[0];
+	}
+	return NULL;
+}
+
+
+bool objlist_t::is_road_occupant(const obj_t *o)
+{
+	return o->is_moving()  &&  o->get_typ()!=obj_t::pedestrian  &&  ((const vehicle_base_t *)o)->get_waytype()==road_wt;
+}
+
+
+void objlist_t::add_occupant(uint8 index)
+{
+	strasse_t *str = get_road();
+	if(  str  &&  is_road_occupant(obj.some[index])  ) {
+		// same order as here
+		uint32 pos = 0;
+		for(  uint8 i=1;  i<index;  i++  ) {
+			if(  is_road_occupant(obj.some[i])  ) {
+				pos++;
 			}
-			else {
-				intern_insert_at(new_obj, end);
+		}
+		str->insert_occupant( pos, (vehicle_base_t *)obj.some[index] );
+	}
+}
+
+
+void objlist_t::remove_occupant(const obj_t *o)
+{
+	if(  o->is_moving()  ) {
+		if(  strasse_t *str = get_road()  ) {
+			str->remove_occupant( (const vehicle_base_t *)o );
+		}
+	}
+}
+
+
+void objlist_t::rebuild_occupants()
+{
+	if(  strasse_t *str = get_road()  ) {
+		str->clear_occupants();
+		for(  uint8 i=1;  i<top;  i++  ) {
+			if(  is_road_occupant(obj.some[i])  ) {
+				str->insert_occupant( str->get_occupants().get_count(), (vehicle_base_t *)obj.some[i] );
 			}
-			return true;
 		}
 	}
-	return false;
 }
 
 
@@ -472,6 +528,8 @@ bool objlist_t::add(obj_t* new_obj)
 		weg_t const* const w   = obj_cast<weg_t>(obj.some[0]);
 		uint8        const pos = w  &&  w->get_waytype() < static_cast<weg_t*>(new_obj)->get_waytype() ? 1 : 0;
 		intern_insert_at(new_obj, pos);
+		// a road may be put below vehicles, when objects are moved to another ground
+		rebuild_occupants();
 		return true;
 	}
 
@@ -534,6 +592,7 @@ obj_t *objlist_t::remove_last()
 	}
 	else {
 		if(top>0) {
+			remove_occupant(obj.some[top-1]);
 			top --;
 			last_obj = obj.some[top];
 			obj.some[top] = NULL;
@@ -562,6 +621,7 @@ bool objlist_t::remove(const obj_t* remove_obj)
 	for(  uint8 i=0;  i<top;  i++  ) {
 		if(  obj.some[i] == remove_obj  ) {
 			// found it!
+			remove_occupant(remove_obj);
 			top--;
 			while(  i < top  ) {
 				obj.some[i] = obj.some[i+1];
@@ -609,6 +669,7 @@ bool objlist_t::loesche_alle(player_t *player, uint8 offset)
 
 	if(capacity>1) {
 		while(  top>offset  ) {
+			remove_occupant(obj.some[top-1]);
 			top --;
 			local_delete_object(obj.some[top], player);
 			obj.some[top] = NULL;
@@ -10,6 +10,8 @@
 #include "../simtypes.h"
 #include "../obj/simobj.h"
 
+class strasse_t;
+
 
 /**
  * All things including ways are stored in this structure.
@@ -54,6 +56,20 @@ private:
 	// this will automatically give the right order for citycars and the like ...
 	bool intern_add_moving(obj_t* new_obj);
 
+	/// the road of this tile, if any
+	strasse_t *get_road() const;
+
+	/// true for all vehicles, which are registered with the road (see strasse_t::get_occupants())
+	static bool is_road_occupant(const obj_t *o);
+
+	/// registers the object at @p index with the road of this tile
+	void add_occupant(uint8 index);
+
+	void remove_occupant(const obj_t *o);
+
+	/// registers all road vehicles anew, when a road is added below them
+	void rebuild_occupants();
+
 	objlist_t(objlist_t const&);
 	objlist_t& operator=(objlist_t const&);
 
@@ -17,6 +17,7 @@
 #include "../ifc/simtestdriver.h"
 #include "loadsave.h"
 #include "route.h"
+#include "route_graph.h"
 #include "environment.h"
 #include "../vehicle/simvehicle.h"
 
@@ -106,12 +107,53 @@ bool route_t::append_straight_route(karte_t *welt, koord3d dest )
 
 
 // node arrays
-route_t::ANode* route_t::nodes=NULL;
+route_t::ANode* route_t::nodes[MAX_THREADS];
 uint32 route_t::MAX_STEP=0;
 #ifdef DEBUG
-bool route_t::node_in_use=false;
+bool route_t::node_in_use[MAX_THREADS];
 #endif
 
+
+/**
+ * Nodes for the search on the route graph: the start, junctions and the target
+ */
+struct graph_node_t
+{
+	graph_node_t *parent;
+	const grund_t *gr;
+	uint32 f;                ///< heuristic for cost to reach target
+	uint32 g;                ///< cost to reach this tile
+	uint32 count;            ///< length of route up to here
+	route_turn_state_t turn; ///< for the curve penalties of the next step
+	ribi_t::ribi first_dir;  ///< direction of the first step from parent
+
+	/// sort nodes first with respect to f, then with respect to g
+	inline bool operator <= (const graph_node_t &k) const { return f==k.f ? g<=k.g : f<=k.f; }
+};
+
+// node arrays for the search on the route graph, only allocated if used
+static graph_node_t *graph_nodes[MAX_THREADS];
+static uint32 max_graph_nodes = 0;
+
+
+route_t::ANode *route_t::init_nodes(karte_t *welt, uint8 thread_num)
+{
+	// memory in static list ...
+	if(  nodes[thread_num] == NULL  ) {
+		if(  MAX_STEP == 0  ) {
+			MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
+		}
+		nodes[thread_num] = new ANode[MAX_STEP + 4 + 2];
+	}
+	if(  graph_nodes[thread_num] == NULL  &&  welt->get_settings().get_route_graph_search()  ) {
+		// only junctions are nodes, so much fewer are needed
+		max_graph_nodes = max( MAX_STEP / 8, 4096u );
+		graph_nodes[thread_num] = new graph_node_t[max_graph_nodes];
+		route_graph_t::init_edges( thread_num );
+	}
+	return nodes[thread_num];
+}
+
 /**
  * find the route to an unknown location
  */
@@ -129,10 +171,7 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	const waytype_t wegtyp = tdriver->get_waytype();
 
 	// memory in static list ...
-	if(  nodes == NULL  ) {
-		MAX_STEP = welt->get_settings().get_max_route_steps();
-		nodes = new ANode[MAX_STEP];
-	}
+	ANode *const node_pool = init_nodes(welt, 0);
 
 	INT_CHECK("route 347");
 
@@ -148,12 +187,12 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 
 	GET_NODE();
 #ifdef USE_VALGRIND_MEMCHECK
-	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
+	VALGRIND_MAKE_MEM_UNDEFINED(node_pool, sizeof(ANode)*MAX_STEP);
 #endif
 
 
 	uint32 step = 0;
-	ANode* tmp = &nodes[step++];
+	ANode* tmp = &node_pool[step++];
 	tmp->parent = NULL;
 	tmp->gr = g;
 	tmp->count = 0;
@@ -218,7 +257,7 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 			    && tdriver->check_next_tile(to, true) // can be driven on
 			) {
 				// not in there or taken out => add new
-				ANode* k = &nodes[step++];
+				ANode* k = &node_pool[step++];
 
 				k->parent = tmp;
 				k->gr = to;
@@ -275,9 +314,8 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 
 
 
-ribi_t::ribi *get_next_dirs(const koord3d& gr_pos, const koord3d& ziel)
+static void get_next_dirs(const koord3d& gr_pos, const koord3d& ziel, ribi_t::ribi next_ribi[4])
 {
-	static ribi_t::ribi next_ribi[4];
 	if( abs(gr_pos.x-ziel.x)>abs(gr_pos.y-ziel.y) ) {
 		next_ribi[0] = (ziel.x>gr_pos.x) ? ribi_t::east : ribi_t::west;
 		next_ribi[1] = (ziel.y>gr_pos.y) ? ribi_t::south : ribi_t::north;
@@ -288,12 +326,53 @@ ribi_t::ribi *get_next_dirs(const koord3d& gr_pos, const koord3d& ziel)
 	}
 	next_ribi[2] = ribi_t::reverse_single( next_ribi[1] );
 	next_ribi[3] = ribi_t::reverse_single( next_ribi[0] );
-	return next_ribi;
 }
 
 
+// one queue per thread, like the node arrays
+static binary_heap_tpl <route_t::ANode *> queues[MAX_THREADS];
+static binary_heap_tpl <graph_node_t *> graph_queues[MAX_THREADS];
 
-bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_speed, const uint32 max_cost)
+
+/**
+ * Lower bound of the cost from @p to to @p ziel, when driving in @p current_dir
+ * after entering @p to in direction @p from.
+ */
+static uint32 calc_heuristic(const grund_t *to, const koord3d &ziel, uint8 current_dir, ribi_t::ribi from, uint32 cost_upslope)
+{
+	uint32 dist = koord_distance( to->get_pos(), ziel );
+
+	// count how many 45 degree turns are necessary to get to target
+	sint8 turns = 0;
+	if (dist>1) {
+		ribi_t::ribi to_target = ribi_type(to->get_pos(), ziel );
+
+		if (to_target  &&  (to_target!=current_dir)) {
+			if (ribi_t::is_single(current_dir) != ribi_t::is_single(to_target)) {
+				to_target = ribi_t::rotate45(to_target);
+				turns ++;
+			}
+			while(to_target!=current_dir) {
+				to_target = ribi_t::rotate90(to_target);
+				turns +=2;
+			}
+			if (turns>4) turns = 8-turns;
+		}
+	}
+	// add 3*turns to the heuristic bound
+
+	// take height difference into account when calculating distance
+	uint32 costup = 0;
+	if (cost_upslope) {
+		costup = cost_upslope * max(ziel.z - to->get_vmove(from), 0);
+	}
+
+	return dist + turns * 3 + costup;
+}
+
+
+
+bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_speed, const uint32 max_cost, uint8 thread_num)
 {
 	bool ok = false;
 
@@ -332,22 +411,24 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 	bool ziel_erreicht=false;
 
 	// memory in static list ...
-	if(  nodes == NULL  ) {
-		MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		nodes = new ANode[MAX_STEP + 4 + 2];
+	if(  thread_num == 0  ) {
+		init_nodes(welt, 0);
 	}
+	// the other threads only search in the plan phase, and karte_t::plan_convois() allocated their memory
+	ANode *const node_pool = nodes[thread_num];
+	assert( node_pool );
 
 	INT_CHECK("route 347");
 
-	static binary_heap_tpl <ANode *> queue;
+	binary_heap_tpl <ANode *> &queue = queues[thread_num];
 
-	GET_NODE();
+	GET_NODE(thread_num);
 #ifdef USE_VALGRIND_MEMCHECK
-	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
+	VALGRIND_MAKE_MEM_UNDEFINED(node_pool, sizeof(ANode)*MAX_STEP);
 #endif
 
 	uint32 step = 0;
-	ANode* tmp = &nodes[step];
+	ANode* tmp = &node_pool[step];
 	step ++;
 
 	tmp->parent = NULL;
@@ -360,7 +441,7 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 	tmp->jps_ribi  = ribi_t::all;
 
 	// nothing in lists
-	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y);
+	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y, thread_num);
 
 	// clear the queue (should be empty anyhow)
 	queue.clear();
@@ -404,7 +485,8 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 		// mask direction we came from
 		const ribi_t::ribi ribi =  way_ribi  &  ( ~ribi_t::reverse_single(tmp->ribi_from) )  &  tmp->jps_ribi;
 
-		const ribi_t::ribi *next_ribi = get_next_dirs(gr->get_pos(), ziel);
+		ribi_t::ribi next_ribi[4];
+		get_next_dirs(gr->get_pos(), ziel, next_ribi);
 		for(int r=0; r<4; r++) {
 
 			// a way in our direction?
@@ -454,37 +536,10 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 					current_dir = next_ribi[r];
 				}
 
-				uint32 dist = calc_distance( to->get_pos(), ziel );
-
-				// count how many 45 degree turns are necessary to get to target
-				sint8 turns = 0;
-				if (dist>1) {
-					ribi_t::ribi to_target = ribi_type(to->get_pos(), ziel );
-
-					if (to_target  &&  (to_target!=current_dir)) {
-						if (ribi_t::is_single(current_dir) != ribi_t::is_single(to_target)) {
-							to_target = ribi_t::rotate45(to_target);
-							turns ++;
-						}
-						while(to_target!=current_dir) {
-							to_target = ribi_t::rotate90(to_target);
-							turns +=2;
-						}
-						if (turns>4) turns = 8-turns;
-					}
-				}
-				// add 3*turns to the heuristic bound
-
-				// take height difference into account when calculating distance
-				uint32 costup = 0;
-				if (cost_upslope) {
-					costup = cost_upslope * max(ziel.z - to->get_vmove(next_ribi[r]), 0);
-				}
-
-				const uint32 new_f = new_g + dist + turns * 3 + costup;
+				const uint32 new_f = new_g + calc_heuristic( to, ziel, current_dir, next_ribi[r], cost_upslope );
 
 				// add new
-				ANode* k = &nodes[step];
+				ANode* k = &node_pool[step];
 				step ++;
 
 				k->parent = tmp;
@@ -564,7 +619,214 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 		ok = true;
 	}
 
-	RELEASE_NODE();
+	RELEASE_NODE(thread_num);
+
+	return ok;
+}
+
+
+bool route_t::intern_calc_route_graph(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_speed, const uint32 max_cost, uint8 thread_num, bool &gave_up)
+{
+	bool ok = false;
+	gave_up = false;
+
+	// check for existing koordinates
+	const grund_t *gr = welt->lookup(start);
+	const grund_t *ziel_gr = welt->lookup(ziel);
+	if(  gr == NULL  ||  ziel_gr == NULL  ) {
+		return false;
+	}
+
+	route.clear();
+
+	// first tile is not valid?!?
+	if(  !tdriver->check_next_tile(gr)  ) {
+		return false;
+	}
+
+	if(  thread_num == 0  ) {
+		init_nodes(welt, 0);
+	}
+	// the other threads only search in the plan phase, and karte_t::plan_convois() allocated their memory
+	graph_node_t *const node_pool = graph_nodes[thread_num];
+	assert( node_pool );
+
+	const waytype_t wegtyp = tdriver->get_waytype();
+	const uint32 cost_upslope = tdriver->get_cost_upslope();
+
+	// start and target must not be skipped inside an edge
+	const bool start_inner = route_graph_t::is_inner_tile( gr, wegtyp );
+	const bool ziel_inner = route_graph_t::is_inner_tile( ziel_gr, wegtyp );
+
+	bool ziel_erreicht = false;
+
+	INT_CHECK("route graph 1");
+
+	binary_heap_tpl <graph_node_t *> &queue = graph_queues[thread_num];
+
+	GET_NODE(thread_num);
+
+	uint32 step = 0;
+	graph_node_t* tmp = &node_pool[step];
+	step ++;
+
+	tmp->parent = NULL;
+	tmp->gr = gr;
+	tmp->f = calc_distance(start,ziel);
+	tmp->g = 0;
+	tmp->count = 0;
+	tmp->turn.dir = 0;
+	tmp->turn.parent_dir = 0;
+	tmp->turn.ribi_from = ribi_t::none;
+	tmp->turn.depth = 0;
+	tmp->first_dir = ribi_t::none;
+
+	// nothing in lists
+	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y, thread_num);
+
+	queue.clear();
+	queue.insert(tmp);
+
+	uint32 beat=1;
+	while(  !queue.empty()  &&  step < max_graph_nodes  ) {
+		// this is too expensive to be called each step
+		if((beat++ & 4095) == 0) {
+			INT_CHECK("route graph 2");
+		}
+
+		tmp = queue.pop();
+		gr = tmp->gr;
+		if(  tmp->g >= max_cost  ) {
+			break;
+		}
+		if(  marker.test_and_mark(gr)  ) {
+			// we were already here on a faster route
+			continue;
+		}
+
+		if(  ziel == gr->get_pos()  ) {
+			ziel_erreicht = true;
+			break;
+		}
+
+		const ribi_t::ribi ribi = tdriver->get_ribi(gr)  &  ( ~ribi_t::reverse_single(tmp->turn.ribi_from) );
+
+		ribi_t::ribi next_ribi[4];
+		get_next_dirs(gr->get_pos(), ziel, next_ribi);
+		for(  int r=0;  r<4  &&  step < max_graph_nodes;  r++  ) {
+
+			// a way in our direction?
+			if(  (ribi & next_ribi[r])==0  ) {
+				continue;
+			}
+
+			route_turn_state_t turn = tmp->turn;
+			uint32 new_g = tmp->g;
+			uint32 count = tmp->count;
+			grund_t *to = NULL;
+			ribi_t::ribi to_dir = next_ribi[r];
+
+			const route_edge_t *edge = NULL;
+			uint32 edge_cost;
+			if(  !route_graph_t::is_inner_tile( gr, wegtyp )
+				&&  (edge = route_graph_t::get_edge( gr, wegtyp, next_ribi[r], thread_num ))
+				&&  !(start_inner  &&  edge->bbox_min.x <= start.x  &&  start.x <= edge->bbox_max.x  &&  edge->bbox_min.y <= start.y  &&  start.y <= edge->bbox_max.y)
+				&&  !(ziel_inner  &&  edge->bbox_min.x <= ziel.x  &&  ziel.x <= edge->bbox_max.x  &&  edge->bbox_min.y <= ziel.y  &&  ziel.y <= edge->bbox_max.y)
+				&&  tdriver->get_edge_cost( *edge, max_speed, edge_cost )  ) {
+				// take all inner tiles at once
+				new_g += edge_cost + edge->turn_cost;
+				for(  int i=0;  i<3;  i++  ) {
+					new_g += route_graph_t::step_turn_cost( turn, edge->dirs[i] );
+				}
+				// state on the last inner tile
+				turn.dir = edge->end_dirs[2] | edge->end_dirs[1];
+				turn.parent_dir = edge->end_dirs[1] | edge->end_dirs[0];
+				turn.ribi_from = edge->end_dirs[2];
+				turn.depth = 2;
+				count += edge->length - 1;
+				to = welt->lookup( edge->end );
+				to_dir = edge->end_dirs[3];
+			}
+			else if(  !gr->get_neighbour( to, wegtyp, to_dir )  ) {
+				to = NULL;
+			}
+
+			// go on tile by tile up to the next junction
+			while(  to  ) {
+				if(  !tdriver->check_next_tile(to)  ||  marker.is_marked(to)  ) {
+					break;
+				}
+
+				const weg_t *w = to->get_weg(wegtyp);
+				// Do not go on a tile, where a oneway sign forbids going.
+				if(  w  &&  w->get_ribi_maske()  &&  ribi_t::reverse_single(to_dir) == w->get_ribi()  ) {
+					break;
+				}
+
+				new_g += (w ? tdriver->get_cost(to, w, max_speed, to_dir) : 1);
+				new_g += route_graph_t::step_turn_cost( turn, to_dir );
+				count ++;
+				if(  new_g >= max_cost  ||  count >= INVALID_INDEX  ) {
+					break;
+				}
+
+				if(  to->get_pos() == ziel  ||  !route_graph_t::is_inner_tile( to, wegtyp )  ) {
+					// add new
+					graph_node_t* k = &node_pool[step];
+					step ++;
+
+					k->parent = tmp;
+					k->gr = to;
+					k->g = new_g;
+					k->f = new_g + calc_heuristic( to, ziel, turn.dir, to_dir, cost_upslope );
+					k->count = count;
+					k->turn = turn;
+					k->first_dir = next_ribi[r];
+					queue.insert( k );
+					break;
+				}
+
+				// only one way to go on an inner tile
+				const ribi_t::ribi next_dir = tdriver->get_ribi(to) & ~ribi_t::reverse_single(to_dir);
+				grund_t *next_gr;
+				if(  next_dir == ribi_t::none  ||  !to->get_neighbour( next_gr, wegtyp, next_dir )  ) {
+					break;
+				}
+				to = next_gr;
+				to_dir = next_dir;
+			}
+		}
+	}
+
+	INT_CHECK("route graph 3");
+	// target reached?
+	if(  !ziel_erreicht  ||  tmp->parent==NULL  ) {
+		if(  step >= max_graph_nodes  ) {
+			// the tile search will try with more memory
+			gave_up = true;
+		}
+	}
+	else {
+		// reached => construct route, filling in the inner tiles of each edge
+		route.store_at( tmp->count, tmp->gr->get_pos() );
+		while(  tmp->parent != NULL  ) {
+			route[ tmp->count ] = tmp->gr->get_pos();
+			const grund_t *from = tmp->parent->gr;
+			ribi_t::ribi dir = tmp->first_dir;
+			for(  uint32 i = tmp->parent->count + 1;  i < tmp->count;  i++  ) {
+				grund_t *to = NULL;
+				from->get_neighbour( to, wegtyp, dir );
+				route[i] = to->get_pos();
+				dir = to->get_weg_ribi_unmasked(wegtyp) & ~ribi_t::reverse_single(dir);
+				from = to;
+			}
+			tmp = tmp->parent;
+		}
+		route[0] = tmp->gr->get_pos();
+		ok = true;
+	}
+
+	RELEASE_NODE(thread_num);
 
 	return ok;
 }
@@ -686,7 +948,49 @@ bool is_way_bend(koord3d pos, waytype_t waytype) {
  * searches route, uses intern_calc_route() for distance between stations
  * handles only driving in stations by itself
  */
-route_t::route_result_t route_t::calc_route(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_khm, sint32 max_len )
+route_t::route_result_t route_t::calc_route(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_khm, sint32 max_len, prepared_t *prepared )
+{
+	if(  prepared  &&  prepared->valid  ) {
+		prepared->valid = false;
+		if(  prepared->start == ziel  &&  prepared->target == start  &&  prepared->max_speed_kmh == max_khm  &&  prepared->max_len == max_len  &&  prepared->ticks == welt->get_ticks()  ) {
+			// nothing could have changed since => same result as searching now
+#ifdef DEBUG
+			// check this, since a different result would desync games with a different number of threads
+			const route_result_t result = search_route( welt, ziel, start, tdriver, max_khm, max_len, 0 );
+			bool same = result == prepared->result  &&  route.get_count() == prepared->route.get_count();
+			for(  uint32 i = 0;  same  &&  i < route.get_count();  i++  ) {
+				same = route[i] == prepared->route[i];
+			}
+			if(  !same  ) {
+				dbg->fatal( "route_t::calc_route()", "prepared route from %s to %s differs from the search now", ziel.get_str(), start.get_str() );
+			}
+			return result;
+#else
+			swap( route, prepared->route );
+			return prepared->result;
+#endif
+		}
+	}
+	return search_route( welt, ziel, start, tdriver, max_khm, max_len, 0 );
+}
+
+
+void route_t::prepare_route(karte_t *welt, const koord3d start, const koord3d target, test_driver_t *tdriver, const sint32 max_khm, sint32 max_len, prepared_t &prepared, uint8 thread_num )
+{
+	route_t r;
+	swap( r.route, prepared.route ); // reuse the memory
+	prepared.result = r.search_route( welt, start, target, tdriver, max_khm, max_len, thread_num );
+	swap( r.route, prepared.route );
+	prepared.start = start;
+	prepared.target = target;
+	prepared.max_speed_kmh = max_khm;
+	prepared.max_len = max_len;
+	prepared.ticks = welt->get_ticks();
+	prepared.valid = true;
+}
+
+
+route_t::route_result_t route_t::search_route(karte_t *welt, const koord3d ziel, const koord3d start, test_driver_t *tdriver, const sint32 max_khm, sint32 max_len, uint8 thread_num )
 {
 	route.clear();
 
@@ -695,7 +999,15 @@ route_t::route_result_t route_t::calc_route(karte_t *welt, const koord3d ziel, c
 #ifdef DEBUG_ROUTES
 	const uint32 ms = dr_time();
 #endif
-	const bool ok = intern_calc_route(welt, start, ziel, tdriver, max_khm, 0xFFFFFFFFul );
+	bool ok = false;
+	bool use_tiles = true;
+	// without edge costs the graph search would walk all tiles too, only with more overhead
+	if(  welt->get_settings().get_route_graph_search()  &&  tdriver->has_edge_cost()  ) {
+		ok = intern_calc_route_graph(welt, start, ziel, tdriver, max_khm, 0xFFFFFFFFul, thread_num, use_tiles );
+	}
+	if(  use_tiles  ) {
+		ok = intern_calc_route(welt, start, ziel, tdriver, max_khm, 0xFFFFFFFFul, thread_num );
+	}
 #ifdef DEBUG_ROUTES
 	if(tdriver->get_waytype()==water_wt) {
 		DBG_DEBUG("route_t::calc_route()", "route from %d,%d to %d,%d with %i steps in %u ms found.", start.x, start.y, ziel.x, ziel.y, route.get_count()-1, dr_time()-ms );
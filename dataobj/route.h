@@ -8,6 +8,7 @@
 
 
 #include "../simdebug.h"
+#include "../simconst.h"
 
 #include "../dataobj/koord3d.h"
 
@@ -30,8 +31,16 @@ public:
 private:
 	/**
 	 * The actual route search
+	 * @param thread_num selects the search memory, so searches of different threads do not interfere
 	 */
-	bool intern_calc_route(karte_t *w, koord3d start, koord3d ziel, test_driver_t *tdriver, const sint32 max_kmh, const uint32 max_cost);
+	bool intern_calc_route(karte_t *w, koord3d start, koord3d ziel, test_driver_t *tdriver, const sint32 max_kmh, const uint32 max_cost, uint8 thread_num);
+
+	/**
+	 * The route search on the route graph (see route_graph_t): only junctions are nodes,
+	 * the runs of tiles between them are taken at once.
+	 * @param gave_up set, if the nodes were not sufficient, then the tile search should be used
+	 */
+	bool intern_calc_route_graph(karte_t *w, koord3d start, koord3d ziel, test_driver_t *tdriver, const sint32 max_kmh, const uint32 max_cost, uint8 thread_num, bool &gave_up);
 
 	koord3d_vector_t route;           // The coordinates for the vehicle route
 
@@ -67,18 +76,51 @@ public:
 		inline bool operator <= (const ANode &k) const { return f==k.f ? g<=k.g : f<=k.f; }
 	};
 
-	static ANode *nodes;
+	/// node arrays, one per thread (allocated on first use by init_nodes())
+	static ANode *nodes[MAX_THREADS];
 	static uint32 MAX_STEP;
 #ifdef DEBUG
-	// a semaphore, since we only have a single version of the array in memory
-	static bool node_in_use;
-	static void GET_NODE() {if(node_in_use){ dbg->fatal("GET_NODE","called while list in use");} node_in_use =1; }
-	static void RELEASE_NODE() {if(!node_in_use){ dbg->fatal("RELEASE_NODE","called while list free");} node_in_use =0; }
+	// a semaphore, since we only have a single version of the array per thread in memory
+	static bool node_in_use[MAX_THREADS];
+	static void GET_NODE(uint8 thread_num = 0) {if(node_in_use[thread_num]){ dbg->fatal("GET_NODE","called while list in use");} node_in_use[thread_num] =1; }
+	static void RELEASE_NODE(uint8 thread_num = 0) {if(!node_in_use[thread_num]){ dbg->fatal("RELEASE_NODE","called while list free");} node_in_use[thread_num] =0; }
 #else
-	static void GET_NODE() {}
-	static void RELEASE_NODE() {}
+	static void GET_NODE(uint8 = 0) {}
+	static void RELEASE_NODE(uint8 = 0) {}
 #endif
 
+	/**
+	 * Allocates the node arrays (and the route graph memory, if used) of thread @p thread_num, if not done yet.
+	 * Must be called from the main thread before any worker thread searches; the searches allocate only for thread 0.
+	 */
+	static ANode *init_nodes(karte_t *welt, uint8 thread_num);
+
+	/**
+	 * Result of a route search done ahead of time, i.e. during the parallel plan phase
+	 * of karte_t::step(). calc_route() takes it over instead of searching again,
+	 * if it was searched with the same parameters and no sync_step happened since.
+	 */
+	struct prepared_t {
+		koord3d_vector_t route;
+		koord3d start;
+		koord3d target;
+		sint32 max_speed_kmh;
+		sint32 max_len;
+		uint32 ticks;
+		route_result_t result;
+		bool valid;
+
+		prepared_t() : max_speed_kmh(0), max_len(0), ticks(0), result(no_route), valid(false) {}
+	};
+
+private:
+	/**
+	 * The search part of calc_route(), also used by prepare_route()
+	 */
+	route_result_t search_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, sint32 max_len, uint8 thread_num);
+
+public:
+
 	const koord3d_vector_t &get_route() const { return route; }
 
 	void rotate90( sint16 y_size ) { route.rotate90( y_size ); }
@@ -141,8 +183,16 @@ public:
 	/**
 	 * Calculates the route from @p start to @p target
 	 * @param for max_len, 16 is one tile
+	 * @param prepared if it holds a valid search result for the same parameters, it is used instead of searching
+	 */
+	route_result_t calc_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, sint32 max_len, prepared_t *prepared = NULL );
+
+	/**
+	 * Searches the route from @p start to @p target into @p prepared, to be used by a later calc_route().
+	 * Does not change anything in the world, hence several threads can prepare routes at the same time,
+	 * each with its own @p thread_num.
 	 */
-	route_result_t calc_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, sint32 max_len );
+	static void prepare_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, sint32 max_len, prepared_t &prepared, uint8 thread_num );
 
 	/**
 	 * Load/Save of the route.
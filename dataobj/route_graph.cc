@@ -0,0 +1,224 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "route_graph.h"
+
+#include "../boden/grund.h"
+#include "../boden/wege/weg.h"
+
+
+// a block is BLOCK_SIZE x BLOCK_SIZE tiles
+#define BLOCK_SHIFT (4)
+
+// edge cache entries per thread (must be a power of two)
+#define ROUTE_GRAPH_EDGES (1<<15)
+
+// longer runs are searched tile by tile
+#define MAX_EDGE_LENGTH (60000)
+
+// shorter edges are searched tile by tile, since the first three steps depend on how the edge was entered
+#define MIN_EDGE_LENGTH (5)
+
+
+uint32 *route_graph_t::block_changed = NULL;
+sint16 route_graph_t::blocks_x = 0;
+sint16 route_graph_t::blocks_y = 0;
+uint32 route_graph_t::change_counter = 1;
+route_edge_t *route_graph_t::edges[MAX_THREADS];
+
+
+void route_graph_t::reset(koord size)
+{
+	delete [] block_changed;
+	blocks_x = (size.x >> BLOCK_SHIFT) + 1;
+	blocks_y = (size.y >> BLOCK_SHIFT) + 1;
+	block_changed = new uint32[ blocks_x * blocks_y ];
+	// everything traced before is outdated now
+	change_counter ++;
+	for(  sint32 i = 0;  i < blocks_x * blocks_y;  i++  ) {
+		block_changed[i] = change_counter;
+	}
+}
+
+
+void route_graph_t::free()
+{
+	delete [] block_changed;
+	block_changed = NULL;
+	blocks_x = blocks_y = 0;
+	for(  int t = 0;  t < MAX_THREADS;  t++  ) {
+		delete [] edges[t];
+		edges[t] = NULL;
+	}
+}
+
+
+void route_graph_t::mark_changed(sint16 x, sint16 y)
+{
+	const sint16 bx = x >> BLOCK_SHIFT;
+	const sint16 by = y >> BLOCK_SHIFT;
+	if(  x < 0  ||  y < 0  ||  bx >= blocks_x  ||  by >= blocks_y  ) {
+		// e.g. ways not yet placed on the map
+		return;
+	}
+	// also the neighbouring blocks, since a junction there may connect to this tile
+	const sint16 x_min = (x-1) < 0 ? 0 : (x-1) >> BLOCK_SHIFT;
+	const sint16 y_min = (y-1) < 0 ? 0 : (y-1) >> BLOCK_SHIFT;
+	const sint16 x_max = min( ((x+1) >> BLOCK_SHIFT), blocks_x-1 );
+	const sint16 y_max = min( ((y+1) >> BLOCK_SHIFT), blocks_y-1 );
+	change_counter ++;
+	for(  sint16 j = y_min;  j <= y_max;  j++  ) {
+		for(  sint16 i = x_min;  i <= x_max;  i++  ) {
+			block_changed[ j * blocks_x + i ] = change_counter;
+		}
+	}
+}
+
+
+bool route_graph_t::is_unchanged(koord bbox_min, koord bbox_max, uint32 stamp)
+{
+	if(  block_changed == NULL  ) {
+		return false;
+	}
+	const sint16 x_max = bbox_max.x >> BLOCK_SHIFT;
+	const sint16 y_max = bbox_max.y >> BLOCK_SHIFT;
+	if(  x_max >= blocks_x  ||  y_max >= blocks_y  ) {
+		// traced on a different map
+		return false;
+	}
+	for(  sint16 j = bbox_min.y >> BLOCK_SHIFT;  j <= y_max;  j++  ) {
+		for(  sint16 i = bbox_min.x >> BLOCK_SHIFT;  i <= x_max;  i++  ) {
+			if(  block_changed[ j * blocks_x + i ] > stamp  ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+bool route_graph_t::is_current(const route_edge_t &edge)
+{
+	return is_unchanged( edge.bbox_min, edge.bbox_max, edge.stamp );
+}
+
+
+bool route_graph_t::is_inner_tile(const grund_t *gr, waytype_t wt)
+{
+	return ribi_t::is_twoway( gr->get_weg_ribi_unmasked(wt) );
+}
+
+
+void route_graph_t::trace(const grund_t *from, waytype_t wt, ribi_t::ribi dir, route_edge_t &edge)
+{
+	edge.start = from->get_pos();
+	edge.end = koord3d::invalid;
+	edge.bbox_min = edge.bbox_max = edge.start.get_2d();
+	edge.stamp = change_counter;
+	edge.length = 0;
+	edge.turn_cost = 0;
+	edge.upslopes = 0;
+	edge.speeds = 0;
+	edge.waytype = wt;
+	edge.start_dir = dir;
+	edge.plain = true;
+	edge.electrified = true;
+	edge.usable = false;
+
+	// the penalties from the fourth step on do not depend on the state before the edge
+	route_turn_state_t state = { 0, 0, 0, 2 };
+	const grund_t *gr = from;
+	while(  true  ) {
+		grund_t *to;
+		if(  !gr->get_neighbour( to, wt, dir )  ) {
+			// broken connection, the tile search will find out what to do
+			return;
+		}
+		const koord pos = to->get_pos().get_2d();
+		edge.bbox_min.clip_max( pos );
+		edge.bbox_max.clip_min( pos );
+
+		if(  edge.length < 3  ) {
+			edge.dirs[edge.length] = dir;
+		}
+		edge.end_dirs[0] = edge.end_dirs[1];
+		edge.end_dirs[1] = edge.end_dirs[2];
+		edge.end_dirs[2] = edge.end_dirs[3];
+		edge.end_dirs[3] = dir;
+		edge.length ++;
+
+		if(  !is_inner_tile( to, wt )  ) {
+			edge.end = to->get_pos();
+			edge.usable = edge.length >= MIN_EDGE_LENGTH;
+			return;
+		}
+		if(  edge.length >= MAX_EDGE_LENGTH  ) {
+			return;
+		}
+
+		const uint32 turn_cost = step_turn_cost( state, dir );
+		if(  edge.length >= 4  ) {
+			edge.turn_cost += turn_cost;
+		}
+
+		const weg_t *w = to->get_weg(wt);
+		edge.upslopes += get_sloping_upwards( to->get_weg_hang(), dir );
+		if(  w->has_sign()  ||  w->has_signal()  ||  w->get_ribi_maske()  ||  w->get_max_speed() <= 0  ||  to->get_depot()  ) {
+			edge.plain = false;
+		}
+		if(  !w->is_electrified()  ) {
+			edge.electrified = false;
+		}
+
+		const uint16 speed = (uint16)w->get_max_speed();
+		uint8 i = 0;
+		while(  i < edge.speeds  &&  edge.speed[i] != speed  ) {
+			i++;
+		}
+		if(  i < edge.speeds  ) {
+			edge.speed_count[i] ++;
+		}
+		else if(  i < ROUTE_EDGE_SPEEDS  ) {
+			edge.speed[i] = speed;
+			edge.speed_count[i] = 1;
+			edge.speeds ++;
+		}
+		else {
+			// too many different speeds to summarize
+			edge.plain = false;
+		}
+
+		dir = to->get_weg_ribi_unmasked(wt) & ~ribi_t::reverse_single(dir);
+		gr = to;
+	}
+}
+
+
+void route_graph_t::init_edges(uint8 thread_num)
+{
+	if(  edges[thread_num] == NULL  ) {
+		edges[thread_num] = new route_edge_t[ROUTE_GRAPH_EDGES];
+		for(  uint32 i = 0;  i < ROUTE_GRAPH_EDGES;  i++  ) {
+			edges[thread_num][i].start = koord3d::invalid;
+		}
+	}
+}
+
+
+const route_edge_t *route_graph_t::get_edge(const grund_t *gr, waytype_t wt, ribi_t::ribi dir, uint8 thread_num)
+{
+	if(  block_changed == NULL  ) {
+		return NULL;
+	}
+	assert( edges[thread_num] );
+
+	const koord3d pos = gr->get_pos();
+	const uint32 hash = ((uint32)pos.x * 73856093u) ^ ((uint32)pos.y * 19349663u) ^ ((uint32)(uint8)pos.z * 83492791u) ^ ((uint32)dir << 8) ^ (uint32)wt;
+	route_edge_t &edge = edges[thread_num][ hash & (ROUTE_GRAPH_EDGES-1) ];
+	if(  edge.start != pos  ||  edge.start_dir != dir  ||  edge.waytype != wt  ||  !is_current(edge)  ) {
+		trace( gr, wt, dir, edge );
+	}
+	return edge.usable ? &edge : NULL;
+}
@@ -0,0 +1,159 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_ROUTE_GRAPH_H
+#define DATAOBJ_ROUTE_GRAPH_H
+
+
+#include "../simconst.h"
+#include "../simtypes.h"
+#include "koord3d.h"
+#include "ribi.h"
+
+
+class grund_t;
+
+
+// number of different way speeds an edge can summarize
+#define ROUTE_EDGE_SPEEDS (4)
+
+
+/**
+ * A run of tiles without junctions between two junctions (or dead ends) of the same waytype,
+ * as seen from the junction at its start.
+ * The summary of the inner tiles only depends on the ways, not on the vehicle.
+ * Vehicles can compute the cost of all inner tiles from it at once, see test_driver_t::get_edge_cost().
+ */
+struct route_edge_t
+{
+	koord3d start;       ///< junction the edge starts from
+	koord3d end;         ///< junction or dead end at the other end
+	koord bbox_min;      ///< bounding box of all tiles of the edge, including both ends
+	koord bbox_max;
+	uint32 stamp;        ///< route_graph_t change counter, when the edge was traced
+	uint32 length;       ///< number of steps from start to end
+	uint32 turn_cost;    ///< curve penalties for entering the fourth and all following inner tiles
+	uint32 upslopes;     ///< sum of get_sloping_upwards() over the inner tiles
+	uint32 speed_count[ROUTE_EDGE_SPEEDS]; ///< number of inner tiles with speed[i]
+	uint16 speed[ROUTE_EDGE_SPEEDS];       ///< the different max speeds of the inner tiles
+	uint8 speeds;        ///< used entries in speed[]
+	uint8 waytype;
+	ribi_t::ribi start_dir;   ///< direction of the first step
+	ribi_t::ribi dirs[3];     ///< directions of the first three steps
+	ribi_t::ribi end_dirs[4]; ///< directions of the last four steps, the last one enters end
+	bool plain;          ///< no signs, signals, depots or closed ways on the inner tiles
+	bool electrified;    ///< all inner tiles are electrified
+	bool usable;         ///< long enough and a proper edge, otherwise the tiles are searched one by one
+};
+
+
+/**
+ * State of the curve penalties of the route search, see route_t::intern_calc_route()
+ */
+struct route_turn_state_t
+{
+	uint8 dir;        ///< driving direction on the current tile
+	uint8 parent_dir; ///< driving direction on the previous tile
+	uint8 ribi_from;  ///< we came from this direction
+	uint8 depth;      ///< steps from the start of the search, but at most two
+};
+
+
+/**
+ * The hierarchical graph for route_t: runs of tiles without junctions are collapsed into edges.
+ * Edges are traced on first use and cached per thread; any change of a way marks its map block
+ * as changed, which invalidates all edges touching that block.
+ */
+class route_graph_t
+{
+	/// change counter of each map block at the time of the last change
+	static uint32 *block_changed;
+	static sint16 blocks_x;
+	static sint16 blocks_y;
+
+	static uint32 change_counter;
+
+	/// the edge caches, one per thread (allocated by init_edges())
+	static route_edge_t *edges[MAX_THREADS];
+
+	static void mark_changed(sint16 x, sint16 y);
+
+	/// @returns true, if no way in the bounding box of the edge changed since it was traced
+	static bool is_current(const route_edge_t &edge);
+
+	static void trace(const grund_t *from, waytype_t wt, ribi_t::ribi dir, route_edge_t &edge);
+
+public:
+	/**
+	 * Sets up the block table for a map of size @p size and invalidates all edges.
+	 * To be called from the main thread, when a map is created, loaded, enlarged or rotated.
+	 */
+	static void reset(koord size);
+
+	/// frees all memory
+	static void free();
+
+	/// Allocates the edge cache of thread @p thread_num, if not done yet. Main thread only.
+	static void init_edges(uint8 thread_num);
+
+	/// @returns the current change counter, to stamp data derived from the ways
+	static uint32 get_change_counter() { return change_counter; }
+
+	/**
+	 * @returns true, if no way in the rectangle @p bbox_min to @p bbox_max changed since the counter was @p stamp,
+	 * false also if the change tracking is not set up
+	 */
+	static bool is_unchanged(koord bbox_min, koord bbox_max, uint32 stamp);
+
+	/// Must be called for all changes of ways (direction, speed, signs, slope ...) at @p pos.
+	static inline void tile_changed(const koord3d &pos)
+	{
+		if(  block_changed  ) {
+			mark_changed( pos.x, pos.y );
+		}
+	}
+
+	/// inner tiles have exactly two directions, all others are junctions or dead ends
+	static bool is_inner_tile(const grund_t *gr, waytype_t wt);
+
+	/**
+	 * The edge leaving the junction @p gr in direction @p dir.
+	 * @returns NULL, if the tiles in this direction must be searched one by one
+	 */
+	static const route_edge_t *get_edge(const grund_t *gr, waytype_t wt, ribi_t::ribi dir, uint8 thread_num);
+
+	/**
+	 * Adds the curve penalty for going in direction @p dir to the route search cost
+	 * and updates @p state accordingly.
+	 */
+	static inline uint32 step_turn_cost(route_turn_state_t &state, ribi_t::ribi dir)
+	{
+		uint32 cost = 0;
+		uint8 current_dir = dir;
+		if(  state.depth > 0  ) {
+			current_dir = dir | state.ribi_from;
+			if(  state.dir != current_dir  ) {
+				cost += 3;
+				if(  state.parent_dir != state.dir  &&  state.depth > 1  ) {
+					// discourage 90 degree turns
+					cost += 10;
+				}
+				else if(  ribi_t::is_perpendicular( state.dir, current_dir )  ) {
+					// discourage v turns heavily
+					cost += 25;
+				}
+			}
+		}
+		state.parent_dir = state.dir;
+		state.dir = current_dir;
+		state.ribi_from = dir;
+		if(  state.depth < 2  ) {
+			state.depth ++;
+		}
+		return cost;
+	}
+};
+
+#endif
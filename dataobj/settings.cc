@@ -308,6 +308,7 @@ settings_t::settings_t() :
 	advance_to_end = true;
 	first_come_first_serve = false;
 	waiting_limit_for_first_come_first_serve = 500000;
+	route_graph_search = false;
 	
 	routecost_wait = 8;
 	routecost_halt = 1;
@@ -944,6 +945,9 @@ void settings_t::rdwr(loadsave_t *file)
 		if(  file->get_OTRP_version() >= 31  ) {
 			file->rdwr_long(waiting_limit_for_first_come_first_serve);
 		}
+		if(  file->get_OTRP_version() >= 34  ) {
+			file->rdwr_bool(route_graph_search);
+		}
 		if(  file->is_version_atleast(122, 1)  ) {
 			file->rdwr_enum(climate_generator);
 			file->rdwr_byte( wind_direction );
@@ -1046,6 +1050,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	env_t::fps                         = contents.get_int_clamped( "frames_per_second",              env_t::fps,                       env_t::min_fps, env_t::max_fps );
 	env_t::ff_fps                      = contents.get_int_clamped( "fast_forward_frames_per_second", env_t::ff_fps,                    env_t::min_fps, env_t::max_fps );
 	env_t::num_threads                 = contents.get_int_clamped( "threads",                        env_t::num_threads,               1, min(dr_get_max_threads(), MAX_THREADS) );
+	env_t::compact_way_statistics      = contents.get_int( "compact_way_statistics",                 env_t::compact_way_statistics ) != 0;
 	env_t::simple_drawing_default      = contents.get_int_clamped( "simple_drawing_tile_size",       env_t::simple_drawing_default,    2, 256 );
 
 	env_t::simple_drawing_fast_forward = contents.get_int( "simple_drawing_fast_forward", env_t::simple_drawing_fast_forward ) != 0;
@@ -1573,6 +1578,12 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	else if(strcmp(str, "xml_zstd") == 0) {
 		loadsave_t::set_savemode(loadsave_t::xml_zstd );
 	}
+	else if(strcmp(str, "zstd_chunked") == 0) {
+		loadsave_t::set_savemode(loadsave_t::zstd_chunked );
+	}
+	else if(strcmp(str, "xml_zstd_chunked") == 0) {
+		loadsave_t::set_savemode(loadsave_t::xml_zstd_chunked );
+	}
 
 	str = contents.get("autosaveformat" );
 	while (*str == ' ') str++;
@@ -1600,6 +1611,12 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	else if(strcmp(str, "xml_zstd") == 0) {
 		loadsave_t::set_autosavemode(loadsave_t::xml_zstd );
 	}
+	else if(strcmp(str, "zstd_chunked") == 0) {
+		loadsave_t::set_autosavemode(loadsave_t::zstd_chunked );
+	}
+	else if(strcmp(str, "xml_zstd_chunked") == 0) {
+		loadsave_t::set_autosavemode(loadsave_t::xml_zstd_chunked );
+	}
 
 	loadsave_t::save_level     = contents.get_int("save_level", loadsave_t::save_level );
 	loadsave_t::autosave_level = contents.get_int("autosave_level", loadsave_t::autosave_level );
@@ -1631,6 +1648,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	first_come_first_serve = contents.get_int("first_come_first_serve", first_come_first_serve);
 	waiting_limit_for_first_come_first_serve 
 		= contents.get_int("waiting_limit_for_first_come_first_serve", waiting_limit_for_first_come_first_serve);
+	route_graph_search = contents.get_int("route_graph_search", route_graph_search);
 	
 	routecost_wait = contents.get_int("routecost_wait", routecost_wait);
 	routecost_halt = contents.get_int("routecost_halt", routecost_halt);
@@ -333,6 +333,9 @@ private:
 	// first_come_first_serve is no longer applied to reduce the calculation load.
 	uint32 waiting_limit_for_first_come_first_serve;
 	
+	// if true, vehicles search their routes on the graph of junctions (see route_graph_t)
+	bool route_graph_search;
+	
 	// paramters for haltestelle_t::rebuild_connections()
 	uint8 routecost_halt;
 	uint8 routecost_wait;
@@ -692,6 +695,8 @@ public:
 	uint32 get_waiting_limit_for_first_come_first_serve() const 
 		{ return waiting_limit_for_first_come_first_serve; }
 	
+	bool get_route_graph_search() const { return route_graph_search; }
+	
 	uint8 get_routecost_halt() const { return routecost_halt; }
 	uint8 get_routecost_wait() const { return routecost_wait; }
 	
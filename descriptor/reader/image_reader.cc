@@ -26,22 +26,14 @@
 #define skip_reading_pixels_if_no_graphics goto adjust_image
 #endif
 
-obj_desc_t *image_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *image_reader_t::read_node(const char *data, obj_node_info_t &node)
 {
-	array_tpl<char> desc_buf(node.size);
-#if COLOUR_DEPTH != 0
-	if (fread(desc_buf.begin(), node.size, 1, fp) != 1) {
-		return NULL;
-	}
-#else
-	fread(desc_buf.begin(), node.size, 1, fp);
-#endif
-	char *p = desc_buf.begin()+6;
+	const char *p = data+6;
 
 	// always zero in old version, since length was always less than 65535
 	// because a node could not hold more data
 	uint8 version = decode_uint8(p);
-	p = desc_buf.begin();
+	p = data;
 
 #if COLOUR_DEPTH != 0
 	image_t *desc = new image_t();
@@ -64,16 +56,16 @@ obj_desc_t *image_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 		//DBG_DEBUG("image_t::read_node()","x,y=%d,%d  w,h=%d,%d, len=%i",desc->x,desc->y,desc->w,desc->h, desc->len);
 
 		uint16* dest = desc->data;
-		p = desc_buf.begin()+12;
+		p = data+12;
 
 		if (desc->h > 0) {
 			for (uint i = 0; i < desc->len; i++) {
-				uint16 data = decode_uint16(p);
-				if(data>=0x8000u  &&  data<=0x800Fu) {
+				uint16 pixel = decode_uint16(p);
+				if(pixel>=0x8000u  &&  pixel<=0x800Fu) {
 					// player color offset changed
-					data ++;
+					pixel ++;
 				}
-				*dest++ = data;
+				*dest++ = pixel;
 			}
 		}
 	}
@@ -27,8 +27,13 @@
 #include "../../tpl/inthashtable_tpl.h"
 #include "../../tpl/ptrhashtable_tpl.h"
 #include "../../tpl/stringhashtable_tpl.h"
+#include "../../tpl/vector_tpl.h"
 #include "../../simdebug.h"
 
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+#endif
+
 #include "../obj_desc.h"
 #include "../obj_node_info.h"
 #include "../vehicle_desc.h"
@@ -161,17 +166,11 @@ bool obj_reader_t::load(const char *path, const char *message)
 DBG_MESSAGE("obj_reader_t::load()", "reading from '%s'", name.c_str());
 
 		// sort file path before loading
-		uint n = 0;
 		vector_tpl<const char*> sorted_find;
 		FOR(searchfolder_t, const& i, find) {
 			sorted_find.insert_ordered(i,cmp);
 		}
-		FORX(vector_tpl<const char*>, const& i, sorted_find, ++n) {
-			read_file(i);
-			if ((n & step) == 0 && drawing) {
-				ls.set_progress(n);
-			}
-		}
+		read_files( sorted_find, drawing ? &ls : NULL, step );
 		ls.set_progress(max);
 
 		return find.begin()!=find.end();
@@ -180,108 +179,305 @@ DBG_MESSAGE("obj_reader_t::load()", "reading from '%s'", name.c_str());
 }
 
 
-bool obj_reader_t::read_file(const char *name)
+/// a node of a parsed pak file
+struct obj_reader_t::pak_node_t
 {
-	// added trace
-	DBG_DEBUG("obj_reader_t::read_file()", "filename='%s'", name);
+	obj_node_info_t info;
+	const char *data; ///< the info.size bytes of the node inside the mapped file
+};
+
+
+/// a pak file mapped into memory and its nodes in file order (i.e. parents before their children)
+struct obj_reader_t::pak_file_t
+{
+	enum status_t { OPEN_FAILED, NO_HEADER, NO_VERSION, TOO_NEW, PARSED };
+
+	const char *name;
+	const char *data;
+	size_t size;
+	uint32 version;
+	status_t status;
+	/// all complete nodes; if the file is truncated, reading fails at the first missing node
+	vector_tpl<pak_node_t> *nodes;
+#ifdef MULTI_THREAD
+	bool parsed;
+#endif
+
+	pak_file_t() : name(NULL), data(NULL), size(0), version(0), status(OPEN_FAILED), nodes(NULL)
+#ifdef MULTI_THREAD
+		, parsed(false)
+#endif
+	{}
+
+	~pak_file_t() { release(); }
+
+	/// the descriptors hold copies of all data, so this can be freed after registering
+	void release()
+	{
+		dr_unmap_file(data, size);
+		data = NULL;
+		size = 0;
+		delete nodes;
+		nodes = NULL;
+	}
+};
+
 
-	FILE* const fp = dr_fopen(name, "rb");
-	if (!fp) {
-		dbg->error("obj_reader_t::read_file()", "reading '%s' failed!", name);
+static bool read_node_info(obj_node_info_t& node, const char *&pos, const char *end, uint32 const version)
+{
+	if (end - pos < OBJ_NODE_INFO_SIZE) {
 		return false;
 	}
 
-	// This is the normal header reading code
-	int c;
-	uint32 n = 0;
+	const char *p = pos;
+	node.type     = decode_uint32(p);
+	node.children = decode_uint16(p);
+	node.size     = decode_uint16(p);
 
-	do {
-		c = fgetc(fp);
-		n ++;
-	} while(c != EOF && c != 0x1a);
+	// can have larger records
+	if (version != COMPILER_VERSION_CODE_11 && node.size == LARGE_RECORD_SIZE) {
+		if (end - p < EXT_OBJ_NODE_INFO_SIZE - OBJ_NODE_INFO_SIZE) {
+			return false;
+		}
+		node.size = decode_uint32(p);
+	}
 
-	if(c == EOF) {
-		dbg->error("obj_reader_t::read_file()", "unexpected end of file after %u bytes while reading '%s'!",n, name);
-		fclose(fp);
+	if ((size_t)(end - p) < node.size) {
 		return false;
 	}
+	pos = p;
+	return true;
+}
+
+
+void obj_reader_t::parse_file(pak_file_t &file)
+{
+	file.data = dr_map_file(file.name, &file.size);
+	if (!file.data) {
+		file.status = pak_file_t::OPEN_FAILED;
+		return;
+	}
+
+	// This is the normal header reading code
+	const char *p = (const char *)memchr(file.data, 0x1a, file.size);
+	if (!p) {
+		file.status = pak_file_t::NO_HEADER;
+		return;
+	}
+	p++;
+	if (file.data + file.size - p < 4) {
+		file.status = pak_file_t::NO_VERSION;
+		return;
+	}
 
 	// Compiled Version
-	char dummy[4];
-	n = fread(dummy, 4, 1, fp);
-	if (n != 1) {
-		fclose(fp);
-		return false;
+	file.version = decode_uint32(p);
+	if (file.version > COMPILER_VERSION_CODE) {
+		file.status = pak_file_t::TOO_NEW;
+		return;
 	}
 
-	char *p = dummy;
-	const uint32 version = decode_uint32(p);
+	// the root node and its subtree; a truncated file fails, when the missing node would be read
+	file.nodes = new vector_tpl<pak_node_t>();
+	parse_nodes(p, file.data + file.size, file.version, *file.nodes);
+	file.status = pak_file_t::PARSED;
+}
 
-	DBG_DEBUG("obj_reader_t::read_file()", "read %u blocks, file version is %x", n, version);
 
-	if(version <= COMPILER_VERSION_CODE) {
-		obj_desc_t *data = NULL;
-		if (!read_nodes(fp, data, 0, version)) {
-			fclose(fp);
-			return false;
-		}
-	}
-	else {
-		DBG_DEBUG("obj_reader_t::read_file()","version of '%s' is too old, %u instead of %u", name, version, COMPILER_VERSION_CODE );
-		fclose(fp);
+bool obj_reader_t::parse_nodes(const char *&pos, const char *end, uint32 version, vector_tpl<pak_node_t> &nodes)
+{
+	pak_node_t node;
+	if (!read_node_info(node.info, pos, end, version)) {
 		return false;
 	}
+	node.data = pos;
+	pos += node.info.size;
+	nodes.append(node);
 
-	fclose(fp);
+	for (int i = 0; i < node.info.children; i++) {
+		if (!parse_nodes(pos, end, version, nodes)) {
+			return false;
+		}
+	}
 	return true;
 }
 
 
-static bool read_node_info(obj_node_info_t& node, FILE* const f, uint32 const version)
+bool obj_reader_t::register_file(const pak_file_t &file)
 {
-	char data[EXT_OBJ_NODE_INFO_SIZE];
-	if (fread(data, OBJ_NODE_INFO_SIZE, 1, f) != 1) {
-		return false;
-	}
+	switch (file.status) {
+		case pak_file_t::OPEN_FAILED:
+			dbg->error("obj_reader_t::read_file()", "reading '%s' failed!", file.name);
+			return false;
 
-	char *p = data;
-	node.type     = decode_uint32(p);
-	node.children = decode_uint16(p);
-	node.size     = decode_uint16(p);
+		case pak_file_t::NO_HEADER:
+			dbg->error("obj_reader_t::read_file()", "unexpected end of file after %u bytes while reading '%s'!", (unsigned)file.size, file.name);
+			return false;
 
-	// can have larger records
-	if (version != COMPILER_VERSION_CODE_11 && node.size == LARGE_RECORD_SIZE) {
-		if (fread(p, sizeof(data) - OBJ_NODE_INFO_SIZE, 1, f) != 1) {
+		case pak_file_t::NO_VERSION:
+			return false;
+
+		case pak_file_t::TOO_NEW:
+			DBG_DEBUG("obj_reader_t::read_file()","version of '%s' is too old, %u instead of %u", file.name, file.version, COMPILER_VERSION_CODE );
 			return false;
+
+		case pak_file_t::PARSED:
+			break;
+	}
+
+	DBG_DEBUG("obj_reader_t::read_file()", "file version is %x", file.version);
+
+	const pak_node_t *node = file.nodes->begin();
+	obj_desc_t *data = NULL;
+	return read_nodes(node, file.nodes->end(), data, 0);
+}
+
+
+bool obj_reader_t::read_file(const char *name)
+{
+	// added trace
+	DBG_DEBUG("obj_reader_t::read_file()", "filename='%s'", name);
+
+	pak_file_t file;
+	file.name = name;
+	parse_file(file);
+	return register_file(file);
+}
+
+
+#ifdef MULTI_THREAD
+// parsing may run ahead of registration by this many files per thread
+#define PARSE_AHEAD_PER_THREAD (4)
+
+struct obj_reader_t::parse_queue_t
+{
+	pak_file_t *files;
+	uint32 count;
+	uint32 next;       ///< next file to parse
+	uint32 registered; ///< files already registered and released
+	uint32 ahead;      ///< maximum number of parsed files waiting for registration
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+};
+#endif
+
+
+void obj_reader_t::read_files(const vector_tpl<const char *> &names, loadingscreen_t *ls, sint32 step)
+{
+	const uint32 count = names.get_count();
+	pak_file_t *files = new pak_file_t[count];
+	for (uint32 i = 0; i < count; i++) {
+		files[i].name = names[i];
+	}
+
+#ifdef MULTI_THREAD
+	parse_queue_t queue;
+	queue.files = files;
+	queue.count = count;
+	queue.next = 0;
+	queue.registered = 0;
+	// the main thread is busy with registering
+	const uint32 num_workers = env_t::num_threads > 1 ? env_t::num_threads - 1 : 1;
+	queue.ahead = num_workers * PARSE_AHEAD_PER_THREAD;
+	pthread_mutex_init(&queue.mutex, NULL);
+	pthread_cond_init(&queue.cond, NULL);
+
+	pthread_t *workers = new pthread_t[num_workers];
+	for (uint32 t = 0; t < num_workers; t++) {
+		pthread_create(&workers[t], NULL, parse_thread, &queue);
+	}
+#endif
+
+	for (uint32 n = 0; n < count; n++) {
+		pak_file_t &file = files[n];
+#ifdef MULTI_THREAD
+		pthread_mutex_lock(&queue.mutex);
+		while (!file.parsed) {
+			pthread_cond_wait(&queue.cond, &queue.mutex);
+		}
+		pthread_mutex_unlock(&queue.mutex);
+#else
+		parse_file(file);
+#endif
+
+		DBG_DEBUG("obj_reader_t::read_file()", "filename='%s'", file.name);
+		register_file(file);
+		file.release();
+
+#ifdef MULTI_THREAD
+		pthread_mutex_lock(&queue.mutex);
+		queue.registered = n + 1;
+		pthread_cond_broadcast(&queue.cond);
+		pthread_mutex_unlock(&queue.mutex);
+#endif
+		if ((n & step) == 0 && ls) {
+			ls->set_progress(n);
 		}
-		node.size = decode_uint32(p);
 	}
 
-	return true;
+#ifdef MULTI_THREAD
+	for (uint32 t = 0; t < num_workers; t++) {
+		pthread_join(workers[t], NULL);
+	}
+	delete [] workers;
+	pthread_cond_destroy(&queue.cond);
+	pthread_mutex_destroy(&queue.mutex);
+#endif
+
+	delete [] files;
 }
 
 
-bool obj_reader_t::read_nodes(FILE *fp, obj_desc_t *&data, int register_nodes, uint32 version)
+#ifdef MULTI_THREAD
+void *obj_reader_t::parse_thread(void *ptr)
 {
-	obj_node_info_t node;
-	if (!read_node_info(node, fp, version)) {
+	parse_queue_t *queue = (parse_queue_t *)ptr;
+
+	pthread_mutex_lock(&queue->mutex);
+	while (queue->next < queue->count) {
+		if (queue->next >= queue->registered + queue->ahead) {
+			pthread_cond_wait(&queue->cond, &queue->mutex);
+			continue;
+		}
+		pak_file_t &file = queue->files[queue->next++];
+		pthread_mutex_unlock(&queue->mutex);
+
+		parse_file(file);
+
+		pthread_mutex_lock(&queue->mutex);
+		file.parsed = true;
+		pthread_cond_broadcast(&queue->cond);
+	}
+	pthread_mutex_unlock(&queue->mutex);
+	return NULL;
+}
+#endif
+
+
+bool obj_reader_t::read_nodes(const pak_node_t *&node, const pak_node_t *end, obj_desc_t *&data, int register_nodes)
+{
+	if (node == end) {
+		// file ended before this node
 		return false;
 	}
+	obj_node_info_t info = node->info;
+	const char *node_data = node->data;
+	node++;
 
-	obj_reader_t *reader = obj_reader->get(static_cast<obj_type>(node.type));
+	obj_reader_t *reader = obj_reader->get(static_cast<obj_type>(info.type));
 
 	if(reader) {
-//DBG_DEBUG("obj_reader_t::read_nodes()","Reading %.4s-node of length %d with '%s'", reinterpret_cast<const char *>(&node.type), node.size, reader->get_type_name());
-		data = reader->read_node(fp, node);
+//DBG_DEBUG("obj_reader_t::read_nodes()","Reading %.4s-node of length %d with '%s'", reinterpret_cast<const char *>(&info.type), info.size, reader->get_type_name());
+		data = reader->read_node(node_data, info);
 		if (!data) {
 			return false;
 		}
 
-		if (node.children != 0) {
-			data->children = new obj_desc_t *[node.children];
+		if (info.children != 0) {
+			data->children = new obj_desc_t *[info.children];
 
-			for (int i = 0; i < node.children; i++) {
-				if (!read_nodes(fp, data->children[i], register_nodes + 1, version)) {
+			for (int i = 0; i < info.children; i++) {
+				if (!read_nodes(node, end, data->children[i], register_nodes + 1)) {
 					// Note: cannot delete siblings of data->children[i], since equal images point to the same desc
 					delete data; // data->children is delete[]'d by the destructor
 					data = NULL;
@@ -291,20 +487,17 @@ bool obj_reader_t::read_nodes(FILE *fp, obj_desc_t *&data, int register_nodes, u
 		}
 
 //DBG_DEBUG("obj_reader_t","registering with '%s'", reader->get_type_name());
-		if(register_nodes<2  ||  node.type!=obj_cursor) {
+		if(register_nodes<2  ||  info.type!=obj_cursor) {
 			// since many buildings are with cursors that do not need registration
 			reader->register_obj(data);
 		}
 	}
 	else {
 		// no reader found ...
-		dbg->warning("obj_reader_t::read_nodes()","skipping unknown %.4s-node\n",reinterpret_cast<const char *>(&node.type));
-		if (fseek(fp, node.size, SEEK_CUR) != 0) {
-			return false;
-		}
+		dbg->warning("obj_reader_t::read_nodes()","skipping unknown %.4s-node\n",reinterpret_cast<const char *>(&info.type));
 
-		for(int i = 0; i < node.children; i++) {
-			if (!skip_nodes(fp,version)) {
+		for(int i = 0; i < info.children; i++) {
+			if (!skip_nodes(node, end)) {
 				return false;
 			}
 		}
@@ -316,19 +509,16 @@ bool obj_reader_t::read_nodes(FILE *fp, obj_desc_t *&data, int register_nodes, u
 }
 
 
-bool obj_reader_t::skip_nodes(FILE *fp,uint32 version)
+bool obj_reader_t::skip_nodes(const pak_node_t *&node, const pak_node_t *end)
 {
-	obj_node_info_t node;
-	if (!read_node_info(node, fp, version)) {
-		return false;
-	}
-
-	if (fseek(fp, node.size, SEEK_CUR) != 0) {
+	if (node == end) {
 		return false;
 	}
+	const uint16 children = node->info.children;
+	node++;
 
-	for(int i = 0; i < node.children; i++) {
-		if (!skip_nodes(fp,version)) {
+	for(int i = 0; i < children; i++) {
+		if (!skip_nodes(node, end)) {
 			return false;
 		}
 	}
@@ -7,8 +7,6 @@
 #define DESCRIPTOR_READER_OBJ_READER_H
 
 
-#include <stdio.h>
-
 #include "../obj_node_info.h"
 #include "../objversion.h"
 #include "../../simdebug.h"
@@ -20,15 +18,17 @@ template<class key_t, class value_t> class inthashtable_tpl;
 template<class value_t> class stringhashtable_tpl;
 template<class key_t, class value_t> class ptrhashtable_tpl;
 template<class T> class slist_tpl;
+template<class T> class vector_tpl;
+class loadingscreen_t;
 
 
 
 /**
  * Reads uint8 from memory area. Advances pointer by 1 byte.
  */
-inline uint8 decode_uint8(char * &data)
+inline uint8 decode_uint8(const char * &data)
 {
-	const sint8 v = *((sint8 *)data);
+	const sint8 v = *((const sint8 *)data);
 	data ++;
 	return v;
 }
@@ -39,7 +39,7 @@ inline uint8 decode_uint8(char * &data)
 /**
  * Reads uint16 from memory area. Advances pointer by 2 bytes.
  */
-inline uint16 decode_uint16(char * &data)
+inline uint16 decode_uint16(const char * &data)
 {
 	uint16 const v = (uint16)(uint8)data[0] | (uint16)(uint8)data[1] << 8;
 	data += sizeof(v);
@@ -52,7 +52,7 @@ inline uint16 decode_uint16(char * &data)
 /**
  * Reads uint32 from memory area. Advances pointer by 4 bytes.
  */
-inline uint32 decode_uint32(char * &data)
+inline uint32 decode_uint32(const char * &data)
 {
 	uint32 const v = (uint32)(uint8)data[0] | (uint32)(uint8)data[1] << 8 | (uint32)(uint8)data[2] << 16 | (uint32)(uint8)data[3] << 24;
 	data += sizeof(v);
@@ -88,13 +88,35 @@ class obj_reader_t
 	static unresolved_map unresolved;
 	static ptrhashtable_tpl<obj_desc_t **, int>  fatals;
 
+	struct pak_node_t;
+	struct pak_file_t;
+
+	/// Maps the file into memory and splits it into its nodes.
+	/// Does not touch any global state, hence can run on worker threads.
+	static void parse_file(pak_file_t &file);
+
+	/// Appends the node at @p pos and all its children to @p nodes.
+	/// @returns false, if the file ends before the last child
+	static bool parse_nodes(const char *&pos, const char *end, uint32 version, vector_tpl<pak_node_t> &nodes);
+
+#ifdef MULTI_THREAD
+	struct parse_queue_t;
+	static void *parse_thread(void *ptr);
+#endif
+
+	/// Creates and registers the descriptors of a parsed file, main thread only.
+	static bool register_file(const pak_file_t &file);
+
+	/// Reads and registers the files in this order, while worker threads parse the next files.
+	static void read_files(const vector_tpl<const char *> &names, loadingscreen_t *ls, sint32 step);
+
 	/// Read a descriptor node.
-	/// @param fp File to read from
+	/// @param node Node to read, advanced past the node and all its children
+	/// @param end End of the parsed nodes of the file
 	/// @param[out] data If reading is successful, contains descriptor for the object, else NULL.
 	/// @param register_nodes Nesting level for desc-nodes, should normally be 0
-	/// @param version File format version
-	static bool read_nodes(FILE* fp, obj_desc_t *&data, int register_nodes, uint32 version);
-	static bool skip_nodes(FILE *fp, uint32 version);
+	static bool read_nodes(const pak_node_t *&node, const pak_node_t *end, obj_desc_t *&data, int register_nodes);
+	static bool skip_nodes(const pak_node_t *&node, const pak_node_t *end);
 
 protected:
 	obj_reader_t() { /* Beware: Cannot register here! */}
@@ -104,9 +126,9 @@ protected:
 	static void xref_to_resolve(obj_type type, const char *name, obj_desc_t **dest, bool fatal);
 	static void resolve_xrefs();
 
-	/// Read a descriptor from @p fp. Does version check and compatibility transformations.
+	/// Read a descriptor from @p data (the node.size bytes of the node). Does version check and compatibility transformations.
 	/// @returns The descriptor on success, or NULL on failure
-	virtual obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) = 0;
+	virtual obj_desc_t *read_node(const char *data, obj_node_info_t &node) = 0;
 
 	/// Register descriptor so the object described by the descriptor can be built in-game.
 	virtual void register_obj(obj_desc_t *&/*desc*/) {}
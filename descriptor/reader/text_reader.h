@@ -16,7 +16,7 @@ class text_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::register_obj
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *data, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -17,7 +17,6 @@
 
 #include "../../bauer/tunnelbauer.h"
 #include "../../network/pakset_info.h"
-#include "../../tpl/array_tpl.h"
 
 
 void tunnel_reader_t::register_obj(obj_desc_t *&data)
@@ -56,7 +55,7 @@ void tunnel_reader_t::convert_old_tunnel(tunnel_desc_t *desc)
 }
 
 
-obj_desc_t * tunnel_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * tunnel_reader_t::read_node(const char *data, obj_node_info_t &node)
 {
 	tunnel_desc_t *desc = new tunnel_desc_t();
 	desc->topspeed = 0; // indicate, that we have to convert this to reasonable date, when read completely
@@ -65,12 +64,7 @@ obj_desc_t * tunnel_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 		return desc;
 	}
 
-	array_tpl<char> desc_buf(node.size);
-	if (fread(desc_buf.begin(), node.size, 1, fp) != 1) {
-		delete desc;
-		return NULL;
-	}
-	char *p = desc_buf.begin();
+	const char *p = data;
 
 	const uint16 v = decode_uint16(p);
 	const int version = v & 0x8000 ? v & 0x7FFF : 0;
@@ -137,6 +137,9 @@ bool is_display_init();
 void simgraph_exit();
 void simgraph_resize(scr_size new_window_size);
 
+/// compares the SIMD blend routines with the scalar ones, see -test_blend
+bool display_test_simd_blend();
+
 
 /**
  * Loads the font, returns the number of characters in it
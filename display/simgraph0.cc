@@ -355,6 +355,11 @@ bool is_display_init()
 	return false;
 }
 
+bool display_test_simd_blend()
+{
+	return true;
+}
+
 void display_free_all_images_above(image_id)
 {
 }
@@ -48,6 +48,19 @@ static pthread_mutex_t rezoom_img_mutex[MAX_THREADS];
 static pthread_mutex_t recode_img_mutex;
 #endif
 
+// SIMD versions of the blending routines, chosen at runtime
+#if defined __SSE2__  ||  defined _M_X64  ||  (defined _M_IX86_FP  &&  _M_IX86_FP >= 2)
+#	define USE_SIMD_BLEND
+#	include <emmintrin.h>
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#		define AVX2_TARGET
+#	else
+#		define AVX2_TARGET __attribute__((target("avx2")))
+#	endif
+#endif
+
 // to pass the extra clipnum when not needed use this
 #ifdef MULTI_THREAD
 #define CLIPNUM_IGNORE , 0
@@ -2239,9 +2252,54 @@ void display_get_base_image_offset(image_id image, scr_coord_val *xoff, scr_coor
  */
 static inline void pixcopy(PIXVAL *dest, const PIXVAL *src, const PIXVAL * const end)
 {
-	// for gcc this seems to produce the optimal code ...
+	// the C library picks the fastest copy for this CPU
+	if(  src < end  ) {
+		memcpy( dest, src, (end - src) * sizeof(PIXVAL) );
+	}
+}
+
+
+
+#ifdef USE_SIMD_BLEND
+// set by select_simd_blend(), if the CPU has AVX2 and recode_run_avx2() gives the same pixels
+static bool use_recode_run_avx2 = false;
+
+/**
+ * Replaces the player colours of 16 pixels at once by gathering them from rgbmap_current.
+ * A gather reads 32 bits, so this must only get opaque pixels (below 0x8020) and not the last table entry.
+ * @returns the number of pixels done, the rest is left to the caller
+ */
+AVX2_TARGET static int recode_run_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *const end)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low_word = _mm256_set1_epi32( 0xFFFF );
+	int i = 0;
+	for(  ;  end - src >= i + 16;  i += 16  ) {
+		const __m256i idx = _mm256_loadu_si256( (const __m256i *)(src + i) );
+		// unpack and pack work on each 128 bit lane, so the pixels come back in order
+		const __m256i lo = _mm256_i32gather_epi32( (const int *)rgbmap_current, _mm256_unpacklo_epi16( idx, zero ), 2 );
+		const __m256i hi = _mm256_i32gather_epi32( (const int *)rgbmap_current, _mm256_unpackhi_epi16( idx, zero ), 2 );
+		_mm256_storeu_si256( (__m256i *)(dest + i), _mm256_packus_epi32( _mm256_and_si256( lo, low_word ), _mm256_and_si256( hi, low_word ) ) );
+	}
+	return i;
+}
+#endif
+
+
+/**
+ * Copy a run of opaque pixels, replace player color
+ */
+static inline void recode_run(PIXVAL *dest, const PIXVAL *src, const PIXVAL *const end)
+{
+#ifdef USE_SIMD_BLEND
+	if(  use_recode_run_avx2  ) {
+		const int done = recode_run_avx2( dest, src, end );
+		dest += done;
+		src += done;
+	}
+#endif
 	while (src < end) {
-		*dest++ = *src++;
+		*dest++ = rgbmap_current[*src++];
 	}
 }
 
@@ -2254,9 +2312,7 @@ static inline void pixcopy(PIXVAL *dest, const PIXVAL *src, const PIXVAL * const
 static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
-		while (src < end) {
-			*dest++ = rgbmap_current[*src++];
-		}
+		recode_run(dest, src, end);
 	}
 	else {
 		while (src < end) {
@@ -2292,9 +2348,7 @@ static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* c
 static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
-		while (src < end) {
-			*dest++ = rgbmap_current[*src++];
-		}
+		recode_run(dest, src, end);
 	}
 	else {
 		while (src < end) {
@@ -2340,9 +2394,7 @@ static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* c
 static inline void colorpixcopydaytime(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
-		while (src < end) {
-			*dest++ = rgbmap_current[*src++];
-		}
+		recode_run(dest, src, end);
 	}
 	else {
 		while (src < end) {
@@ -2378,9 +2430,7 @@ static inline void colorpixcopydaytime(PIXVAL* dest, const PIXVAL* src, const PI
 static inline void colorpixcopydaytime(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
-		while (src < end) {
-			*dest++ = rgbmap_current[*src++];
-		}
+		recode_run(dest, src, end);
 	}
 	else {
 		while (src < end) {
@@ -3405,6 +3455,362 @@ static blend_proc blend[3];
 static blend_proc blend_recode[3];
 static blend_proc outline[3];
 
+#ifdef USE_SIMD_BLEND
+/*
+ * SIMD versions of the blend, blend_recode and outline routines above.
+ * They work on 8 (SSE2) resp. 16 (AVX2) pixels at once and leave the rest to the scalar routine,
+ * so the results are identical.
+ */
+enum blend_source_t {
+	BLEND_SRC,    ///< pixels from src
+	BLEND_RECODE, ///< pixels from src with player colors replaced
+	BLEND_COLOUR  ///< a single colour
+};
+
+
+template<blend_source_t source>
+static inline __m128i blend_load_sse2(const PIXVAL *src, const PIXVAL colour)
+{
+	switch(  source  ) {
+		case BLEND_SRC:
+			return _mm_loadu_si128( (const __m128i *)src );
+		case BLEND_RECODE:
+			return _mm_setr_epi16( rgbmap_current[src[0]], rgbmap_current[src[1]], rgbmap_current[src[2]], rgbmap_current[src[3]],
+				rgbmap_current[src[4]], rgbmap_current[src[5]], rgbmap_current[src[6]], rgbmap_current[src[7]] );
+		default:
+			return _mm_set1_epi16( (short)colour );
+	}
+}
+
+
+/// @p percent of @p s over @p d, @p mask is ONE_OUT for 50 and TWO_OUT otherwise
+template<int percent>
+static inline __m128i blend_sse2(const __m128i s, const __m128i d, const __m128i mask)
+{
+	if(  percent == 50  ) {
+		return _mm_add_epi16( _mm_and_si128( _mm_srli_epi16( s, 1 ), mask ), _mm_and_si128( _mm_srli_epi16( d, 1 ), mask ) );
+	}
+	const __m128i three = _mm_and_si128( _mm_srli_epi16( percent == 75 ? s : d, 2 ), mask );
+	const __m128i one   = _mm_and_si128( _mm_srli_epi16( percent == 75 ? d : s, 2 ), mask );
+	return _mm_add_epi16( _mm_add_epi16( three, _mm_add_epi16( three, three ) ), one );
+}
+
+
+template<blend_source_t source, int percent, PIXVAL mask, blend_proc scalar>
+static void pix_blend_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL colour, const PIXVAL len)
+{
+	const __m128i vmask = _mm_set1_epi16( (short)mask );
+	PIXVAL i = 0;
+	for(  ;  i + 8 <= len;  i += 8  ) {
+		const __m128i s = blend_load_sse2<source>( src + i, colour );
+		const __m128i d = _mm_loadu_si128( (const __m128i *)(dest + i) );
+		_mm_storeu_si128( (__m128i *)(dest + i), blend_sse2<percent>( s, d, vmask ) );
+	}
+	scalar( dest + i, source == BLEND_COLOUR ? src : src + i, colour, len - i );
+}
+
+
+template<blend_source_t source>
+AVX2_TARGET static inline __m256i blend_load_avx2(const PIXVAL *src, const PIXVAL colour)
+{
+	switch(  source  ) {
+		case BLEND_SRC:
+			return _mm256_loadu_si256( (const __m256i *)src );
+		case BLEND_RECODE:
+			return _mm256_setr_epi16( rgbmap_current[src[0]], rgbmap_current[src[1]], rgbmap_current[src[2]], rgbmap_current[src[3]],
+				rgbmap_current[src[4]], rgbmap_current[src[5]], rgbmap_current[src[6]], rgbmap_current[src[7]],
+				rgbmap_current[src[8]], rgbmap_current[src[9]], rgbmap_current[src[10]], rgbmap_current[src[11]],
+				rgbmap_current[src[12]], rgbmap_current[src[13]], rgbmap_current[src[14]], rgbmap_current[src[15]] );
+		default:
+			return _mm256_set1_epi16( (short)colour );
+	}
+}
+
+
+template<int percent>
+AVX2_TARGET static inline __m256i blend_avx2(const __m256i s, const __m256i d, const __m256i mask)
+{
+	if(  percent == 50  ) {
+		return _mm256_add_epi16( _mm256_and_si256( _mm256_srli_epi16( s, 1 ), mask ), _mm256_and_si256( _mm256_srli_epi16( d, 1 ), mask ) );
+	}
+	const __m256i three = _mm256_and_si256( _mm256_srli_epi16( percent == 75 ? s : d, 2 ), mask );
+	const __m256i one   = _mm256_and_si256( _mm256_srli_epi16( percent == 75 ? d : s, 2 ), mask );
+	return _mm256_add_epi16( _mm256_add_epi16( three, _mm256_add_epi16( three, three ) ), one );
+}
+
+
+template<blend_source_t source, int percent, PIXVAL mask, blend_proc scalar>
+AVX2_TARGET static void pix_blend_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL colour, const PIXVAL len)
+{
+	const __m256i vmask = _mm256_set1_epi16( (short)mask );
+	PIXVAL i = 0;
+	for(  ;  i + 16 <= len;  i += 16  ) {
+		const __m256i s = blend_load_avx2<source>( src + i, colour );
+		const __m256i d = _mm256_loadu_si256( (const __m256i *)(dest + i) );
+		_mm256_storeu_si256( (__m256i *)(dest + i), blend_avx2<percent>( s, d, vmask ) );
+	}
+	// the rest with SSE2 and then scalar
+	pix_blend_sse2<source, percent, mask, scalar>( dest + i, source == BLEND_COLOUR ? src : src + i, colour, len - i );
+}
+
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid( info, 0 );
+	if(  info[0] < 7  ) {
+		return false;
+	}
+	__cpuid( info, 1 );
+	// the OS must also save the AVX registers
+	if(  (info[2] & (1 << 27)) == 0  ||  (_xgetbv(0) & 6) != 6  ) {
+		return false;
+	}
+	__cpuidex( info, 7, 0 );
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+#endif
+}
+
+
+// the recode versions need a colour table, but the player colours are not yet set up in simgraph_init()
+static PIXVAL test_rgbmap[RGBMAPSIZE];
+
+// pixels for the checks below, one more in front to start unaligned
+#define TEST_RUN_LEN (4096)
+static PIXVAL test_src[TEST_RUN_LEN+1], test_dest_simd[TEST_RUN_LEN+1], test_dest_scalar[TEST_RUN_LEN+1];
+
+
+static inline PIXVAL test_random(uint32 &seed)
+{
+	seed = seed * 1103515245u + 12345u;
+	return (PIXVAL)(seed >> 16);
+}
+
+
+/// fills test_rgbmap, @p pass 0 and 1 together give every 16 bit colour
+static void fill_test_rgbmap(int pass)
+{
+	for(  int i = 0;  i < RGBMAPSIZE;  i++  ) {
+		// an odd factor maps the 0x10000 indices of both passes to all 16 bit values
+		test_rgbmap[i] = (PIXVAL)((i + pass * 0x8000) * 40503u);
+	}
+}
+
+
+/// runs @p simd and @p scalar on the same pixels and @returns true, if they give the same result
+static bool compare_blend_run(blend_proc simd, blend_proc scalar, const PIXVAL colour, const PIXVAL len)
+{
+	memcpy( test_dest_simd, test_dest_scalar, sizeof(test_dest_simd) );
+	simd( test_dest_simd + 1, test_src + 1, colour, len );
+	scalar( test_dest_scalar + 1, test_src + 1, colour, len );
+	return memcmp( test_dest_simd, test_dest_scalar, sizeof(test_dest_simd) ) == 0;
+}
+
+
+/**
+ * Compares @p simd with @p scalar for all run lengths up to 64,
+ * for every 16 bit value as source pixel (or outline colour) and as destination pixel.
+ * The recode versions get every index of the colour table as source, which gives every colour in two passes.
+ * @returns true, if they give the same pixels
+ */
+static bool check_blend_proc(blend_proc simd, blend_proc scalar, blend_source_t source)
+{
+	PIXVAL *const old_rgbmap = rgbmap_current;
+	rgbmap_current = test_rgbmap;
+
+	// the recode versions read src through the colour table
+	const uint32 src_range = source == BLEND_RECODE ? RGBMAPSIZE : 0x10000;
+	uint32 seed = 12345;
+	bool ok = true;
+	for(  int pass = 0;  pass < (source == BLEND_RECODE ? 2 : 1)  &&  ok;  pass++  ) {
+		fill_test_rgbmap( pass );
+
+		// all short lengths, so every split into SIMD and scalar part is tested
+		for(  PIXVAL len = 0;  len <= 64  &&  ok;  len++  ) {
+			for(  int i = 0;  i <= TEST_RUN_LEN;  i++  ) {
+				test_src[i] = (PIXVAL)(test_random(seed) % src_range);
+				test_dest_scalar[i] = test_random(seed);
+			}
+			ok = compare_blend_run( simd, scalar, test_random(seed), len );
+		}
+
+		// every source pixel over random destination pixels, and every destination pixel under random source pixels
+		for(  uint32 base = 0;  base < 0x10000  &&  ok;  base += TEST_RUN_LEN  ) {
+			for(  int i = 0;  i <= TEST_RUN_LEN;  i++  ) {
+				test_src[i] = (PIXVAL)((base + i) % src_range);
+				test_dest_scalar[i] = test_random(seed);
+			}
+			ok = compare_blend_run( simd, scalar, test_random(seed), TEST_RUN_LEN );
+			for(  int i = 0;  i <= TEST_RUN_LEN;  i++  ) {
+				test_src[i] = (PIXVAL)(test_random(seed) % src_range);
+				test_dest_scalar[i] = (PIXVAL)(base + i);
+			}
+			ok = ok  &&  compare_blend_run( simd, scalar, test_random(seed), TEST_RUN_LEN );
+		}
+
+		// every outline colour
+		for(  uint32 colour = 0;  colour < 0x10000  &&  ok  &&  source == BLEND_COLOUR;  colour++  ) {
+			for(  int i = 0;  i <= 24;  i++  ) {
+				test_dest_scalar[i] = test_random(seed);
+			}
+			ok = compare_blend_run( simd, scalar, (PIXVAL)colour, 24 );
+		}
+	}
+
+	rgbmap_current = old_rgbmap;
+	return ok;
+}
+
+
+/// runs recode_run_avx2() (and the scalar rest) and the scalar loop on the same pixels and @returns true, if they give the same result
+static bool compare_recode_run(const int len)
+{
+	memcpy( test_dest_simd, test_dest_scalar, sizeof(test_dest_simd) );
+	const int done = recode_run_avx2( test_dest_simd + 1, test_src + 1, test_src + 1 + len );
+	for(  int i = 1;  i <= len;  i++  ) {
+		if(  i > done  ) {
+			test_dest_simd[i] = rgbmap_current[test_src[i]];
+		}
+		test_dest_scalar[i] = rgbmap_current[test_src[i]];
+	}
+	return memcmp( test_dest_simd, test_dest_scalar, sizeof(test_dest_simd) ) == 0;
+}
+
+
+/**
+ * Compares recode_run_avx2() with the scalar loop of recode_run() for all run lengths up to 64
+ * and every opaque pixel, in two passes with together every colour.
+ * @returns true, if they give the same pixels
+ */
+static bool check_recode_run()
+{
+	PIXVAL *const old_rgbmap = rgbmap_current;
+	rgbmap_current = test_rgbmap;
+
+	uint32 seed = 12345;
+	bool ok = true;
+	for(  int pass = 0;  pass < 2  &&  ok;  pass++  ) {
+		fill_test_rgbmap( pass );
+
+		for(  int len = 0;  len <= 64  &&  ok;  len++  ) {
+			for(  int i = 0;  i <= TEST_RUN_LEN;  i++  ) {
+				test_src[i] = (PIXVAL)(test_random(seed) % 0x8020);
+				test_dest_scalar[i] = test_random(seed);
+			}
+			ok = compare_recode_run( len );
+		}
+
+		for(  uint32 base = 0;  base < 0x8020  &&  ok;  base += TEST_RUN_LEN  ) {
+			for(  int i = 0;  i <= TEST_RUN_LEN;  i++  ) {
+				test_src[i] = (PIXVAL)((base + i) % 0x8020);
+				test_dest_scalar[i] = test_random(seed);
+			}
+			ok = compare_recode_run( TEST_RUN_LEN );
+		}
+	}
+
+	rgbmap_current = old_rgbmap;
+	return ok;
+}
+
+
+#define BLEND_PROCS(depth, scalar) { scalar##25_##depth, scalar##50_##depth, scalar##75_##depth }
+
+#define BLEND_PROCS_SIMD(arch, source, depth, scalar) { \
+	pix_blend_##arch<source, 25, TWO_OUT_##depth, scalar##25_##depth>, \
+	pix_blend_##arch<source, 50, ONE_OUT_##depth, scalar##50_##depth>, \
+	pix_blend_##arch<source, 75, TWO_OUT_##depth, scalar##75_##depth> }
+
+#define BLEND_FAMILIES_SIMD(arch, depth) { \
+	BLEND_PROCS_SIMD( arch, BLEND_SRC,    depth, pix_blend ), \
+	BLEND_PROCS_SIMD( arch, BLEND_RECODE, depth, pix_blend_recode ), \
+	BLEND_PROCS_SIMD( arch, BLEND_COLOUR, depth, pix_outline ) }
+
+static const char *const blend_family_names[3] = { "blend", "blend_recode", "outline" };
+static const char *const blend_arch_names[2] = { "SSE2", "AVX2" };
+
+// [15/16 bit][blend/blend_recode/outline][25/50/75 percent]
+static blend_proc const scalar_blend_procs[2][3][3] = {
+	{ BLEND_PROCS( 15, pix_blend ), BLEND_PROCS( 15, pix_blend_recode ), BLEND_PROCS( 15, pix_outline ) },
+	{ BLEND_PROCS( 16, pix_blend ), BLEND_PROCS( 16, pix_blend_recode ), BLEND_PROCS( 16, pix_outline ) }
+};
+
+// [15/16 bit][SSE2/AVX2][blend/blend_recode/outline][25/50/75 percent]
+static blend_proc const simd_blend_procs[2][2][3][3] = {
+	{ BLEND_FAMILIES_SIMD( sse2, 15 ), BLEND_FAMILIES_SIMD( avx2, 15 ) },
+	{ BLEND_FAMILIES_SIMD( sse2, 16 ), BLEND_FAMILIES_SIMD( avx2, 16 ) }
+};
+
+
+/**
+ * replaces the blend routines by the SIMD versions,
+ * if the CPU supports them and they give the same pixels
+ */
+static void select_simd_blend(int depth)
+{
+	const int d = depth == 15 ? 0 : 1;
+	const int arch = cpu_has_avx2() ? 1 : 0;
+	blend_proc *const procs[3] = { blend, blend_recode, outline };
+	for(  int f = 0;  f < 3;  f++  ) {
+		for(  int i = 0;  i < 3;  i++  ) {
+			blend_proc simd = simd_blend_procs[d][arch][f][i];
+			if(  check_blend_proc( simd, scalar_blend_procs[d][f][i], (blend_source_t)f )  ) {
+				procs[f][i] = simd;
+			}
+			else {
+				dbg->error( "select_simd_blend()", "%s %s[%i] differs from scalar version, not used", blend_arch_names[arch], blend_family_names[f], i );
+			}
+		}
+	}
+	if(  arch == 1  ) {
+		use_recode_run_avx2 = check_recode_run();
+		if(  !use_recode_run_avx2  ) {
+			dbg->error( "select_simd_blend()", "AVX2 recode_run differs from scalar version, not used" );
+		}
+	}
+	DBG_MESSAGE( "select_simd_blend()", "using %s", blend_arch_names[arch] );
+}
+#endif
+
+
+/**
+ * Compares every SIMD blend routine this CPU can run with its scalar version, for 15 and 16 bit,
+ * and the AVX2 recode of opaque runs with the scalar loop.
+ * @returns true, if all give the same pixels (or there are no SIMD routines in this build)
+ */
+bool display_test_simd_blend()
+{
+	bool ok = true;
+#ifdef USE_SIMD_BLEND
+	const int archs = cpu_has_avx2() ? 2 : 1;
+	for(  int d = 0;  d < 2;  d++  ) {
+		for(  int arch = 0;  arch < archs;  arch++  ) {
+			for(  int f = 0;  f < 3;  f++  ) {
+				for(  int i = 0;  i < 3;  i++  ) {
+					if(  !check_blend_proc( simd_blend_procs[d][arch][f][i], scalar_blend_procs[d][f][i], (blend_source_t)f )  ) {
+						dbg->error( "display_test_simd_blend()", "%i bit %s %s[%i] differs from scalar version", 15 + d, blend_arch_names[arch], blend_family_names[f], i );
+						ok = false;
+					}
+				}
+			}
+		}
+	}
+	if(  archs == 2  &&  !check_recode_run()  ) {
+		dbg->error( "display_test_simd_blend()", "AVX2 recode_run differs from scalar version" );
+		ok = false;
+	}
+	dbg->message( "display_test_simd_blend()", "%s: %s", archs == 2 ? "SSE2 and AVX2" : "SSE2 (no AVX2 on this CPU)", ok ? "all routines match" : "FAILED" );
+#else
+	dbg->message( "display_test_simd_blend()", "no SIMD blend routines in this build" );
+#endif
+	return ok;
+}
+
+
 
 /**
  * Blends a rectangular region with a color
@@ -5417,6 +5823,9 @@ bool simgraph_init(scr_size window_size, sint16 full_screen)
 			dr_fatal_notify( "Compiled for 15 bit color depth but using 16!" );
 #endif
 		}
+#ifdef USE_SIMD_BLEND
+		select_simd_blend( bitdepth );
+#endif
 	}
 
 	return true;
@@ -24,6 +24,7 @@
 #include "gui_theme.h"
 #include "themeselector.h"
 #include "loadfont_frame.h"
+#include "step_profiler_frame.h"
 #include "simwin.h"
 
 // display text label in player colors
@@ -52,6 +53,7 @@ enum {
 	IDBTN_INFINITE_SCROLL,
 	IDBTN_RIBI_ARROW,
 	IDBTN_ONEWAY_RIBI_ONLY,
+	IDBTN_STEP_PROFILER,
 	COLORS_MAX_BUTTONS, 
 };
 
@@ -163,6 +165,10 @@ gui_settings_t::gui_settings_t()
 	simloops_value_label.buf().printf(" 999.9");
 	simloops_value_label.update();
 	add_component( &simloops_value_label );
+
+	// timings of the simulation phases
+	buttons[ IDBTN_STEP_PROFILER ].init( button_t::roundbox | button_t::flexible, "Step profiler" );
+	add_component( buttons + IDBTN_STEP_PROFILER, 2 );
 }
 
 void gui_settings_t::draw(scr_coord offset)
@@ -710,6 +716,9 @@ bool color_gui_t::action_triggered( gui_action_creator_t *comp, value_t p)
 	case IDBTN_CHANGE_FONT:
 		create_win( new loadfont_frame_t(), w_info, magic_font );
 		break;
+	case IDBTN_STEP_PROFILER:
+		create_win( new step_profiler_frame_t(), w_info, magic_step_profiler );
+		break;
 	case IDBTN_RIBI_ARROW:
 		strasse_t::show_masked_ribi ^= 1;
 		break;
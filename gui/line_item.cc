@@ -59,7 +59,7 @@ bool line_scrollitem_t::compare(const gui_component_t *aa, const gui_component_t
 			case SORT_BY_NAME: // default
 				break;
 			case SORT_BY_ID:
-				return ((a->get_line().get_id() - b->get_line().get_id())<0) ^ sort_reverse;
+				return (a->get_line().get_id() < b->get_line().get_id()) ^ sort_reverse;
 			case SORT_BY_PROFIT:
 				return ((a->get_line()->get_finance_history(1,LINE_PROFIT) - b->get_line()->get_finance_history(1,LINE_PROFIT))<0 ) ^ sort_reverse;
 			case SORT_BY_TRANSPORTED:
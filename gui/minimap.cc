@@ -40,6 +40,12 @@
 
 #include <math.h>
 
+// more changed tiles per frame are handled by a full redraw
+#define MAX_CHANGED_TILES (1<<16)
+
+// tiles calculated at once in parallel by calc_map()
+#define MAP_BAND_TILES (1<<16)
+
 sint32 minimap_t::max_cargo=0;
 sint32 minimap_t::max_passed=0;
 
@@ -786,27 +792,22 @@ PIXVAL minimap_t::calc_ground_color(const grund_t *gr)
 }
 
 
-void minimap_t::calc_map_pixel(const koord k)
+bool minimap_t::calc_map_pixel_color(const koord k, map_maxima_t &maxima, PIXVAL &color) const
 {
-	// no pixels visible, so noting to calculate
-	if(!is_visible) {
-		return;
-	}
-
 	// always use to uppermost ground
 	const planquadrat_t *plan=world->access(k);
 	if(plan==NULL  ||  plan->get_boden_count()==0) {
-		return;
+		return false;
 	}
 	const grund_t *gr=plan->get_boden_bei(plan->get_boden_count()-1);
 
 	if(  mode!=MAP_PAX_DEST  &&  gr->get_convoi_vehicle()  ) {
-		set_map_color( k, COL_VEHICLE );
-		return;
+		color = COL_VEHICLE;
+		return true;
 	}
 
 	// first use ground color
-	set_map_color( k, calc_ground_color (gr) );
+	color = calc_ground_color (gr);
 
 	switch(mode&~MAP_MODE_FLAGS) {
 		// show passenger coverage
@@ -815,7 +816,7 @@ void minimap_t::calc_map_pixel(const koord k)
 			for( int i = 0; i < plan->get_haltlist_count(); i++  ) {
 				halthandle_t halt = plan->get_haltlist()[i];
 				if (halt->get_pax_enabled() && !halt->get_pax_connections().empty()) {
-					set_map_color( k, color_idx_to_rgb(halt->get_owner()->get_player_color1() + 3) );
+					color = color_idx_to_rgb(halt->get_owner()->get_player_color1() + 3);
 					break;
 				}
 			}
@@ -827,7 +828,7 @@ void minimap_t::calc_map_pixel(const koord k)
 			for( int i = 0; i < plan->get_haltlist_count(); i++  ) {
 				halthandle_t halt = plan->get_haltlist()[i];
 				if (halt->get_mail_enabled() && !halt->get_mail_connections().empty()) {
-					set_map_color( k, color_idx_to_rgb(halt->get_owner()->get_player_color1() + 3) );
+					color = color_idx_to_rgb(halt->get_owner()->get_player_color1() + 3);
 					break;
 				}
 			}
@@ -835,12 +836,7 @@ void minimap_t::calc_map_pixel(const koord k)
 
 		// show usage
 		case MAP_FREIGHT:
-			// need to init the maximum?
-			if(max_cargo==0) {
-				max_cargo = 1;
-				calc_map();
-			}
-			else if(  gr->hat_wege()  ) {
+			if(  gr->hat_wege()  ) {
 				// now calc again ...
 				sint32 cargo=0;
 
@@ -852,22 +848,17 @@ void minimap_t::calc_map_pixel(const koord k)
 					if(w) {
 						cargo += w->get_statistics(WAY_STAT_GOODS);
 					}
-					if(  cargo > max_cargo  ) {
-						max_cargo = cargo;
+					if(  cargo > maxima.cargo  ) {
+						maxima.cargo = cargo;
 					}
-					set_map_color(k, calc_severity_color_log(cargo, max_cargo));
+					color = calc_severity_color_log(cargo, maxima.cargo);
 				}
 			}
 			break;
 
 		// show traffic (=convois/month)
 		case MAP_TRAFFIC:
-			// need to init the maximum?
-			if(  max_passed==0  ) {
-				max_passed = 1;
-				calc_map();
-			}
-			else if(gr->hat_wege()) {
+			if(gr->hat_wege()) {
 				// now calc again ...
 				sint32 passed=0;
 
@@ -878,10 +869,10 @@ void minimap_t::calc_map_pixel(const koord k)
 					if(  weg_t *w=gr->get_weg_nr(1)  ) {
 						passed += w->get_statistics(WAY_STAT_CONVOIS);
 					}
-					if(  passed > max_passed  ) {
-						max_passed = passed;
+					if(  passed > maxima.passed  ) {
+						maxima.passed = passed;
 					}
-					set_map_color(k, calc_severity_color_log( passed, max_passed ) );
+					color = calc_severity_color_log( passed, maxima.passed );
 				}
 			}
 			break;
@@ -892,14 +883,14 @@ void minimap_t::calc_map_pixel(const koord k)
 			if (gr->hat_weg(track_wt)) {
 				const schiene_t * sch = (const schiene_t *) (gr->get_weg(track_wt));
 				if(sch->is_electrified()) {
-					set_map_color(k, color_idx_to_rgb(COL_RED));
+					color = color_idx_to_rgb(COL_RED);
 				}
 				else {
-					set_map_color(k, color_idx_to_rgb(COL_WHITE));
+					color = color_idx_to_rgb(COL_WHITE);
 				}
 				// show signals
 				if(sch->has_sign()  ||  sch->has_signal()) {
-					set_map_color(k, color_idx_to_rgb(COL_YELLOW));
+					color = color_idx_to_rgb(COL_YELLOW);
 				}
 			}
 			break;
@@ -909,7 +900,7 @@ void minimap_t::calc_map_pixel(const koord k)
 			{
 				sint32 speed=gr->get_max_speed();
 				if(speed) {
-					set_map_color(k, calc_severity_color(gr->get_max_speed(), 450));
+					color = calc_severity_color(gr->get_max_speed(), 450);
 				}
 			}
 			break;
@@ -919,14 +910,14 @@ void minimap_t::calc_map_pixel(const koord k)
 			{
 				const leitung_t* lt = gr->find<leitung_t>();
 				if(lt!=NULL) {
-					set_map_color(k, calc_severity_color((sint32)lt->get_net()->get_demand(),(sint32)lt->get_net()->get_supply()) );
+					color = calc_severity_color((sint32)lt->get_net()->get_demand(),(sint32)lt->get_net()->get_supply());
 				}
 			}
 			break;
 
 		case MAP_FOREST:
 			if(  gr->get_top()>1  &&  gr->obj_bei(gr->get_top()-1)->get_typ()==obj_t::baum  ) {
-				set_map_color(k, color_idx_to_rgb(COL_GREEN) );
+				color = color_idx_to_rgb(COL_GREEN);
 			}
 			break;
 
@@ -934,33 +925,28 @@ void minimap_t::calc_map_pixel(const koord k)
 			// show ownership
 			{
 				if(  gr->is_halt()  ) {
-					set_map_color(k, color_idx_to_rgb(gr->get_halt()->get_owner()->get_player_color1()+3));
+					color = color_idx_to_rgb(gr->get_halt()->get_owner()->get_player_color1()+3);
 				}
 				else if(  weg_t *weg = gr->get_weg_nr(0)  ) {
-					set_map_color(k, weg->get_owner()==NULL ? color_idx_to_rgb(COL_ORANGE) : color_idx_to_rgb(weg->get_owner()->get_player_color1()+3) );
+					color = weg->get_owner()==NULL ? color_idx_to_rgb(COL_ORANGE) : color_idx_to_rgb(weg->get_owner()->get_player_color1()+3);
 				}
 				if(  gebaeude_t *gb = gr->find<gebaeude_t>()  ) {
 					if(  gb->get_owner()!=NULL  ) {
-						set_map_color(k, color_idx_to_rgb(gb->get_owner()->get_player_color1()+3) );
+						color = color_idx_to_rgb(gb->get_owner()->get_player_color1()+3);
 					}
 				}
 				break;
 			}
 
 		case MAP_LEVEL:
-			if(  max_building_level == 0  ) {
-				// init maximum
-				max_building_level = 1;
-				calc_map();
-			}
-			else if(  gr->get_typ() == grund_t::fundament  ) {
+			if(  gr->get_typ() == grund_t::fundament  ) {
 				if(  gebaeude_t *gb = gr->find<gebaeude_t>()  ) {
 					if(  gb->is_city_building()  ) {
 						sint32 level = gb->get_tile()->get_desc()->get_level();
-						if(  level > max_building_level  ) {
-							max_building_level = level;
+						if(  level > maxima.building_level  ) {
+							maxima.building_level = level;
 						}
-						set_map_color(k, calc_severity_color( level, max_building_level ) );
+						color = calc_severity_color( level, maxima.building_level );
 					}
 				}
 			}
@@ -969,9 +955,49 @@ void minimap_t::calc_map_pixel(const koord k)
 		default:
 			break;
 	}
+	return true;
 }
 
 
+void minimap_t::calc_map_pixel(const koord k)
+{
+	map_maxima_t maxima = { max_cargo, max_passed, max_building_level };
+	PIXVAL color;
+	if(  calc_map_pixel_color( k, maxima, color )  ) {
+		set_map_color( k, color );
+	}
+	max_cargo = maxima.cargo;
+	max_passed = maxima.passed;
+	max_building_level = maxima.building_level;
+}
+
+
+void minimap_t::invalidate_map_pixel(const koord k)
+{
+	// no pixels visible or all redrawn anyway
+	if(  !is_visible  ||  needs_redraw  ||  !world->is_within_limits(k)  ) {
+		return;
+	}
+	const uint32 i = (uint32)k.y * world->get_size().x + k.x;
+	if(  (i >> 5) >= changed_bits.get_count()  ) {
+		// not drawn yet
+		return;
+	}
+	if(  changed_bits[i >> 5] & (1u << (i & 31))  ) {
+		// already pending
+		return;
+	}
+	changed_bits[i >> 5] |= 1u << (i & 31);
+	changed_tiles.append( k );
+	if(  changed_tiles.get_count() > MAX_CHANGED_TILES  ) {
+		// cheaper to draw everything
+		needs_redraw = true;
+	}
+}
+
+
+
+
 scr_size minimap_t::get_min_size() const
 {
 	return get_max_size(); //scr_size(0,0);
@@ -1011,32 +1037,108 @@ void minimap_t::calc_map()
 	needs_redraw = false;
 	is_visible = true;
 
+	// everything is new now
+	const uint32 bits = ((uint32)world->get_size().x * world->get_size().y + 31) >> 5;
+	if(  changed_bits.get_count() != bits  ) {
+		changed_bits.clear();
+		changed_bits.resize( bits, 0 );
+	}
+	else {
+		for(  uint32 i = 0;  i < bits;  i++  ) {
+			changed_bits[i] = 0;
+		}
+	}
+	changed_tiles.clear();
+
+	// the scales start with the first tiles
+	max_cargo = max( max_cargo, 1 );
+	max_passed = max( max_passed, 1 );
+	max_building_level = max( max_building_level, 1 );
+
 	// redraw the map
 	if(  !isometric  ) {
-		koord k;
 		koord start_off = koord( (cur_off.x*zoom_out)/zoom_in, (cur_off.y*zoom_out)/zoom_in );
 		koord end_off = start_off+koord( ( map_data->get_width()*zoom_out)/zoom_in+1, ( map_data->get_height()*zoom_out)/zoom_in+1 );
-		for(  k.y=start_off.y;  k.y<end_off.y;  k.y+=zoom_out  ) {
-			for(  k.x=start_off.x;  k.x<end_off.x;  k.x+=zoom_out  ) {
-				calc_map_pixel(k);
-			}
-		}
+		calc_map_tiles( start_off, end_off, zoom_out );
 	}
 	else {
 		// always the whole map ...
-		if(isometric) {
-			map_data->init( color_idx_to_rgb(COL_BLACK) );
-		}
-		koord k;
-		for(  k.y=0;  k.y < world->get_size().y;  k.y++  ) {
-			for(  k.x=0;  k.x < world->get_size().x;  k.x++  ) {
-				calc_map_pixel(k);
+		map_data->init( color_idx_to_rgb(COL_BLACK) );
+		calc_map_tiles( koord(0,0), world->get_size(), 1 );
+	}
+}
+
+
+void minimap_t::calc_map_tiles(koord start, koord end, sint16 step)
+{
+	// only tiles on the map
+	start.clip_min( koord(0,0) );
+	end.clip_max( world->get_size() );
+	if(  start.x >= end.x  ||  start.y >= end.y  ) {
+		return;
+	}
+	band.start = start;
+	band.step = step;
+	band.columns = (end.x - start.x + step - 1) / step;
+	const uint32 rows = (end.y - start.y + step - 1) / step;
+
+	// the colors are calculated in parallel for a band of rows, then set in the usual order
+	const uint32 band_rows = max( 1u, MAP_BAND_TILES / band.columns );
+	band.colors.resize( band_rows * band.columns );
+	band.valid.resize( band_rows * band.columns );
+	for(  uint32 first_row = 0;  first_row < rows;  first_row += band_rows  ) {
+		band.first_row = first_row;
+		const uint32 count = min( band_rows, rows - first_row );
+		for(  int t = 0;  t < MAX_THREADS;  t++  ) {
+			band.maxima[t].cargo = max_cargo;
+			band.maxima[t].passed = max_passed;
+			band.maxima[t].building_level = max_building_level;
+		}
+
+		world->calc_minimap_rows( count );
+
+		for(  int t = 0;  t < MAX_THREADS;  t++  ) {
+			max_cargo = max( max_cargo, band.maxima[t].cargo );
+			max_passed = max( max_passed, band.maxima[t].passed );
+			max_building_level = max( max_building_level, band.maxima[t].building_level );
+		}
+		for(  uint32 r = 0;  r < count;  r++  ) {
+			koord k( start.x, start.y + (sint16)((first_row + r) * step) );
+			for(  uint32 c = 0;  c < band.columns;  c++, k.x += step  ) {
+				const uint32 i = r * band.columns + c;
+				if(  band.valid[i]  ) {
+					set_map_color( k, band.colors[i] );
+				}
 			}
 		}
 	}
 }
 
 
+void minimap_t::calc_map_rows(uint32 first, uint32 last, uint8 thread_num)
+{
+	map_maxima_t &maxima = band.maxima[thread_num];
+	for(  uint32 r = first;  r < last;  r++  ) {
+		koord k( band.start.x, band.start.y + (sint16)((band.first_row + r) * band.step) );
+		for(  uint32 c = 0;  c < band.columns;  c++, k.x += band.step  ) {
+			const uint32 i = r * band.columns + c;
+			band.valid[i] = calc_map_pixel_color( k, maxima, band.colors[i] );
+		}
+	}
+}
+
+
+void minimap_t::update_changed_tiles()
+{
+	FOR( vector_tpl<koord>, const& k, changed_tiles ) {
+		const uint32 i = (uint32)k.y * world->get_size().x + k.x;
+		changed_bits[i >> 5] &= ~(1u << (i & 31));
+		calc_map_pixel( k );
+	}
+	changed_tiles.clear();
+}
+
+
 minimap_t::minimap_t()
 {
 	map_data = NULL;
@@ -1098,8 +1200,8 @@ void minimap_t::new_month()
 
 void minimap_t::invalidate_map_lines_cache()
 {
+	// the lines are drawn over the map, so the map itself stays
 	last_schedule_counter = world->get_schedule_counter() - 1;
-	needs_redraw = true;
 }
 
 
@@ -1220,6 +1322,9 @@ void minimap_t::draw(scr_coord pos)
 		return;
 	}
 
+	// tiles changed since the last frame
+	update_changed_tiles();
+
 	if(  mode & MAP_PAX_DEST  &&  selected_city!=NULL  ) {
 		const uint32 current_pax_destinations = selected_city->get_pax_destinations_new_change();
 		if(  pax_destinations_last_change > current_pax_destinations  ) {
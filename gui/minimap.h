@@ -12,6 +12,8 @@
 #include "../simline.h"
 #include "../convoihandle_t.h"
 #include "../dataobj/schedule.h"
+#include "../simconst.h"
+#include "../tpl/array_tpl.h"
 #include "../tpl/array2d_tpl.h"
 #include "../tpl/vector_tpl.h"
 
@@ -151,6 +153,45 @@ private:
 	static sint32 max_cargo;
 	static sint32 max_passed;
 
+	/// maxima for the scales of the tile colors, found while calculating them
+	struct map_maxima_t
+	{
+		sint32 cargo;
+		sint32 passed;
+		sint32 building_level;
+	};
+
+	/**
+	 * the color of the tile at @p k in the current mode
+	 * @returns false, if there is no ground
+	 */
+	bool calc_map_pixel_color(const koord k, map_maxima_t &maxima, PIXVAL &color) const;
+
+	/// updates the color of the tile at @p k
+	void calc_map_pixel(const koord k);
+
+	/// tiles changed since the last draw
+	vector_tpl<koord> changed_tiles;
+	/// one bit per tile of the map, set for the tiles in changed_tiles
+	array_tpl<uint32> changed_bits;
+
+	void update_changed_tiles();
+
+	/// the rows of tiles, whose colors calc_map_rows() calculates
+	struct
+	{
+		koord start;
+		sint16 step;
+		uint32 columns;
+		uint32 first_row;
+		array_tpl<PIXVAL> colors;
+		array_tpl<bool> valid;
+		map_maxima_t maxima[MAX_THREADS];
+	} band;
+
+	/// redraws every @p step th tile from @p start to @p end
+	void calc_map_tiles(koord start, koord end, sint16 step);
+
 	/// the zoom factors
 	sint16 zoom_out, zoom_in;
 
@@ -204,8 +245,11 @@ public:
 		new_size = size;
 	}
 
-	/// update color with render mode (but few are ignored ... )
-	void calc_map_pixel(const koord k);
+	/// the tile at @p k changed, its color will be updated at the next draw
+	void invalidate_map_pixel(const koord k);
+
+	/// calculates the colors of the rows @p first ... @p last-1 of the current band, called on all threads
+	void calc_map_rows(uint32 first, uint32 last, uint8 thread_num);
 
 	void calc_map();
 
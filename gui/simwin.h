@@ -37,6 +37,13 @@ enum wintype {
 ENUM_BITSET(wintype)
 
 
+// windows of convoys and halts use the magic of their range plus the handle id
+#ifdef HANDLES_32BIT
+#define MAGIC_HANDLE_RANGE (0x10000000)
+#else
+#define MAGIC_HANDLE_RANGE (0x10000)
+#endif
+
 enum magic_numbers {
 	magic_none     = -1,
 	magic_reserved = 0,
@@ -111,10 +118,10 @@ enum magic_numbers {
 
 	// magic numbers with big jumps between them
 	magic_convoi_info,
-	magic_UNUSED_convoi_detail = magic_convoi_info          + 0x10000, // unused range
-	magic_halt_info            = magic_UNUSED_convoi_detail + 0x10000,
-	magic_UNUSED_halt_detail   = magic_halt_info            + 0x10000, // unused range
-	magic_toolbar              = magic_UNUSED_halt_detail   + 0x10000,
+	magic_UNUSED_convoi_detail = magic_convoi_info          + MAGIC_HANDLE_RANGE, // unused range
+	magic_halt_info            = magic_UNUSED_convoi_detail + MAGIC_HANDLE_RANGE,
+	magic_UNUSED_halt_detail   = magic_halt_info            + MAGIC_HANDLE_RANGE, // unused range
+	magic_toolbar              = magic_UNUSED_halt_detail   + MAGIC_HANDLE_RANGE,
 	magic_script_error         = magic_toolbar              + 0x100,
 	magic_haltlist_filter,
 	magic_depot, // only used to load/save
@@ -122,6 +129,7 @@ enum magic_numbers {
 	magic_vehiclelist = magic_depotlist   + MAX_PLAYER_COUNT,
 	magic_script_generator,
 	magic_pakinstall,
+	magic_step_profiler,
 	magic_max
 };
 
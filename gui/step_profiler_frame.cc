@@ -0,0 +1,103 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "step_profiler_frame.h"
+#include "../simhalt.h"
+#include "../dataobj/translator.h"
+#include "../sys/simsys.h"
+
+
+static const char *const column_names[] = {
+	"calls",
+	"avg us",
+	"p50 us",
+	"p99 us",
+	"max us",
+	"total ms"
+};
+
+
+step_profiler_frame_t::step_profiler_frame_t() :
+	gui_frame_t( translator::translate("Step profiler") )
+{
+	set_table_layout(1,0);
+
+	add_table(1+MAX_COLS,0);
+	{
+		new_component<gui_empty_t>();
+		for(  int c = 0;  c < MAX_COLS;  c++  ) {
+			new_component<gui_label_t>( column_names[c], SYSCOL_TEXT, gui_label_t::right );
+		}
+
+		for(  int p = 0;  p < step_profiler_t::MAX_PHASES;  p++  ) {
+			new_component<gui_label_t>( step_profiler_t::get_phase_name( (step_profiler_t::phase_t)p ) );
+			for(  int c = 0;  c < MAX_COLS;  c++  ) {
+				values[p][c].set_align( gui_label_t::right );
+				values[p][c].buf().append( "999999999" );
+				values[p][c].update();
+				add_component( &values[p][c] );
+			}
+		}
+	}
+	end_table();
+
+	add_component( &route_cache );
+
+	reset_button.init( button_t::roundbox, "Reset" );
+	reset_button.add_listener( this );
+	add_component( &reset_button );
+
+	update_values();
+
+	reset_min_windowsize();
+	set_windowsize( get_min_windowsize() );
+}
+
+
+void step_profiler_frame_t::update_values()
+{
+	for(  int p = 0;  p < step_profiler_t::MAX_PHASES;  p++  ) {
+		step_profiler_t::stats_t stats;
+		step_profiler_t::get_stats( (step_profiler_t::phase_t)p, stats );
+
+		values[p][COL_CALLS].buf().printf( "%u", (uint32)stats.calls );
+		values[p][COL_AVG].buf().printf( "%u", stats.calls ? (uint32)(stats.total_us / stats.calls) : 0 );
+		values[p][COL_P50].buf().printf( "%u", stats.p50_us );
+		values[p][COL_P99].buf().printf( "%u", stats.p99_us );
+		values[p][COL_MAX].buf().printf( "%u", stats.max_us );
+		values[p][COL_TOTAL].buf().printf( "%u", (uint32)(stats.total_us / 1000) );
+		for(  int c = 0;  c < MAX_COLS;  c++  ) {
+			values[p][c].update();
+		}
+	}
+
+	uint64 hits, misses;
+	haltestelle_t::get_route_cache_stats( hits, misses );
+	route_cache.buf().printf( "%s: %u %s, %u %s (%u%%)", translator::translate("Route cache"),
+		(uint32)hits, translator::translate("hits"), (uint32)misses, translator::translate("misses"),
+		hits+misses ? (uint32)((hits*100)/(hits+misses)) : 0 );
+	route_cache.update();
+
+	last_update = dr_time();
+}
+
+
+void step_profiler_frame_t::draw(scr_coord pos, scr_size size)
+{
+	if(  dr_time() - last_update > 1000  ) {
+		update_values();
+	}
+	gui_frame_t::draw( pos, size );
+}
+
+
+bool step_profiler_frame_t::action_triggered(gui_action_creator_t *comp, value_t)
+{
+	if(  comp == &reset_button  ) {
+		step_profiler_t::reset();
+		update_values();
+	}
+	return true;
+}
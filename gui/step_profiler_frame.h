@@ -0,0 +1,44 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef GUI_STEP_PROFILER_FRAME_H
+#define GUI_STEP_PROFILER_FRAME_H
+
+
+#include "gui_frame.h"
+#include "components/gui_label.h"
+#include "components/gui_button.h"
+#include "components/action_listener.h"
+#include "../utils/step_profiler.h"
+
+
+/**
+ * Shows the timings of the simulation phases recorded by step_profiler_t
+ */
+class step_profiler_frame_t : public gui_frame_t, action_listener_t
+{
+private:
+	enum { COL_CALLS, COL_AVG, COL_P50, COL_P99, COL_MAX, COL_TOTAL, MAX_COLS };
+
+	gui_label_buf_t values[step_profiler_t::MAX_PHASES][MAX_COLS];
+
+	gui_label_buf_t route_cache;
+
+	button_t reset_button;
+
+	uint32 last_update;
+
+	void update_values();
+
+public:
+	step_profiler_frame_t();
+
+	// refreshes the values every second
+	void draw(scr_coord pos, scr_size size) OVERRIDE;
+
+	bool action_triggered(gui_action_creator_t*, value_t) OVERRIDE;
+};
+
+#endif
@@ -13,6 +13,7 @@
 
 class grund_t;
 class weg_t;
+struct route_edge_t;
 
 
 /**
@@ -51,6 +52,17 @@ public:
 
 	// return the cost of a single step upwards
 	virtual uint32 get_cost_upslope() const { return 0; }
+
+	/// true, if get_edge_cost() can handle edges of the route graph at all
+	virtual bool has_edge_cost() const { return false; }
+
+	/**
+	 * How expensive to go over all inner tiles of a route graph edge at once,
+	 * i.e. the sum of get_cost() over them, if check_next_tile() is true for all of them.
+	 * @param max_speed the maximum convoi speed
+	 * @returns false, if the inner tiles must be checked one by one
+	 */
+	virtual bool get_edge_cost(const route_edge_t &, const sint32 /*max_speed*/, uint32 &/*cost*/) const { return false; }
 };
 
 #endif
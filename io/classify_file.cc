@@ -10,6 +10,7 @@
 #include "rdwr/zlib_file_rdwr_stream.h"
 #ifdef USE_ZSTD
 #include "rdwr/zstd_file_rdwr_stream.h"
+#include "rdwr/zstd_chunked_file_rdwr_stream.h"
 #endif
 
 #include "../dataobj/loadsave.h"
@@ -82,12 +83,21 @@ file_classify_status_t classify_save_file(const char *path, file_info_t *info)
 		fclose(f);
 
 #if USE_ZSTD // otherwise we cannot read it
-		zstd_file_rdwr_stream_t s(path, false, 0);
-		if (!classify_file_data(&s, info)) {
+		const file_info_t::file_type_t type = info->file_type;
+		rdwr_stream_t *s;
+		if (type == file_info_t::TYPE_ZSTD_CHUNKED) {
+			s = new zstd_chunked_file_rdwr_stream_t(path, false, 0);
+		}
+		else {
+			s = new zstd_file_rdwr_stream_t(path, false, 0);
+		}
+		const bool ok = classify_file_data(s, info);
+		delete s;
+		if (!ok) {
+			info->file_type = type;
 #else
 		{
 #endif
-			info->file_type = file_info_t::TYPE_ZSTD;
 			info->version = INVALID_FILE_VERSION;
 			info->header_size = 0;
 		}
@@ -256,6 +266,11 @@ bool classify_as_zstd(FILE *f, file_info_t *info)
 		return false;
 	}
 
+	if(  memcmp(buf, "ZC", 2) == 0) {
+		info->file_type = file_info_t::TYPE_ZSTD_CHUNKED;
+		return true;
+	}
+
 	if(  memcmp(buf, "ZD", 2) != 0) {
 		return false; // not zstd compressed
 	}
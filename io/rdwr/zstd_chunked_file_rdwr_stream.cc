@@ -0,0 +1,439 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "zstd_chunked_file_rdwr_stream.h"
+
+#include "../../dataobj/environment.h"
+#include "../../simdebug.h"
+#include "../../simmem.h"
+
+#include <string.h>
+
+
+#define ZSTD_CHUNK_SIZE (1 << 21) // 2MiB uncompressed per frame
+
+// size of an entry of the frame index
+#define ZSTD_CHUNK_ENTRY_SIZE (8)
+
+
+static void put_entry(char *entry, uint32 raw_size, uint32 packed_size)
+{
+	for(  int i = 0;  i < 4;  i++  ) {
+		entry[i]   = (char)(raw_size >> (8*i));
+		entry[4+i] = (char)(packed_size >> (8*i));
+	}
+}
+
+
+static void get_entry(const char *entry, uint32 &raw_size, uint32 &packed_size)
+{
+	raw_size = packed_size = 0;
+	for(  int i = 0;  i < 4;  i++  ) {
+		raw_size    |= (uint32)(uint8)entry[i] << (8*i);
+		packed_size |= (uint32)(uint8)entry[4+i] << (8*i);
+	}
+}
+
+
+zstd_chunked_file_rdwr_stream_t::zstd_chunked_file_rdwr_stream_t(const std::string &filename, bool writing, int compression) :
+	raw_file_rdwr_stream_t(filename, writing),
+	frames(NULL),
+	frame_count(0),
+	current(0),
+	next_fetch(0),
+	compression_level(compression),
+	end_reached(false),
+	end_marker(false),
+	compression_context(NULL),
+	decompression_context(NULL)
+{
+#ifdef MULTI_THREAD
+	workers = NULL;
+	num_workers = 0;
+	quit = false;
+#endif
+
+	if (status != STATUS_OK) {
+		return; // Could not open file
+	}
+
+	if (writing) {
+		// the additional magic for chunked zstd
+		if (raw_file_rdwr_stream_t::write("ZC", 2) != 2) {
+			return;
+		}
+	}
+	else {
+		char buf[2];
+		if (raw_file_rdwr_stream_t::read(buf, 2) != 2  ||  buf[0] != 'Z'  ||  buf[1] != 'C') {
+			status = STATUS_ERR_CORRUPT;
+			return;
+		}
+	}
+
+#ifdef MULTI_THREAD
+	// two frames per worker keep all workers busy while the oldest frame is written resp. read
+	num_workers = max( env_t::num_threads, 1 );
+	frame_count = num_workers * 2;
+#else
+	frame_count = 1;
+#endif
+
+	frames = new frame_t[frame_count];
+	for(  uint32 i = 0;  i < frame_count;  i++  ) {
+		frame_t &f = frames[i];
+		f.state = frame_t::FREE;
+		f.failed = false;
+		f.raw = NULL;
+		f.raw_size = 0;
+		f.raw_pos = 0;
+		f.packed = NULL;
+		f.packed_size = 0;
+	}
+
+	status = STATUS_OK;
+
+	if (writing) {
+		alloc_frame(frames[0]);
+	}
+	else {
+		// Only the first frame and without workers: when just the header is read (e.g. in the file dialog),
+		// there is no need to decompress more. The reading ahead starts once it is used up.
+		if (fetch_frame(frames[0])) {
+			next_fetch = 1 % frame_count;
+		}
+		status = STATUS_OK;
+	}
+}
+
+
+zstd_chunked_file_rdwr_stream_t::~zstd_chunked_file_rdwr_stream_t()
+{
+	if (frames != NULL) {
+		if (is_writing()) {
+			// the last, partially filled frame
+			if (frames[current].raw_size > 0) {
+				submit(frames[current]);
+				current = (current + 1) % frame_count;
+			}
+			// all frames in flight in file order
+			for(  uint32 i = 0;  i < frame_count;  i++  ) {
+				flush_frame(frames[current]);
+				current = (current + 1) % frame_count;
+			}
+			// end of the frame index
+			char entry[ZSTD_CHUNK_ENTRY_SIZE];
+			put_entry(entry, 0, 0);
+			raw_file_rdwr_stream_t::write(entry, ZSTD_CHUNK_ENTRY_SIZE);
+		}
+		else {
+			// frames read ahead, but not needed
+			for(  uint32 i = 0;  i < frame_count;  i++  ) {
+				if (frames[i].state != frame_t::FREE) {
+					wait_done(frames[i]);
+				}
+			}
+		}
+
+#ifdef MULTI_THREAD
+		if (workers != NULL) {
+			pthread_mutex_lock(&mutex);
+			quit = true;
+			pthread_cond_broadcast(&queued_cond);
+			pthread_mutex_unlock(&mutex);
+			for(  uint32 i = 0;  i < num_workers;  i++  ) {
+				pthread_join(workers[i], NULL);
+			}
+			delete [] workers;
+
+			pthread_cond_destroy(&done_cond);
+			pthread_cond_destroy(&queued_cond);
+			pthread_mutex_destroy(&mutex);
+		}
+#endif
+
+		for(  uint32 i = 0;  i < frame_count;  i++  ) {
+			free(frames[i].raw);
+			free(frames[i].packed);
+		}
+		delete [] frames;
+	}
+
+	ZSTD_freeCCtx(compression_context);
+	ZSTD_freeDCtx(decompression_context);
+}
+
+
+void zstd_chunked_file_rdwr_stream_t::alloc_frame(frame_t &f)
+{
+	if (f.raw == NULL) {
+		f.raw = (char *)xmalloc(ZSTD_CHUNK_SIZE);
+		f.packed = (char *)xmalloc(ZSTD_compressBound(ZSTD_CHUNK_SIZE));
+	}
+}
+
+
+bool zstd_chunked_file_rdwr_stream_t::process(frame_t &f, ZSTD_CCtx *cctx, ZSTD_DCtx *dctx) const
+{
+	if (is_writing()) {
+		const size_t ret = ZSTD_compressCCtx(cctx, f.packed, ZSTD_compressBound(ZSTD_CHUNK_SIZE), f.raw, f.raw_size, compression_level);
+		if (ZSTD_isError(ret)) {
+			return false;
+		}
+		f.packed_size = ret;
+	}
+	else {
+		const size_t ret = ZSTD_decompressDCtx(dctx, f.raw, ZSTD_CHUNK_SIZE, f.packed, f.packed_size);
+		if (ZSTD_isError(ret)  ||  ret != f.raw_size) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+#ifdef MULTI_THREAD
+void zstd_chunked_file_rdwr_stream_t::start_workers()
+{
+	if (workers != NULL) {
+		return;
+	}
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&queued_cond, NULL);
+	pthread_cond_init(&done_cond, NULL);
+
+	workers = new pthread_t[num_workers];
+	for(  uint32 i = 0;  i < num_workers;  i++  ) {
+		pthread_create(&workers[i], NULL, worker_thread, this);
+	}
+}
+
+
+void *zstd_chunked_file_rdwr_stream_t::worker_thread(void *ptr)
+{
+	zstd_chunked_file_rdwr_stream_t *stream = (zstd_chunked_file_rdwr_stream_t *)ptr;
+
+	// every worker has its own context
+	ZSTD_CCtx *cctx = stream->is_writing() ? ZSTD_createCCtx() : NULL;
+	ZSTD_DCtx *dctx = stream->is_writing() ? NULL : ZSTD_createDCtx();
+
+	pthread_mutex_lock(&stream->mutex);
+	while(  true  ) {
+		frame_t *f = NULL;
+		for(  uint32 i = 0;  i < stream->frame_count  &&  f == NULL;  i++  ) {
+			if (stream->frames[i].state == frame_t::QUEUED) {
+				f = &stream->frames[i];
+			}
+		}
+		if (f == NULL) {
+			if (stream->quit) {
+				break;
+			}
+			pthread_cond_wait(&stream->queued_cond, &stream->mutex);
+			continue;
+		}
+
+		f->state = frame_t::WORKING;
+		pthread_mutex_unlock(&stream->mutex);
+
+		const bool ok = (cctx != NULL  ||  dctx != NULL)  &&  stream->process(*f, cctx, dctx);
+
+		pthread_mutex_lock(&stream->mutex);
+		f->failed = !ok;
+		f->state = frame_t::DONE;
+		pthread_cond_broadcast(&stream->done_cond);
+	}
+	pthread_mutex_unlock(&stream->mutex);
+
+	ZSTD_freeCCtx(cctx);
+	ZSTD_freeDCtx(dctx);
+	return NULL;
+}
+#endif
+
+
+void zstd_chunked_file_rdwr_stream_t::submit(frame_t &f)
+{
+#ifdef MULTI_THREAD
+	if (workers != NULL) {
+		pthread_mutex_lock(&mutex);
+		f.state = frame_t::QUEUED;
+		pthread_cond_signal(&queued_cond);
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+#endif
+	if (is_writing()) {
+		if (compression_context == NULL) {
+			compression_context = ZSTD_createCCtx();
+		}
+	}
+	else if (decompression_context == NULL) {
+		decompression_context = ZSTD_createDCtx();
+	}
+	f.failed = (compression_context == NULL  &&  decompression_context == NULL)  ||  !process(f, compression_context, decompression_context);
+	f.state = frame_t::DONE;
+}
+
+
+void zstd_chunked_file_rdwr_stream_t::wait_done(frame_t &f)
+{
+#ifdef MULTI_THREAD
+	if (workers != NULL) {
+		pthread_mutex_lock(&mutex);
+		while(  f.state != frame_t::DONE  ) {
+			pthread_cond_wait(&done_cond, &mutex);
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+#else
+	(void)f;
+#endif
+}
+
+
+bool zstd_chunked_file_rdwr_stream_t::flush_frame(frame_t &f)
+{
+	if (f.state == frame_t::FREE) {
+		return true;
+	}
+
+	wait_done(f);
+	f.state = frame_t::FREE;
+	if (f.failed) {
+		dbg->error("zstd_chunked_file_rdwr_stream_t::flush_frame", "Error during compression");
+		status = STATUS_ERR_CORRUPT;
+		return false;
+	}
+
+	char entry[ZSTD_CHUNK_ENTRY_SIZE];
+	put_entry(entry, (uint32)f.raw_size, (uint32)f.packed_size);
+	f.raw_size = 0;
+	if (raw_file_rdwr_stream_t::write(entry, ZSTD_CHUNK_ENTRY_SIZE) != ZSTD_CHUNK_ENTRY_SIZE  ||
+		raw_file_rdwr_stream_t::write(f.packed, f.packed_size) != f.packed_size) {
+		status = STATUS_ERR_FULL;
+		return false;
+	}
+	return true;
+}
+
+
+bool zstd_chunked_file_rdwr_stream_t::fetch_frame(frame_t &f)
+{
+	if (end_reached) {
+		return false;
+	}
+
+	char entry[ZSTD_CHUNK_ENTRY_SIZE];
+	uint32 raw_size, packed_size;
+	if (raw_file_rdwr_stream_t::read(entry, ZSTD_CHUNK_ENTRY_SIZE) != ZSTD_CHUNK_ENTRY_SIZE) {
+		// truncated file
+		end_reached = true;
+		return false;
+	}
+
+	get_entry(entry, raw_size, packed_size);
+	if (raw_size == 0  &&  packed_size == 0) {
+		end_reached = true;
+		end_marker = true;
+		return false;
+	}
+
+	alloc_frame(f);
+	if (raw_size == 0  ||  raw_size > ZSTD_CHUNK_SIZE  ||  packed_size > ZSTD_compressBound(ZSTD_CHUNK_SIZE)  ||
+		raw_file_rdwr_stream_t::read(f.packed, packed_size) != packed_size) {
+		dbg->error("zstd_chunked_file_rdwr_stream_t::fetch_frame", "Invalid frame");
+		end_reached = true;
+		return false;
+	}
+
+	f.raw_size = raw_size;
+	f.raw_pos = 0;
+	f.packed_size = packed_size;
+	submit(f);
+	return true;
+}
+
+
+void zstd_chunked_file_rdwr_stream_t::fetch_ahead()
+{
+#ifdef MULTI_THREAD
+	// more than the first frame is read, so it is worth to start the workers
+	start_workers();
+#endif
+	while(  frames[next_fetch].state == frame_t::FREE  &&  fetch_frame(frames[next_fetch])  ) {
+		next_fetch = (next_fetch + 1) % frame_count;
+	}
+}
+
+
+size_t zstd_chunked_file_rdwr_stream_t::read(void *buf, size_t len)
+{
+	size_t pos = 0;
+	while(  pos < len  ) {
+		frame_t &f = frames[current];
+		if (f.state == frame_t::FREE) {
+			// no more frames
+			break;
+		}
+
+		wait_done(f);
+		if (f.failed) {
+			dbg->error("zstd_chunked_file_rdwr_stream_t::read", "Error during decompression");
+			status = STATUS_ERR_CORRUPT;
+			return 0;
+		}
+
+		const size_t available = f.raw_size - f.raw_pos;
+		const size_t n = len - pos < available ? len - pos : available;
+		memcpy((char *)buf + pos, f.raw + f.raw_pos, n);
+		pos += n;
+		f.raw_pos += n;
+
+		if (f.raw_pos == f.raw_size) {
+			f.state = frame_t::FREE;
+			current = (current + 1) % frame_count;
+			fetch_ahead();
+		}
+	}
+
+	if (pos < len) {
+		// end of decompressed data reached; without end marker the file was cut off
+		status = end_marker ? STATUS_EOF : STATUS_ERR_CORRUPT;
+	}
+	else {
+		status = STATUS_OK;
+	}
+	return pos;
+}
+
+
+size_t zstd_chunked_file_rdwr_stream_t::write(const void *buf, size_t len)
+{
+	size_t pos = 0;
+	while(  pos < len  ) {
+		frame_t &f = frames[current];
+		const size_t space = ZSTD_CHUNK_SIZE - f.raw_size;
+		const size_t n = len - pos < space ? len - pos : space;
+		memcpy(f.raw + f.raw_size, (const char *)buf + pos, n);
+		f.raw_size += n;
+		pos += n;
+
+		if (f.raw_size == ZSTD_CHUNK_SIZE) {
+#ifdef MULTI_THREAD
+			// more than one frame, so it is worth to start the workers
+			start_workers();
+#endif
+			submit(f);
+			current = (current + 1) % frame_count;
+			alloc_frame(frames[current]);
+			// the oldest frame in flight must be written before its buffers are reused
+			if (!flush_frame(frames[current])) {
+				return 0;
+			}
+		}
+	}
+	return len;
+}
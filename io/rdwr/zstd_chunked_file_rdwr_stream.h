@@ -0,0 +1,117 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef IO_RDWR_ZSTD_CHUNKED_FILE_RDWR_STREAM_H
+#define IO_RDWR_ZSTD_CHUNKED_FILE_RDWR_STREAM_H
+
+
+#include "raw_file_rdwr_stream.h"
+
+#include <zstd.h>
+
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+#endif
+
+
+#if !USE_ZSTD
+#  error "Cannot use zstd_chunked_file_rdwr_stream_t: zstd not enabled"
+#endif
+
+
+/**
+ * Reads/writes data from/to a file of independent zstd frames, which are
+ * compressed resp. decompressed on several threads.
+ *
+ * File layout: the magic "ZC", then for every frame its entry of the frame index
+ * (uncompressed and compressed size, 32 bit little endian each) followed by the frame.
+ * An entry with both sizes zero ends the file. Since the index is interleaved with
+ * the frames, neither writing nor reading needs to seek.
+ *
+ * The buffers of a frame are allocated on its first use, and the worker threads only
+ * start once more than one frame is needed. So reading just the header (e.g. to list
+ * the savegames) costs one frame on the calling thread.
+ */
+class zstd_chunked_file_rdwr_stream_t : public raw_file_rdwr_stream_t
+{
+public:
+	zstd_chunked_file_rdwr_stream_t(const std::string &filename, bool writing, int compression);
+	~zstd_chunked_file_rdwr_stream_t();
+
+public:
+	/// @copydoc rdwr_stream_t::read
+	size_t read(void *buf, size_t len) OVERRIDE;
+
+	/// @copydoc rdwr_stream_t::write
+	size_t write(const void *buf, size_t len) OVERRIDE;
+
+private:
+	struct frame_t
+	{
+		enum state_t { FREE, QUEUED, WORKING, DONE };
+
+		state_t state;
+		bool failed;
+		char *raw;          ///< uncompressed data
+		size_t raw_size;
+		size_t raw_pos;     ///< (when reading) bytes already returned by read()
+		char *packed;       ///< the zstd frame
+		size_t packed_size;
+	};
+
+	/// frames in flight, used as a ring in file order
+	frame_t *frames;
+	uint32 frame_count;
+	uint32 current;
+	/// (when reading) the slot for the next frame from the file
+	uint32 next_fetch;
+
+	int compression_level;
+
+	/// (when reading) no more frames in the file
+	bool end_reached;
+	/// (when reading) the end entry of the frame index was found
+	bool end_marker;
+
+	/// compresses resp. decompresses @p f
+	bool process(frame_t &f, ZSTD_CCtx *cctx, ZSTD_DCtx *dctx) const;
+
+	/// allocates the buffers of @p f, if not yet done
+	void alloc_frame(frame_t &f);
+
+	/// hands @p f to the workers (or processes it at once, if they are not started)
+	void submit(frame_t &f);
+
+	void wait_done(frame_t &f);
+
+	/// (when writing) waits for @p f and writes it to the file
+	bool flush_frame(frame_t &f);
+
+	/// (when reading) reads the next frame from the file into @p f and submits it
+	bool fetch_frame(frame_t &f);
+
+	/// (when reading) fills all free slots with the next frames
+	void fetch_ahead();
+
+	/// for the frames processed on the calling thread, created on first use
+	ZSTD_CCtx *compression_context;
+	ZSTD_DCtx *decompression_context;
+
+#ifdef MULTI_THREAD
+	pthread_t *workers; ///< NULL until start_workers()
+	uint32 num_workers;
+	bool quit;
+	pthread_mutex_t mutex;
+	pthread_cond_t queued_cond;
+	pthread_cond_t done_cond;
+
+	/// starts the workers, if not yet done
+	void start_workers();
+
+	static void *worker_thread(void *ptr);
+#endif
+};
+
+#endif
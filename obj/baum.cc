@@ -9,7 +9,6 @@
 
 #include "../boden/grund.h"
 #include "../dataobj/environment.h"
-#include "../dataobj/freelist.h"
 #include "../dataobj/loadsave.h"
 #include "../dataobj/translator.h"
 #include "../descriptor/tree_desc.h"
@@ -18,6 +17,7 @@
 #include "../simdebug.h"
 #include "../simtypes.h"
 #include "../simworld.h"
+#include "../tpl/freelist_tpl.h"
 #include "../utils/cbuffer_t.h"
 #include "../utils/simrandom.h"
 
@@ -327,11 +327,11 @@ uint16 baum_t::get_age() const
 
 void *baum_t::operator new(size_t /*s*/)
 {
-	return freelist_t::gimme_node(sizeof(baum_t));
+	return freelist_tpl<baum_t>::gimme_node("baum_t");
 }
 
 
 void baum_t::operator delete(void *p)
 {
-	freelist_t::putback_node(sizeof(baum_t),p);
+	freelist_tpl<baum_t>::putback_node(p);
 }
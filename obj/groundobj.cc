@@ -13,6 +13,8 @@
 #include "../boden/grund.h"
 #include "../descriptor/groundobj_desc.h"
 
+#include "../tpl/freelist_tpl.h"
+
 #include "../utils/cbuffer_t.h"
 #include "../utils/simstring.h"
 #include "../utils/simrandom.h"
@@ -20,7 +22,6 @@
 #include "../dataobj/loadsave.h"
 #include "../dataobj/translator.h"
 #include "../dataobj/environment.h"
-#include "../dataobj/freelist.h"
 
 
 #include "groundobj.h"
@@ -296,11 +297,11 @@ void groundobj_t::cleanup(player_t *player)
 
 void *groundobj_t::operator new(size_t /*s*/)
 {
-	return freelist_t::gimme_node(sizeof(groundobj_t));
+	return freelist_tpl<groundobj_t>::gimme_node("groundobj_t");
 }
 
 
 void groundobj_t::operator delete(void *p)
 {
-	freelist_t::putback_node(sizeof(groundobj_t),p);
+	freelist_tpl<groundobj_t>::putback_node(p);
 }
@@ -11,11 +11,11 @@
 #include "../utils/simrandom.h"
 #include "wolke.h"
 
-#include "../dataobj/freelist.h"
 #include "../dataobj/loadsave.h"
 
 #include "../descriptor/factory_desc.h"
 
+#include "../tpl/freelist_tpl.h"
 #include "../tpl/vector_tpl.h"
 
 
@@ -36,13 +36,13 @@ bool wolke_t::register_desc(const skin_desc_t* desc)
 
 void *wolke_t::operator new(size_t /*s*/)
 {
-	return freelist_t::gimme_node(sizeof(wolke_t));
+	return freelist_tpl<wolke_t>::gimme_node("wolke_t");
 }
 
 
 void wolke_t::operator delete(void *p)
 {
-	freelist_t::putback_node(sizeof(wolke_t),p);
+	freelist_tpl<wolke_t>::putback_node(p);
 }
 
 
@@ -357,7 +357,7 @@ call_tool_init depot_append_vehicle(depot_t *depot, player_t *player, convoihand
 	// see depot_frame_t::image_from_storage_list: tool = 'a'
 	// see depot_t::call_depot_tool for command string composition
 	cbuffer_t buf;
-	buf.printf( "%c,%s,%hu,%s", 'a', depot->get_pos().get_str(), cnv.get_id(), desc->get_name());
+	buf.printf( "%c,%s,%u,%s", 'a', depot->get_pos().get_str(), cnv.get_id(), desc->get_name());
 
 	return call_tool_init(TOOL_CHANGE_DEPOT | SIMPLE_TOOL, buf, 0, player);
 }
@@ -368,7 +368,7 @@ call_tool_init depot_start_convoy(depot_t *depot, player_t *player, convoihandle
 	// see depot_t::call_depot_tool for command string composition
 	cbuffer_t buf;
 	if (cnv.is_bound()) {
-		buf.printf( "%c,%s,%hu", 'b', depot->get_pos().get_str(), cnv->self.get_id());
+		buf.printf( "%c,%s,%u", 'b', depot->get_pos().get_str(), cnv->self.get_id());
 	}
 	else {
 		buf.printf( "%c,%s,%hu", 'B', depot->get_pos().get_str(), 0);
@@ -16,6 +16,7 @@
 #include "../../player/simplay.h"
 #include "../../obj/gebaeude.h"
 #include "../../descriptor/ground_desc.h"
+#include "../../utils/step_profiler.h"
 
 using namespace script_api;
 
@@ -124,6 +125,38 @@ SQInteger world_get_size(HSQUIRRELVM vm)
 	}
 }
 
+#ifdef DOXYGEN
+/**
+ * Timings of one phase of the simulation step
+ */
+struct step_profile_x { // begin_class("step_profile_x")
+	string name;      ///< name of the phase
+	integer calls;    ///< number of calls since start or reset
+	integer total_us; ///< total time in microseconds
+	integer p50_us;   ///< median time of the last 1024 calls in microseconds
+	integer p99_us;   ///< 99th percentile of the last 1024 calls in microseconds
+	integer max_us;   ///< longest call in microseconds
+}; // end_class
+#endif
+
+SQInteger world_get_step_profile(HSQUIRRELVM vm)
+{
+	sq_newarray(vm, 0);
+	for(  int i = 0;  i < step_profiler_t::MAX_PHASES;  i++  ) {
+		step_profiler_t::stats_t stats;
+		step_profiler_t::get_stats( (step_profiler_t::phase_t)i, stats );
+		sq_newtable(vm);
+		create_slot(vm, "name", step_profiler_t::get_phase_name( (step_profiler_t::phase_t)i ) );
+		create_slot(vm, "calls", stats.calls);
+		create_slot(vm, "total_us", stats.total_us);
+		create_slot(vm, "p50_us", stats.p50_us);
+		create_slot(vm, "p99_us", stats.p99_us);
+		create_slot(vm, "max_us", stats.max_us);
+		sq_arrayappend(vm, -2);
+	}
+	return 1;
+}
+
 const char* get_pakset_name()
 {
 	return ground_desc_t::outside->get_copyright();
@@ -342,6 +375,12 @@ void export_world(HSQUIRRELVM vm, bool scenario)
 	 * Returns bits_per_month
 	 */
 	STATIC register_method(vm, world_get_bits_per_month, "get_bits_per_month");
+	/**
+	 * Returns the timings of the phases of the simulation step (convoys, cities, factories, ...)
+	 * as measured on this computer. Not synchronized in network games.
+	 * @typemask array<step_profile_x> ()
+	 */
+	STATIC register_function(vm, world_get_step_profile, "get_step_profile", 1, ".");
 
 	end_class(vm);
 
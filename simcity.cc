@@ -731,10 +731,10 @@ const stadt_t::factory_entry_t* stadt_t::factory_set_t::get_entry(const fabrik_t
 }
 
 
-stadt_t::factory_entry_t* stadt_t::factory_set_t::get_random_entry()
+stadt_t::factory_entry_t* stadt_t::factory_set_t::get_random_entry(simrand_stream_t &rand)
 {
 	if(  total_remaining>0  ) {
-		sint32 weight = simrand(total_remaining);
+		sint32 weight = rand.rand(total_remaining);
 		FOR(vector_tpl<factory_entry_t>, & entry, entries) {
 			if(  entry.remaining>0  ) {
 				if(  weight<entry.remaining  ) {
@@ -974,6 +974,8 @@ stadt_t::stadt_t(player_t* player, koord pos, sint32 citizens) :
 	step_count = 0;
 	pax_destinations_new_change = 0;
 	next_step = 0;
+	pax_steps = 0;
+	pax_overcrowded_epoch = 0;
 	step_interval = 1;
 	next_growth_step = 0;
 	has_low_density = false;
@@ -1075,6 +1077,8 @@ stadt_t::stadt_t(loadsave_t* file) :
 {
 	step_count = 0;
 	next_step = 0;
+	pax_steps = 0;
+	pax_overcrowded_epoch = 0;
 	step_interval = 1;
 	next_growth_step = 0;
 	has_low_density = false;
@@ -1462,11 +1466,14 @@ void stadt_t::step(uint32 delta_t)
 	}
 
 	// create passenger rate proportional to town size
+	// (the passengers are generated by generate_passagiere() later)
 	while(next_step > step_interval) {
-		step_passagiere();
-		step_count++;
+		pax_steps++;
 		next_step -= step_interval;
 	}
+	if(  pax_steps > 0  ) {
+		pax_rand.set_seed( simrand_plain() );
+	}
 
 	// update history (might be changed do to construction/destroying of houses)
 	city_history_month[0][HIST_CITIZENS] = get_einwohner(); // total number
@@ -1798,13 +1805,41 @@ void stadt_t::step_grow_city( bool new_town )
 }
 
 
+/// all halts at plan where passengers or mail of this type can start (i.e. enabled and not overcrowded)
+static void get_start_halts(const planquadrat_t *plan, const goods_desc_t *wtyp, vector_tpl<halthandle_t> &start_halts)
+{
+	const halthandle_t *const halt_list = plan->get_haltlist();
+	start_halts.clear();
+	for (uint h = 0; h < plan->get_haltlist_count(); h++) {
+		halthandle_t halt = halt_list[h];
+		if(  halt.is_bound()  &&  halt->is_enabled(wtyp)  &&  !halt->is_overcrowded(wtyp->get_index())  ) {
+			start_halts.append(halt);
+		}
+	}
+}
+
+
+void stadt_t::generate_passagiere(uint8 thread_num)
+{
+	pax_packets.clear();
+	// no halt changes its overcrowding while the cities generate passengers
+	pax_overcrowded_epoch = haltestelle_t::get_overcrowded_epoch();
+	for(  ;  pax_steps > 0;  pax_steps--  ) {
+		step_passagiere( thread_num );
+		step_count++;
+	}
+}
+
+
 /* this creates passengers and mail for everything is is therefore one of the CPU hogs of the machine
  * think trice, before applying optimisation here ...
+ * Runs in parallel for different cities, so only this city may be changed here.
+ * Halts, factories and other cities are booked by merge_passagiere().
  */
-void stadt_t::step_passagiere()
+void stadt_t::step_passagiere(uint8 thread_num)
 {
 	// decide whether to generate passengers or mail
-	const bool ispass = simrand(GENERATE_RATIO_PASS + GENERATE_RATIO_MAIL) < GENERATE_RATIO_PASS;
+	const bool ispass = pax_rand.rand(GENERATE_RATIO_PASS + GENERATE_RATIO_MAIL) < GENERATE_RATIO_PASS;
 	const goods_desc_t *const wtyp = ispass ? goods_manager_t::passengers : goods_manager_t::mail;
 	const uint32 history_type = ispass ? HIST_BASE_PASS : HIST_BASE_MAIL;
 	factory_set_t &target_factories = ispass ? target_factories_pax : target_factories_mail;
@@ -1825,31 +1860,30 @@ void stadt_t::step_passagiere()
 			(gb->get_tile()->get_desc()->get_mail_level() + 8) >> 3 ;
 
 	// create pedestrians in the near area?
-	if (welt->get_settings().get_random_pedestrians()  &&  ispass) {
-		haltestelle_t::generate_pedestrians(gb->get_pos(), num_pax);
-	}
+	const uint32 pedestrians = (welt->get_settings().get_random_pedestrians()  &&  ispass) ? num_pax : 0;
 
 	// suitable start search
 	const koord origin_pos = gb->get_pos().get_2d();
 	const planquadrat_t *const plan = welt->access(origin_pos);
-	const halthandle_t *const halt_list = plan->get_haltlist();
 
 	// suitable start search
-	static vector_tpl<halthandle_t> start_halts(16);
-	start_halts.clear();
-	for (uint h = 0; h < plan->get_haltlist_count(); h++) {
-		halthandle_t halt = halt_list[h];
-		if(  halt.is_bound()  &&  halt->is_enabled(wtyp)  &&  !halt->is_overcrowded(wtyp->get_index())  ) {
-			start_halts.append(halt);
-		}
-	}
+	static vector_tpl<halthandle_t> thread_start_halts[MAX_THREADS];
+	vector_tpl<halthandle_t> &start_halts = thread_start_halts[thread_num];
+	get_start_halts( plan, wtyp, start_halts );
 
 	// track number of generated passengers.
 	city_history_year[0][history_type + HIST_OFFSET_GENERATED] += num_pax;
 	city_history_month[0][history_type + HIST_OFFSET_GENERATED] += num_pax;
 
+	pax_packet_t packet;
+	packet.origin = gb->get_pos();
+	packet.ispass = ispass;
+	packet.pedestrians = pedestrians;
+	packet.has_start_halt = !start_halts.empty();
+
 	// only continue, if this is a good start halt
 	if(  !start_halts.empty()  ) {
+		packet.first_halt = start_halts[0];
 		// Find passenger destination
 		for(  uint pax_routed=0, pax_left_to_do=0;  pax_routed < num_pax;  pax_routed += pax_left_to_do  ) {
 			// number of passengers that want to travel
@@ -1859,93 +1893,131 @@ void stadt_t::step_passagiere()
 			pax_left_to_do = min(PACKET_SIZE, num_pax - pax_routed);
 
 			// search target for the passenger
-			pax_return_type will_return;
-			factory_entry_t *factory_entry = NULL;
-			stadt_t *dest_city = NULL;
-			const koord dest_pos = find_destination(target_factories, city_history_month[0][history_type + HIST_OFFSET_GENERATED], &will_return, factory_entry, dest_city);
-			if(  factory_entry  ) {
+			packet.factory_entry = NULL;
+			packet.dest_city = NULL;
+			packet.dest_pos = find_destination(target_factories, city_history_month[0][history_type + HIST_OFFSET_GENERATED], &packet.will_return, packet.factory_entry, packet.dest_city, pax_rand);
+			if(  packet.factory_entry  ) {
 				if (welt->get_settings().get_factory_enforce_demand()) {
 					// ensure no more than remaining amount
-					pax_left_to_do = min( pax_left_to_do, factory_entry->remaining );
-					factory_entry->remaining -= pax_left_to_do;
+					pax_left_to_do = min( pax_left_to_do, packet.factory_entry->remaining );
+					packet.factory_entry->remaining -= pax_left_to_do;
 					target_factories.total_remaining -= pax_left_to_do;
 				}
 				target_factories.total_generated += pax_left_to_do;
-				factory_entry->factory->book_stat(pax_left_to_do, ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED);
 			}
 
-			ware_t pax(wtyp);
-			pax.set_zielpos(dest_pos);
-			pax.menge = pax_left_to_do;
-			pax.to_factory = ( factory_entry ? 1 : 0 );
+			packet.pax = ware_t(wtyp);
+			packet.pax.set_zielpos(packet.dest_pos);
+			packet.pax.menge = pax_left_to_do;
+			packet.pax.to_factory = ( packet.factory_entry ? 1 : 0 );
 
-			ware_t return_pax(wtyp);
+			packet.return_pax = ware_t(wtyp);
 
 			// now, finally search a route; this consumes most of the time
-			int const route_result = haltestelle_t::search_route( &start_halts[0], start_halts.get_count(), welt->get_settings().is_no_routing_over_overcrowding(), pax, &return_pax);
-			halthandle_t start_halt = return_pax.get_ziel();
-			if(  route_result==haltestelle_t::ROUTE_OK  ) {
-				// so we have happy traveling passengers
-				start_halt->starte_mit_route(pax);
-				start_halt->add_pax_happy(pax.menge);
-
-				// people were transported so are logged
-				city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
-				city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
+			packet.route_result = haltestelle_t::search_route( &start_halts[0], start_halts.get_count(), welt->get_settings().is_no_routing_over_overcrowding(), packet.pax, &packet.return_pax, thread_num );
+			packet.amount = pax_left_to_do;
+			packet.factory_amount = pax_left_to_do;
+			pax_packets.append( packet );
 
-				// destination logged
-				merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_YELLOW));
+			// only once per building
+			packet.pedestrians = 0;
+		}
+	}
+	else {
+		// all passengers without suitable start:
+		// fake one ride to get a proper display of destinations (although there may be more) ...
+		packet.factory_entry = NULL;
+		packet.dest_city = NULL;
+		packet.dest_pos = find_destination(target_factories, city_history_month[0][history_type + HIST_OFFSET_GENERATED], &packet.will_return, packet.factory_entry, packet.dest_city, pax_rand);
+		packet.factory_amount = 0;
+		if(  packet.factory_entry  ) {
+			// consider at most 1 packet's amount as factory-going
+			sint32 amount = min(PACKET_SIZE, num_pax);
+			if(  welt->get_settings().get_factory_enforce_demand()  ) {
+				// ensure no more than remaining amount
+				amount = min( amount, packet.factory_entry->remaining );
+				packet.factory_entry->remaining -= amount;
+				target_factories.total_remaining -= amount;
 			}
-			else if(  route_result==haltestelle_t::ROUTE_WALK  ) {
-				if(  factory_entry  ) {
-					// workers and mail delivered instantly to factory
-					factory_entry->factory->liefere_an(wtyp, pax_left_to_do);
-				}
+			target_factories.total_generated += amount;
+			packet.factory_amount = amount;
+		}
+		packet.pax = ware_t(wtyp);
+		packet.amount = num_pax;
+		packet.route_result = haltestelle_t::NO_ROUTE;
+		pax_packets.append( packet );
+	}
+}
 
-				// log walked at stop
-				start_halt->add_pax_walked(pax_left_to_do);
 
-				// people who walk or deliver by hand logged as walking
-				city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
-				city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
+void stadt_t::reroute_pax_packet(pax_packet_t &packet)
+{
+	const goods_desc_t *const wtyp = packet.ispass ? goods_manager_t::passengers : goods_manager_t::mail;
+
+	static vector_tpl<halthandle_t> start_halts;
+	get_start_halts( welt->access(packet.origin.get_2d()), wtyp, start_halts );
+	if(  start_halts.empty()  ) {
+		// all start halts are overcrowded by now
+		packet.has_start_halt = false;
+		packet.route_result = haltestelle_t::NO_ROUTE;
+		return;
+	}
 
-				// probably not a good idea to mark them as player only cares about remote traffic
-				//merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_YELLOW));
-			}
-			else if(  route_result==haltestelle_t::ROUTE_OVERCROWDED  ) {
-				// overcrowded routes cause unhappiness to be logged
+	packet.first_halt = start_halts[0];
+	packet.pax = ware_t(wtyp);
+	packet.pax.set_zielpos(packet.dest_pos);
+	packet.pax.menge = packet.amount;
+	packet.pax.to_factory = ( packet.factory_entry ? 1 : 0 );
+	packet.return_pax = ware_t(wtyp);
+	// a hit in the route cache, unless the routes must avoid overcrowded halts
+	packet.route_result = haltestelle_t::search_route( &start_halts[0], start_halts.get_count(), welt->get_settings().is_no_routing_over_overcrowding(), packet.pax, &packet.return_pax );
+}
 
-				if(  start_halt.is_bound()  ) {
-					start_halt->add_pax_unhappy(pax_left_to_do);
-				}
-				else {
-					// all routes to goal are overcrowded -> register at first stop (closest)
-					FOR(vector_tpl<halthandle_t>, const s, start_halts) {
-						s->add_pax_unhappy(pax_left_to_do);
-						merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_ORANGE));
-						break;
-					}
-				}
 
-				// destination logged
-				merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_ORANGE));
-			}
-			else if (  route_result == haltestelle_t::NO_ROUTE  ) {
-				// since there is no route from any start halt -> register no route at first halts (closest)
-				FOR(vector_tpl<halthandle_t>, const s, start_halts) {
-					s->add_pax_no_route(pax_left_to_do);
+void stadt_t::merge_passagiere()
+{
+	FOR(vector_tpl<pax_packet_t>, & packet, pax_packets) {
+		if(  packet.has_start_halt  &&  haltestelle_t::get_overcrowded_epoch() != pax_overcrowded_epoch  ) {
+			// an earlier booking (also of another city) made a halt overcrowded since this packet was routed
+			reroute_pax_packet( packet );
+		}
+
+		const bool ispass = packet.ispass;
+		const goods_desc_t *const wtyp = ispass ? goods_manager_t::passengers : goods_manager_t::mail;
+		const uint32 history_type = ispass ? HIST_BASE_PASS : HIST_BASE_MAIL;
+		const koord origin_pos = packet.origin.get_2d();
+		const koord dest_pos = packet.dest_pos;
+		const uint32 pax_left_to_do = packet.amount;
+		factory_entry_t *const factory_entry = packet.factory_entry;
+		stadt_t *const dest_city = packet.dest_city;
+		const int route_result = packet.route_result;
+		const pax_return_type will_return = packet.will_return;
+
+		if(  packet.pedestrians  ) {
+			haltestelle_t::generate_pedestrians(packet.origin, packet.pedestrians);
+		}
+
+		if(  factory_entry  ) {
+			factory_entry->factory->book_stat( packet.factory_amount, ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED );
+		}
+
+		if(  !packet.has_start_halt  ) {
+			// assume no free stop to start at all
+			bool is_there_any_stop = false;
+
+			// the unhappy passengers will be added to the first stop if any
+			const planquadrat_t *const plan = welt->access(origin_pos);
+			for(  uint h=0;  h<plan->get_haltlist_count(); h++  ) {
+				halthandle_t halt = plan->get_haltlist()[h];
+				if(  halt->is_enabled(wtyp)  ) {
+					halt->add_pax_unhappy(pax_left_to_do);
+					is_there_any_stop = true; // only overcrowded
 					break;
 				}
-				merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_DARK_ORANGE));
-#ifdef DESTINATION_CITYCARS
-				//citycars with destination
-				generate_private_cars( origin_pos, dest_pos );
-#endif
 			}
 
-			// return passenger traffic
+			// log reverse flow at destination city for accurate tally
 			if(  will_return != no_return  ) {
-				// compute return amount
 				uint32 pax_return = pax_left_to_do;
 
 				// apply return modifiers
@@ -1963,123 +2035,94 @@ void stadt_t::step_passagiere()
 					factory_entry->factory->book_stat(pax_return, (ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED));
 				}
 
-				// route type specific logic
-				if(  route_result == haltestelle_t::ROUTE_OK  ) {
-					// send return packet
-					halthandle_t return_halt = pax.get_ziel();
-					if(  !return_halt->is_overcrowded(wtyp->get_index())  ) {
-						// stop can receive passengers
-
-						// register departed pax/mail at factory
-						if (factory_entry) {
-							factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
+				// passengers with no route will be added to the first stops near destination (might be none)
+				const planquadrat_t *const dest_plan = welt->access(dest_pos);
+				const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
+				for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
+					halthandle_t halt = dest_halt_list[h];
+					if (  halt->is_enabled(wtyp)  ) {
+						if(  is_there_any_stop  ) {
+							// "just" overcrowded
+							halt->add_pax_unhappy(pax_return);
 						}
-
-						// setup ware packet
-						return_pax.menge = pax_return;
-						return_pax.set_zielpos(origin_pos);
-						return_halt->starte_mit_route(return_pax);
-
-						// log departed at stop
-						return_halt->add_pax_happy(pax_return);
-
-						// log departed at destination city
-						dest_city->city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
-						dest_city->city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
-					}
-					else {
-						// stop is crowded
-						return_halt->add_pax_unhappy(pax_return);
+						else {
+							// no stops at all
+							halt->add_pax_no_route(pax_return);
+						}
+						break;
 					}
-
 				}
-				else if(  route_result == haltestelle_t::ROUTE_WALK  ) {
-					// walking can produce return flow as a result of commuters to industry, monuments or stupidly big stops
+			}
 
-					// register departed pax/mail at factory
-					if (  factory_entry  ) {
-						factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
-					}
+#ifdef DESTINATION_CITYCARS
+			//citycars with destination
+			generate_private_cars( origin_pos, dest_pos );
+#endif
+			merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_ORANGE));
+			// we show unhappy instead no route for destination stop
+			continue;
+		}
 
-					// log walked at stop (source and destination stops are the same)
-					start_halt->add_pax_walked(pax_return);
+		ware_t pax = packet.pax;
+		ware_t return_pax = packet.return_pax;
+		halthandle_t start_halt = return_pax.get_ziel();
+		if(  route_result==haltestelle_t::ROUTE_OK  ) {
+			// so we have happy traveling passengers
+			start_halt->starte_mit_route(pax);
+			start_halt->add_pax_happy(pax.menge);
 
-					// log people who walk or deliver by hand
-					dest_city->city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_return;
-					dest_city->city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_return;
-				}
-				else if(  route_result == haltestelle_t::ROUTE_OVERCROWDED  ) {
-					// overcrowded routes cause unhappiness to be logged
+			// people were transported so are logged
+			city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
+			city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
 
-					if (pax.get_ziel().is_bound()) {
-						pax.get_ziel()->add_pax_unhappy(pax_return);
-					}
-					else {
-						// the unhappy passengers will be added to the first stops near destination (might be none)
-						const planquadrat_t *const dest_plan = welt->access(dest_pos);
-						const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
-						for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
-							halthandle_t halt = dest_halt_list[h];
-							if (halt->is_enabled(wtyp)) {
-								halt->add_pax_unhappy(pax_return);
-								break;
-							}
-						}
-					}
-				}
-				else if (route_result == haltestelle_t::NO_ROUTE) {
-					// passengers who cannot find a route will be added to the first stops near destination (might be none)
-					const planquadrat_t *const dest_plan = welt->access(dest_pos);
-					const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
-					for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
-						halthandle_t halt = dest_halt_list[h];
-						if (halt->is_enabled(wtyp)) {
-							halt->add_pax_no_route(pax_return);
-							break;
-						}
-					}
-				}
-			}
-			INT_CHECK( "simcity 1579" );
+			// destination logged
+			merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_YELLOW));
 		}
-	}
-	else {
-		// assume no free stop to start at all
-		bool is_there_any_stop = false;
-
-		// the unhappy passengers will be added to the first stop if any
-		for(  uint h=0;  h<plan->get_haltlist_count(); h++  ) {
-			halthandle_t halt = plan->get_haltlist()[h];
-			if(  halt->is_enabled(wtyp)  ) {
-				halt->add_pax_unhappy(num_pax);
-				is_there_any_stop = true; // only overcrowded
-				break;
+		else if(  route_result==haltestelle_t::ROUTE_WALK  ) {
+			if(  factory_entry  ) {
+				// workers and mail delivered instantly to factory
+				factory_entry->factory->liefere_an(wtyp, pax_left_to_do);
 			}
+
+			// log walked at stop
+			start_halt->add_pax_walked(pax_left_to_do);
+
+			// people who walk or deliver by hand logged as walking
+			city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
+			city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
+
+			// probably not a good idea to mark them as player only cares about remote traffic
+			//merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_YELLOW));
 		}
+		else if(  route_result==haltestelle_t::ROUTE_OVERCROWDED  ) {
+			// overcrowded routes cause unhappiness to be logged
 
-		// all passengers without suitable start:
-		// fake one ride to get a proper display of destinations (although there may be more) ...
-		pax_return_type will_return;
-		factory_entry_t *factory_entry = NULL;
-		stadt_t *dest_city = NULL;
-		const koord ziel = find_destination(target_factories, city_history_month[0][history_type + HIST_OFFSET_GENERATED], &will_return, factory_entry, dest_city);
-		if(  factory_entry  ) {
-			// consider at most 1 packet's amount as factory-going
-			sint32 amount = min(PACKET_SIZE, num_pax);
-			if(  welt->get_settings().get_factory_enforce_demand()  ) {
-				// ensure no more than remaining amount
-				amount = min( amount, factory_entry->remaining );
-				factory_entry->remaining -= amount;
-				target_factories.total_remaining -= amount;
+			if(  start_halt.is_bound()  ) {
+				start_halt->add_pax_unhappy(pax_left_to_do);
+			}
+			else {
+				// all routes to goal are overcrowded -> register at first stop (closest)
+				packet.first_halt->add_pax_unhappy(pax_left_to_do);
+				merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_ORANGE));
 			}
-			target_factories.total_generated += amount;
-			factory_entry->factory->book_stat( amount, ( ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED ) );
-		}
 
+			// destination logged
+			merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_ORANGE));
+		}
+		else if (  route_result == haltestelle_t::NO_ROUTE  ) {
+			// since there is no route from any start halt -> register no route at first halts (closest)
+			packet.first_halt->add_pax_no_route(pax_left_to_do);
+			merke_passagier_ziel(dest_pos, color_idx_to_rgb(COL_DARK_ORANGE));
+#ifdef DESTINATION_CITYCARS
+			//citycars with destination
+			generate_private_cars( origin_pos, dest_pos );
+#endif
+		}
 
-		// log reverse flow at destination city for accurate tally
+		// return passenger traffic
 		if(  will_return != no_return  ) {
-			uint32 pax_return = num_pax;
+			// compute return amount
+			uint32 pax_return = pax_left_to_do;
 
 			// apply return modifiers
 			if(  will_return != city_return  &&  wtyp == goods_manager_t::mail  ) {
@@ -2096,31 +2139,84 @@ void stadt_t::step_passagiere()
 				factory_entry->factory->book_stat(pax_return, (ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED));
 			}
 
-			// passengers with no route will be added to the first stops near destination (might be none)
-			const planquadrat_t *const dest_plan = welt->access(ziel);
-			const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
-			for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
-				halthandle_t halt = dest_halt_list[h];
-				if (  halt->is_enabled(wtyp)  ) {
-					if(  is_there_any_stop  ) {
-						// "just" overcrowded
-						halt->add_pax_unhappy(pax_return);
+			// route type specific logic
+			if(  route_result == haltestelle_t::ROUTE_OK  ) {
+				// send return packet
+				halthandle_t return_halt = pax.get_ziel();
+				if(  !return_halt->is_overcrowded(wtyp->get_index())  ) {
+					// stop can receive passengers
+
+					// register departed pax/mail at factory
+					if (factory_entry) {
+						factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
 					}
-					else {
-						// no stops at all
+
+					// setup ware packet
+					return_pax.menge = pax_return;
+					return_pax.set_zielpos(origin_pos);
+					return_halt->starte_mit_route(return_pax);
+
+					// log departed at stop
+					return_halt->add_pax_happy(pax_return);
+
+					// log departed at destination city
+					dest_city->city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
+					dest_city->city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
+				}
+				else {
+					// stop is crowded
+					return_halt->add_pax_unhappy(pax_return);
+				}
+
+			}
+			else if(  route_result == haltestelle_t::ROUTE_WALK  ) {
+				// walking can produce return flow as a result of commuters to industry, monuments or stupidly big stops
+
+				// register departed pax/mail at factory
+				if (  factory_entry  ) {
+					factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
+				}
+
+				// log walked at stop (source and destination stops are the same)
+				start_halt->add_pax_walked(pax_return);
+
+				// log people who walk or deliver by hand
+				dest_city->city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_return;
+				dest_city->city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_return;
+			}
+			else if(  route_result == haltestelle_t::ROUTE_OVERCROWDED  ) {
+				// overcrowded routes cause unhappiness to be logged
+
+				if (pax.get_ziel().is_bound()) {
+					pax.get_ziel()->add_pax_unhappy(pax_return);
+				}
+				else {
+					// the unhappy passengers will be added to the first stops near destination (might be none)
+					const planquadrat_t *const dest_plan = welt->access(dest_pos);
+					const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
+					for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
+						halthandle_t halt = dest_halt_list[h];
+						if (halt->is_enabled(wtyp)) {
+							halt->add_pax_unhappy(pax_return);
+							break;
+						}
+					}
+				}
+			}
+			else if (route_result == haltestelle_t::NO_ROUTE) {
+				// passengers who cannot find a route will be added to the first stops near destination (might be none)
+				const planquadrat_t *const dest_plan = welt->access(dest_pos);
+				const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
+				for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
+					halthandle_t halt = dest_halt_list[h];
+					if (halt->is_enabled(wtyp)) {
 						halt->add_pax_no_route(pax_return);
+						break;
 					}
-					break;
 				}
 			}
 		}
-
-#ifdef DESTINATION_CITYCARS
-		//citycars with destination
-		generate_private_cars( origin_pos, ziel );
-#endif
-		merke_passagier_ziel(ziel, color_idx_to_rgb(COL_ORANGE));
-		// we show unhappy instead no route for destination stop
+		INT_CHECK( "simcity 1579" );
 	}
 }
 
@@ -2143,6 +2239,21 @@ koord stadt_t::get_zufallspunkt() const
 }
 
 
+koord stadt_t::get_zufallspunkt(simrand_stream_t &rand) const
+{
+	if(!buildings.empty()) {
+		koord k = pick_any_weighted(buildings, rand)->get_pos().get_2d();
+		if(!welt->is_within_limits(k)) {
+			// other cities may draw from here at the same time, so the illegal building is removed by get_zufallspunkt() only
+			k = koord(0, 0);
+		}
+		return k;
+	}
+	// might happen on slow computers during creation of new cities or start of map
+	return koord(0,0);
+}
+
+
 void stadt_t::add_target_city(stadt_t *const city)
 {
 	target_cities.append(
@@ -2183,11 +2294,11 @@ void stadt_t::recalc_target_attractions()
 /* this function generates a random target for passenger/mail
  * changing this strongly affects selection of targets and thus game strategy
  */
-koord stadt_t::find_destination(factory_set_t &target_factories, const sint64 generated, pax_return_type* will_return, factory_entry_t* &factory_entry, stadt_t* &dest_city)
+koord stadt_t::find_destination(factory_set_t &target_factories, const sint64 generated, pax_return_type* will_return, factory_entry_t* &factory_entry, stadt_t* &dest_city, simrand_stream_t &rand)
 {
 	// generate factory traffic when required
 	if(  target_factories.total_remaining>0  &&  (sint64)target_factories.generation_ratio>((sint64)(target_factories.total_generated*100)<<RATIO_BITS)/(generated+1)  ) {
-		factory_entry_t *const entry = target_factories.get_random_entry();
+		factory_entry_t *const entry = target_factories.get_random_entry(rand);
 		assert( entry );
 		*will_return = factory_return; // worker will return
 		factory_entry = entry;
@@ -2196,10 +2307,10 @@ koord stadt_t::find_destination(factory_set_t &target_factories, const sint64 ge
 	}
 
 	// chance to generate tourist traffic
-	const sint16 rand = simrand(100 - (target_factories.generation_ratio >> RATIO_BITS));
-	if(  rand < welt->get_settings().get_tourist_percentage()  &&  target_attractions.get_sum_weight() > 0  ) {
+	const sint16 tourist_rand = rand.rand(100 - (target_factories.generation_ratio >> RATIO_BITS));
+	if(  tourist_rand < welt->get_settings().get_tourist_percentage()  &&  target_attractions.get_sum_weight() > 0  ) {
 		*will_return = tourist_return; // tourists will return
-		gebaeude_t *const &attraction = pick_any_weighted(target_attractions);
+		gebaeude_t *const &attraction = pick_any_weighted(target_attractions, rand);
 		dest_city = attraction->get_stadt(); // unsure if return value always valid
 		if (dest_city == NULL) {
 			// if destination city was invalid assume this city is the source
@@ -2211,12 +2322,12 @@ koord stadt_t::find_destination(factory_set_t &target_factories, const sint64 ge
 	// generate general traffic between buildings
 
 	// since the locality is already taken into account for us, we just use the random weight
-	stadt_t *const selected_city = pick_any_weighted( target_cities );
+	stadt_t *const selected_city = pick_any_weighted( target_cities, rand );
 	// no return trip if the destination is inside the same city
 	*will_return = selected_city == this ? no_return : city_return;
 	dest_city = selected_city;
 	// find a random spot inside the selected city
-	return selected_city->get_zufallspunkt();
+	return selected_city->get_zufallspunkt(rand);
 
 }
 
@@ -2745,7 +2856,7 @@ bool update_city_street(koord pos)
 					weg->set_gehweg(true);
 					weg->set_desc(cr);
 					gr->calc_image();
-					minimap_t::get_instance()->calc_map_pixel(pos+neighbors[i]);
+					minimap_t::get_instance()->invalidate_map_pixel(pos+neighbors[i]);
 					return true; // update only one road per renovation
 				}
 			}
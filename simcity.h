@@ -9,11 +9,14 @@
 
 #include "obj/simobj.h"
 #include "obj/gebaeude.h"
+#include "simware.h"
+#include "halthandle_t.h"
 
 #include "tpl/vector_tpl.h"
 #include "tpl/weighted_vector_tpl.h"
 #include "tpl/sparse_tpl.h"
 #include "utils/plainstring.h"
+#include "utils/simrandom.h"
 
 #include <string>
 
@@ -157,6 +160,24 @@ private:
 	 */
 	uint32 next_step;
 
+	/**
+	 * number of buildings generate_passagiere() has to handle in this step
+	 */
+	uint32 pax_steps;
+
+	/**
+	 * haltestelle_t::get_overcrowded_epoch() when the pax_packets were routed;
+	 * if it changed until merge_passagiere(), the packets are routed again
+	 */
+	uint32 pax_overcrowded_epoch;
+
+	/**
+	 * Passenger generation draws from its own random numbers,
+	 * so cities can generate passengers in parallel.
+	 * Seeded from simrand() in every step, thus not saved.
+	 */
+	simrand_stream_t pax_rand;
+
 	/**
 	 * in this fixed interval, construction will happen
 	 */
@@ -288,7 +309,7 @@ public:
 
 		const vector_tpl<factory_entry_t>& get_entries() const { return entries; }
 		const factory_entry_t* get_entry(const fabrik_t *const factory) const;
-		factory_entry_t* get_random_entry();
+		factory_entry_t* get_random_entry(simrand_stream_t &rand);
 		void update_factory(fabrik_t *const factory, const sint32 demand);
 		void remove_factory(fabrik_t *const factory);
 		void recalc_generation_ratio(const sint32 default_percent, const sint64 *city_stats, const int stats_count, const int stat_type);
@@ -330,10 +351,41 @@ private:
 		city_return
 	};
 
+	/**
+	 * A packet of passengers or mail generated by step_passagiere().
+	 * Everything outside of the city is only booked by merge_passagiere().
+	 */
+	struct pax_packet_t
+	{
+		ware_t pax;                     // routed packet
+		ware_t return_pax;              // route of the return trip
+		koord3d origin;                 // generating building
+		koord dest_pos;
+		factory_entry_t *factory_entry; // destination factory (if any)
+		stadt_t *dest_city;             // for return flow
+		halthandle_t first_halt;        // closest suitable start halt (if any)
+		uint32 amount;                  // passengers in this packet
+		sint32 factory_amount;          // passengers to book as generated at the factory
+		uint32 pedestrians;             // pedestrians to show at the origin
+		int route_result;               // of haltestelle_t::search_route()
+		pax_return_type will_return;
+		bool ispass;
+		bool has_start_halt;            // false: no start halt could take them at all
+	};
+
+	vector_tpl<pax_packet_t> pax_packets;
+
 	/**
 	 * verteilt die Passagiere auf die Haltestellen
+	 * Only the city itself is changed, everything else is collected in pax_packets.
+	 */
+	void step_passagiere(uint8 thread_num);
+
+	/**
+	 * Selects the start halts and searches the route of a packet again with the current halt state,
+	 * like a serial step_passagiere() would have done after the earlier bookings.
 	 */
-	void step_passagiere();
+	void reroute_pax_packet(pax_packet_t &packet);
 
 	/**
 	 * ein Passagierziel in die Zielkarte eintragen
@@ -457,6 +509,9 @@ public:
 	/// @returns a random point within city borders.
 	koord get_zufallspunkt() const;
 
+	/// @returns a random point within city borders, using the given random stream (thread safe)
+	koord get_zufallspunkt(simrand_stream_t &rand) const;
+
 	/// @returns passenger destination statistics for the last month
 	const sparse_tpl<PIXVAL>* get_pax_destinations_old() const { return &pax_destinations_old; }
 
@@ -511,8 +566,24 @@ public:
 	void set_citygrowth_yesno( bool ng ) { allow_citygrowth = ng; }
 	bool get_citygrowth() const { return allow_citygrowth; }
 
+	/**
+	 * Growth and bookkeeping; passengers are only generated afterwards
+	 * by generate_passagiere() and merge_passagiere().
+	 */
 	void step(uint32 delta_t);
 
+	/**
+	 * Generates the passengers and mail due since the last step.
+	 * Changes only this city, so several cities can do this in parallel (one per thread_num).
+	 */
+	void generate_passagiere(uint8 thread_num);
+
+	/**
+	 * Books the passengers and mail from generate_passagiere() at the stops, factories and cities.
+	 * Must be called for all cities in the same order on all clients.
+	 */
+	void merge_passagiere();
+
 	void new_month( bool recalc_destinations );
 
 private:
@@ -548,8 +619,9 @@ public:
 	 * @param will_return set to the jounrey return type on return.
 	 * @param factory_entry set to the destination factory, if any.
 	 * @param dest_city set to the destination city for return flow use.
+	 * @param rand the random stream of the generating city.
 	 */
-	koord find_destination(factory_set_t &target_factories, const sint64 generated, pax_return_type* will_return, factory_entry_t* &factory_entry, stadt_t* &dest_city);
+	koord find_destination(factory_set_t &target_factories, const sint64 generated, pax_return_type* will_return, factory_entry_t* &factory_entry, stadt_t* &dest_city, simrand_stream_t &rand);
 
 	/**
 	 * Gibt die Gruendungsposition der City zurueck.
@@ -63,6 +63,11 @@
 // Maximum number of threads
 #define MAX_THREADS (12)
 
+// map tiles are stored in square chunks of 1<<PLAN_CHUNK_SHIFT tiles per side (zero stores them row by row)
+#ifndef PLAN_CHUNK_SHIFT
+#define PLAN_CHUNK_SHIFT (4)
+#endif
+
 // Use own routines for downloading paks and installing (requires libzip and libcurl)
 //#define USE_OWN_PAKINSTALL
 
@@ -65,6 +65,20 @@
  */
 #define WTT_LOADING 2000
 
+/*
+ * Waiting time before a blocked convoi tests the way again (ms),
+ * after a month of waiting a random time up to WTT_WAITING_RANDOM
+ */
+#define WTT_WAITING 500
+#define WTT_WAITING_RANDOM 5000
+
+/*
+ * Waiting time for trains waiting for a reserved track (ms);
+ * they are woken when it is released, so this is only a fallback
+ * and much longer than any of the polling waits above
+ */
+#define WTT_WAITING_FOR_TRACK (4*WTT_WAITING_RANDOM)
+
 
 karte_ptr_t convoi_t::welt;
 
@@ -132,6 +146,8 @@ void convoi_t::init(player_t *player)
 	maxspeed_average_count = 0;
 	next_reservation_index = 0;
 	reserved_tiles.clear();
+	waiting_track = koord3d::invalid;
+	blocking_track = koord3d::invalid;
 
 	alte_richtung = ribi_t::none;
 	next_wolke = 0;
@@ -224,6 +240,7 @@ DBG_MESSAGE("convoi_t::~convoi_t()", "destroying %d, %p", self.get_id(), this);
 
 	welt->sync.remove( this );
 	welt->rem_convoi( self );
+	stop_waiting_for_track();
 
 	// if lineless convoy -> unregister from stops
 	if(  !line.is_bound()  ) {
@@ -236,7 +253,7 @@ DBG_MESSAGE("convoi_t::~convoi_t()", "destroying %d, %p", self.get_id(), this);
 			destroy_win((ptrdiff_t)schedule);
 		}
 		if (!schedule->empty() && !line.is_bound()) {
-			welt->set_schedule_counter();
+			welt->set_schedule_counter( schedule, get_owner() );
 		}
 		delete schedule;
 	}
@@ -609,6 +626,10 @@ void convoi_t::rotate90( const sint16 y_size )
 	if(  schedule_target!=koord3d::invalid  ) {
 		schedule_target.rotate90( y_size );
 	}
+	if(  waiting_track!=koord3d::invalid  ) {
+		waiting_track.rotate90( y_size );
+	}
+	blocking_track = koord3d::invalid;
 	if(schedule) {
 		schedule->rotate90( y_size );
 	}
@@ -1211,7 +1232,7 @@ bool convoi_t::drive_to()
 			}
 		}
 
-		if(  !fahr[0]->calc_route( start, ziel, speed_to_kmh(min_top_speed), &route )  ) {
+		if(  !fahr[0]->calc_route( start, ziel, speed_to_kmh(min_top_speed), &route, &prepared_route )  ) {
 			if(  state != NO_ROUTE  ) {
 				state = NO_ROUTE;
 				get_owner()->report_vehicle_problem( self, ziel );
@@ -1333,6 +1354,30 @@ void convoi_t::suche_neue_route()
 }
 
 
+bool convoi_t::wants_route_plan() const
+{
+	if(  wait_lock > 0  ||  line_update_pending.is_bound()  ||  anz_vehikel == 0  ||  schedule == NULL  ||  schedule->empty()  ) {
+		return false;
+	}
+	if(  state != ROUTING_1  &&  state != NO_ROUTE  ) {
+		return false;
+	}
+	// aircraft have their own route search; and coupling convoys may start from the tail of another convoy
+	if(  fahr[0]->get_waytype() == air_wt  ||  coupling_convoi.is_bound()  ) {
+		return false;
+	}
+	// already there => no route search at all
+	return fahr[0]->get_pos() != schedule->get_current_entry().pos;
+}
+
+
+void convoi_t::plan_step(uint8 thread_num)
+{
+	// same parameters as the first search in drive_to()
+	fahr[0]->plan_route( fahr[0]->get_pos(), schedule->get_current_entry().pos, speed_to_kmh(min_top_speed), prepared_route, thread_num );
+}
+
+
 /**
  * Asynchrne step methode des Convois
  */
@@ -1464,6 +1509,7 @@ void convoi_t::step()
 				vehicle_t* v = fahr[0];
 
 				sint32 restart_speed = -1;
+				stop_waiting_for_track();
 				if(  v->can_enter_tile( restart_speed, 0 )  ) {
 					// can reserve new block => drive on
 					state = (steps_driven>=0) ? LEAVING_DEPOT : DRIVING;
@@ -1496,6 +1542,7 @@ void convoi_t::step()
 		case WAITING_FOR_CLEARANCE:
 			{
 				sint32 restart_speed = -1;
+				stop_waiting_for_track();
 				if(  fahr[0]->can_enter_tile( restart_speed, 0 )  ) {
 					state = (steps_driven>=0) ? LEAVING_DEPOT : DRIVING;
 				}
@@ -1579,8 +1626,14 @@ void convoi_t::step()
 			if (wait_lock > 2500) {
 				break;
 			}
+			if(  waiting_track!=koord3d::invalid  ) {
+				// will be woken by the track
+				wait_lock = WTT_WAITING_FOR_TRACK;
+				break;
+			}
+			// FALLTHROUGH
 		case WAITING_FOR_LEAVING_DEPOT:
-			wait_lock = max( wait_lock, 500 );
+			wait_lock = max( wait_lock, WTT_WAITING );
 			break;
 
 		// waiting for free way, not too heavy, not to slow
@@ -1589,7 +1642,7 @@ void convoi_t::step()
 		case CAN_START_TWO_MONTHS:
 		case WAITING_FOR_CLEARANCE_TWO_MONTHS:
 			// to avoid having a convoi stuck at a heavy traffic intersection/signal, the waiting time is randomized
-			wait_lock = simrand(5000)+1;
+			wait_lock = waiting_track!=koord3d::invalid ? WTT_WAITING_FOR_TRACK : simrand(WTT_WAITING_RANDOM)+1;
 			break;
 		default: ;
 	}
@@ -1779,7 +1832,7 @@ void convoi_t::start()
 			line->recalc_catg_index();
 		}
 		else {
-			welt->set_schedule_counter();
+			welt->set_schedule_counter( schedule, get_owner() );
 		}
 		wait_lock = 0;
 
@@ -2124,7 +2177,7 @@ bool convoi_t::set_schedule(schedule_t * f)
 			// if line is unset or schedule is changed
 			// -> register stops from new schedule
 			register_stops();
-			welt->set_schedule_counter(); // must trigger refresh
+			welt->set_schedule_counter( schedule, get_owner() ); // must trigger refresh
 		}
 	}
 
@@ -2518,8 +2571,8 @@ void convoi_t::vorfahren()
 void convoi_t::rdwr_convoihandle_t(loadsave_t *file, convoihandle_t &cnv)
 {
 	if(  file->is_version_atleast(112, 3)  ) {
-		uint16 id = (file->is_saving()  &&  cnv.is_bound()) ? cnv.get_id() : 0;
-		file->rdwr_short( id );
+		uint32 id = (file->is_saving()  &&  cnv.is_bound()) ? cnv.get_id() : 0;
+		file->rdwr_handle_id( id );
 		if (file->is_loading()) {
 			cnv.set_id( id );
 		}
@@ -2554,14 +2607,14 @@ void convoi_t::rdwr(loadsave_t *file)
 			self = convoihandle_t( this );
 		}
 		else {
-			uint16 id;
-			file->rdwr_short( id );
+			uint32 id = 0;
+			file->rdwr_handle_id( id );
 			self = convoihandle_t( this, id );
 		}
 	}
 	else if(  file->is_version_atleast(112, 3)  ) {
-		uint16 id = self.get_id();
-		file->rdwr_short( id );
+		uint32 id = self.get_id();
+		file->rdwr_handle_id( id );
 	}
 
 	dummy = anz_vehikel;
@@ -3111,7 +3164,7 @@ void convoi_t::get_freight_info(cbuffer_t & buf)
 			}
 
 			// then add the actual load
-			FOR(slist_tpl<ware_t>, ware, v->get_cargo()) {
+			FOR(vehicle_cargo_t, ware, v->get_cargo()) {
 				FOR(vector_tpl<ware_t>, & tmp, total_fracht) {
 					// could this be joined with existing freight?
 
@@ -3161,7 +3214,7 @@ void convoi_t::get_freight_info(cbuffer_t & buf)
 
 void convoi_t::open_schedule_window( bool show )
 {
-	DBG_MESSAGE("convoi_t::open_schedule_window()","Id = %hu, State = %d, Lock = %d", self.get_id(), (int)state, wait_lock);
+	DBG_MESSAGE("convoi_t::open_schedule_window()","Id = %u, State = %d, Lock = %d", self.get_id(), (int)state, wait_lock);
 
 	// manipulation of schedule not allowed while:
 	// - just starting
@@ -3924,7 +3977,7 @@ void convoi_t::set_line(linehandle_t org_line)
 		unregister_stops();
 		// must trigger refresh if old schedule was not empty
 		if (schedule  &&  !schedule->empty()) {
-			welt->set_schedule_counter();
+			welt->set_schedule_counter( schedule, get_owner() );
 		}
 	}
 	line_update_pending = org_line;
@@ -4311,20 +4364,12 @@ bool convoi_t::can_overtake(overtaker_t *other_overtaker, sint32 other_speed, si
 			}
 			if(  overtaking_mode>oneway_mode  ) {
 				// Check for other vehicles on the next tile
-				const uint8 top = gr->get_top();
 				//These conditions is abandoned on one-way road to overtake in traffic jam.
-				for(  uint8 j=1;  j<top;  j++  ) {
-					if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j))  ) {
-						// check for other traffic on the road
-						const overtaker_t *ov = v->get_overtaker();
-						if(ov) {
-							if(this!=ov  &&  other_overtaker!=ov) {
-								return false;
-							}
-						}
-						else if(  v->get_waytype()==road_wt  &&  v->get_typ()!=obj_t::pedestrian  ) {
-							return false;
-						}
+				FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+					// check for other traffic on the road
+					const overtaker_t *ov = v->get_overtaker();
+					if(  ov==NULL  ||  (this!=ov  &&  other_overtaker!=ov)  ) {
+						return false;
 					}
 				}
 			}
@@ -4443,31 +4488,27 @@ bool convoi_t::can_overtake(overtaker_t *other_overtaker, sint32 other_speed, si
 		time_overtaking += d;
 
 		// Check for other vehicles
-		const uint8 top = gr->get_top();
-		for(  uint8 j=1;  j<top;  j++ ) {
-			if (vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j))) {
-				// check for other traffic on the road
-				const overtaker_t *ov = v->get_overtaker();
-				if(ov) {
-					if(this!=ov  &&  other_overtaker!=ov) {
-						if(  overtaking_mode_loop <= oneway_mode  ) {
-							//If ov goes same directory, should not return false
-							ribi_t::ribi their_direction = ribi_t::backward( fahr[0]->calc_direction(pos_prev, pos_next) );
-							vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j));
-							if (v && v->get_direction() == their_direction && v->get_overtaker()) {
-								return false;
-							}
-						}
-						else {
+		FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+			// check for other traffic on the road
+			const overtaker_t *ov = v->get_overtaker();
+			if(ov) {
+				if(this!=ov  &&  other_overtaker!=ov) {
+					if(  overtaking_mode_loop <= oneway_mode  ) {
+						//If ov goes same directory, should not return false
+						ribi_t::ribi their_direction = ribi_t::backward( fahr[0]->calc_direction(pos_prev, pos_next) );
+						if (v->get_direction() == their_direction) {
 							return false;
 						}
 					}
-				}
-				else if(  v->get_waytype()==road_wt  &&  v->get_typ()!=obj_t::pedestrian  ) {
-					// sheeps etc.
-					return false;
+					else {
+						return false;
+					}
 				}
 			}
+			else {
+				// sheeps etc.
+				return false;
+			}
 		}
 		n_tiles++;
 		pos_prev = pos;
@@ -4514,10 +4555,8 @@ bool convoi_t::can_overtake(overtaker_t *other_overtaker, sint32 other_speed, si
 
 		// Check for other vehicles in facing direction
 		ribi_t::ribi their_direction = ribi_t::backward( fahr[0]->calc_direction(pos_prev, pos_next) );
-		const uint8 top = gr->get_top();
-		for(  uint8 j=1;  j<top;  j++ ) {
-			vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j));
-			if(  v  &&  v->get_direction() == their_direction  &&  v->get_overtaker()  ) {
+		FOR(vector_tpl<vehicle_base_t *>, const v, ((const strasse_t *)str)->get_occupants()) {
+			if(  v->get_direction() == their_direction  &&  v->get_overtaker()  ) {
 				// tolerated distance us>them: total_distance*akt_speed > current_distance*other_speed
 				if(  road_vehicle_t const* const car = obj_cast<road_vehicle_t>(v)  ) {
 					convoi_t* const ocnv = car->get_convoi();
@@ -4757,6 +4796,47 @@ void convoi_t::clear_reserved_tiles(){
 	reserved_tiles.clear();
 }
 
+
+void convoi_t::wait_for_blocking_track()
+{
+	stop_waiting_for_track();
+	grund_t *gr = blocking_track!=koord3d::invalid ? welt->lookup(blocking_track) : NULL;
+	schiene_t *sch = gr ? obj_cast<schiene_t>(gr->get_weg(front()->get_waytype())) : NULL;
+	if(  sch  &&  !sch->can_reserve(self)  ) {
+		sch->add_waiting(self);
+		waiting_track = blocking_track;
+	}
+}
+
+
+void convoi_t::stop_waiting_for_track()
+{
+	if(  waiting_track==koord3d::invalid  ) {
+		return;
+	}
+	// the convoi may be empty already, so try all tracks there
+	if(  grund_t *gr = welt->lookup(waiting_track)  ) {
+		for(  uint8 i=0;  i<2;  i++  ) {
+			if(  schiene_t *sch = obj_cast<schiene_t>(gr->get_weg_nr(i))  ) {
+				sch->remove_waiting(self);
+			}
+		}
+	}
+	waiting_track = koord3d::invalid;
+	next_waiting = convoihandle_t();
+}
+
+
+void convoi_t::wake_up()
+{
+	waiting_track = koord3d::invalid;
+	next_waiting = convoihandle_t();
+	if(  is_waiting()  ) {
+		// test the way again during the next step
+		wait_lock = 0;
+	}
+}
+
 // this function should be called from rail vehicles
 void convoi_t::calc_crossing_reservation() {
 	crossing_reservation_index.clear();
@@ -177,6 +177,12 @@ private:
 	 */
 	route_t route;
 
+	/**
+	 * Route searched ahead of time during the parallel plan phase of karte_t::step(),
+	 * taken over by the next drive_to() if still valid.
+	 */
+	route_t::prepared_t prepared_route;
+
 	/**
 	 * assigned line
 	 */
@@ -275,6 +281,17 @@ private:
 	 * @author THLeaderH
 	 */
 	vector_tpl<koord3d> reserved_tiles;
+
+	/**
+	 * A train waiting for a reserved track registers there (see schiene_t::add_waiting()) and
+	 * is woken, when the track is released.
+	 * waiting_track is the position of this track (or koord3d::invalid), next_waiting is the
+	 * next train waiting for the same track. blocking_track is the track, at which the last
+	 * reservation failed. Not saved: after loading, waiting trains poll until they register again.
+	 */
+	koord3d waiting_track;
+	koord3d blocking_track;
+	convoihandle_t next_waiting;
 	
 	/*
 	 * these give the index and steps of the coupling point.
@@ -650,6 +667,23 @@ public:
 	 */
 	void step();
 
+	/**
+	 * @returns true, if the next step() will search a new route, which then can be prepared by plan_step()
+	 */
+	bool wants_route_plan() const;
+
+	/**
+	 * Read-only part of step(): searches the route the next step() will need.
+	 * Changes nothing outside this convoi, so it can run for several convois in parallel.
+	 * @param thread_num selects the route search memory of this thread
+	 */
+	void plan_step(uint8 thread_num);
+
+	/**
+	 * Drops a prepared route not used by step().
+	 */
+	void clear_step_plan() { prepared_route.valid = false; }
+
 	/**
 	* sets a new convoi in route
 	*/
@@ -868,6 +902,27 @@ public:
 	bool is_reservation_empty() const { return reserved_tiles.empty(); }
 	vector_tpl<koord3d>& get_reserved_tiles() { return reserved_tiles; }
 	void clear_reserved_tiles();
+
+	/// called by rail_vehicle_t::block_reserver(), if the track at @p pos is reserved by another convoi
+	void set_blocking_track(koord3d pos) { blocking_track = pos; }
+
+	/**
+	 * Registers at the track, where the last reservation failed. The train is then woken, as soon
+	 * as this track is released, and needs to test the way only rarely until then.
+	 */
+	void wait_for_blocking_track();
+
+	/// cancels the registration of wait_for_blocking_track()
+	void stop_waiting_for_track();
+
+	/// called by the track this train is waiting for, when it is released
+	void wake_up();
+
+	bool is_waiting_for_track() const { return waiting_track != koord3d::invalid; }
+	koord3d get_waiting_track() const { return waiting_track; }
+	convoihandle_t get_next_waiting() const { return next_waiting; }
+	void set_next_waiting(convoihandle_t c) { next_waiting = c; }
+
 	/**
 	 * the index and steps of the coupling point.
 	 * Convois do the coupling process when reaching this index.
@@ -69,20 +69,50 @@ inthashtable_tpl<sint32,halthandle_t> *haltestelle_t::all_koords = NULL;
 
 uint8 haltestelle_t::status_step = 0;
 uint8 haltestelle_t::reconnect_counter = 0;
+uint8 haltestelle_t::partial_reconnect_counter = 0;
+vector_tpl<halthandle_t> haltestelle_t::reconnect_halts;
+vector_tpl<haltestelle_t::departure_expiry_t> haltestelle_t::departure_expiry;
 
 
 static vector_tpl<convoihandle_t>stale_convois;
 static vector_tpl<linehandle_t>stale_lines;
 
+// the halts of the current reconnecting or rerouting pass of step_all()
+static vector_tpl<halthandle_t> step_halts;
+static uint32 step_index = 0;
+// only the halts of changed schedules are reconnected in this pass
+static bool partial_reconnect = false;
+
 
 void haltestelle_t::reset_routing()
 {
 	reconnect_counter = welt->get_schedule_counter()-1;
+	partial_reconnect_counter = reconnect_counter;
+	invalidate_route_cache();
+}
+
+
+void haltestelle_t::reconnect_stops( const schedule_t *schedule, const player_t *owner, uint8 schedule_counter )
+{
+	if(  (uint8)(partial_reconnect_counter+1) == schedule_counter  ) {
+		// no other change since: can stay partial
+		partial_reconnect_counter = schedule_counter;
+	}
+	if(  schedule  ) {
+		FOR(minivec_tpl<schedule_entry_t>, const& i, schedule->entries) {
+			halthandle_t const halt = get_halt( i.pos, owner );
+			if(  halt.is_bound()  ) {
+				halt->request_reconnect();
+			}
+		}
+	}
 }
 
 
 void haltestelle_t::step_all()
 {
+	sweep_departures();
+
 	// tell all stale convois to reroute their goods
 	if(  !stale_convois.empty()  ) {
 		convoihandle_t cnv = stale_convois.pop_back();
@@ -98,39 +128,107 @@ void haltestelle_t::step_all()
 		}
 	}
 
-	static vector_tpl<halthandle_t>::iterator iter( alle_haltestellen.begin() );
 	if (alle_haltestellen.empty()) {
 		return;
 	}
 	const uint8 schedule_counter = welt->get_schedule_counter();
 	if (reconnect_counter != schedule_counter) {
 		// always start with reconnection, re-routing will happen after complete reconnection
+		// only the halts of changed schedules, if nothing else changed and no other pass is unfinished
+		partial_reconnect = status_step == 0  &&  partial_reconnect_counter == schedule_counter;
 		status_step = RECONNECTING;
 		reconnect_counter = schedule_counter;
-		iter = alle_haltestellen.begin();
+		partial_reconnect_counter = schedule_counter;
+		step_halts.clear();
+		if(  partial_reconnect  ) {
+			FOR(vector_tpl<halthandle_t>, const halt, reconnect_halts) {
+				if(  halt.is_bound()  ) {
+					step_halts.append( halt );
+				}
+			}
+		}
+		else {
+			FOR(vector_tpl<halthandle_t>, const halt, reconnect_halts) {
+				if(  halt.is_bound()  ) {
+					halt->reconnect_requested = false;
+				}
+			}
+			FOR(vector_tpl<halthandle_t>, const halt, alle_haltestellen) {
+				step_halts.append( halt );
+			}
+		}
+		reconnect_halts.clear();
+		step_index = 0;
 	}
 
 	sint16 units_remaining = 128;
-	for (; iter != alle_haltestellen.end(); ++iter) {
+	for (; step_index < step_halts.get_count(); ++step_index) {
 		if (units_remaining <= 0) return;
 
 		// iterate until the specified number of units were handled
-		if(  !(*iter)->step(status_step, units_remaining)  ) {
+		halthandle_t const halt = step_halts[step_index];
+		if(  halt.is_bound()  &&  !halt->step(status_step, units_remaining)  ) {
 			// too much rerouted => needs to continue at next round!
 			return;
 		}
 	}
 
 	if (status_step == RECONNECTING) {
-		// reconnecting finished, compute connected components in one sweep
-		rebuild_connected_components();
+		if(  partial_reconnect  ) {
+			// relabel the components, and reroute only where something changed
+			update_connected_components( step_halts );
+		}
+		else {
+			// reconnecting finished, compute connected components in one sweep
+			rebuild_connected_components();
+		}
 		// reroute in next call
 		status_step = REROUTING;
 	}
 	else if (status_step == REROUTING) {
 		status_step = 0;
+		step_halts.clear();
+	}
+	step_index = 0;
+}
+
+
+void haltestelle_t::start_reconnect_all()
+{
+	// like the first call of step_all() after reset_routing(), but for all halts at once
+	reconnect_counter = welt->get_schedule_counter();
+	partial_reconnect_counter = reconnect_counter;
+	partial_reconnect = false;
+	status_step = RECONNECTING;
+	FOR(vector_tpl<halthandle_t>, const halt, reconnect_halts) {
+		if(  halt.is_bound()  ) {
+			halt->reconnect_requested = false;
+		}
+	}
+	reconnect_halts.clear();
+	step_halts.clear();
+	FOR(vector_tpl<halthandle_t>, const halt, alle_haltestellen) {
+		// here, since reconnect_loop() must not write the shared comp_version
+		halt->outdate_cached_routes();
+		step_halts.append( halt );
+	}
+	step_index = 0;
+}
+
+
+void haltestelle_t::reconnect_loop( uint32 first, uint32 last, uint8 thread_num )
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		step_halts[i]->rebuild_connections( thread_num, true );
 	}
-	iter = alle_haltestellen.begin();
+}
+
+
+void haltestelle_t::end_reconnect_all()
+{
+	rebuild_connected_components();
+	// reroute in the next calls of step_all()
+	status_step = step_halts.empty() ? 0 : REROUTING;
 }
 
 
@@ -142,6 +240,10 @@ void haltestelle_t::start_load_game()
 
 void haltestelle_t::end_load_game()
 {
+	// the lines of the convois are known now
+	FOR(vector_tpl<halthandle_t>, const i, alle_haltestellen) {
+		i->finish_departures_rd();
+	}
 	delete all_koords;
 	all_koords = NULL;
 }
@@ -356,7 +458,7 @@ DBG_DEBUG("haltestelle_t::remove()","destroy");
 	// if building was removed this is false!
 	if(bd) {
 		bd->calc_image();
-		minimap_t::get_instance()->calc_map_pixel(pos.get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(pos.get_2d());
 	}
 	return true;
 }
@@ -396,6 +498,7 @@ void haltestelle_t::destroy_all()
 	delete all_koords;
 	all_koords = NULL;
 	status_step = 0;
+	departure_expiry.clear();
 }
 
 
@@ -403,7 +506,7 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 {
 	last_loading_step = welt->get_steps();
 
-	cargo = (slist_tpl<ware_t> **)calloc( goods_manager_t::get_max_catg_index(), sizeof(slist_tpl<ware_t> *) );
+	cargo = (halt_cargo_t **)calloc( goods_manager_t::get_max_catg_index(), sizeof(halt_cargo_t *) );
 	all_links = new link_t[ goods_manager_t::get_max_catg_index() ];
 
 	status_color = SYSCOL_TEXT_UNUSED;
@@ -411,6 +514,8 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 	last_bar_count = 0;
 
 	reconnect_counter = welt->get_schedule_counter()-1;
+	partial_reconnect_counter = reconnect_counter;
+	reconnect_requested = false;
 
 	enables = NOT_ENABLED;
 
@@ -419,7 +524,9 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 
 	rdwr(file);
 
-	markers[ self.get_id() ] = current_marker;
+	mark_in_search_contexts( self );
+	// cached routes may refer to an old halt with this id
+	invalidate_route_cache();
 
 	alle_haltestellen.append(self);
 }
@@ -431,7 +538,9 @@ haltestelle_t::haltestelle_t(koord k, player_t* player)
 	assert( !alle_haltestellen.is_contained(self) );
 	alle_haltestellen.append(self);
 
-	markers[ self.get_id() ] = current_marker;
+	mark_in_search_contexts( self );
+	// cached routes may refer to an old halt with this id
+	invalidate_route_cache();
 
 	last_loading_step = welt->get_steps();
 
@@ -441,9 +550,11 @@ haltestelle_t::haltestelle_t(koord k, player_t* player)
 	enables = NOT_ENABLED;
 	// force total re-routing
 	reconnect_counter = welt->get_schedule_counter()-1;
+	partial_reconnect_counter = reconnect_counter;
+	reconnect_requested = false;
 	last_catg_index = 255;
 
-	cargo = (slist_tpl<ware_t> **)calloc( goods_manager_t::get_max_catg_index(), sizeof(slist_tpl<ware_t> *) );
+	cargo = (halt_cargo_t **)calloc( goods_manager_t::get_max_catg_index(), sizeof(halt_cargo_t *) );
 	all_links = new link_t[ goods_manager_t::get_max_catg_index() ];
 
 	status_color = SYSCOL_TEXT_UNUSED;
@@ -460,6 +571,7 @@ haltestelle_t::~haltestelle_t()
 	assert(self.is_bound());
 
 	// first: remove halt from all lists
+	welt->rollover_halt_removed(self);
 	int i=0;
 	while(alle_haltestellen.is_contained(self)) {
 		alle_haltestellen.remove(self);
@@ -468,6 +580,7 @@ haltestelle_t::~haltestelle_t()
 	if (i != 1) {
 		dbg->error("haltestelle_t::~haltestelle_t()", "handle %i found %i times in haltlist!", self.get_id(), i );
 	}
+	invalidate_route_cache();
 
 	// free name
 	set_name(NULL);
@@ -507,8 +620,8 @@ haltestelle_t::~haltestelle_t()
 
 	for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
 		if (cargo[i]) {
-			FOR(slist_tpl<ware_t>, const &w, *cargo[i]) {
-				fabrik_t::update_transit(&w, false);
+			for(  halt_cargo_t::slot_t s = cargo[i]->first();  s != halt_cargo_t::END;  s = cargo[i]->next(s)  ) {
+				fabrik_t::update_transit(&(*cargo[i])[s], false);
 			}
 			delete cargo[i];
 			cargo[i] = NULL;
@@ -530,15 +643,14 @@ void haltestelle_t::rotate90( const sint16 y_size )
 	// iterate over all different categories
 	for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
 		if(cargo[i]) {
-			slist_tpl<ware_t>& warray = *cargo[i];
-			for (  slist_tpl<ware_t>::iterator ware = warray.begin();  ware!=warray.end();  ) {
-				if(  ware->menge>0  ) {
-					ware->rotate90(y_size);
-					ware ++;
-				} else {
-					// empty => remove
-					ware = warray.erase(ware);
+			vector_tpl<ware_t> wares;
+			cargo[i]->extract( wares );
+			FOR(vector_tpl<ware_t>, & ware, wares) {
+				if(  ware.menge>0  ) {
+					ware.rotate90(y_size);
+					cargo[i]->append( ware );
 				}
+				// else empty => remove
 			}
 		}
 	}
@@ -620,7 +732,7 @@ char* haltestelle_t::create_name(koord const k, char const* const typ)
 
 	// this fails only, if there are no towns at all!
 	if(stadt==NULL) {
-		for(  uint32 i=1;  i<65536;  i++  ) {
+		for(  uint32 i=1;  i<=halthandle_t::get_size();  i++  ) {
 			// get a default name
 			buf.printf( translator::translate("land stop %i %s",lang), i, stop );
 			if(  !all_names.get(buf).is_bound()  ) {
@@ -890,7 +1002,7 @@ char* haltestelle_t::create_name(koord const k, char const* const typ)
 	const char *base_name = translator::translate( inside ? "%s city %d %s" : "%s land %d %s", lang);
 
 	// finally: is there a stop with this name already?
-	for(  uint32 i=1;  i<65536;  i++  ) {
+	for(  uint32 i=1;  i<=halthandle_t::get_size();  i++  ) {
 		buf.printf( base_name, city_name, i, stop );
 		if(  !all_names.get(buf).is_bound()  ) {
 			return strdup(buf);
@@ -1035,26 +1147,32 @@ bool haltestelle_t::reroute_goods(sint16 &units_remaining)
 		}
 
 		// first: clean out the array
-		slist_tpl<ware_t> * warray = cargo[last_catg_index];
-		for (  slist_tpl<ware_t>::iterator ware = warray->begin(); ware!=warray->end();  ) {
-			if(  ware->menge==0  ) {
-				ware = warray->erase(ware);
+		// (the remaining packets are moved to the front in a single pass)
+		halt_cargo_t * warray = cargo[last_catg_index];
+		vector_tpl<ware_t> wares;
+		warray->extract( wares );
+		uint32 waiting = 0;
+		for(  uint32 i = 0;  i < wares.get_count();  i++  ) {
+			ware_t &ware = wares[i];
+			if(  ware.menge==0  ) {
 				continue;
 			}
 			// since also the factory halt list is added to the ground, we can use just this ...
-			else if(  welt->access(ware->get_zielpos())->is_connected(self)  ) {
+			if(  welt->access(ware.get_zielpos())->is_connected(self)  ) {
 				// we are already there!
-				if(  ware->to_factory  ) {
-					liefere_an_fabrik(*ware);
+				if(  ware.to_factory  ) {
+					liefere_an_fabrik(ware);
 				}
-				ware = warray->erase(ware);
 				continue;
 			}
-			ware ++;
+			if(  waiting != i  ) {
+				wares[waiting] = ware;
+			}
+			waiting++;
 		}
 
 		// delete, if nothing connects here
-		if(  warray->empty()  &&  all_links[last_catg_index].connections.empty()  ) {
+		if(  waiting==0  &&  all_links[last_catg_index].connections.empty()  ) {
 			// no connections from here => delete
 			delete cargo[last_catg_index];
 			cargo[last_catg_index] = NULL;
@@ -1064,16 +1182,15 @@ bool haltestelle_t::reroute_goods(sint16 &units_remaining)
 		// if something left
 		// re-route goods to adapt to changes in world layout,
 		// remove all goods whose destination was removed from the map
-		for(  slist_tpl<ware_t>::iterator ware = warray->begin();  ware!=warray->end();  ) {
-			search_route_resumable(*ware);
-			if(  ware->get_ziel()==halthandle_t()  ) {
+		for(  uint32 i = 0;  i < waiting;  i++  ) {
+			ware_t &ware = wares[i];
+			search_route_resumable(ware);
+			if(  ware.get_ziel()==halthandle_t()  ) {
 				// remove invalid destinations
-				const ware_t w = *ware;
-				fabrik_t::update_transit( &w, false);
-				ware = warray->erase(ware);
+				fabrik_t::update_transit( &ware, false);
 			}
 			else {
-				ware++;
+				warray->append( ware );
 			}
 		}
 
@@ -1135,6 +1252,16 @@ void haltestelle_t::remove_fabriken(fabrik_t *fab)
 }
 
 
+void haltestelle_t::outdate_cached_routes()
+{
+	for(  uint8 i=0;  i<goods_manager_t::get_max_catg_index();  i++  ){
+		if(  all_links[i].catg_connected_component != UNDECIDED_CONNECTED_COMPONENT  ) {
+			comp_version[ all_links[i].catg_connected_component ]++;
+		}
+	}
+}
+
+
 /**
  * Rebuilds the list of connections to directly reachable halts
  * Returns the number of stops considered
@@ -1143,19 +1270,26 @@ void haltestelle_t::remove_fabriken(fabrik_t *fab)
 #define WEIGHT_HALT welt->get_settings().get_routecost_halt()
 // the minimum weight of a connection from a transfer halt
 #define WEIGHT_MIN (WEIGHT_WAIT+WEIGHT_HALT)
-sint32 haltestelle_t::rebuild_connections()
+sint32 haltestelle_t::rebuild_connections(uint8 thread_num, bool on_worker)
 {
 	// halts which either immediately precede or succeed self halt in serving schedules
-	static vector_tpl<halthandle_t> consecutive_halts[256];
+	static vector_tpl<halthandle_t> consecutive_halts_per_thread[MAX_THREADS][256];
+	vector_tpl<halthandle_t> *consecutive_halts = consecutive_halts_per_thread[thread_num];
 	// halts which either immediately precede or succeed self halt in currently processed schedule
-	static vector_tpl<halthandle_t> consecutive_halts_schedule[256];
+	static vector_tpl<halthandle_t> consecutive_halts_schedule_per_thread[MAX_THREADS][256];
+	vector_tpl<halthandle_t> *consecutive_halts_schedule = consecutive_halts_schedule_per_thread[thread_num];
 	// remember max number of consecutive halts for one schedule
 	uint8 max_consecutive_halts_schedule[256];
 	MEMZERON(max_consecutive_halts_schedule, goods_manager_t::get_max_catg_index());
 	// previous halt supporting the ware categories of the serving line
-	static halthandle_t previous_halt[256];
+	static halthandle_t previous_halt_per_thread[MAX_THREADS][256];
+	halthandle_t *previous_halt = previous_halt_per_thread[thread_num];
 
 	// first, remove all old entries
+	if(  !on_worker  ) {
+		// routes cached through these components are outdated (comp_version is shared by all threads)
+		outdate_cached_routes();
+	}
 	for(  uint8 i=0;  i<goods_manager_t::get_max_catg_index();  i++  ){
 		all_links[i].clear();
 		consecutive_halts[i].clear();
@@ -1243,7 +1377,9 @@ sint32 haltestelle_t::rebuild_connections()
 			continue;
 		}
 
-		INT_CHECK("simhalt.cc 612");
+		if(  !on_worker  ) {
+			INT_CHECK("simhalt.cc 612");
+		}
 
 		minivec_tpl<halthandle_t> no_unload_halts;
 
@@ -1348,7 +1484,7 @@ void haltestelle_t::rebuild_linked_connections()
 }
 
 
-void haltestelle_t::fill_connected_component(uint8 catg_idx, uint16 comp)
+void haltestelle_t::fill_connected_component(uint8 catg_idx, handle_id_t comp)
 {
 	if (all_links[catg_idx].catg_connected_component != UNDECIDED_CONNECTED_COMPONENT) {
 		// already connected
@@ -1359,7 +1495,12 @@ void haltestelle_t::fill_connected_component(uint8 catg_idx, uint16 comp)
 	FOR(vector_tpl<connection_t>, &c, all_links[catg_idx].connections) {
 		c.halt->fill_connected_component(catg_idx, comp);
 		// cache the is_transfer value
-		c.is_transfer = c.halt->is_transfer(catg_idx);
+		const bool is_transfer = c.halt->is_transfer(catg_idx);
+		if(  c.is_transfer != is_transfer  ) {
+			c.is_transfer = is_transfer;
+			// cached routes through here may now take other transfers
+			comp_version[comp]++;
+		}
 	}
 }
 
@@ -1377,6 +1518,67 @@ void haltestelle_t::rebuild_connected_components()
 }
 
 
+void haltestelle_t::update_connected_components( vector_tpl<halthandle_t> &reroute_halts )
+{
+	// Relabelling all halts is linear in the number of links and gives the same ids
+	// as a complete rebuild; the expensive part (walking the schedules) was only done
+	// for the reconnected halts.
+	static array_tpl<bool> affected_comp;
+	affected_comp.resize( halthandle_t::get_size(), false );
+	const uint32 count = alle_haltestellen.get_count();
+	vector_tpl<handle_id_t> old_comp( count );
+	vector_tpl<handle_id_t> affected_comps;
+	vector_tpl<bool> reroute( count );
+	for(  uint32 i=0;  i<count;  i++  ) {
+		reroute.append( false );
+	}
+
+	for(  uint8 catg_idx = 0;  catg_idx<goods_manager_t::get_max_catg_index();  catg_idx++  ) {
+		old_comp.clear();
+		FOR(vector_tpl<halthandle_t>, halt, alle_haltestellen) {
+			old_comp.append( halt->all_links[catg_idx].catg_connected_component );
+			halt->all_links[catg_idx].catg_connected_component = UNDECIDED_CONNECTED_COMPONENT;
+		}
+		FOR(vector_tpl<halthandle_t>, halt, alle_haltestellen) {
+			if(  halt->all_links[catg_idx].catg_connected_component == UNDECIDED_CONNECTED_COMPONENT  ) {
+				halt->fill_connected_component( catg_idx, halt.get_id() );
+			}
+		}
+
+		// components with reconnected halts, or which were split or joined
+		affected_comps.clear();
+		for(  uint32 i=0;  i<count;  i++  ) {
+			const handle_id_t comp = alle_haltestellen[i]->all_links[catg_idx].catg_connected_component;
+			const bool changed = old_comp[i] != comp;
+			if(  changed  &&  old_comp[i] != UNDECIDED_CONNECTED_COMPONENT  ) {
+				// cached routes filtered start halts by the old component
+				comp_version[ old_comp[i] ]++;
+			}
+			if(  (changed  ||  alle_haltestellen[i]->reconnect_requested)  &&  !affected_comp[comp]  ) {
+				affected_comp[comp] = true;
+				affected_comps.append( comp );
+			}
+		}
+		for(  uint32 i=0;  i<count;  i++  ) {
+			if(  affected_comp[ alle_haltestellen[i]->all_links[catg_idx].catg_connected_component ]  ) {
+				reroute[i] = true;
+			}
+		}
+		FOR(vector_tpl<handle_id_t>, const comp, affected_comps) {
+			affected_comp[comp] = false;
+		}
+	}
+
+	reroute_halts.clear();
+	for(  uint32 i=0;  i<count;  i++  ) {
+		alle_haltestellen[i]->reconnect_requested = false;
+		if(  reroute[i]  ) {
+			reroute_halts.append( alle_haltestellen[i] );
+		}
+	}
+}
+
+
 sint8 haltestelle_t::is_connected(halthandle_t halt, uint8 catg_index) const
 {
 	if (!halt.is_bound()) {
@@ -1489,18 +1691,192 @@ public:
 	bool empty() const { return node_count == 0; }
 };
 
-/**
- * Data for route searching
- */
-haltestelle_t::halt_data_t haltestelle_t::halt_data[65536];
-bucket_heap_tpl<haltestelle_t::route_node_t> haltestelle_t::open_list;
-uint8 haltestelle_t::markers[65536];
-uint8 haltestelle_t::current_marker = 0;
-/**
- * Data for resumable route search
- */
-halthandle_t haltestelle_t::last_search_origin;
-uint8 haltestelle_t::last_search_ware_catg_idx = 255;
+struct haltestelle_t::search_context_t
+{
+	// store the best weight so far for a halt, and indicate whether it is a destination
+	// (one entry for each halt id, like the markers)
+	array_tpl<halt_data_t> halt_data;
+
+	// for efficient retrieval of the node with the smallest weight
+	bucket_heap_tpl<route_node_t> open_list;
+
+	/**
+	 * Markers used in route searching to avoid processing the same halt more than once
+	 */
+	array_tpl<uint8> markers;
+	uint8 current_marker;
+
+	/**
+	 * Remember last route search start and catg to resume search
+	 */
+	halthandle_t last_search_origin;
+	uint8        last_search_ware_catg_idx;
+	uint16       last_search_allocation_pointer;
+
+	// reused lists of search_route() and search_route_resumable()
+	vector_tpl<halthandle_t> end_halts;
+	vector_tpl<handle_id_t> end_conn_comp;
+	vector_tpl<handle_id_t> dest_indices;
+
+	// cached results of search_route()
+	route_cache_entry_t route_cache[ROUTE_CACHE_SIZE];
+	uint64 route_cache_hits;
+	uint64 route_cache_misses;
+	// settings the cached routes were searched with
+	uint16 route_cache_max_transfers;
+	uint16 route_cache_max_hops;
+
+	search_context_t() :
+		current_marker(0),
+		last_search_ware_catg_idx(255),
+		last_search_allocation_pointer(0),
+		route_cache_hits(0),
+		route_cache_misses(0),
+		route_cache_max_transfers(0),
+		route_cache_max_hops(0)
+	{
+		for(  uint32 i=0;  i<ROUTE_CACHE_SIZE;  i++  ) {
+			route_cache[i].epoch = 0;
+		}
+	}
+
+	/// all halts become unprocessed
+	void next_marker()
+	{
+		++current_marker;
+		if(  current_marker==0  ) {
+			memset( markers.begin(), 0, markers.get_count() );
+			current_marker = 1u;
+		}
+	}
+
+	/// makes room for all halt ids
+	void check_size()
+	{
+		if(  markers.get_count() < halthandle_t::get_size()  ) {
+			halt_data.resize( halthandle_t::get_size() );
+			markers.resize( halthandle_t::get_size(), 0 );
+		}
+	}
+};
+
+haltestelle_t::search_context_t haltestelle_t::search_contexts[MAX_THREADS];
+
+
+void haltestelle_t::mark_in_search_contexts( halthandle_t halt )
+{
+	// halts are only created in the main thread, so all tables can grow here
+	comp_version.resize( halthandle_t::get_size(), 0 );
+	for(  int t=0;  t<MAX_THREADS;  t++  ) {
+		search_contexts[t].check_size();
+		search_contexts[t].markers[ halt.get_id() ] = search_contexts[t].current_marker;
+	}
+}
+
+uint32 haltestelle_t::route_cache_epoch = 1;
+uint32 haltestelle_t::overcrowded_epoch = 0;
+array_tpl<uint32> haltestelle_t::comp_version;
+
+
+void haltestelle_t::invalidate_route_cache()
+{
+	route_cache_epoch++;
+	if(  route_cache_epoch == 0  ) {
+		// zero marks unused entries
+		route_cache_epoch = 1;
+		for(  int t=0;  t<MAX_THREADS;  t++  ) {
+			for(  uint32 i=0;  i<ROUTE_CACHE_SIZE;  i++  ) {
+				search_contexts[t].route_cache[i].epoch = 0;
+			}
+		}
+	}
+}
+
+
+void haltestelle_t::get_route_cache_stats( uint64 &hits, uint64 &misses )
+{
+	hits = 0;
+	misses = 0;
+	for(  int t=0;  t<MAX_THREADS;  t++  ) {
+		hits += search_contexts[t].route_cache_hits;
+		misses += search_contexts[t].route_cache_misses;
+	}
+}
+
+
+void haltestelle_t::add_route_cache_comp( route_cache_entry_t &entry, handle_id_t comp )
+{
+	if(  entry.comp_count > ROUTE_CACHE_COMPS  ) {
+		// already not cacheable
+		return;
+	}
+	if(  comp == UNDECIDED_CONNECTED_COMPONENT  ) {
+		// in the middle of reconnecting: the result must not be kept
+		entry.comp_count = ROUTE_CACHE_COMPS+1;
+		return;
+	}
+	for(  uint8 i=0;  i<entry.comp_count;  i++  ) {
+		if(  entry.comp[i] == comp  ) {
+			return;
+		}
+	}
+	if(  entry.comp_count == ROUTE_CACHE_COMPS  ) {
+		entry.comp_count = ROUTE_CACHE_COMPS+1;
+		return;
+	}
+	entry.comp[entry.comp_count] = comp;
+	entry.comp_version[entry.comp_count] = comp_version[comp];
+	entry.comp_count++;
+}
+
+
+bool haltestelle_t::is_route_cache_hit( const route_cache_entry_t &entry, const halthandle_t *const start_halts, const uint16 start_halt_count, const vector_tpl<halthandle_t> &end_halts, const uint8 ware_catg_idx, const bool no_routing_over_overcrowding, const uint8 ware_idx )
+{
+	if(  entry.epoch != route_cache_epoch  ||  entry.catg_idx != ware_catg_idx  ||  entry.avoid_overcrowding != no_routing_over_overcrowding  ) {
+		return false;
+	}
+	if(  no_routing_over_overcrowding  &&  ( entry.ware_idx != ware_idx  ||  entry.overcrowded_epoch != overcrowded_epoch )  ) {
+		return false;
+	}
+	if(  entry.start_count != start_halt_count  ||  entry.end_count != end_halts.get_count()  ) {
+		return false;
+	}
+	for(  uint16 s=0;  s<start_halt_count;  s++  ) {
+		if(  entry.start[s] != start_halts[s].get_id()  ) {
+			return false;
+		}
+	}
+	for(  uint32 e=0;  e<end_halts.get_count();  e++  ) {
+		if(  entry.end[e] != end_halts[e].get_id()  ) {
+			return false;
+		}
+	}
+	for(  uint8 i=0;  i<entry.comp_count;  i++  ) {
+		if(  comp_version[ entry.comp[i] ] != entry.comp_version[i]  ) {
+			// links in this component were rebuilt
+			return false;
+		}
+	}
+	return true;
+}
+
+
+int haltestelle_t::apply_route_result( const route_cache_entry_t &entry, ware_t &ware, ware_t *const return_ware )
+{
+	if(  entry.result == ROUTE_OVERCROWDED  &&  !entry.ziel.is_bound()  ) {
+		// search gave up before any destination, ware is unchanged
+		return ROUTE_OVERCROWDED;
+	}
+	ware.set_ziel( entry.ziel );
+	ware.set_zwischenziel( entry.zwischenziel );
+	if(  return_ware  ) {
+		return_ware->set_ziel( entry.return_ziel );
+		return_ware->set_zwischenziel( entry.return_zwischenziel );
+	}
+	return entry.result;
+}
+
+
 /**
  * This routine tries to find a route for a good packet (ware)
  * it will be called for
@@ -1517,24 +1893,31 @@ uint8 haltestelle_t::last_search_ware_catg_idx = 255;
  *
  * if USE_ROUTE_SLIST_TPL is defined, the list template will be used.
  * However, this is about 50% slower.
+ *
+ * Results for up to ROUTE_CACHE_HALTS start and end halts are kept in the
+ * route cache of the thread, until the network of the halts changes.
  */
-int haltestelle_t::search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware )
+int haltestelle_t::search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware, const uint8 thread_num )
 {
 	const uint8 ware_catg_idx = ware.get_desc()->get_catg_index();
 	const uint8 ware_idx = ware.get_desc()->get_index();
+	search_context_t &ctx = search_contexts[thread_num];
 
 	// since also the factory halt list is added to the ground, we can use just this ...
 	const planquadrat_t *const plan = welt->access( ware.get_zielpos() );
 	const halthandle_t *const halt_list = plan->get_haltlist();
 	// but we can only use a subset of these
-	static vector_tpl<halthandle_t> end_halts(16);
+	vector_tpl<halthandle_t> &end_halts = ctx.end_halts;
 	end_halts.clear();
 	// target halts are in these connected components
 	// we start from halts only in the same components
-	static vector_tpl<uint16> end_conn_comp(16);
+	vector_tpl<handle_id_t> &end_conn_comp = ctx.end_conn_comp;
 	end_conn_comp.clear();
 	// if one target halt is undefined, we have to start search from all halts
 	bool end_conn_comp_undefined = false;
+	// the result, and what it depends on for the route cache
+	route_cache_entry_t found;
+	found.comp_count = 0;
 
 	for( uint32 h=0;  h<plan->get_haltlist_count();  ++h ) {
 		halthandle_t halt = halt_list[h];
@@ -1555,7 +1938,8 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 			end_halts.append(halt);
 
 			// check connected component of target halt
-			uint16 endhalt_conn_comp = halt->all_links[ware_catg_idx].catg_connected_component;
+			handle_id_t endhalt_conn_comp = halt->all_links[ware_catg_idx].catg_connected_component;
+			add_route_cache_comp( found, endhalt_conn_comp );
 			if (endhalt_conn_comp == UNDECIDED_CONNECTED_COMPONENT) {
 				// undefined: all start halts are probably connected to this target
 				end_conn_comp_undefined = true;
@@ -1579,104 +1963,132 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 		}
 		return NO_ROUTE;
 	}
+
+	uint16 const max_transfers = welt->get_settings().get_max_transfers();
+	uint16 const max_hops      = welt->get_settings().get_max_hops();
+
+	if(  ctx.route_cache_max_transfers != max_transfers  ||  ctx.route_cache_max_hops != max_hops  ) {
+		// entries were searched with other limits
+		for(  uint32 i=0;  i<ROUTE_CACHE_SIZE;  i++  ) {
+			ctx.route_cache[i].epoch = 0;
+		}
+		ctx.route_cache_max_transfers = max_transfers;
+		ctx.route_cache_max_hops = max_hops;
+	}
+	route_cache_entry_t *cache_entry = NULL;
+	if(  start_halt_count <= ROUTE_CACHE_HALTS  &&  end_halts.get_count() <= ROUTE_CACHE_HALTS  ) {
+		uint32 hash = ware_catg_idx;
+		for(  uint16 s=0;  s<start_halt_count;  ++s  ) {
+			hash = hash*31u + start_halts[s].get_id();
+		}
+		FOR(vector_tpl<halthandle_t>, const e, end_halts) {
+			hash = hash*17u + e.get_id();
+		}
+		hash ^= hash >> 13;
+		cache_entry = &ctx.route_cache[ hash & (ROUTE_CACHE_SIZE-1) ];
+		if(  is_route_cache_hit( *cache_entry, start_halts, start_halt_count, end_halts, ware_catg_idx, no_routing_over_overcrowding, ware_idx )  ) {
+			ctx.route_cache_hits++;
+			return apply_route_result( *cache_entry, ware, return_ware );
+		}
+		ctx.route_cache_misses++;
+	}
+
 	// invalidate search history
-	last_search_origin = halthandle_t();
+	ctx.last_search_origin = halthandle_t();
 
 	// set current marker
-	++current_marker;
-	if(  current_marker==0  ) {
-		MEMZERON(markers, halthandle_t::get_size());
-		current_marker = 1u;
-	}
+	ctx.next_marker();
 
 	// initialisations for end halts => save some checking inside search loop
 	FOR(vector_tpl<halthandle_t>, const e, end_halts) {
-		uint16 const halt_id = e.get_id();
-		halt_data[ halt_id ].best_weight = 65535u;
-		halt_data[ halt_id ].destination = 1u;
-		halt_data[ halt_id ].depth       = 1u; // to distinct them from start halts
-		markers[ halt_id ] = current_marker;
+		handle_id_t const halt_id = e.get_id();
+		ctx.halt_data[ halt_id ].best_weight = 65535u;
+		ctx.halt_data[ halt_id ].destination = 1u;
+		ctx.halt_data[ halt_id ].depth       = 1u; // to distinct them from start halts
+		ctx.markers[ halt_id ] = ctx.current_marker;
 	}
 
-	uint16 const max_transfers = welt->get_settings().get_max_transfers();
-	uint16 const max_hops      = welt->get_settings().get_max_hops();
 	uint16 allocation_pointer = 0;
 	uint16 best_destination_weight = 65535u; // best weight among all destinations
 
-	open_list.clear();
+	ctx.open_list.clear();
 
 	uint32 overcrowded_nodes = 0;
 	// initialise the origin node(s)
 	for(  ;  allocation_pointer<start_halt_count;  ++allocation_pointer  ) {
 		halthandle_t start_halt = start_halts[allocation_pointer];
 
-		uint16 start_conn_comp = start_halt->all_links[ware_catg_idx].catg_connected_component;
+		handle_id_t start_conn_comp = start_halt->all_links[ware_catg_idx].catg_connected_component;
+		add_route_cache_comp( found, start_conn_comp );
 
 		if (!end_conn_comp_undefined   &&  start_conn_comp != UNDECIDED_CONNECTED_COMPONENT  &&  !end_conn_comp.is_contained( start_conn_comp  )){
 			// this start halt will not lead to any target
 			continue;
 		}
-		open_list.insert( route_node_t(start_halt, 0) );
+		ctx.open_list.insert( route_node_t(start_halt, 0) );
 
-		halt_data_t & start_data = halt_data[ start_halt.get_id() ];
+		halt_data_t & start_data = ctx.halt_data[ start_halt.get_id() ];
 		start_data.best_weight = 65535u;
 		start_data.destination = 0;
 		start_data.depth       = 0;
 		start_data.overcrowded = false; // start halt overcrowding is handled by routines calling this one
 		start_data.transfer    = halthandle_t();
 
-		markers[ start_halt.get_id() ] = current_marker;
+		ctx.markers[ start_halt.get_id() ] = ctx.current_marker;
 	}
 
+	// if the loop ends, nothing was found
+	found.result = NO_ROUTE;
+
 	// here the normal routing with overcrowded stops is done
-	while (!open_list.empty())
+	while (!ctx.open_list.empty())
 	{
-		if(  overcrowded_nodes == open_list.get_count()  ) {
-			// all unexplored routes go over overcrowded stations
-			return ROUTE_OVERCROWDED;
+		if(  overcrowded_nodes == ctx.open_list.get_count()  ) {
+			// all unexplored routes go over overcrowded stations (the ware is not changed)
+			found.result = ROUTE_OVERCROWDED;
+			break;
 		}
 
 		// take node out of open list
-		route_node_t current_node = open_list.pop();
+		route_node_t current_node = ctx.open_list.pop();
 		// do not use aggregate_weight as it is _not_ the weight of the current_node
 		// there might be a heuristic weight added
 
-		const uint16 current_halt_id = current_node.halt.get_id();
-		halt_data_t & current_halt_data = halt_data[ current_halt_id ];
+		const handle_id_t current_halt_id = current_node.halt.get_id();
+		halt_data_t & current_halt_data = ctx.halt_data[ current_halt_id ];
 		overcrowded_nodes -= current_halt_data.overcrowded;
+		if(  cache_entry  ) {
+			add_route_cache_comp( found, current_node.halt->all_links[ware_catg_idx].catg_connected_component );
+		}
 
 		if(  current_halt_data.destination  ) {
 			// destination found
-			ware.set_ziel( current_node.halt );
+			found.ziel = current_node.halt;
 			assert(current_halt_data.transfer.get_id() != 0);
-			if(  return_ware  ) {
-				// next transfer for the reverse route
-				// if the end halt and its connections contain more than one transfer halt then
-				// the transfer halt may not be the last transfer of the forward route
-				// (the re-routing will happen in haltestelle_t::fetch_goods)
-				return_ware->set_zwischenziel(current_halt_data.transfer);
-				// count the connected transfer halts (including end halt)
-				uint8 t = current_node.halt->is_transfer(ware_catg_idx);
-				FOR(vector_tpl<connection_t>, const& i, current_node.halt->all_links[ware_catg_idx].connections) {
-					if (t > 1) {
-						break;
-					}
-					t += i.halt.is_bound() && i.is_transfer;
+			// next transfer for the reverse route
+			// if the end halt and its connections contain more than one transfer halt then
+			// the transfer halt may not be the last transfer of the forward route
+			// (the re-routing will happen in haltestelle_t::fetch_goods)
+			// count the connected transfer halts (including end halt)
+			uint8 t = current_node.halt->is_transfer(ware_catg_idx);
+			FOR(vector_tpl<connection_t>, const& i, current_node.halt->all_links[ware_catg_idx].connections) {
+				if (t > 1) {
+					break;
 				}
-				return_ware->set_zwischenziel(  t<=1  ?  current_halt_data.transfer  : halthandle_t());
+				t += i.halt.is_bound() && i.is_transfer;
 			}
+			found.return_zwischenziel = t<=1  ?  current_halt_data.transfer  : halthandle_t();
 			// find the next transfer
 			halthandle_t transfer_halt = current_node.halt;
-			while(  halt_data[ transfer_halt.get_id() ].depth > 1   ) {
-				transfer_halt = halt_data[ transfer_halt.get_id() ].transfer;
-			}
-			ware.set_zwischenziel(transfer_halt);
-			if(  return_ware  ) {
-				// return ware's destination halt is the start halt of the forward trip
-				assert( halt_data[ transfer_halt.get_id() ].transfer.get_id() );
-				return_ware->set_ziel( halt_data[ transfer_halt.get_id() ].transfer );
-			}
-			return current_halt_data.overcrowded ? ROUTE_OVERCROWDED : ROUTE_OK;
+			while(  ctx.halt_data[ transfer_halt.get_id() ].depth > 1   ) {
+				transfer_halt = ctx.halt_data[ transfer_halt.get_id() ].transfer;
+			}
+			found.zwischenziel = transfer_halt;
+			// return ware's destination halt is the start halt of the forward trip
+			assert( ctx.halt_data[ transfer_halt.get_id() ].transfer.get_id() );
+			found.return_ziel = ctx.halt_data[ transfer_halt.get_id() ].transfer;
+			found.result = current_halt_data.overcrowded ? ROUTE_OVERCROWDED : ROUTE_OK;
+			break;
 		}
 
 		// check if the current halt is already in closed list
@@ -1700,13 +2112,13 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 
 			// since these are pre-calculated, they should be always pointing to a valid ground
 			// (if not, we were just under construction, and will be fine after 16 steps)
-			const uint16 reachable_halt_id = current_conn.halt.get_id();
+			const handle_id_t reachable_halt_id = current_conn.halt.get_id();
 
-			if(  markers[ reachable_halt_id ]!=current_marker  ) {
+			if(  ctx.markers[ reachable_halt_id ]!=ctx.current_marker  ) {
 				// Case : not processed before
 
 				// indicate that this halt has been processed
-				markers[ reachable_halt_id ] = current_marker;
+				ctx.markers[ reachable_halt_id ] = ctx.current_marker;
 
 				if(  current_conn.halt.is_bound()  &&  current_conn.is_transfer  &&  allocation_pointer<max_hops  ) {
 					// Case : transfer halt
@@ -1715,47 +2127,47 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 					if(  total_weight < best_destination_weight  ) {
 						const bool overcrowded_transfer = no_routing_over_overcrowding  &&  ( current_halt_data.overcrowded  ||  current_conn.halt->is_overcrowded( ware_idx ) );
 
-						halt_data[ reachable_halt_id ].best_weight = total_weight;
-						halt_data[ reachable_halt_id ].destination = 0;
-						halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
-						halt_data[ reachable_halt_id ].transfer    = current_node.halt;
-						halt_data[ reachable_halt_id ].overcrowded = overcrowded_transfer;
+						ctx.halt_data[ reachable_halt_id ].best_weight = total_weight;
+						ctx.halt_data[ reachable_halt_id ].destination = 0;
+						ctx.halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
+						ctx.halt_data[ reachable_halt_id ].transfer    = current_node.halt;
+						ctx.halt_data[ reachable_halt_id ].overcrowded = overcrowded_transfer;
 						overcrowded_nodes                         += overcrowded_transfer;
 
 						allocation_pointer++;
 						// as the next halt is not a destination add WEIGHT_MIN
-						open_list.insert( route_node_t(current_conn.halt, total_weight + WEIGHT_MIN) );
+						ctx.open_list.insert( route_node_t(current_conn.halt, total_weight + WEIGHT_MIN) );
 					}
 					else {
 						// Case: non-optimal transfer halt -> put in closed list
-						halt_data[ reachable_halt_id ].best_weight = 0;
+						ctx.halt_data[ reachable_halt_id ].best_weight = 0;
 					}
 				}
 				else {
 					// Case: halt is removed / no transfer halt -> put in closed list
-					halt_data[ reachable_halt_id ].best_weight = 0;
+					ctx.halt_data[ reachable_halt_id ].best_weight = 0;
 				}
 
 			} // if not processed before
-			else if(  halt_data[ reachable_halt_id ].best_weight!=0  &&  halt_data[ reachable_halt_id ].depth>0) {
+			else if(  ctx.halt_data[ reachable_halt_id ].best_weight!=0  &&  ctx.halt_data[ reachable_halt_id ].depth>0) {
 				// Case : processed before but not in closed list : that is, in open list
 				//        --> can only be destination halt or transfer halt
 				//        or start halt (filter the latter out with the condition depth>0)
 
 				uint16 total_weight = current_halt_data.best_weight + current_conn.weight;
 
-				if(  total_weight<halt_data[ reachable_halt_id ].best_weight  &&  total_weight<best_destination_weight  &&  allocation_pointer<max_hops  ) {
+				if(  total_weight<ctx.halt_data[ reachable_halt_id ].best_weight  &&  total_weight<best_destination_weight  &&  allocation_pointer<max_hops  ) {
 					// new weight is lower than lowest weight --> create new node and update halt data
-					const bool overcrowded_transfer = no_routing_over_overcrowding  &&  ( current_halt_data.overcrowded  ||  ( !halt_data[reachable_halt_id].destination  &&  current_conn.halt->is_overcrowded( ware_idx ) ) );
+					const bool overcrowded_transfer = no_routing_over_overcrowding  &&  ( current_halt_data.overcrowded  ||  ( !ctx.halt_data[reachable_halt_id].destination  &&  current_conn.halt->is_overcrowded( ware_idx ) ) );
 
-					halt_data[ reachable_halt_id ].best_weight = total_weight;
+					ctx.halt_data[ reachable_halt_id ].best_weight = total_weight;
 					// no need to update destination, as halt nature (as destination or transfer) will not change
-					halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
-					halt_data[ reachable_halt_id ].transfer    = current_node.halt;
-					halt_data[ reachable_halt_id ].overcrowded = overcrowded_transfer;
+					ctx.halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
+					ctx.halt_data[ reachable_halt_id ].transfer    = current_node.halt;
+					ctx.halt_data[ reachable_halt_id ].overcrowded = overcrowded_transfer;
 					overcrowded_nodes                         += overcrowded_transfer;
 
-					if(  halt_data[reachable_halt_id].destination  ) {
+					if(  ctx.halt_data[reachable_halt_id].destination  ) {
 						best_destination_weight = total_weight;
 					}
 					else {
@@ -1764,7 +2176,7 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 					}
 
 					allocation_pointer++;
-					open_list.insert( route_node_t(current_conn.halt, total_weight) );
+					ctx.open_list.insert( route_node_t(current_conn.halt, total_weight) );
 				}
 			} // else if not in closed list
 		} // for each connection entry
@@ -1773,38 +2185,45 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 		current_halt_data.best_weight = 0;
 	}
 
-	// if the loop ends, nothing was found
-	ware.set_ziel( halthandle_t() );
-	ware.set_zwischenziel( halthandle_t() );
-	if(  return_ware  ) {
-		return_ware->set_ziel( halthandle_t() );
-		return_ware->set_zwischenziel( halthandle_t() );
+	if(  cache_entry  &&  found.comp_count <= ROUTE_CACHE_COMPS  ) {
+		// keep the result until the network changes
+		found.epoch = route_cache_epoch;
+		found.overcrowded_epoch = overcrowded_epoch;
+		found.start_count = (uint8)start_halt_count;
+		for(  uint16 s=0;  s<start_halt_count;  ++s  ) {
+			found.start[s] = start_halts[s].get_id();
+		}
+		found.end_count = (uint8)end_halts.get_count();
+		for(  uint32 e=0;  e<end_halts.get_count();  ++e  ) {
+			found.end[e] = end_halts[e].get_id();
+		}
+		found.catg_idx = ware_catg_idx;
+		found.ware_idx = ware_idx;
+		found.avoid_overcrowding = no_routing_over_overcrowding;
+		*cache_entry = found;
 	}
-	return NO_ROUTE;
+	return apply_route_result( found, ware, return_ware );
 }
 
 
-void haltestelle_t::search_route_resumable(  ware_t &ware   )
+void haltestelle_t::search_route_resumable(  ware_t &ware, const uint8 thread_num  )
 {
 	const uint8 ware_catg_idx = ware.get_desc()->get_catg_index();
+	search_context_t &ctx = search_contexts[thread_num];
 
 	// continue search if start halt and good category did not change
-	const bool resume_search = last_search_origin == self  &&  ware_catg_idx == last_search_ware_catg_idx;
+	const bool resume_search = ctx.last_search_origin == self  &&  ware_catg_idx == ctx.last_search_ware_catg_idx;
 
 	if (!resume_search) {
-		last_search_origin = self;
-		last_search_ware_catg_idx = ware_catg_idx;
-		open_list.clear();
+		ctx.last_search_origin = self;
+		ctx.last_search_ware_catg_idx = ware_catg_idx;
+		ctx.open_list.clear();
 		// set current marker
-		++current_marker;
-		if(  current_marker==0  ) {
-			MEMZERON(markers, halthandle_t::get_size());
-			current_marker = 1u;
-		}
+		ctx.next_marker();
 	}
 
 	// remember destination nodes, to reset them before returning
-	static vector_tpl<uint16> dest_indices(16);
+	vector_tpl<handle_id_t> &dest_indices = ctx.dest_indices;
 	dest_indices.clear();
 
 	uint16 best_destination_weight = 65535u;
@@ -1829,14 +2248,14 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 	if (resume_search) {
 		for( uint8 h=0;  h<plan->get_haltlist_count();  ++h  ) {
 			const halthandle_t halt = halt_list[h];
-			if (markers[ halt.get_id() ]==current_marker  &&  halt_data[ halt.get_id() ].best_weight < best_destination_weight  &&  halt.is_bound()) {
-				best_destination_weight = halt_data[ halt.get_id() ].best_weight;
+			if (ctx.markers[ halt.get_id() ]==ctx.current_marker  &&  ctx.halt_data[ halt.get_id() ].best_weight < best_destination_weight  &&  halt.is_bound()) {
+				best_destination_weight = ctx.halt_data[ halt.get_id() ].best_weight;
 				ware.set_ziel( halt );
-				ware.set_zwischenziel( halt_data[ halt.get_id() ].transfer );
+				ware.set_zwischenziel( ctx.halt_data[ halt.get_id() ].transfer );
 			}
 		}
 		// for all halts with halt_data.weight < explored_weight one of the best routes is found
-		const uint16 explored_weight = open_list.empty()  ? 65535u : open_list.front().aggregate_weight;
+		const uint16 explored_weight = ctx.open_list.empty()  ? 65535u : ctx.open_list.front().aggregate_weight;
 
 		if (best_destination_weight <= explored_weight  &&  best_destination_weight < 65535u) {
 			// we explored best route to this destination in last run
@@ -1846,7 +2265,7 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 		}
 	}
 	// we start in this connected component
-	uint16 const conn_comp = all_links[ ware_catg_idx ].catg_connected_component;
+	handle_id_t const conn_comp = all_links[ ware_catg_idx ].catg_connected_component;
 
 	// find suitable destination halt(s), if any
 	for( uint8 h=0;  h<plan->get_haltlist_count();  ++h  ) {
@@ -1854,21 +2273,21 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 		if(  halt.is_bound()  &&  halt->is_enabled(ware_catg_idx)  ) {
 
 			// test for connected component
-			uint16 const dest_comp = halt->all_links[ ware_catg_idx ].catg_connected_component;
+			handle_id_t const dest_comp = halt->all_links[ ware_catg_idx ].catg_connected_component;
 			if (dest_comp != UNDECIDED_CONNECTED_COMPONENT  &&  conn_comp != UNDECIDED_CONNECTED_COMPONENT  &&  conn_comp != dest_comp) {
 				continue;
 			}
 
 			// initialisations for destination halts => save some checking inside search loop
-			if(  markers[ halt.get_id() ]!=current_marker  ) {
+			if(  ctx.markers[ halt.get_id() ]!=ctx.current_marker  ) {
 				// first time -> initialise marker and all halt data
-				markers[ halt.get_id() ] = current_marker;
-				halt_data[ halt.get_id() ].best_weight = 65535u;
-				halt_data[ halt.get_id() ].destination = true;
+				ctx.markers[ halt.get_id() ] = ctx.current_marker;
+				ctx.halt_data[ halt.get_id() ].best_weight = 65535u;
+				ctx.halt_data[ halt.get_id() ].destination = true;
 			}
 			else {
 				// initialised before -> only update destination bit set
-				halt_data[ halt.get_id() ].destination = true;
+				ctx.halt_data[ halt.get_id() ].destination = true;
 			}
 			dest_indices.append(halt.get_id());
 		}
@@ -1882,33 +2301,33 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 	uint16 const max_transfers = welt->get_settings().get_max_transfers();
 	uint16 const max_hops      = welt->get_settings().get_max_hops();
 
-	static uint16 allocation_pointer;
+	uint16 &allocation_pointer = ctx.last_search_allocation_pointer;
 	if (!resume_search) {
 		// initialise the origin node
 		allocation_pointer = 1u;
-		open_list.insert( route_node_t(self, 0) );
+		ctx.open_list.insert( route_node_t(self, 0) );
 
-		halt_data_t & start_data = halt_data[ self.get_id() ];
+		halt_data_t & start_data = ctx.halt_data[ self.get_id() ];
 		start_data.best_weight = 0;
 		start_data.destination = 0;
 		start_data.depth       = 0;
 		start_data.transfer    = halthandle_t();
 
-		markers[ self.get_id() ] = current_marker;
+		ctx.markers[ self.get_id() ] = ctx.current_marker;
 	}
 
-	while(  !open_list.empty()  ) {
+	while(  !ctx.open_list.empty()  ) {
 
-		if (best_destination_weight <= open_list.front().aggregate_weight) {
+		if (best_destination_weight <= ctx.open_list.front().aggregate_weight) {
 			// best route to destination found already
 			break;
 		}
 
-		route_node_t current_node = open_list.pop();
+		route_node_t current_node = ctx.open_list.pop();
 
-		const uint16 current_halt_id = current_node.halt.get_id();
+		const handle_id_t current_halt_id = current_node.halt.get_id();
 		const uint16 current_weight = current_node.aggregate_weight;
-		halt_data_t & current_halt_data = halt_data[ current_halt_id ];
+		halt_data_t & current_halt_data = ctx.halt_data[ current_halt_id ];
 
 		// check if the current halt is already in closed list (or removed)
 		if(  !current_node.halt.is_bound()  ) {
@@ -1916,7 +2335,7 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 		}
 		else if(  current_halt_data.best_weight < current_weight) {
 			// shortest path to the current halt has already been found earlier
-			// assert(markers[ current_halt_id ]==current_marker);
+			// assert(ctx.markers[ current_halt_id ]==ctx.current_marker);
 			continue;
 		}
 		else {
@@ -1947,59 +2366,59 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 		}
 
 		FOR(vector_tpl<connection_t>, const& current_conn, current_node.halt->all_links[ware_catg_idx].connections) {
-			const uint16 reachable_halt_id = current_conn.halt.get_id();
+			const handle_id_t reachable_halt_id = current_conn.halt.get_id();
 
 			const uint16 total_weight = current_weight + current_conn.weight;
 
 			if(  !current_conn.halt.is_bound()  ) {
 				// Case: halt removed -> make sure we never visit it again
-				markers[ reachable_halt_id ] = current_marker;
-				halt_data[ reachable_halt_id ].best_weight = 0;
+				ctx.markers[ reachable_halt_id ] = ctx.current_marker;
+				ctx.halt_data[ reachable_halt_id ].best_weight = 0;
 			}
-			else if(  markers[ reachable_halt_id ]!=current_marker  ) {
+			else if(  ctx.markers[ reachable_halt_id ]!=ctx.current_marker  ) {
 				// Case : not processed before and not destination
 
 				// indicate that this halt has been processed
-				markers[ reachable_halt_id ] = current_marker;
+				ctx.markers[ reachable_halt_id ] = ctx.current_marker;
 
 				// update data
-				halt_data[ reachable_halt_id ].best_weight = total_weight;
-				halt_data[ reachable_halt_id ].destination = false; // reset necessary if this was set by search_route
-				halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
-				halt_data[ reachable_halt_id ].transfer    = current_halt_data.transfer.get_id() ? current_halt_data.transfer : current_conn.halt;
+				ctx.halt_data[ reachable_halt_id ].best_weight = total_weight;
+				ctx.halt_data[ reachable_halt_id ].destination = false; // reset necessary if this was set by search_route
+				ctx.halt_data[ reachable_halt_id ].depth       = current_halt_data.depth + 1u;
+				ctx.halt_data[ reachable_halt_id ].transfer    = current_halt_data.transfer.get_id() ? current_halt_data.transfer : current_conn.halt;
 
 				if(  current_conn.is_transfer  &&  allocation_pointer<max_hops  ) {
 					// Case : transfer halt
 					allocation_pointer++;
-					open_list.insert( route_node_t(current_conn.halt, total_weight) );
+					ctx.open_list.insert( route_node_t(current_conn.halt, total_weight) );
 				}
 			} // if not processed before
 			else {
 				// Case : processed before (or destination halt)
 				//        -> need to check whether we can reach it with smaller weight
-				if(  total_weight<halt_data[ reachable_halt_id ].best_weight  ) {
+				if(  total_weight<ctx.halt_data[ reachable_halt_id ].best_weight  ) {
 					// new weight is lower than lowest weight --> update halt data
 
-					halt_data[ reachable_halt_id ].best_weight = total_weight;
-					halt_data[ reachable_halt_id ].transfer    = current_halt_data.transfer.get_id() ? current_halt_data.transfer : current_conn.halt;
+					ctx.halt_data[ reachable_halt_id ].best_weight = total_weight;
+					ctx.halt_data[ reachable_halt_id ].transfer    = current_halt_data.transfer.get_id() ? current_halt_data.transfer : current_conn.halt;
 
 					// for transfer/destination nodes create new node
-					if ( (halt_data[ reachable_halt_id ].destination  ||  current_conn.is_transfer )  &&  allocation_pointer<max_hops ) {
-						halt_data[ reachable_halt_id ].depth = current_halt_data.depth + 1u;
+					if ( (ctx.halt_data[ reachable_halt_id ].destination  ||  current_conn.is_transfer )  &&  allocation_pointer<max_hops ) {
+						ctx.halt_data[ reachable_halt_id ].depth = current_halt_data.depth + 1u;
 						allocation_pointer++;
-						open_list.insert( route_node_t(current_conn.halt, total_weight) );
+						ctx.open_list.insert( route_node_t(current_conn.halt, total_weight) );
 					}
 				}
 			} // else processed before
 		} // for each connection entry
 	}
 
-	// clear destinations since we may want to do another search with the same current_marker
-	FOR(vector_tpl<uint16>, const i, dest_indices) {
-		halt_data[i].destination = false;
-		if (halt_data[i].best_weight == 65535u) {
+	// clear destinations since we may want to do another search with the same ctx.current_marker
+	FOR(vector_tpl<handle_id_t>, const i, dest_indices) {
+		ctx.halt_data[i].destination = false;
+		if (ctx.halt_data[i].best_weight == 65535u) {
 			// not processed -> reset marker
-			--markers[i];
+			--ctx.markers[i];
 		}
 	}
 }
@@ -2059,11 +2478,13 @@ void haltestelle_t::liefere_an_fabrik(const ware_t& ware) const
 bool haltestelle_t::recall_ware( ware_t& w, uint32 menge )
 {
 	w.menge = 0;
-	slist_tpl<ware_t> *warray = cargo[w.get_desc()->get_catg_index()];
-	if(warray!=NULL) {
-		FOR(slist_tpl<ware_t>, & tmp, *warray) {
+	halt_cargo_t *warray = cargo[w.get_desc()->get_catg_index()];
+	const halt_cargo_t::slot_list_t *same_pos = warray ? warray->get_by_zielpos( w.get_index(), w.get_zielpos() ) : NULL;
+	if(same_pos!=NULL) {
+		FOR(halt_cargo_t::slot_list_t, const s, *same_pos) {
+			ware_t tmp = (*warray)[s];
 			// skip empty entries
-			if(tmp.menge==0  ||  w.get_index()!=tmp.get_index()  ||  w.get_zielpos()!=tmp.get_zielpos()) {
+			if(tmp.menge==0) {
 				continue;
 			}
 
@@ -2078,6 +2499,7 @@ bool haltestelle_t::recall_ware( ware_t& w, uint32 menge )
 				w.menge = tmp.menge;
 				tmp.menge = 0;
 			}
+			warray->replace( s, tmp );
 			book(w.menge, HALT_ARRIVED);
 			fabrik_t::update_transit( &w, false );
 			resort_freight_info = true;
@@ -2089,111 +2511,140 @@ bool haltestelle_t::recall_ware( ware_t& w, uint32 menge )
 }
 
 
-void haltestelle_t::fetch_goods_nearest_first( slist_tpl<ware_t> &load, slist_tpl<ware_t> *wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts) {
+void haltestelle_t::route_unrouted_goods(halt_cargo_t &wares)
+{
+	const halt_cargo_t::slot_list_t *unrouted = wares.get_by_next( halthandle_t() );
+	if(  !unrouted  ) {
+		return;
+	}
+	// routing moves the packets to other lists
+	const halt_cargo_t::slot_list_t slots( *unrouted );
+	FOR(halt_cargo_t::slot_list_t, const s, slots) {
+		ware_t ware = wares[s];
+		// skip empty entries
+		if(  ware.menge==0  ) {
+			continue;
+		}
+		search_route_resumable(ware);
+		if(  !ware.get_ziel().is_bound()  ) {
+			// no route anymore
+			ware.menge = 0;
+		}
+		wares.replace( s, ware );
+	}
+}
+
+
+void haltestelle_t::fetch_goods_nearest_first( slist_tpl<ware_t> &load, halt_cargo_t &wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts) {
+	// goods without route -> returning passengers/mail
+	route_unrouted_goods(wares);
+
 	// first iterate over the next stop, then over the ware
 	// might be a little slower, but ensures that passengers to nearest stop are served first
 	// this allows for separate high speed and normal service
 	for(  uint32 i=0; i < destination_halts.get_count();  i++  ) {
 		halthandle_t plan_halt = destination_halts[i];
 
-		// REMOVED: The random offset will ensure that all goods have an equal chance to be loaded.
-		for(  slist_tpl<ware_t>::iterator tmp = wares->begin();  tmp!=wares->end();  tmp++) {
+		const halt_cargo_t::slot_list_t *slots = wares.get_by_next( plan_halt );
+		if(  !slots  ) {
+			// nothing there to load
+			continue;
+		}
+		// loading only changes amounts, so the list stays the same
+		FOR(halt_cargo_t::slot_list_t, const s, *slots) {
+			ware_t tmp = wares[s];
 			// skip empty entries
-			if(tmp->menge==0) {
+			if(tmp.menge==0) {
 				continue;
 			}
 
-			// goods without route -> returning passengers/mail
-			if(  !tmp->get_zwischenziel().is_bound()  ) {
-				search_route_resumable(*tmp);
-				if (!tmp->get_ziel().is_bound()) {
-					// no route anymore
-					tmp->menge = 0;
+			if(  plan_halt->is_overcrowded( tmp.get_index() )  ) {
+				if (welt->get_settings().is_avoid_overcrowding() && tmp.get_ziel() != plan_halt) {
+					// do not go for transfer to overcrowded transfer stop
 					continue;
 				}
 			}
 
-			// compatible car and right target stop?
-			if(  tmp->get_zwischenziel()==plan_halt  ) {
-				if(  plan_halt->is_overcrowded( tmp->get_index() )  ) {
-					if (welt->get_settings().is_avoid_overcrowding() && tmp->get_ziel() != plan_halt) {
-						// do not go for transfer to overcrowded transfer stop
-						continue;
-					}
-				}
-
-				// not too much?
-				ware_t neu(*tmp);
-				if(  tmp->menge > requested_amount  ) {
-					// not all can be loaded
-					neu.menge = requested_amount;
-					tmp->menge -= requested_amount;
-					requested_amount = 0;
-				}
-				else {
-					requested_amount -= tmp->menge;
-					// leave an empty entry => joining will more often work
-					tmp->menge = 0;
-				}
-				load.insert(neu);
+			// not too much?
+			ware_t neu(tmp);
+			if(  tmp.menge > requested_amount  ) {
+				// not all can be loaded
+				neu.menge = requested_amount;
+				tmp.menge -= requested_amount;
+				requested_amount = 0;
+			}
+			else {
+				requested_amount -= tmp.menge;
+				// leave an empty entry => joining will more often work
+				tmp.menge = 0;
+			}
+			wares.replace( s, tmp );
+			load.insert(neu);
 
-				book(neu.menge, HALT_DEPARTED);
-				resort_freight_info = true;
+			book(neu.menge, HALT_DEPARTED);
+			resort_freight_info = true;
 
-				if (requested_amount==0) {
-					return;
-				}
+			if (requested_amount==0) {
+				return;
 			}
 		}
-
-		// nothing there to load
 	}
 }
 
 
-void haltestelle_t::fetch_goods_FIFO( slist_tpl<ware_t> &load, slist_tpl<ware_t> *wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts) {
-	for(  slist_tpl<ware_t>::iterator ware = wares->begin();  ware!=wares->end();  ) {
+void haltestelle_t::fetch_goods_FIFO( slist_tpl<ware_t> &load, halt_cargo_t &wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts) {
+	// visit the packets for these stops and those without route yet (returning passengers/mail) in arrival order
+	vector_tpl<halthandle_t> next_halts( destination_halts.get_count()+1 );
+	next_halts.append( halthandle_t() );
+	FOR(vector_tpl<halthandle_t>, const h, destination_halts) {
+		next_halts.append_unique( h );
+	}
+
+	uint32 order = 0;
+	for(  halt_cargo_t::slot_t s = wares.find_next( next_halts, order );  s != halt_cargo_t::END;  s = wares.find_next( next_halts, order )  ) {
+		order = wares.get_order(s);
+		ware_t ware = wares[s];
+
 		// empty entry -> remove
-		if(ware->menge==0) {
-			ware = wares->erase(ware);
+		if(ware.menge==0) {
+			wares.remove(s);
 			continue;
 		}
 
 		// goods without route -> returning passengers/mail
-		if(  !ware->get_zwischenziel().is_bound()  ) {
-			search_route_resumable(*ware);
-			if (!ware->get_ziel().is_bound()) {
+		if(  !ware.get_zwischenziel().is_bound()  ) {
+			search_route_resumable(ware);
+			if (!ware.get_ziel().is_bound()) {
 				// no route anymore
-				ware = wares->erase(ware);
+				wares.remove(s);
 				continue;
 			}
+			wares.replace( s, ware );
 		}
 
 		// right target stop, and not overcrowding?
 		// do not go for transfer to overcrowded transfer stop
 		if(
-			!destination_halts.is_contained(ware->get_zwischenziel())  ||
+			!destination_halts.is_contained(ware.get_zwischenziel())  ||
 			(welt->get_settings().is_avoid_overcrowding()  &&
-				ware->get_zwischenziel()->is_overcrowded( ware->get_index() )  &&
-				ware->get_ziel() != ware->get_zwischenziel())
+				ware.get_zwischenziel()->is_overcrowded( ware.get_index() )  &&
+				ware.get_ziel() != ware.get_zwischenziel())
 		) {
-			ware++;
 			continue;
 		}
 
 		// not too much?
-		ware_t neu(*ware);
-		if(  ware->menge > requested_amount  ) {
+		ware_t neu(ware);
+		if(  ware.menge > requested_amount  ) {
 			// not all can be loaded
 			neu.menge = requested_amount;
-			ware->menge -= requested_amount;
+			ware.menge -= requested_amount;
 			requested_amount = 0;
+			wares.replace( s, ware );
 		}
 		else {
-			requested_amount -= ware->menge;
-			// leave an empty entry => joining will more often work
-			ware->menge = 0;
-			ware = wares->erase(ware);
+			requested_amount -= ware.menge;
+			wares.remove(s);
 		}
 		load.insert(neu);
 
@@ -2209,42 +2660,32 @@ void haltestelle_t::fetch_goods_FIFO( slist_tpl<ware_t> &load, slist_tpl<ware_t>
 
 void haltestelle_t::fetch_goods( slist_tpl<ware_t> &load, const goods_desc_t *good_category, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts)
 {
-	slist_tpl<ware_t> *warray = cargo[good_category->get_catg_index()];
+	halt_cargo_t *warray = cargo[good_category->get_catg_index()];
 	if(  !warray  ||  warray->empty()  ) {
 		return;
 	}
 	if(  world()->get_settings().get_first_come_first_serve()  ) {
-		fetch_goods_FIFO(load, warray, requested_amount, destination_halts);
+		fetch_goods_FIFO(load, *warray, requested_amount, destination_halts);
 	} else {
-		fetch_goods_nearest_first(load, warray, requested_amount, destination_halts);
+		fetch_goods_nearest_first(load, *warray, requested_amount, destination_halts);
 	}
 }
 
 
 uint32 haltestelle_t::get_ware_summe(const goods_desc_t *wtyp) const
 {
-	int sum = 0;
-	const slist_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		FOR(slist_tpl<ware_t>, const& i, *warray) {
-			if (wtyp->get_index() == i.get_index()) {
-				sum += i.menge;
-			}
-		}
-	}
-	return sum;
+	const halt_cargo_t * warray = cargo[wtyp->get_catg_index()];
+	return warray ? warray->get_sum( wtyp->get_index() ) : 0;
 }
 
 
 uint32 haltestelle_t::get_ware_fuer_zielpos(const goods_desc_t *wtyp, const koord zielpos) const
 {
-	const slist_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		FOR(slist_tpl<ware_t>, const& ware, *warray) {
-			if(wtyp->get_index()==ware.get_index()  &&  ware.get_zielpos()==zielpos) {
-				return ware.menge;
-			}
-		}
+	const halt_cargo_t * warray = cargo[wtyp->get_catg_index()];
+	const halt_cargo_t::slot_list_t *same_pos = warray ? warray->get_by_zielpos( wtyp->get_index(), zielpos ) : NULL;
+	if(same_pos!=NULL) {
+		// the first one, as it will be joined with new goods
+		return (*warray)[ (*same_pos)[0] ].menge;
 	}
 	return 0;
 }
@@ -2253,10 +2694,12 @@ uint32 haltestelle_t::get_ware_fuer_zielpos(const goods_desc_t *wtyp, const koor
 uint32 haltestelle_t::get_ware_fuer_zwischenziel(const goods_desc_t *wtyp, const halthandle_t zwischenziel) const
 {
 	uint32 sum = 0;
-	const slist_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		FOR(slist_tpl<ware_t>, const& ware, *warray) {
-			if(wtyp->get_index()==ware.get_index()  &&  ware.get_zwischenziel()==zwischenziel) {
+	const halt_cargo_t * warray = cargo[wtyp->get_catg_index()];
+	const halt_cargo_t::slot_list_t *slots = warray ? warray->get_by_next( zwischenziel ) : NULL;
+	if(slots!=NULL) {
+		FOR(halt_cargo_t::slot_list_t, const s, *slots) {
+			const ware_t &ware = (*warray)[s];
+			if(wtyp->get_index()==ware.get_index()) {
 				sum += ware.menge;
 			}
 		}
@@ -2275,21 +2718,29 @@ bool haltestelle_t::vereinige_waren(const ware_t &ware)
 	}
 
 	// pruefen ob die ware mit bereits wartender ware vereinigt werden kann
-	slist_tpl<ware_t> * warray = cargo[ware.get_desc()->get_catg_index()];
+	halt_cargo_t * warray = cargo[ware.get_desc()->get_catg_index()];
 	if(  !warray  ) {
 		return false;
 	}
-	FOR(slist_tpl<ware_t>, & tmp, *warray) {
-		// join packets with same destination
-		if(ware.same_destination(tmp)) {
-			if(  ware.get_zwischenziel().is_bound()  &&  ware.get_zwischenziel()!=self  ) {
-				// update route if there is newer route
-				tmp.set_zwischenziel( ware.get_zwischenziel() );
-			}
-			tmp.menge += ware.menge;
-			resort_freight_info = true;
-			return true;
+	// join packets with same destination
+	const halt_cargo_t::slot_list_t *same_destination = warray->get_by_destination( ware );
+	if(  !same_destination  ) {
+		return false;
+	}
+	FOR(halt_cargo_t::slot_list_t, const s, *same_destination) {
+		ware_t tmp = (*warray)[s];
+		if(  !tmp.same_destination( ware )  ) {
+			// only possible with 32 bit handles, where the keys are not unique
+			continue;
+		}
+		if(  ware.get_zwischenziel().is_bound()  &&  ware.get_zwischenziel()!=self  ) {
+			// update route if there is newer route
+			tmp.set_zwischenziel( ware.get_zwischenziel() );
 		}
+		tmp.menge += ware.menge;
+		warray->replace( s, tmp );
+		resort_freight_info = true;
+		return true;
 	}
 	return false;
 }
@@ -2301,10 +2752,10 @@ bool haltestelle_t::vereinige_waren(const ware_t &ware)
 void haltestelle_t::add_ware_to_halt(ware_t ware)
 {
 	// now we have to add the ware to the stop
-	slist_tpl<ware_t> * warray = cargo[ware.get_desc()->get_catg_index()];
+	halt_cargo_t * warray = cargo[ware.get_desc()->get_catg_index()];
 	if(warray==NULL) {
 		// this type was not stored here before ...
-		warray = new slist_tpl<ware_t>();
+		warray = new halt_cargo_t();
 		cargo[ware.get_desc()->get_catg_index()] = warray;
 	}
 	resort_freight_info = true;
@@ -2421,9 +2872,9 @@ void haltestelle_t::get_freight_info(cbuffer_t & buf)
 			if(  !cargo[i]  ) {
 				continue;
 			}
-			vector_tpl<ware_t> wvector;
-			FOR(slist_tpl<ware_t>, & w, *cargo[i]) {
-				wvector.append(w);
+			vector_tpl<ware_t> wvector( cargo[i]->get_count() );
+			for(  halt_cargo_t::slot_t s = cargo[i]->first();  s != halt_cargo_t::END;  s = cargo[i]->next(s)  ) {
+				wvector.append( (*cargo[i])[s] );
 			}
 			freight_list_sorter_t::sort_freight(wvector, buf, (freight_list_sorter_t::sort_mode_t)sortierung, NULL, "waiting");
 		}
@@ -2752,9 +3203,11 @@ void haltestelle_t::transfer_goods(halthandle_t halt)
 	}
 	// transfer goods to halt
 	for(uint8 i=0; i<goods_manager_t::get_max_catg_index(); i++) {
-		const slist_tpl<ware_t> * warray = cargo[i];
+		halt_cargo_t * warray = cargo[i];
 		if (warray) {
-			FOR(slist_tpl<ware_t>, const& j, *warray) {
+			vector_tpl<ware_t> wares;
+			warray->extract( wares );
+			FOR(vector_tpl<ware_t>, const& j, wares) {
 				halt->add_ware_to_halt(j);
 			}
 			delete cargo[i];
@@ -2921,12 +3374,12 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	// will restore halthandle_t after loading
 	if(file->is_version_atleast(110, 6)) {
 		if(file->is_saving()) {
-			uint16 halt_id = self.is_bound() ? self.get_id() : 0;
-			file->rdwr_short(halt_id);
+			uint32 halt_id = self.is_bound() ? self.get_id() : 0;
+			file->rdwr_handle_id(halt_id);
 		}
 		else {
-			uint16 halt_id;
-			file->rdwr_short(halt_id);
+			uint32 halt_id = 0;
+			file->rdwr_handle_id(halt_id);
 			self.set_id(halt_id);
 			self = halthandle_t(this, halt_id);
 		}
@@ -2994,7 +3447,7 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	if(file->is_saving()) {
 		const char *s;
 		for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
-			slist_tpl<ware_t> *warray = cargo[i];
+			halt_cargo_t *warray = cargo[i];
 			if(warray) {
 				s = "y"; // needs to be non-empty
 				file->rdwr_str(s);
@@ -3006,7 +3459,8 @@ void haltestelle_t::rdwr(loadsave_t *file)
 					uint32 count = warray->get_count();
 					file->rdwr_long(count);
 				}
-				FOR(slist_tpl<ware_t>, & ware, *warray) {
+				for(  halt_cargo_t::slot_t s = warray->first();  s != halt_cargo_t::END;  s = warray->next(s)  ) {
+					ware_t ware = (*warray)[s];
 					ware.rdwr(file);
 				}
 			}
@@ -3082,16 +3536,30 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	}
 
 	// read and write departure slots.
+	// The slots are still saved in DST_SIZE lists by departure tick, as in the former hash table.
 	if(  file->get_OTRP_version()>=24  ) {
+		if(  file->is_loading()  ) {
+			departure_slots.clear();
+			convoy_departures.clear();
+		}
 		for(uint8 idx=0; idx<DST_SIZE; idx++) {
-			uint32 n = departure_slot_table[idx].get_count();
-			file->rdwr_long(n);
-			slist_tpl<departure_t>::iterator i = departure_slot_table[idx].begin();
-			if(  file->is_loading()  ) {
-				departure_slot_table[idx].clear();
+			uint32 n = 0;
+			if(  file->is_saving()  ) {
+				FOR(vector_tpl<departure_t>, const& d, departure_slots) {
+					if(  d.dep_tick % DST_SIZE == idx  ) {
+						n++;
+					}
+				}
 			}
-			for(uint8 k=0; k<n; k++) {
-				departure_t d = file->is_loading() ? departure_t() : *i;
+			file->rdwr_long(n);
+			uint32 i = 0;
+			for(uint32 k=0; k<n; k++) {
+				if(  file->is_saving()  ) {
+					while(  departure_slots[i].dep_tick % DST_SIZE != idx  ) {
+						i++;
+					}
+				}
+				departure_t d = file->is_loading() ? departure_t() : departure_slots[i];
 				file->rdwr_long(d.arr_tick);
 				file->rdwr_long(d.dep_tick);
 				file->rdwr_long(d.exp_tick);
@@ -3102,9 +3570,11 @@ void haltestelle_t::rdwr(loadsave_t *file)
 				}
 				convoi_t::rdwr_convoihandle_t(file, d.cnv);
 				if(  file->is_loading()  ) {
-					departure_slot_table[idx].append(d);
+					// sorted by finish_departures_rd(), when the lines of the convois are known
+					d.line_id = 0;
+					departure_slots.append(d);
 				} else {
-					i++; // increment iterator
+					i++;
 				}
 			}
 		}
@@ -3113,21 +3583,34 @@ void haltestelle_t::rdwr(loadsave_t *file)
 
 
 
-void haltestelle_t::finish_rd()
+void haltestelle_t::finish_cargo_rd()
 {
-	verbinde_fabriken();
-
-	stale_convois.clear();
-	stale_lines.clear();
 	// fix good destination coordinates
 	for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
 		if(cargo[i]) {
-			slist_tpl<ware_t> * warray = cargo[i];
-			FOR(slist_tpl<ware_t>, & j, *warray) {
+			// this changes the routes, so the packets must be indexed anew
+			vector_tpl<ware_t> wares;
+			cargo[i]->extract( wares );
+			FOR(vector_tpl<ware_t>, & j, wares) {
 				j.finish_rd(welt);
+				cargo[i]->append( j );
 			}
 		}
 	}
+}
+
+
+void haltestelle_t::finish_rd()
+{
+	verbinde_fabriken();
+
+	stale_convois.clear();
+	stale_lines.clear();
+	if(  welt->load_version<=111005  ) {
+		// the goods refer to halts by coordinates, which may create halts
+		// (newer games are fixed by karte_t::load() for all halts in parallel)
+		finish_cargo_rd();
+	}
 
 	// handle name for old stations which don't exist in kartenboden
 	// also recover from stations without tiles (from broken savegames)
@@ -3210,6 +3693,8 @@ void haltestelle_t::recalc_status()
 	// since the status is ordered ...
 	uint8 status_bits = 0;
 
+	uint8 old_overcrowded[256/8];
+	memcpy( old_overcrowded, overcrowded, sizeof(overcrowded) );
 	MEMZERO(overcrowded);
 
 	uint64 total_sum = 0;
@@ -3252,6 +3737,11 @@ void haltestelle_t::recalc_status()
 		}
 	}
 
+	if(  memcmp( old_overcrowded, overcrowded, sizeof(overcrowded) )  ) {
+		// routes avoiding overcrowded stops may change
+		overcrowded_epoch++;
+	}
+
 	// take the worst color for status
 	if(  status_bits  ) {
 		status_color = color_idx_to_rgb(status_bits&2 ? COL_RED : COL_ORANGE);
@@ -3815,59 +4305,139 @@ bool haltestelle_t::is_halt_covered(const halthandle_t &halt) const
 }
 
 
+uint32 haltestelle_t::find_departure( const vector_tpl<departure_t> &departures, uint64 key, bool by_convoy )
+{
+	uint32 low = 0;
+	uint32 high = departures.get_count();
+	while(  low < high  ) {
+		const uint32 mid = (low + high) / 2;
+		const uint64 mid_key = by_convoy ? departures[mid].get_convoy_key() : departures[mid].get_slot_key();
+		if(  mid_key < key  ) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+
+bool haltestelle_t::remove_departure( convoihandle_t cnv, uint32 dep_tick, bool only_expired )
+{
+	const uint64 key = ((uint64)cnv.get_id() << 32) | dep_tick;
+	for(  uint32 i = find_departure( convoy_departures, key, true );  i < convoy_departures.get_count()  &&  convoy_departures[i].get_convoy_key() == key;  i++  ) {
+		const departure_t d = convoy_departures[i];
+		if(  only_expired  &&  welt->get_ticks() <= d.exp_tick  ) {
+			continue;
+		}
+		convoy_departures.remove_at( i );
+		// and the same entry from the slots
+		const uint64 slot_key = d.get_slot_key();
+		for(  uint32 j = find_departure( departure_slots, slot_key, false );  j < departure_slots.get_count()  &&  departure_slots[j].get_slot_key() == slot_key;  j++  ) {
+			const departure_t &s = departure_slots[j];
+			if(  s.cnv == d.cnv  &&  s.arr_tick == d.arr_tick  &&  s.exp_tick == d.exp_tick  ) {
+				departure_slots.remove_at( j );
+				break;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+
+void haltestelle_t::finish_departures_rd()
+{
+	for(  uint32 i = 0;  i < departure_slots.get_count();  ) {
+		departure_t &d = departure_slots[i];
+		if(  !d.cnv.is_bound()  ) {
+			departure_slots.remove_at( i );
+			continue;
+		}
+		d.line_id = d.cnv->get_line().get_id();
+		i++;
+	}
+	// stable, so the order of equal keys does not depend on the platform
+	std::stable_sort( departure_slots.begin(), departure_slots.end(), departure_t::slot_order );
+	convoy_departures.clear();
+	convoy_departures.resize( departure_slots.get_count() );
+	FOR(vector_tpl<departure_t>, const& d, departure_slots) {
+		convoy_departures.append( d );
+		departure_expiry_t e = { d.exp_tick, d.dep_tick, self, d.cnv };
+		departure_expiry.append( e );
+		std::push_heap( departure_expiry.begin(), departure_expiry.end(), departure_expiry_t::expires_later );
+	}
+	std::stable_sort( convoy_departures.begin(), convoy_departures.end(), departure_t::convoy_order );
+}
+
+
+void haltestelle_t::sweep_departures()
+{
+	while(  !departure_expiry.empty()  &&  welt->get_ticks() > departure_expiry[0].exp_tick  ) {
+		std::pop_heap( departure_expiry.begin(), departure_expiry.end(), departure_expiry_t::expires_later );
+		const departure_expiry_t e = departure_expiry.pop_back();
+		// the slot may have been removed already or the stop may be gone
+		if(  e.halt.is_bound()  ) {
+			e.halt->remove_departure( e.cnv, e.dep_tick, true );
+		}
+	}
+}
+
+
 bool haltestelle_t::book_departure (uint32 arr_tick, uint32 dep_tick, uint32 exp_tick, convoihandle_t cnv) {
-	const uint8 idx = dep_tick % DST_SIZE;
-	slist_tpl<departure_t>::iterator i = departure_slot_table[idx].begin();
 	const uint8 stop_index = cnv->get_schedule()->get_current_stop_exluding_depot();
-	while(  i!=departure_slot_table[idx].end()  ) {
-		if(  welt->get_ticks()>i->exp_tick  ||  !i->cnv.is_bound()  ) {
-			// This entry is already obsolete. Just remove it.
-			i = departure_slot_table[idx].erase(i);
+	const uint32 ticks = welt->get_ticks();
+	// Expired slots are left to sweep_departures() and are just ignored here.
+
+	// The requested slot may already be reserved by this convoy.
+	const uint64 cnv_key = (uint64)cnv.get_id() << 32;
+	for(  uint32 i = find_departure( convoy_departures, cnv_key, true );  i < convoy_departures.get_count()  &&  convoy_departures[i].cnv == cnv;  i++  ) {
+		const departure_t &d = convoy_departures[i];
+		if(  ticks > d.exp_tick  ) {
 			continue;
 		}
-		if(  i->cnv==cnv  &&  i->arr_tick==arr_tick  ) {
-			// The requested slot is already reserved by this convoy.
+		if(  d.arr_tick == arr_tick  ) {
 			return true;
-		} else if(
-			i->dep_tick==dep_tick  &&
-			(i->cnv==cnv  ||  i->cnv->get_line()==cnv->get_line())  &&
-			i->stop_index==stop_index
-		) {
-			// The slot is already reserved by other convoy.
+		}
+		if(  d.dep_tick == dep_tick  &&  d.stop_index == stop_index  ) {
+			// This convoy departs at that time already.
 			return false;
 		}
-		i++;
 	}
+
+	// The slot may be reserved by another convoy of the line.
+	departure_t dep(arr_tick, dep_tick, exp_tick, stop_index, cnv->get_line().get_id(), cnv);
+	const uint64 slot_key = dep.get_slot_key();
+	uint32 slot_pos = find_departure( departure_slots, slot_key, false );
+	for(  uint32 i = slot_pos;  i < departure_slots.get_count()  &&  departure_slots[i].get_slot_key() == slot_key;  i++  ) {
+		if(  ticks <= departure_slots[i].exp_tick  &&  departure_slots[i].cnv.is_bound()  ) {
+			return false;
+		}
+	}
+
 	// reserve the slot.
-	departure_t dep(arr_tick, dep_tick, exp_tick, stop_index, cnv);
-	departure_slot_table[idx].insert(departure_slot_table[idx].begin(), dep);
+	departure_slots.insert_at( slot_pos, dep );
+	convoy_departures.insert_at( find_departure( convoy_departures, dep.get_convoy_key(), true ), dep );
+	departure_expiry_t e = { exp_tick, dep_tick, self, cnv };
+	departure_expiry.append( e );
+	std::push_heap( departure_expiry.begin(), departure_expiry.end(), departure_expiry_t::expires_later );
 	return true;
 }
 
 
 bool haltestelle_t::erase_departure(uint32 dep_tick, convoihandle_t cnv) {
-	const uint8 idx = dep_tick % DST_SIZE;
-	slist_tpl<departure_t>::iterator i = departure_slot_table[idx].begin();
-	// find and remove the requested departure slot
-	while(  i!=departure_slot_table[idx].end()  ) {
-		if(  i->cnv==cnv  &&  i->dep_tick==dep_tick  ) {
-			departure_slot_table[idx].erase(i);
-			return true;
-		}
-		i++;
-	}
-	return false; // we cannot find the requested departure slot.
+	// the entry in departure_expiry is skipped, when it expires
+	return remove_departure( cnv, dep_tick, false );
 }
 
 
 bool haltestelle_t::is_departure_booked(uint32 dep_tick, uint8 stop_index, linehandle_t line) const {
-	const uint8 idx = dep_tick % DST_SIZE;
-	slist_tpl<departure_t>::const_iterator i = departure_slot_table[idx].begin();
-	while(  i!=departure_slot_table[idx].end()  ) {
-		if(  i->dep_tick==dep_tick  &&  i->stop_index==stop_index  &&  i->cnv->get_line()==line  ) {
+	const uint64 slot_key = ((uint64)line.get_id() << 40) | ((uint64)stop_index << 32) | dep_tick;
+	for(  uint32 i = find_departure( departure_slots, slot_key, false );  i < departure_slots.get_count()  &&  departure_slots[i].get_slot_key() == slot_key;  i++  ) {
+		if(  departure_slots[i].cnv.is_bound()  ) {
 			return true;
 		}
-		i++;
 	}
 	return false;
 }
@@ -14,13 +14,16 @@
 #include "obj/simobj.h"
 #include "display/simgraph.h"
 #include "simtypes.h"
+#include "simconst.h"
 
 #include "bauer/goods_manager.h"
 
 #include "descriptor/goods_desc.h"
 
 #include "dataobj/koord.h"
+#include "dataobj/halt_cargo.h"
 
+#include "tpl/array_tpl.h"
 #include "tpl/inthashtable_tpl.h"
 
 #include "tpl/slist_tpl.h"
@@ -42,7 +45,11 @@
 #define HALT_CONVOIS_ARRIVED 6 // number of convois arrived this month
 #define HALT_WALKED          7 // could walk to destination
 
-#define DST_SIZE 101 // size of departure_slot_table
+#define DST_SIZE 101 // number of departure slot lists in savegames
+
+#define ROUTE_CACHE_SIZE  (4096) // entries of the route cache per thread (must be a power of two)
+#define ROUTE_CACHE_HALTS (4)    // only searches with up to this many start and end halts are cached
+#define ROUTE_CACHE_COMPS (4)    // max connected components a cached search may depend on
 
 class cbuffer_t;
 class grund_t;
@@ -158,6 +165,24 @@ public:
 	 */
 	static void reset_routing();
 
+	/**
+	 * Marks the stops of a changed schedule for reconnection. If all changes since the
+	 * last reconnection came through here, step_all() only reconnects the marked halts.
+	 * Called from karte_t::set_schedule_counter().
+	 */
+	static void reconnect_stops( const schedule_t *schedule, const player_t *owner, uint8 schedule_counter );
+
+	/**
+	 * Complete reconnection of a loaded game, spread over the worker threads:
+	 * start_reconnect_all(), then reconnect_loop() for all halts (in parallel
+	 * for disjoint ranges), then end_reconnect_all(), which leaves rerouting
+	 * to step_all(). Only for freshly loaded halts, whose connected components
+	 * are still undecided.
+	 */
+	static void start_reconnect_all();
+	static void reconnect_loop( uint32 first, uint32 last, uint8 thread_num );
+	static void end_reconnect_all();
+
 	/**
 	 * Tries to generate some pedestrians on the square and the
 	 * adjacent squares. Return actual number of generated
@@ -271,9 +296,9 @@ private:
 		 * The id of the component has to be equal to the halt-id of one of its halts.
 		 * This ensures that we always have unique component ids.
 		 */
-		uint16 catg_connected_component;
+		handle_id_t catg_connected_component;
 
-#		define UNDECIDED_CONNECTED_COMPONENT (0xffff)
+#		define UNDECIDED_CONNECTED_COMPONENT ((handle_id_t)~0)
 
 		link_t() { clear(); }
 
@@ -294,6 +319,13 @@ private:
 	 */
 	static void rebuild_connected_components();
 
+	/**
+	 * Recomputes the connected components of all halts after only some halts were reconnected.
+	 * Returns the halts whose goods must be rerouted: all halts in components
+	 * with a reconnected halt or which changed.
+	 */
+	static void update_connected_components( vector_tpl<halthandle_t> &reroute_halts );
+
 	/**
 	 * Helper method: This halt (and all its connected neighbors) belong
 	 * to the same component.
@@ -301,11 +333,11 @@ private:
 	 * @param catg category of cargo network
 	 * @param comp number of component
 	 */
-	void fill_connected_component(uint8 catg, uint16 comp);
+	void fill_connected_component(uint8 catg, handle_id_t comp);
 
 
 	// Array with different categories that contains all waiting goods at this stop
-	slist_tpl<ware_t> **cargo;
+	halt_cargo_t **cargo;
 
 	/**
 	 * Liste der angeschlossenen Fabriken
@@ -327,6 +359,26 @@ private:
 	 * Reconnect and reroute if counter different from welt->get_schedule_counter()
 	 */
 	static uint8 reconnect_counter;
+
+	/**
+	 * Up to this schedule counter all changes were limited to the halts in reconnect_halts,
+	 * so only these must be reconnected
+	 */
+	static uint8 partial_reconnect_counter;
+
+	/// halts whose serving schedules changed since the last reconnection
+	static vector_tpl<halthandle_t> reconnect_halts;
+
+	/// true while in reconnect_halts
+	bool reconnect_requested;
+
+	void request_reconnect()
+	{
+		if(  !reconnect_requested  ) {
+			reconnect_requested = true;
+			reconnect_halts.append(self);
+		}
+	}
 	// since we do partial routing, we remember the last offset
 	uint8 last_catg_index;
 
@@ -352,9 +404,12 @@ private:
 	void transfer_goods(halthandle_t halt);
 	
 	
-	void fetch_goods_FIFO( slist_tpl<ware_t> &load, slist_tpl<ware_t> *wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts);
+	void fetch_goods_FIFO( slist_tpl<ware_t> &load, halt_cargo_t &wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts);
 	
-	void fetch_goods_nearest_first( slist_tpl<ware_t> &load, slist_tpl<ware_t> *wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts);
+	void fetch_goods_nearest_first( slist_tpl<ware_t> &load, halt_cargo_t &wares, uint32 requested_amount, const vector_tpl<halthandle_t>& destination_halts);
+
+	/// routes the packets without route yet (returning passengers/mail)
+	void route_unrouted_goods(halt_cargo_t &wares);
 
 	/**
 	* parameter to ease sorting
@@ -410,8 +465,13 @@ public:
 	/**
 	 * Rebuilds the list of connections to reachable halts
 	 * returns the search number of connections
+	 * @param on_worker called on a worker thread by reconnect_loop() (with its @p thread_num):
+	 *        no INT_CHECK, and the cached routes were already outdated by start_reconnect_all()
 	 */
-	sint32 rebuild_connections();
+	sint32 rebuild_connections(uint8 thread_num = 0, bool on_worker = false);
+
+	/// invalidates the cached routes through the connected components of this halt
+	void outdate_cached_routes();
 
 	/**
 	 * Rebuilds connections of all halts connected to this halt.
@@ -494,42 +554,114 @@ private:
 		bool overcrowded:1;
 	};
 
-	// store the best weight so far for a halt, and indicate whether it is a destination
-	static halt_data_t halt_data[65536];
-
-	// for efficient retrieval of the node with the smallest weight
-	static bucket_heap_tpl<route_node_t> open_list;
-
 	/**
-	 * Markers used in route searching to avoid processing the same halt more than once
+	 * Result of search_route() for a set of start and end halts.
+	 * An entry is only valid while none of the connected components the search went through
+	 * was rebuilt, and (when avoiding overcrowded stops) while no halt changed its overcrowding.
+	 * So a hit gives the same result as a new search, also for clients without the entry.
 	 */
-	static uint8 markers[65536];
-	static uint8 current_marker;
+	struct route_cache_entry_t
+	{
+		uint32 epoch; // route_cache_epoch when stored, 0 for unused
+		uint32 overcrowded_epoch;
+		uint32 comp_version[ROUTE_CACHE_COMPS];
+		handle_id_t comp[ROUTE_CACHE_COMPS];
+		handle_id_t start[ROUTE_CACHE_HALTS];
+		handle_id_t end[ROUTE_CACHE_HALTS];
+		halthandle_t ziel;
+		halthandle_t zwischenziel;
+		halthandle_t return_ziel;
+		halthandle_t return_zwischenziel;
+		uint8 start_count;
+		uint8 end_count;
+		uint8 comp_count;
+		uint8 catg_idx;
+		uint8 ware_idx;
+		bool avoid_overcrowding;
+		uint8 result;
+	};
 
 	/**
-	 * Remember last route search start and catg to resume search
+	 * All data of a route search (halt data, open list, markers, resume state and route cache).
+	 * Searches with different contexts can run at the same time.
 	 */
-	static halthandle_t last_search_origin;
-	static uint8        last_search_ware_catg_idx;
+	struct search_context_t;
+
+	// one context for each thread, a thread must only search with its own
+	static search_context_t search_contexts[MAX_THREADS];
+
+	/// a new halt has no search data yet, so it counts as processed in the current search of all contexts
+	static void mark_in_search_contexts( halthandle_t halt );
+
+	// increased to invalidate all cached routes
+	static uint32 route_cache_epoch;
+
+	// increased whenever a halt changes its overcrowded state
+	static uint32 overcrowded_epoch;
+
+	// increased when a halt of this connected component rebuilds its connections
+	// (one entry for each halt id, resized when rebuilding the components)
+	static array_tpl<uint32> comp_version;
+
+	/// remembers that a search depends on this connected component
+	static void add_route_cache_comp( route_cache_entry_t &entry, handle_id_t comp );
+
+	static bool is_route_cache_hit( const route_cache_entry_t &entry, const halthandle_t *const start_halts, const uint16 start_halt_count, const vector_tpl<halthandle_t> &end_halts, const uint8 ware_catg_idx, const bool no_routing_over_overcrowding, const uint8 ware_idx );
+
+	/// sets the route of a search result to ware (and return_ware)
+	static int apply_route_result( const route_cache_entry_t &entry, ware_t &ware, ware_t *const return_ware );
 	
-	// data structure of departure_slot_table below.
+	// data structure of the departure slot tables below.
 	struct departure_t{
 		uint32 arr_tick; // ticks of arrival
 		uint32 dep_tick; // ticks of departure
 		uint32 exp_tick; // expiration ticks of the slot. used only for table clean up.
 		uint8 stop_index; // stop index where the departure slot is requested.
+		handle_id_t line_id; // line of the convoy when the slot was booked
 		convoihandle_t cnv;
 		
-		departure_t(uint32 a, uint32 d, uint32 e, uint8 i, convoihandle_t c) : 
-		arr_tick(a), dep_tick(d), exp_tick(e), stop_index(i), cnv(c) {}
+		departure_t(uint32 a, uint32 d, uint32 e, uint8 i, handle_id_t l, convoihandle_t c) : 
+		arr_tick(a), dep_tick(d), exp_tick(e), stop_index(i), line_id(l), cnv(c) {}
 		departure_t() {};
+		
+		/// the key of departure_slots: the slot (line, stop index, departure); only the lower 24 bits of the line id are used
+		uint64 get_slot_key() const { return ((uint64)line_id << 40) | ((uint64)stop_index << 32) | dep_tick; }
+		/// the key of convoy_departures: departures of a convoy
+		uint64 get_convoy_key() const { return ((uint64)cnv.get_id() << 32) | dep_tick; }
+		
+		static bool slot_order(const departure_t &a, const departure_t &b) { return a.get_slot_key() < b.get_slot_key(); }
+		static bool convoy_order(const departure_t &a, const departure_t &b) { return a.get_convoy_key() < b.get_convoy_key(); }
 	};
 	
-	/*
-	 * Table to hold scheduled departure time of convoy.
-	 * Treated like hash table that allows hash collision.
-	 */
-	slist_tpl<departure_t> departure_slot_table[DST_SIZE];
+	/// booked departures, ordered by get_slot_key()
+	vector_tpl<departure_t> departure_slots;
+	
+	/// the same departures, ordered by get_convoy_key()
+	vector_tpl<departure_t> convoy_departures;
+	
+	/// @returns the index of the first departure with a key not less than @p key
+	static uint32 find_departure( const vector_tpl<departure_t> &departures, uint64 key, bool by_convoy );
+	
+	/// removes the departure of @p cnv at @p dep_tick from both tables
+	bool remove_departure( convoihandle_t cnv, uint32 dep_tick, bool only_expired );
+	
+	/// sorts the departures read from a savegame, once all convoys know their lines
+	void finish_departures_rd();
+	
+	struct departure_expiry_t {
+		uint32 exp_tick;
+		uint32 dep_tick;
+		halthandle_t halt;
+		convoihandle_t cnv;
+		
+		static bool expires_later(const departure_expiry_t &a, const departure_expiry_t &b) { return a.exp_tick > b.exp_tick; }
+	};
+	
+	/// expiry of all departure slots of all halts, a heap ordered by exp_tick
+	static vector_tpl<departure_expiry_t> departure_expiry;
+	
+	/// removes all expired departure slots
+	static void sweep_departures();
 	
 public:
 	enum routing_result_flags {
@@ -548,16 +680,29 @@ public:
 	 * for reverse routing, also the next to last stop can be added, if next_to_ziel!=NULL
 	 *
 	 * if avoid_overcrowding is set, a valid route in only found when there is no overflowing stop in between
+	 *
+	 * Different threads may search at the same time with their own thread_num,
+	 * as long as nobody changes the halts meanwhile.
 	 */
-	static int search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware=NULL );
+	static int search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware=NULL, const uint8 thread_num=0 );
 
 	/**
 	 * A separate version of route searching code for re-calculating routes
 	 * Search is resumable, that is if called for the same halt and same goods category
 	 * it reuses search history from last search
 	 * It is faster than calling the above version on each packet, and is used for re-routing packets from the same halt.
+	 * Like search_route(), different threads may search at the same time with their own thread_num.
 	 */
-	void search_route_resumable( ware_t &ware );
+	void search_route_resumable( ware_t &ware, const uint8 thread_num=0 );
+
+	/// invalidates all results of search_route() cached so far
+	static void invalidate_route_cache();
+
+	/// changes whenever any halt changes its overcrowded state
+	static uint32 get_overcrowded_epoch() { return overcrowded_epoch; }
+
+	/// sums the lookups of the route cache of search_route() in all threads
+	static void get_route_cache_stats( uint64 &hits, uint64 &misses );
 
 	bool get_pax_enabled()  const { return enables & PAX;  }
 	bool get_mail_enabled() const { return enables & POST; }
@@ -740,6 +885,13 @@ public:
 
 	void finish_rd();
 
+	/**
+	 * Fixes the destinations of the waiting goods after loading.
+	 * Only reads the world, so it can run in parallel for different halts.
+	 * Done by finish_rd() for old games, where it may create halts.
+	 */
+	void finish_cargo_rd();
+
 	/**
 	 * Called before savegame will be loaded.
 	 * Creates all_koords table.
@@ -757,12 +909,12 @@ public:
 	/**
 	 * called, if a line serves this stop
 	 */
-	void add_line(linehandle_t line) { registered_lines.append_unique(line); }
+	void add_line(linehandle_t line) { registered_lines.append_unique(line); request_reconnect(); }
 
 	/**
 	 * called, if a line removes this stop from it's schedule
 	 */
-	void remove_line(linehandle_t line) { registered_lines.remove(line); }
+	void remove_line(linehandle_t line) { registered_lines.remove(line); request_reconnect(); }
 
 	/**
 	 * list of line ids that serve this stop
@@ -772,12 +924,12 @@ public:
 	/**
 	 * Register a lineless convoy which serves this stop
 	 */
-	void add_convoy(convoihandle_t convoy) { registered_convoys.append_unique(convoy); }
+	void add_convoy(convoihandle_t convoy) { registered_convoys.append_unique(convoy); request_reconnect(); }
 
 	/**
 	 * Unregister a lineless convoy
 	 */
-	void remove_convoy(convoihandle_t convoy) { registered_convoys.remove(convoy); }
+	void remove_convoy(convoihandle_t convoy) { registered_convoys.remove(convoy); request_reconnect(); }
 
 	/**
 	 * A list of lineless convoys serving this stop
@@ -32,6 +32,23 @@ void intr_set_last_time(uint32 time);
 
 void intr_enable();
 void intr_disable();
+bool intr_is_enabled();
+
+/**
+ * Disables the interrupts (i.e. sync_step) for its lifetime, e.g. while worker threads read the world.
+ * Afterwards they are only enabled again, if they were enabled before.
+ */
+class intr_disable_scope_t
+{
+	const bool was_enabled;
+
+	intr_disable_scope_t(const intr_disable_scope_t &);
+	intr_disable_scope_t &operator=(const intr_disable_scope_t &);
+
+public:
+	intr_disable_scope_t() : was_enabled( intr_is_enabled() ) { intr_disable(); }
+	~intr_disable_scope_t() { if(  was_enabled  ) { intr_enable(); } }
+};
 
 
 void interrupt_check(const char* caller_info = "0");
@@ -65,7 +65,7 @@ void simlinemgmt_t::update_line(linehandle_t line)
 	// finally de/register all stops
 	line->renew_stops();
 	if(  count>0  ) {
-		world()->set_schedule_counter();
+		world()->set_schedule_counter( line->get_schedule(), line->get_owner() );
 	}
 }
 
@@ -28,6 +28,7 @@
 #include "gui/gui_theme.h"
 #include "gui/messagebox.h"
 #include "simhalt.h"
+#include "simconvoi.h"
 #include "display/simimg.h"
 #include "simcolor.h"
 #include "simskin.h"
@@ -73,9 +74,11 @@
 #include "dataobj/environment.h"
 #include "dataobj/tabfile.h"
 #include "dataobj/scenario.h"
+#include "dataobj/schedule.h"
 #include "dataobj/settings.h"
 #include "dataobj/translator.h"
 #include "dataobj/repositioning.h"
+#include "dataobj/freelist.h"
 #include "network/pakset_info.h"
 #include "network/otrp_log_sender.h"
 
@@ -88,7 +91,9 @@
 
 #include "utils/cbuffer_t.h"
 #include "utils/simrandom.h"
+#include "utils/step_profiler.h"
 
+#include "bauer/goods_manager.h"
 #include "bauer/vehikelbauer.h"
 #include "script/script_tool_manager.h"
 
@@ -96,6 +101,7 @@
 #include "vehicle/simroadtraffic.h"
 
 
+
 using std::string;
 
 
@@ -218,6 +224,172 @@ static void show_times(karte_t *welt, main_view_t *view)
 #endif
 
 
+/**
+ * Runs the loaded world for a number of months as fast as possible (like fast forward,
+ * but without interrupts and display) and prints the timings and the final checklist.
+ * Since the ticks per step are fixed, two runs of the same savegame must end with the same checklist.
+ */
+static void run_benchmark(karte_t *welt, uint32 months)
+{
+	intr_disable();
+	welt->set_fast_forward(true);
+
+	const uint32 start_month = welt->get_current_month();
+	const uint32 end_month = start_month + months;
+	const uint32 start_ticks = welt->get_ticks();
+	const uint32 start_ms = dr_time();
+
+	printf( "Benchmark: %u months from %04u-%02u\n", months, start_month/12, start_month%12+1 );
+
+	uint32 month = start_month;
+	uint32 month_start_ms = start_ms;
+	uint32 max_month_ms = 0;
+	while(  welt->get_current_month() < end_month  &&  !env_t::quit_simutrans  ) {
+		welt->sync_step( 100, true, false );
+		set_random_mode( STEP_RANDOM );
+		welt->step();
+		clear_random_mode( STEP_RANDOM );
+
+		if(  welt->get_current_month() != month  ) {
+			const uint32 now = dr_time();
+			printf( "  month %04u-%02u: %u ms\n", month/12, month%12+1, now - month_start_ms );
+			max_month_ms = max( max_month_ms, now - month_start_ms );
+			month = welt->get_current_month();
+			month_start_ms = now;
+		}
+	}
+
+	const uint32 total_ms = max( dr_time() - start_ms, 1u );
+	const uint32 total_ticks = welt->get_ticks() - start_ticks;
+	const uint32 done_months = max( welt->get_current_month() - start_month, 1u );
+
+	char checklist[256];
+	checklist_t( get_random_seed(), halthandle_t::get_next_check(), linehandle_t::get_next_check(), convoihandle_t::get_next_check() ).print( checklist, "final" );
+
+	printf( "Benchmark: %u ticks in %u ms, %.0f ticks/s\n", total_ticks, total_ms, (double)total_ticks * 1000.0 / total_ms );
+	printf( "Benchmark: %u ms/month (max %u ms)\n", total_ms / done_months, max_month_ms );
+	uint64 hits, misses;
+	haltestelle_t::get_route_cache_stats( hits, misses );
+	printf( "Benchmark: route cache %llu hits, %llu misses\n", (unsigned long long)hits, (unsigned long long)misses );
+	printf( "Benchmark: %s\n", checklist );
+	dbg->message( "run_benchmark()", "%u ticks in %u ms, %u ms/month, %s", total_ticks, total_ms, total_ms / done_months, checklist );
+
+	welt->set_fast_forward(false);
+}
+
+
+/**
+ * The halts a convoy at stop @p current of its schedule can load for, like convoi_t::hat_gehalten()
+ * (for a plain schedule: all halts up to the next visit of the current one)
+ */
+static void bench_destination_halts(const convoi_t *cnv, uint8 current, vector_tpl<halthandle_t> &destination_halts)
+{
+	const schedule_t *schedule = cnv->get_schedule();
+	const halthandle_t halt = haltestelle_t::get_halt( schedule->entries[current].pos, cnv->get_owner() );
+	destination_halts.clear();
+	for(  uint8 i = 1;  i < schedule->get_count();  i++  ) {
+		const halthandle_t plan_halt = haltestelle_t::get_halt( schedule->entries[(current + i) % schedule->get_count()].pos, cnv->get_owner() );
+		if(  plan_halt == halt  ) {
+			break;
+		}
+		if(  plan_halt.is_bound()  ) {
+			destination_halts.append( plan_halt );
+		}
+	}
+}
+
+
+/**
+ * Times vehicle_t::unload_cargo() and vehicle_t::load_cargo() for the passenger convoy
+ * of the loaded game with the most vehicles, as if it stopped @p stops times along its schedule.
+ * After unloading, the halt gets as many passengers for the halts ahead as fit in;
+ * only the unload and load calls are timed.
+ */
+static void run_cargo_benchmark(karte_t *welt, uint32 stops)
+{
+	// the fixture: the longest convoy for passengers with at least two halts to go between
+	convoihandle_t cnv;
+	FOR( vector_tpl<convoihandle_t>, const c, welt->convoys() ) {
+		if(  c->get_vehicle_count() > 0  &&  c->get_schedule()  &&  c->get_schedule()->get_count() >= 2  &&  c->get_vehikel(0)->get_cargo_type() == goods_manager_t::passengers
+			&&  (!cnv.is_bound()  ||  c->get_vehicle_count() > cnv->get_vehicle_count())  ) {
+			vector_tpl<halthandle_t> destination_halts;
+			bench_destination_halts( c.get_rep(), 0, destination_halts );
+			if(  !destination_halts.empty()  ) {
+				cnv = c;
+			}
+		}
+	}
+	if(  !cnv.is_bound()  ) {
+		printf( "Benchmark: no convoy for passengers with two halts in the loaded game\n" );
+		return;
+	}
+
+	uint32 capacity = 0;
+	for(  uint8 v = 0;  v < cnv->get_vehicle_count();  v++  ) {
+		if(  cnv->get_vehikel(v)->get_cargo_type() == goods_manager_t::passengers  ) {
+			capacity += cnv->get_vehikel(v)->get_cargo_max();
+		}
+	}
+	printf( "Benchmark: %u stops of convoy \"%s\" with %u vehicles for %u passengers\n", stops, cnv->get_name(), cnv->get_vehicle_count(), capacity );
+
+	// arriving passengers would walk off as pedestrians
+	const bool show_pax = welt->get_settings().get_show_pax();
+	welt->get_settings().set_show_pax( false );
+
+	vector_tpl<halthandle_t> destination_halts;
+	const schedule_t *schedule = cnv->get_schedule();
+	uint32 seed = 12345;
+	uint64 loaded = 0, unloaded = 0, unload_us = 0, load_us = 0;
+	for(  uint32 stop = 0;  stop < stops;  stop++  ) {
+		const uint8 current = stop % schedule->get_count();
+		const halthandle_t halt = haltestelle_t::get_halt( schedule->entries[current].pos, cnv->get_owner() );
+		if(  !halt.is_bound()  ) {
+			continue;
+		}
+		bench_destination_halts( cnv.get_rep(), current, destination_halts );
+
+		uint64 start_us = step_profiler_t::get_time_us();
+		for(  uint8 v = 0;  v < cnv->get_vehicle_count();  v++  ) {
+			unloaded += cnv->get_vehikel(v)->unload_cargo( halt, false );
+		}
+		unload_us += step_profiler_t::get_time_us() - start_us;
+
+		// as many passengers as fit in, in packets of up to 8, each to a random tile of a halt ahead
+		uint32 free_capacity = capacity;
+		for(  uint8 v = 0;  v < cnv->get_vehicle_count();  v++  ) {
+			if(  cnv->get_vehikel(v)->get_cargo_type() == goods_manager_t::passengers  ) {
+				free_capacity -= cnv->get_vehikel(v)->get_total_cargo();
+			}
+		}
+		for(  uint32 pax = 0;  pax < free_capacity  &&  !destination_halts.empty();  ) {
+			seed = seed * 1103515245u + 12345u;
+			const halthandle_t ziel = destination_halts[ (seed >> 8) % destination_halts.get_count() ];
+			const slist_tpl<haltestelle_t::tile_t> &tiles = ziel->get_tiles();
+			ware_t ware( goods_manager_t::passengers );
+			ware.menge = 1 + (seed >> 20) % 8;
+			ware.set_ziel( ziel );
+			ware.set_zwischenziel( ziel );
+			ware.set_zielpos( tiles.at( (seed >> 12) % tiles.get_count() ).grund->get_pos().get_2d() );
+			halt->starte_mit_route( ware );
+			pax += ware.menge;
+		}
+
+		start_us = step_profiler_t::get_time_us();
+		for(  uint8 v = 0;  v < cnv->get_vehicle_count();  v++  ) {
+			loaded += cnv->get_vehikel(v)->load_cargo( halt, destination_halts );
+		}
+		load_us += step_profiler_t::get_time_us() - start_us;
+	}
+
+	welt->get_settings().set_show_pax( show_pax );
+
+	printf( "Benchmark: unload_cargo %llu us for %llu passengers, load_cargo %llu us for %llu passengers\n",
+		(unsigned long long)unload_us, (unsigned long long)unloaded, (unsigned long long)load_us, (unsigned long long)loaded );
+	printf( "Benchmark: %.2f us per stop\n", (double)(unload_us + load_us) / max( stops, 1u ) );
+	dbg->message( "run_cargo_benchmark()", "%u stops: unload %llu us, load %llu us", stops, (unsigned long long)unload_us, (unsigned long long)load_us );
+}
+
+
 // some routines for the modal display
 static bool never_quit() { return false; }
 static bool no_language() { return translator::get_language()!=-1; }
@@ -388,6 +560,7 @@ void print_help()
 		" -objects DIR_NAME/  load the pakset in specified directory\n"
 		" -pause              starts game with paused after loading\n"
 		"                     a server will pause if there are no clients\n"
+		" -profile FILE       writes step timings to FILE (monthly and on exit)\n"
 		" -res N              starts in specified resolution: \n"
 		"                      1=640x480, 2=800x600, 3=1024x768, 4=1280x1024\n"
 		" -scenario NAME      Load scenario NAME\n"
@@ -395,6 +568,10 @@ void print_help()
 		" -server [PORT]      starts program as server (for network game)\n"
 		"                     without port specified uses 13353\n"
 		" -announce           Enable server announcements\n"
+		" -bench MONTHS       runs the loaded game for MONTHS months as fast as possible\n"
+		"                     and prints the timings (use with -load)\n"
+		" -bench_cargo [N]    times loading and unloading of the longest passenger convoy\n"
+		"                     at N stops and quits (use with -load)\n"
 		" -autodpi            Automatic screen scaling for high DPI screens\n"
 		" -screen_scale N     Manual screen scaling to N percent (0=off)\n"
 		"                     Ignored when -autodpi is specified\n"
@@ -407,6 +584,8 @@ void print_help()
 		" -sizes              Show current size of some structures\n"
 #endif
 		" -startyear N        start in year N\n"
+		" -test_blend         checks the SIMD drawing routines against the scalar ones\n"
+		"                     and quits (use with -debug 3 to see the result)\n"
 		" -theme N            user directory containing theme files\n"
 #ifdef MULTI_THREAD
 		" -threads N          use N threads if possible\n"
@@ -587,6 +766,11 @@ int simu_main(int argc, char** argv)
 
 	setup_logging(args);
 
+	if(  args.has_arg("-test_blend")  ) {
+		// does not need the graphics or any data
+		return display_test_simd_blend() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	// now read last setting (might be overwritten by the tab-files)
 	{
 		loadsave_t settings_file;
@@ -1235,6 +1419,10 @@ int simu_main(int argc, char** argv)
 	bool new_world = true;
 	std::string loadgame;
 
+	if(  const char *profile_file = args.gimme_arg("-profile", 1)  ) {
+		step_profiler_t::set_report_file( profile_file );
+	}
+
 	bool pause_after_load = false;
 	if(  args.has_arg("-pause")  ) {
 		if( env_t::server ) {
@@ -1560,6 +1748,19 @@ int simu_main(int argc, char** argv)
 	}
 #endif
 
+	// time the loaded game and quit
+	if(  const char *bench = args.gimme_arg("-bench", 1)  ) {
+		run_benchmark( welt, max( atoi(bench), 1 ) );
+		env_t::quit_simutrans = true;
+	}
+
+	// time loading and unloading of a convoy of the loaded game and quit
+	if(  args.has_arg("-bench_cargo")  ) {
+		const char *stops = args.gimme_arg("-bench_cargo", 1);
+		run_cargo_benchmark( welt, stops ? max( atoi(stops), 1 ) : 20000 );
+		env_t::quit_simutrans = true;
+	}
+
 	welt->reset_timer();
 	if(  !env_t::networkmode  &&  !env_t::server  ) {
 #ifdef display_in_main
@@ -1649,6 +1850,7 @@ int simu_main(int argc, char** argv)
 	intr_disable();
 	
 	log_sender.save_statistics();
+	step_profiler_t::write_report();
 
 	// save settings
 	{
@@ -1681,6 +1883,8 @@ int simu_main(int argc, char** argv)
 
 	close_midi();
 
+	freelist_pool_t::dump_statistics();
+
 #if 0
 	// free all list memories (not working, since there seems to be unitialized list still waiting for automated destruction)
 	freelist_t::free_all_nodes();
@@ -174,6 +174,7 @@ enum {
 	DIALOG_LIST_VEHICLE,
 	DIALOG_SCRIPT_TOOL,
 	DIALOG_EDIT_GROUNDOBJ,
+	DIALOG_STEP_PROFILER,
 	DIALOGE_TOOL_COUNT,
 	DIALOGE_TOOL = 0x4000
 };
@@ -93,7 +93,7 @@ void planquadrat_t::boden_hinzufuegen(grund_t *bd)
 		// completely empty
 		data.one = bd;
 		ground_size = 1;
-		minimap_t::get_instance()->calc_map_pixel(bd->get_pos().get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(bd->get_pos().get_2d());
 		return;
 	}
 	else if(ground_size==1) {
@@ -109,7 +109,7 @@ DBG_MESSAGE("planquadrat_t::boden_hinzufuegen()","addition ground %s at (%i,%i,%
 		tmp[1] = bd;
 		data.some = tmp;
 		ground_size = 2;
-		minimap_t::get_instance()->calc_map_pixel(bd->get_pos().get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(bd->get_pos().get_2d());
 		return;
 	}
 	else {
@@ -138,7 +138,7 @@ DBG_MESSAGE("planquadrat_t::boden_hinzufuegen()","addition ground %s at (%i,%i,%
 		ground_size ++;
 		delete [] data.some;
 		data.some = tmp;
-		minimap_t::get_instance()->calc_map_pixel(bd->get_pos().get_2d());
+		minimap_t::get_instance()->invalidate_map_pixel(bd->get_pos().get_2d());
 	}
 }
 
@@ -191,7 +191,7 @@ void planquadrat_t::kartenboden_setzen(grund_t *bd, bool startup)
 		// water tiles need neighbor tiles, which might not be initialized at startup
 		bd->calc_image();
 	}
-	minimap_t::get_instance()->calc_map_pixel(bd->get_pos().get_2d());
+	minimap_t::get_instance()->invalidate_map_pixel(bd->get_pos().get_2d());
 }
 
 
@@ -374,7 +374,7 @@ void planquadrat_t::abgesenkt()
 			}
 		}
 		else {
-			minimap_t::get_instance()->calc_map_pixel(k);
+			minimap_t::get_instance()->invalidate_map_pixel(k);
 		}
 		gr->set_grund_hang( slope );
 	}
@@ -415,7 +415,7 @@ void planquadrat_t::angehoben()
 			}
 		}
 		else {
-			minimap_t::get_instance()->calc_map_pixel(k);
+			minimap_t::get_instance()->invalidate_map_pixel(k);
 		}
 	}
 }
@@ -50,6 +50,7 @@
 #include "gui/depotlist_frame.h"
 #include "gui/vehiclelist_frame.h"
 #include "gui/script_tool_frame.h"
+#include "gui/step_profiler_frame.h"
 
 #include "obj/baum.h"
 #include "obj/groundobj.h"
@@ -541,6 +542,21 @@ public:
 	bool is_work_network_safe() const OVERRIDE{ return true; }
 };
 
+/* timings of the simulation steps */
+class dialog_step_profiler_t : public tool_t {
+public:
+	dialog_step_profiler_t() : tool_t(DIALOG_STEP_PROFILER | DIALOGE_TOOL) {}
+	char const* get_tooltip(player_t const*) const OVERRIDE{ return translator::translate("Step profiler"); }
+	bool is_selected() const OVERRIDE{ return win_get_magic(magic_step_profiler); }
+	bool init(player_t*) OVERRIDE{
+		create_win(new step_profiler_frame_t(), w_info, magic_step_profiler);
+		return false;
+	}
+	bool exit(player_t*) OVERRIDE{ destroy_win(magic_step_profiler); return false; }
+	bool is_init_network_safe() const OVERRIDE{ return true; }
+	bool is_work_network_safe() const OVERRIDE{ return true; }
+};
+
 // to increase map-size
 class dialog_enlarge_map_t : public tool_t{
 public:
@@ -27,9 +27,9 @@
 #define SIM_SERVER_MINOR    0
 // NOTE: increment before next release to enable save/load of new features
 
-#define OTRP_VERSION_MAJOR 33
-#define OTRP_VERSION_MINOR 2
-#define OTRP_VERSION_PATCH 5
+#define OTRP_VERSION_MAJOR 35
+#define OTRP_VERSION_MINOR 0
+#define OTRP_VERSION_PATCH 0
 // NOTE: increment OTRP_VERSION_MAJOR when the save data structure changes.
 
 #define MAKEOBJ_VERSION "60.5"
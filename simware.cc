@@ -91,16 +91,16 @@ void ware_t::rdwr(loadsave_t *file)
 	if(file->is_version_atleast(110, 6)) {
 		// save halt id directly
 		if(file->is_saving()) {
-			uint16 halt_id = ziel.is_bound() ? ziel.get_id() : 0;
-			file->rdwr_short(halt_id);
+			uint32 halt_id = ziel.is_bound() ? ziel.get_id() : 0;
+			file->rdwr_handle_id(halt_id);
 			halt_id = zwischenziel.is_bound() ? zwischenziel.get_id() : 0;
-			file->rdwr_short(halt_id);
+			file->rdwr_handle_id(halt_id);
 		}
 		else {
-			uint16 halt_id;
-			file->rdwr_short(halt_id);
+			uint32 halt_id = 0;
+			file->rdwr_handle_id(halt_id);
 			ziel.set_id(halt_id);
-			file->rdwr_short(halt_id);
+			file->rdwr_handle_id(halt_id);
 			zwischenziel.set_id(halt_id);
 		}
 
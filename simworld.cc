@@ -77,6 +77,8 @@
 #include "dataobj/translator.h"
 #include "dataobj/loadsave.h"
 #include "dataobj/marker.h"
+#include "dataobj/route_graph.h"
+#include "dataobj/block_graph.h"
 #include "dataobj/scenario.h"
 #include "dataobj/settings.h"
 #include "dataobj/environment.h"
@@ -86,6 +88,7 @@
 #include "utils/cbuffer_t.h"
 #include "utils/simrandom.h"
 #include "utils/simstring.h"
+#include "utils/step_profiler.h"
 
 #include "network/memory_rw.h"
 
@@ -141,6 +144,10 @@ typedef struct{
 	sem_t* wait_for_previous;
 	sem_t* signal_to_next;
 	xy_loop_func function;
+	bool chunks; // call function chunk by chunk instead of in x_step columns
+	index_loop_func index_function; // if set, called once with index_min, index_max instead of function
+	uint32 index_min;
+	uint32 index_max;
 	bool keep_running;
 } world_thread_param_t;
 
@@ -156,9 +163,18 @@ void *karte_t::world_xy_loop_thread(void *ptr)
 	do {
 		simthread_barrier_wait( &world_barrier_start ); // wait for all to start
 
+		if(  param->index_function  ) {
+			(param->welt->*(param->index_function))(param->index_min, param->index_max, param->thread_num);
+		}
+
 		sint16 x_min = 0;
 		sint16 x_max = param->x_step;
 
+		if(  param->function  &&  param->chunks  ) {
+			param->welt->world_chunk_loop( param->function, param->x_world_max, param->y_min, param->y_max );
+			x_min = param->x_world_max;
+		}
+
 		while(  x_min < param->x_world_max  ) {
 			// wait for predecessor to finish its block
 			if(  param->wait_for_previous  ) {
@@ -183,7 +199,78 @@ void *karte_t::world_xy_loop_thread(void *ptr)
 
 	return NULL;
 }
+
+
+// starts the worker threads on first use; they wait at world_barrier_start for work afterwards
+static void spawn_world_threads(void *(*thread_function)(void *))
+{
+	if(  !spawned_world_threads  ) {
+		// we can do the parallel display using posix threads ...
+		pthread_t thread[MAX_THREADS];
+		/* Initialize and set thread detached attribute */
+		pthread_attr_t attr;
+		pthread_attr_init( &attr );
+		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+		// init barrier
+		simthread_barrier_init( &world_barrier_start, NULL, env_t::num_threads );
+		simthread_barrier_init( &world_barrier_end, NULL, env_t::num_threads );
+
+		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
+			if(  pthread_create( &thread[t], &attr, thread_function, (void *)&world_thread_param[t] )  ) {
+				dbg->fatal( "karte_t::world_xy_loop()", "cannot multithread, error at thread #%i", t+1 );
+			}
+		}
+		spawned_world_threads = true;
+		pthread_attr_destroy( &attr );
+	}
+}
+#endif
+
+
+void karte_t::world_index_loop(index_loop_func function, uint32 count)
+{
+#ifdef MULTI_THREAD
+	set_random_mode( INTERACTIVE_RANDOM ); // do not allow simrand() here!
+
+	for(  int t = 0;  t < env_t::num_threads;  t++  ) {
+		world_thread_param[t].welt = this;
+		world_thread_param[t].thread_num = t;
+		world_thread_param[t].x_step = 0;
+		world_thread_param[t].x_world_max = 0;
+		world_thread_param[t].y_min = 0;
+		world_thread_param[t].y_max = 0;
+		world_thread_param[t].function = NULL;
+		world_thread_param[t].chunks = false;
+		world_thread_param[t].index_function = function;
+		world_thread_param[t].index_min = (uint32)(((uint64)t * count) / env_t::num_threads);
+		world_thread_param[t].index_max = (uint32)(((uint64)(t + 1) * count) / env_t::num_threads);
+		world_thread_param[t].wait_for_previous = NULL;
+		world_thread_param[t].signal_to_next = NULL;
+		world_thread_param[t].keep_running = t < env_t::num_threads - 1;
+	}
+
+	spawn_world_threads( world_xy_loop_thread );
+
+	// and start processing; the last we can run ourselves
+	world_xy_loop_thread(&world_thread_param[env_t::num_threads-1]);
+
+	clear_random_mode( INTERACTIVE_RANDOM );
+#else
+	(this->*function)( 0, count, 0 );
 #endif
+}
+
+
+void karte_t::world_chunk_loop(xy_loop_func function, sint16 x_max, sint16 y_min, sint16 y_max)
+{
+	// in the order of plan: rows of chunks
+	const int chunk_size = 1 << PLAN_CHUNK_SHIFT;
+	for(  int y = y_min;  y < y_max;  y += chunk_size  ) {
+		for(  int x = 0;  x < x_max;  x += chunk_size  ) {
+			(this->*function)( x, min( x + chunk_size, (int)x_max ), y, min( y + chunk_size, (int)y_max ) );
+		}
+	}
+}
 
 
 void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
@@ -191,6 +278,8 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 	const bool use_grids = (flags & GRIDS_FLAG) == GRIDS_FLAG;
 	uint16 max_x = use_grids?(cached_grid_size.x+1):cached_grid_size.x;
 	uint16 max_y = use_grids?(cached_grid_size.y+1):cached_grid_size.y;
+	// single tile chunks (i.e. the tiles stored row by row) are better done in one go
+	const bool chunks = PLAN_CHUNK_SHIFT > 0  &&  (flags & CHUNKS_FLAG) == CHUNKS_FLAG;
 #ifdef MULTI_THREAD
 	set_random_mode( INTERACTIVE_RANDOM ); // do not allow simrand() here!
 
@@ -208,9 +297,19 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 		world_thread_param[t].thread_num = t;
 		world_thread_param[t].x_step = sync_x_steps ? min( 64, max_x / env_t::num_threads ) : max_x;
 		world_thread_param[t].x_world_max = max_x;
-		world_thread_param[t].y_min = (t * max_y) / env_t::num_threads;
-		world_thread_param[t].y_max = ((t + 1) * max_y) / env_t::num_threads;
+		if(  chunks  ) {
+			// whole rows of chunks for each thread
+			const uint32 chunk_rows = get_plan_chunks( max_y );
+			world_thread_param[t].y_min = min( (uint32)max_y, ((t * chunk_rows) / env_t::num_threads) << PLAN_CHUNK_SHIFT );
+			world_thread_param[t].y_max = min( (uint32)max_y, (((t + 1) * chunk_rows) / env_t::num_threads) << PLAN_CHUNK_SHIFT );
+		}
+		else {
+			world_thread_param[t].y_min = (t * max_y) / env_t::num_threads;
+			world_thread_param[t].y_max = ((t + 1) * max_y) / env_t::num_threads;
+		}
 		world_thread_param[t].function = function;
+		world_thread_param[t].chunks = chunks;
+		world_thread_param[t].index_function = NULL;
 
 		world_thread_param[t].wait_for_previous = sync_x_steps  &&  t > 0 ? &sems[t-1] : NULL;
 		world_thread_param[t].signal_to_next    = sync_x_steps  &&  t < env_t::num_threads - 1 ? &sems[t] : NULL;
@@ -218,25 +317,7 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 		world_thread_param[t].keep_running = t < env_t::num_threads - 1;
 	}
 
-	if(  !spawned_world_threads  ) {
-		// we can do the parallel display using posix threads ...
-		pthread_t thread[MAX_THREADS];
-		/* Initialize and set thread detached attribute */
-		pthread_attr_t attr;
-		pthread_attr_init( &attr );
-		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
-		// init barrier
-		simthread_barrier_init( &world_barrier_start, NULL, env_t::num_threads );
-		simthread_barrier_init( &world_barrier_end, NULL, env_t::num_threads );
-
-		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
-			if(  pthread_create( &thread[t], &attr, world_xy_loop_thread, (void *)&world_thread_param[t] )  ) {
-				dbg->fatal( "karte_t::world_xy_loop()", "cannot multithread, error at thread #%i", t+1 );
-			}
-		}
-		spawned_world_threads = true;
-		pthread_attr_destroy( &attr );
-	}
+	spawn_world_threads( world_xy_loop_thread );
 
 	// and start processing; the last we can run ourselves
 	world_xy_loop_thread(&world_thread_param[env_t::num_threads-1]);
@@ -252,7 +333,12 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 
 #else
 	// slow serial way of display
-	(this->*function)( 0, max_x, 0, max_y );
+	if(  chunks  ) {
+		world_chunk_loop( function, max_x, 0, max_y );
+	}
+	else {
+		(this->*function)( 0, max_x, 0, max_y );
+	}
 #endif
 }
 
@@ -393,6 +479,7 @@ void karte_t::destroy()
 {
 	is_sound = false; // karte_t::play_sound_area_clipped needs valid zeiger (pointer/drawer)
 	destroying = true;
+	rollover_pending = false;
 	DBG_MESSAGE("karte_t::destroy()", "destroying world");
 
 	uint32 max_display_progress = 256+stadt.get_count()*10 + haltestelle_t::get_alle_haltestellen().get_count() + convoi_array.get_count() + (cached_size.x*cached_size.y)*2;
@@ -480,6 +567,8 @@ void karte_t::destroy()
 	cached_size.x = cached_size.y = 0;
 	delete [] plan;
 	plan = NULL;
+	route_graph_t::free();
+	block_graph_t::free();
 	DBG_MESSAGE("karte_t::destroy()", "planquadrat destroyed");
 
 	old_progress += (cached_size.x*cached_size.y)/2;
@@ -532,6 +621,9 @@ void karte_t::add_convoi(convoihandle_t const cnv)
 
 void karte_t::rem_convoi(convoihandle_t const cnv)
 {
+	if(  rollover_pending  &&  convoi_array.is_contained(cnv)  ) {
+		rollover_removed( ROLLOVER_CONVOIS, convoi_array.index_of(cnv) );
+	}
 	convoi_array.remove(cnv);
 }
 
@@ -561,6 +653,9 @@ bool karte_t::remove_city(stadt_t *s)
 	if(s->get_name()) {
 		DBG_MESSAGE("karte_t::remove_city()", "%s", s->get_name());
 	}
+	if(  rollover_pending  &&  stadt.is_contained(s)  ) {
+		rollover_removed( ROLLOVER_CITIES, stadt.index_of(s) );
+	}
 	stadt.remove(s);
 	DBG_DEBUG4("karte_t::remove_city()", "reduce city to %i", settings.get_city_count() - 1);
 	settings.set_city_count(settings.get_city_count() - 1);
@@ -591,7 +686,8 @@ void karte_t::init_tiles()
 
 	uint32 const x = get_size().x;
 	uint32 const y = get_size().y;
-	plan      = new planquadrat_t[x * y];
+	plan      = new planquadrat_t[get_plan_size(x, y)];
+	plan_chunks_x = get_plan_chunks(x);
 	grid_hgts = new sint8[(x + 1) * (y + 1)];
 	max_height = min_height = 0;
 	MEMZERON(grid_hgts, (x + 1) * (y + 1));
@@ -600,6 +696,7 @@ void karte_t::init_tiles()
 
 	win_set_world( this );
 	minimap_t::get_instance()->init();
+	route_graph_t::reset( get_size() );
 
 	for(int i=0; i<MAX_PLAYER_COUNT ; i++) {
 		// old default: AI 3 passenger, other goods
@@ -625,6 +722,7 @@ void karte_t::init_tiles()
 	last_frame_idx = 0;
 	pending_season_change = 0;
 	pending_snowline_change = 0;
+	rollover_pending = false;
 
 	// init global history
 	for (int year=0; year<MAX_WORLD_HISTORY_YEARS; year++) {
@@ -1466,8 +1564,10 @@ void karte_t::create_lakes(  int xoff, int yoff, sint8 max_lake_height  )
 	delete [] new_stage;
 	delete [] local_stage;
 
-	for (planquadrat_t *pl = plan; pl < (plan + size_x * size_y); pl++) {
-		pl->correct_water();
+	for(  uint16 y = 0;  y < size_y;  y++  ) {
+		for(  uint16 x = 0;  x < size_x;  x++  ) {
+			access_nocheck(x,y)->correct_water();
+		}
 	}
 }
 
@@ -1762,7 +1862,8 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 		grund_t::enlarge_map( new_size_x, new_size_y );
 	}
 
-	planquadrat_t *new_plan = new planquadrat_t[new_size_x*new_size_y];
+	planquadrat_t *new_plan = new planquadrat_t[get_plan_size(new_size_x, new_size_y)];
+	const uint32 new_plan_chunks_x = get_plan_chunks(new_size_x);
 	sint8 *new_grid_hgts = new sint8[(new_size_x + 1) * (new_size_y + 1)];
 	sint8 *new_water_hgts = new sint8[new_size_x * new_size_y];
 
@@ -1779,6 +1880,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 	cached_size_max = max(cached_grid_size.x,cached_grid_size.y);
 	cached_size.x = cached_grid_size.x-1;
 	cached_size.y = cached_grid_size.y-1;
+	route_graph_t::reset( get_size() );
 
 	intr_disable();
 
@@ -1800,7 +1902,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 			for (sint16 ix = 0; ix<old_x; ix++) {
 				uint32 nr = ix+(iy*old_x);
 				uint32 nnr = ix+(iy*new_size_x);
-				swap(new_plan[nnr], plan[nr]);
+				swap(new_plan[get_plan_index(ix, iy, new_plan_chunks_x)], plan[plan_index(ix, iy)]);
 				new_water_hgts[nnr] = water_hgts[nr];
 			}
 		}
@@ -1820,6 +1922,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 
 	delete [] plan;
 	plan = new_plan;
+	plan_chunks_x = new_plan_chunks_x;
 	delete [] grid_hgts;
 	grid_hgts = new_grid_hgts;
 	delete [] water_hgts;
@@ -1975,7 +2078,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 	}
 	else {
 		// new world -> calculate all transitions
-		world_xy_loop(&karte_t::recalc_transitions_loop, 0);
+		world_xy_loop(&karte_t::recalc_transitions_loop, CHUNKS_FLAG);
 		ls.set_progress(16);
 	}
 
@@ -2101,6 +2204,11 @@ karte_t::karte_t() :
 	ticks_per_world_month_shift = 20;
 	ticks_per_world_month = (1 << ticks_per_world_month_shift);
 	last_step_ticks = 0;
+	rollover_pending = false;
+	rollover_players_done = false;
+	for(  int i=0;  i<MAX_ROLLOVER_LISTS;  i++  ) {
+		rollover_next[i] = rollover_end[i] = 0;
+	}
 	server_last_announce_time = 0;
 	last_interaction = dr_time();
 	step_mode = PAUSE_FLAG;
@@ -2128,6 +2236,7 @@ karte_t::karte_t() :
 
 	zeiger = NULL;
 	plan = 0;
+	plan_chunks_x = 0;
 
 	grid_hgts = 0;
 	water_hgts = 0;
@@ -3228,6 +3337,7 @@ sint8 karte_t::max_hgt(const koord k) const
 
 
 planquadrat_t *rotate90_new_plan;
+uint32 rotate90_new_plan_chunks_x;
 sint8 *rotate90_new_water;
 
 void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_max)
@@ -3238,8 +3348,8 @@ void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_
 			for(  int xx = x_min;  xx < x_max;  xx += LOOP_BLOCK  ) {
 				for(  int y = yy;  y < min(yy + LOOP_BLOCK, y_max);  y++  ) {
 					for(  int x = xx;  x < min(xx + LOOP_BLOCK, x_max);  x++  ) {
-						const int nr = x + (y * cached_grid_size.x);
-						const int new_nr = (cached_size.y - y) + (x * cached_grid_size.y);
+						const uint32 nr = plan_index( x, y );
+						const uint32 new_nr = get_plan_index( cached_size.y - y, x, rotate90_new_plan_chunks_x );
 						// first rotate everything on the ground(s)
 						for(  uint i = 0;  i < plan[nr].get_boden_count();  i++  ) {
 							plan[nr].get_boden_bei(i)->rotate90();
@@ -3261,8 +3371,8 @@ void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_
 					for(  int y=yy;  y < min(yy + LOOP_BLOCK, y_max);  y++  ) {
 						// rotate climate transitions
 						rotate_transitions( koord( x, y ) );
-						const int nr = x + (y * cached_grid_size.x);
-						const int new_nr = (cached_size.y - y) + (x * cached_grid_size.y);
+						const uint32 nr = plan_index( x, y );
+						const uint32 new_nr = get_plan_index( cached_size.y - y, x, rotate90_new_plan_chunks_x );
 						swap(rotate90_new_plan[new_nr], plan[nr]);
 					}
 				}
@@ -3273,7 +3383,7 @@ void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_
 			for(  int yy = y_min;  yy < y_max;  yy += LOOP_BLOCK  ) {
 				for(  int x = xx;  x < min(xx + LOOP_BLOCK, x_max);  x++  ) {
 					for(  int y = yy;  y < min(yy + LOOP_BLOCK, y_max);  y++  ) {
-						const int new_nr = (cached_size.y - y) + (x * cached_grid_size.y);
+						const uint32 new_nr = get_plan_index( cached_size.y - y, x, rotate90_new_plan_chunks_x );
 						for(  uint i = 0;  i < rotate90_new_plan[new_nr].get_boden_count();  i++  ) {
 							rotate90_new_plan[new_nr].get_boden_bei(i)->rotate90();
 						}
@@ -3284,9 +3394,9 @@ void karte_t::rotate90_plans(sint16 x_min, sint16 x_max, sint16 y_min, sint16 y_
 	}
 
 	// rotate water
-	for(  int xx = 0;  xx < cached_grid_size.x;  xx += LOOP_BLOCK  ) {
+	for(  int xx = x_min;  xx < x_max;  xx += LOOP_BLOCK  ) {
 		for(  int yy = y_min;  yy < y_max;  yy += LOOP_BLOCK  ) {
-			for(  int x = xx;  x < min( xx + LOOP_BLOCK, cached_grid_size.x );  x++  ) {
+			for(  int x = xx;  x < min( xx + LOOP_BLOCK, (int)x_max );  x++  ) {
 				int nr = x + (yy * cached_grid_size.x);
 				int new_nr = (cached_size.y - yy) + (x * cached_grid_size.y);
 				for(  int y = yy;  y < min( yy + LOOP_BLOCK, y_max );  y++  ) {
@@ -3318,15 +3428,17 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	}
 
 	//rotate plans in parallel posix thread ...
-	rotate90_new_plan = new planquadrat_t[cached_grid_size.y * cached_grid_size.x];
+	rotate90_new_plan = new planquadrat_t[get_plan_size(cached_grid_size.y, cached_grid_size.x)];
+	rotate90_new_plan_chunks_x = get_plan_chunks(cached_grid_size.y);
 	rotate90_new_water = new sint8[cached_grid_size.y * cached_grid_size.x];
 
-	world_xy_loop(&karte_t::rotate90_plans, 0);
+	world_xy_loop(&karte_t::rotate90_plans, CHUNKS_FLAG);
 
 	grund_t::finish_rotate90();
 
 	delete [] plan;
 	plan = rotate90_new_plan;
+	plan_chunks_x = rotate90_new_plan_chunks_x;
 	delete [] water_hgts;
 	water_hgts = rotate90_new_water;
 
@@ -3400,6 +3512,7 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 		// the map must be reinit
 		minimap_t::get_instance()->init();
 	}
+	route_graph_t::reset( get_size() );
 
 	//  rotate map search array
 	factory_builder_t::new_world();
@@ -3434,6 +3547,9 @@ bool karte_t::add_fab(fabrik_t *fab)
 // beware: must remove also links from stops and towns
 bool karte_t::rem_fab(fabrik_t *fab)
 {
+	if(  rollover_pending  &&  rollover_fab != fab_list.end()  &&  *rollover_fab == fab  ) {
+		++rollover_fab;
+	}
 	if(!fab_list.remove( fab )) {
 		return false;
 	}
@@ -3617,6 +3733,7 @@ void karte_t::sync_step(uint32 delta_t, bool do_sync_step, bool display )
 	set_random_mode( SYNC_STEP_RANDOM );
 	if(do_sync_step) {
 		// only omitted, when called to display a new frame during fast forward
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_SYNC );
 
 		// just for progress
 		if(  delta_t > 10000  ) {
@@ -3689,7 +3806,10 @@ void karte_t::sync_step(uint32 delta_t, bool do_sync_step, bool display )
 		}
 
 		// display new frame with water animation
-		intr_refresh_display( false );
+		{
+			step_profiler_t::scope_t profile( step_profiler_t::PHASE_DISPLAY );
+			intr_refresh_display( false );
+		}
 		update_frame_sleep_time();
 	}
 	clear_random_mode( SYNC_STEP_RANDOM );
@@ -3832,6 +3952,9 @@ void karte_t::new_month()
 {
 	bool need_locality_update = false;
 
+	// last month is not done yet (very short months)
+	finish_month_rollover();
+
 	update_history();
 
 	// advance history ...
@@ -3859,70 +3982,89 @@ void karte_t::new_month()
 	}
 	DBG_MESSAGE( "karte_t::new_month()", "Month (%d/%d) has started", (last_month % 12) + 1, last_month / 12 );
 
-	// this should be done before a map update, since the map may want an update of the way usage
-	FOR( slist_tpl<weg_t*>, const w, weg_t::get_alle_wege() ) {
-		w->new_month();
-	}
+	// keep the profile of long running games up to date (if requested by -profile)
+	step_profiler_t::write_report();
 
-	// recalc old settings (and maybe update the stops with the current values)
-	minimap_t::get_instance()->new_month();
+	// the factories, cities, players, convois and halts follow in the next steps (way statistics roll by themselves),
+	// then the scenario and the new year, see step_month_rollover()
+	rollover_fab = fab_list.begin();
+	rollover_locality_update = need_locality_update;
+	stadt.update_weights(get_population);
+	rollover_next[ROLLOVER_CITIES] = 0;
+	rollover_end[ROLLOVER_CITIES] = stadt.get_count();
+	// the convois and halts after the players
+	rollover_next[ROLLOVER_CONVOIS] = rollover_end[ROLLOVER_CONVOIS] = 0;
+	rollover_next[ROLLOVER_HALTS] = rollover_end[ROLLOVER_HALTS] = 0;
+	rollover_players_done = false;
+	rollover_pending = true;
+}
 
-	INT_CHECK( "simworld 1701" );
 
-//	DBG_MESSAGE("karte_t::new_month()","factories");
-	FOR(slist_tpl<fabrik_t*>, const fab, fab_list) {
+void karte_t::step_month_rollover()
+{
+	// at most 1/16 of each list per step, like the season change
+	for(  uint32 n = max( 64u, fab_list.get_count() / 16 );  n > 0  &&  rollover_fab != fab_list.end();  n--  ) {
+		// advance first, since a factory may be removed
+		fabrik_t *fab = *rollover_fab;
+		++rollover_fab;
 		fab->new_month();
 	}
 	INT_CHECK("simworld 1278");
 
+	for(  uint32 n = max( 16u, stadt.get_count() / 16 );  n > 0  &&  rollover_next[ROLLOVER_CITIES] < rollover_end[ROLLOVER_CITIES];  n--  ) {
+		stadt[ rollover_next[ROLLOVER_CITIES]++ ]->new_month( rollover_locality_update );
+	}
+	INT_CHECK("simworld 1282");
 
-//	DBG_MESSAGE("karte_t::new_month()","cities");
-	stadt.update_weights(get_population);
-	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
-		i->new_month(need_locality_update);
+	if(  rollover_fab != fab_list.end()  ||  rollover_next[ROLLOVER_CITIES] < rollover_end[ROLLOVER_CITIES]  ) {
+		return;
 	}
 
-	INT_CHECK("simworld 1282");
+	if(  !rollover_players_done  ) {
+		rollover_players_done = true;
 
-	// player
-	for(uint i=0; i<MAX_PLAYER_COUNT; i++) {
-		if( i>=2  &&  last_month == 0  &&  !settings.is_freeplay() ) {
-			// remove all player (but first and second) who went bankrupt during last year
-			if(  players[i] != NULL  &&  players[i]->get_finance()->is_bancrupted()  )
-			{
-				remove_player(i);
+		// player
+		for(uint i=0; i<MAX_PLAYER_COUNT; i++) {
+			if( i>=2  &&  last_month == 0  &&  !settings.is_freeplay() ) {
+				// remove all player (but first and second) who went bankrupt during last year
+				if(  players[i] != NULL  &&  players[i]->get_finance()->is_bancrupted()  )
+				{
+					remove_player(i);
+				}
 			}
-		}
 
-		if(  players[i] != NULL  ) {
-			// if returns false -> remove player
-			if (!players[i]->new_month()) {
-				remove_player(i);
+			if(  players[i] != NULL  ) {
+				// if returns false -> remove player
+				if (!players[i]->new_month()) {
+					remove_player(i);
+				}
 			}
 		}
-	}
+		INT_CHECK("simworld 1289");
 
-	//	DBG_MESSAGE("karte_t::new_month()","convois");
-	// call new month for convois, must be after player, because fixed costs are booked here and to connected lines
-	FOR(vector_tpl<convoihandle_t>, const cnv, convoi_array) {
-		cnv->new_month();
+		rollover_end[ROLLOVER_CONVOIS] = convoi_array.get_count();
+		rollover_end[ROLLOVER_HALTS] = haltestelle_t::get_alle_haltestellen().get_count();
 	}
 
-	INT_CHECK("simworld 1701");
-	// update the window
-	ki_kontroll_t* playerwin = (ki_kontroll_t*)win_get_magic(magic_ki_kontroll_t);
-	if(  playerwin  ) {
-		playerwin->update_data();
+	// must be after the players, because fixed costs are booked here and to connected lines
+	for(  uint32 n = max( 256u, convoi_array.get_count() / 16 );  n > 0  &&  rollover_next[ROLLOVER_CONVOIS] < rollover_end[ROLLOVER_CONVOIS];  n--  ) {
+		convoi_array[ rollover_next[ROLLOVER_CONVOIS]++ ]->new_month();
 	}
+	INT_CHECK("simworld 1701");
 
-	INT_CHECK("simworld 1289");
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	for(  uint32 n = max( 256u, halts.get_count() / 16 );  n > 0  &&  rollover_next[ROLLOVER_HALTS] < rollover_end[ROLLOVER_HALTS];  n--  ) {
+		halts[ rollover_next[ROLLOVER_HALTS]++ ]->new_month();
+	}
 
-//	DBG_MESSAGE("karte_t::new_month()","halts");
-	FOR(vector_tpl<halthandle_t>, const s, haltestelle_t::get_alle_haltestellen()) {
-		s->new_month();
-		INT_CHECK("simworld 1877");
+	for(  int i=0;  i<MAX_ROLLOVER_LISTS;  i++  ) {
+		if(  rollover_next[i] < rollover_end[i]  ) {
+			return;
+		}
 	}
+	rollover_pending = false;
 
+	// all objects are in the new month, so the scenario and the new year see their final statistics
 	INT_CHECK("simworld 2522");
 	depot_t::new_month();
 
@@ -3943,6 +4085,15 @@ void karte_t::new_month()
 	// update toolbars (i.e. new waytypes
 	tool_t::update_toolbars();
 
+	// recalc old settings (and maybe update the stops with the current values)
+	minimap_t::get_instance()->new_month();
+
+	// update the window
+	ki_kontroll_t* playerwin = (ki_kontroll_t*)win_get_magic(magic_ki_kontroll_t);
+	if(  playerwin  ) {
+		playerwin->update_data();
+	}
+
 	// no autosave in networkmode or when the new world dialogue is shown
 	if( !env_t::networkmode  &&  env_t::autosave>0  &&  last_month%env_t::autosave==0  &&  !win_get_magic(magic_welt_gui_t)  ) {
 		char buf[128];
@@ -3952,6 +4103,33 @@ void karte_t::new_month()
 }
 
 
+void karte_t::finish_month_rollover()
+{
+	while(  rollover_pending  ) {
+		step_month_rollover();
+	}
+}
+
+
+void karte_t::rollover_halt_removed(halthandle_t halt)
+{
+	if(  rollover_pending  &&  haltestelle_t::get_alle_haltestellen().is_contained(halt)  ) {
+		rollover_removed( ROLLOVER_HALTS, haltestelle_t::get_alle_haltestellen().index_of(halt) );
+	}
+}
+
+
+void karte_t::rollover_removed(uint8 list, uint32 index)
+{
+	if(  index < rollover_end[list]  ) {
+		rollover_end[list]--;
+		if(  index < rollover_next[list]  ) {
+			rollover_next[list]--;
+		}
+	}
+}
+
+
 void karte_t::new_year()
 {
 	last_year = current_month/12;
@@ -4123,6 +4301,99 @@ void karte_t::set_schedule_counter()
 }
 
 
+void karte_t::set_schedule_counter(const schedule_t *schedule, const player_t *owner)
+{
+	set_schedule_counter();
+	haltestelle_t::reconnect_stops( schedule, owner, schedule_counter );
+}
+
+
+void karte_t::plan_convois_loop(uint32 first, uint32 last, uint8 thread_num)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		planned_convois[i]->plan_step( thread_num );
+	}
+}
+
+
+void karte_t::plan_convois()
+{
+	planned_convois.clear();
+#ifdef MULTI_THREAD
+	if(  env_t::num_threads < 2  ) {
+		// no gain, the step will search the routes itself
+		return;
+	}
+	// same order as the step below, so the results do not depend on the number of threads
+	for(  size_t i = convoi_array.get_count();  i-- != 0;  ) {
+		if(  convoi_array[i]->wants_route_plan()  ) {
+			planned_convois.append( convoi_array[i] );
+		}
+	}
+	if(  planned_convois.get_count() < 2  ) {
+		// not worth to wake up the threads
+		planned_convois.clear();
+		return;
+	}
+	for(  int t = 0;  t < env_t::num_threads;  t++  ) {
+		route_t::init_nodes( this, t );
+	}
+	// no sync_step while the threads read the world
+	intr_disable_scope_t no_intr;
+	world_index_loop( &karte_t::plan_convois_loop, planned_convois.get_count() );
+#endif
+}
+
+
+void karte_t::generate_passengers_loop(uint32 first, uint32 last, uint8 thread_num)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		stadt[i]->generate_passagiere( thread_num );
+	}
+}
+
+
+void karte_t::minimap_rows_loop(uint32 first, uint32 last, uint8 thread_num)
+{
+	minimap_t::get_instance()->calc_map_rows( first, last, thread_num );
+}
+
+
+void karte_t::calc_minimap_rows(uint32 rows)
+{
+#ifdef MULTI_THREAD
+	if(  env_t::num_threads > 1  &&  rows > 1  ) {
+		// no sync_step while the threads read the world
+		intr_disable_scope_t no_intr;
+		world_index_loop( &karte_t::minimap_rows_loop, rows );
+		return;
+	}
+#endif
+	minimap_rows_loop( 0, rows, 0 );
+}
+
+
+void karte_t::generate_passengers()
+{
+	// the cities draw from their own random streams, so the packets do not depend on the number of threads
+#ifdef MULTI_THREAD
+	if(  env_t::num_threads > 1  &&  stadt.get_count() > 1  ) {
+		// no sync_step while the threads read the world
+		intr_disable_scope_t no_intr;
+		world_index_loop( &karte_t::generate_passengers_loop, stadt.get_count() );
+	}
+	else
+#endif
+	{
+		generate_passengers_loop( 0, stadt.get_count(), 0 );
+	}
+
+	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
+		i->merge_passagiere();
+	}
+}
+
+
 void karte_t::step()
 {
 	DBG_DEBUG4("karte_t::step", "start step");
@@ -4143,9 +4414,16 @@ void karte_t::step()
 		next_month_ticks += karte_t::ticks_per_world_month;
 
 		DBG_DEBUG4("karte_t::step", "calling new_month");
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_MONTH );
 		new_month();
 	}
 
+	if(  rollover_pending  ) {
+		DBG_DEBUG4("karte_t::step", "month rollover");
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_MONTH );
+		step_month_rollover();
+	}
+
 	DBG_DEBUG4("karte_t::step", "time calculations");
 	if(  step_mode==NORMAL  ) {
 		/* Try to maintain a decent pause, with a step every 170-250 ms (~5,5 simloops/s)
@@ -4207,7 +4485,9 @@ void karte_t::step()
 	if(  season_change  ||  snowline_change  ) {
 		DBG_DEBUG4("karte_t::step", "pending_season_change");
 		// process
-		const uint32 end_count = min( cached_grid_size.x * cached_grid_size.y,  tile_counter + max( 16384, cached_grid_size.x * cached_grid_size.y / 16 ) );
+		// in the order of plan, unused tiles of the border chunks are empty
+		const uint32 plan_size = get_plan_size( cached_grid_size.x, cached_grid_size.y );
+		const uint32 end_count = min( plan_size,  tile_counter + max( 16384u, plan_size / 16 ) );
 		while(  tile_counter < end_count  ) {
 			plan[tile_counter].check_season_snowline( season_change, snowline_change );
 			tile_counter++;
@@ -4216,7 +4496,7 @@ void karte_t::step()
 			}
 		}
 
-		if(  tile_counter >= (uint32)cached_grid_size.x * (uint32)cached_grid_size.y  ) {
+		if(  tile_counter >= plan_size  ) {
 			if(  season_change ) {
 				pending_season_change--;
 			}
@@ -4230,49 +4510,80 @@ void karte_t::step()
 	// to make sure the tick counter will be updated
 	INT_CHECK("karte_t::step");
 
-	DBG_DEBUG4("karte_t::step", "step convois");
-	// since convois will be deleted during stepping, we need to step backwards
-	for (size_t i = convoi_array.get_count(); i-- != 0;) {
-		convoihandle_t cnv = convoi_array[i];
-		cnv->step();
-		if((i&7)==0) {
-			INT_CHECK("simworld 1947");
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_CONVOI );
+
+		DBG_DEBUG4("karte_t::step", "plan convois");
+		plan_convois();
+
+		DBG_DEBUG4("karte_t::step", "step convois");
+		// since convois will be deleted during stepping, we need to step backwards
+		for (size_t i = convoi_array.get_count(); i-- != 0;) {
+			convoihandle_t cnv = convoi_array[i];
+			cnv->step();
+			if((i&7)==0) {
+				INT_CHECK("simworld 1947");
+			}
+		}
+
+		// drop plans not taken over by the step
+		FOR(vector_tpl<convoihandle_t>, const cnv, planned_convois) {
+			if(  cnv.is_bound()  ) {
+				cnv->clear_step_plan();
+			}
 		}
+		planned_convois.clear();
 	}
 
 	// now step all towns (to generate passengers)
 	DBG_DEBUG4("karte_t::step", "step cities");
-	sint64 bev=0;
-	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
-		i->step(delta_t);
-		bev += i->get_finance_history_month(0, HIST_CITIZENS);
-	}
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_CITY );
+		sint64 bev=0;
+		FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
+			i->step(delta_t);
+			bev += i->get_finance_history_month(0, HIST_CITIZENS);
+		}
+		generate_passengers();
 
-	// the inhabitants stuff
-	finance_history_month[0][WORLD_CITIZENS] = bev;
+		// the inhabitants stuff
+		finance_history_month[0][WORLD_CITIZENS] = bev;
+	}
 
 	DBG_DEBUG4("karte_t::step", "step factories");
-	FOR(slist_tpl<fabrik_t*>, const f, fab_list) {
-		f->step(delta_t);
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_FACTORY );
+		FOR(slist_tpl<fabrik_t*>, const f, fab_list) {
+			f->step(delta_t);
+		}
 	}
 	finance_history_year[0][WORLD_FACTORIES] = finance_history_month[0][WORLD_FACTORIES] = fab_list.get_count();
 
 	// step powerlines - required order: powernet, pumpe then senke
 	DBG_DEBUG4("karte_t::step", "step poweline stuff");
-	powernet_t::step_all(delta_t);
-	pumpe_t::step_all(delta_t);
-	senke_t::step_all(delta_t);
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_POWERNET );
+		powernet_t::step_all(delta_t);
+		pumpe_t::step_all(delta_t);
+		senke_t::step_all(delta_t);
+	}
 
 	DBG_DEBUG4("karte_t::step", "step players");
 	// then step all players
-	for(  int i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
-		if(  players[i] != NULL  ) {
-			players[i]->step();
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_PLAYER );
+		for(  int i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
+			if(  players[i] != NULL  ) {
+				players[i]->step();
+			}
 		}
 	}
 
 	DBG_DEBUG4("karte_t::step", "step halts");
-	haltestelle_t::step_all();
+	{
+		step_profiler_t::scope_t profile( step_profiler_t::PHASE_HALT );
+		haltestelle_t::step_all();
+	}
 
 	// ok, next step
 	INT_CHECK("simworld 1975");
@@ -4770,6 +5081,9 @@ void karte_t::save(loadsave_t *file,bool silent)
 {
 	bool needs_redraw = false;
 
+	// the rollover state is not saved
+	finish_month_rollover();
+
 	loadingscreen_t *ls = NULL;
 DBG_MESSAGE("karte_t::save(loadsave_t *file)", "start");
 	if(!silent) {
@@ -5259,6 +5573,98 @@ void karte_t::plans_finish_rd( sint16 x_min, sint16 x_max, sint16 y_min, sint16
 }
 
 
+void karte_t::city_targets_loop(uint32 first, uint32 last, uint8)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		stadt[i]->recalc_target_cities();
+	}
+}
+
+
+void karte_t::halt_cargo_loop(uint32 first, uint32 last, uint8)
+{
+	for(  uint32 i = first;  i < last;  i++  ) {
+		haltestelle_t::get_alle_haltestellen()[i]->finish_cargo_rd();
+	}
+}
+
+
+void karte_t::reconnect_halts_loop(uint32 first, uint32 last, uint8 thread_num)
+{
+	haltestelle_t::reconnect_loop( first, last, thread_num );
+}
+
+
+/**
+ * The stages of load() after the game state was read, in the order they run.
+ * The parallel ones only read other objects than the ones they fix.
+ */
+enum load_stage_t {
+	LOAD_TILES = 0,    ///< finish_rd of all objects on the map (parallel)
+	LOAD_CITIES,
+	LOAD_CITY_TARGETS, ///< (parallel)
+	LOAD_FACTORIES,
+	LOAD_HALTS,        ///< finish_rd and removal of the dummy stops
+	LOAD_HALT_CARGO,   ///< (parallel)
+	LOAD_CONVOIS,
+	LOAD_PLAYERS,      ///< registers the stops of all lines
+	LOAD_RECONNECT,    ///< (parallel)
+	MAX_LOAD_STAGES
+};
+
+#define LOAD_STAGE(s) (1u << (s))
+
+static const struct {
+	const char *name;
+	uint32 requires; ///< stages which must be finished before
+} load_stages[MAX_LOAD_STAGES] = {
+	{ "tiles",        0 },
+	{ "cities",       LOAD_STAGE(LOAD_TILES) },
+	{ "city targets", LOAD_STAGE(LOAD_CITIES) },
+	{ "factories",    LOAD_STAGE(LOAD_TILES) | LOAD_STAGE(LOAD_CITIES) },
+	{ "halts",        LOAD_STAGE(LOAD_TILES) | LOAD_STAGE(LOAD_FACTORIES) },
+	{ "halt cargo",   LOAD_STAGE(LOAD_HALTS) | LOAD_STAGE(LOAD_FACTORIES) },
+	{ "convois",      LOAD_STAGE(LOAD_HALTS) },
+	{ "players",      LOAD_STAGE(LOAD_CONVOIS) },
+	{ "reconnect",    LOAD_STAGE(LOAD_PLAYERS) | LOAD_STAGE(LOAD_HALT_CARGO) }
+};
+
+
+/**
+ * Checks the order of the load stages and writes the time of each stage to the log.
+ */
+class load_pipeline_t
+{
+	uint32 finished;
+	uint32 stage_start;
+	uint32 total_ms;
+
+public:
+	load_pipeline_t() : finished(0), stage_start(0), total_ms(0) {}
+
+	void begin(load_stage_t stage)
+	{
+		if(  (finished & load_stages[stage].requires) != load_stages[stage].requires  ) {
+			dbg->fatal( "karte_t::load()", "stage '%s' started too early", load_stages[stage].name );
+		}
+		stage_start = dr_time();
+	}
+
+	void end(load_stage_t stage)
+	{
+		const uint32 ms = dr_time() - stage_start;
+		total_ms += ms;
+		finished |= LOAD_STAGE(stage);
+		dbg->message( "karte_t::load()", "stage %-12s took %5u ms", load_stages[stage].name, ms );
+	}
+
+	~load_pipeline_t()
+	{
+		dbg->message( "karte_t::load()", "all stages took %u ms", total_ms );
+	}
+};
+
+
 void karte_t::load(loadsave_t *file)
 {
 	intr_disable();
@@ -5323,6 +5729,9 @@ DBG_MESSAGE("karte_t::load()", "%d ways loaded",weg_t::get_alle_wege().get_count
 
 	ls.set_progress( (get_size().y*3)/2+256 );
 
+	load_pipeline_t pipeline;
+
+	pipeline.begin( LOAD_TILES );
 	world_xy_loop(&karte_t::plans_finish_rd, SYNCX_FLAG);
 
 	// update power nets with correct power
@@ -5330,27 +5739,35 @@ DBG_MESSAGE("karte_t::load()", "%d ways loaded",weg_t::get_alle_wege().get_count
 
 	if(  file->is_version_less(112, 7)  ) {
 		// set transitions - has to be done after plans_finish_rd
-		world_xy_loop(&karte_t::recalc_transitions_loop, 0);
+		world_xy_loop(&karte_t::recalc_transitions_loop, CHUNKS_FLAG);
 	}
+	pipeline.end( LOAD_TILES );
 
 	ls.set_progress( (get_size().y*3)/2+256+get_size().y/8 );
 
 DBG_MESSAGE("karte_t::load()", "laden_abschliesen for tiles finished" );
 
 	// must finish loading cities first before cleaning up factories
+	pipeline.begin( LOAD_CITIES );
 	weighted_vector_tpl<stadt_t*> new_weighted_stadt(stadt.get_count() + 1);
 	FOR(weighted_vector_tpl<stadt_t*>, const s, stadt) {
 		s->finish_rd();
-		s->recalc_target_cities();
 		new_weighted_stadt.append(s, s->get_einwohner());
 		INT_CHECK("simworld 1278");
 	}
 	swap(stadt, new_weighted_stadt);
+	pipeline.end( LOAD_CITIES );
+
+	// the targets need the final size of all cities
+	pipeline.begin( LOAD_CITY_TARGETS );
+	world_index_loop( &karte_t::city_targets_loop, stadt.get_count() );
+	pipeline.end( LOAD_CITY_TARGETS );
 	DBG_MESSAGE("karte_t::load()", "cities initialized");
 
 	ls.set_progress( (get_size().y*3)/2+256+get_size().y/4 );
 
 	DBG_MESSAGE("karte_t::load()", "clean up factories");
+	pipeline.begin( LOAD_FACTORIES );
 	FOR(slist_tpl<fabrik_t*>, const f, fab_list) {
 		f->finish_rd();
 	}
@@ -5370,9 +5787,11 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 		settings.set_factory_worker_minimum_towns(temp_min);
 		settings.set_factory_worker_maximum_towns(temp_max);
 	}
+	pipeline.end( LOAD_FACTORIES );
 	ls.set_progress( (get_size().y*3)/2+256+get_size().y/3 );
 
 	// resolve dummy stops into real stops first ...
+	pipeline.begin( LOAD_HALTS );
 	FOR(vector_tpl<halthandle_t>, const i, haltestelle_t::get_alle_haltestellen()) {
 		if (i->get_owner() && i->existiert_in_welt()) {
 			i->finish_rd();
@@ -5390,10 +5809,19 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 			++i;
 		}
 	}
+	pipeline.end( LOAD_HALTS );
+
+	pipeline.begin( LOAD_HALT_CARGO );
+	if(  load_version > 111005  ) {
+		// older games were done in haltestelle_t::finish_rd()
+		world_index_loop( &karte_t::halt_cargo_loop, haltestelle_t::get_alle_haltestellen().get_count() );
+	}
+	pipeline.end( LOAD_HALT_CARGO );
 
 	ls.set_progress( (get_size().y*3)/2+256+(get_size().y*3)/8 );
 
 	// adding lines and other stuff for convois
+	pipeline.begin( LOAD_CONVOIS );
 	for(unsigned i=0;  i<convoi_array.get_count();  i++ ) {
 		convoihandle_t cnv = convoi_array[i];
 		cnv->finish_rd();
@@ -5403,25 +5831,24 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 		}
 	}
 	haltestelle_t::end_load_game();
+	pipeline.end( LOAD_CONVOIS );
 
 	// register all line stops and change line types, if needed
+	pipeline.begin( LOAD_PLAYERS );
 	for(int i=0; i<MAX_PLAYER_COUNT ; i++) {
 		if(  players[i]  ) {
 			players[i]->finish_rd();
 		}
 	}
+	pipeline.end( LOAD_PLAYERS );
 
-#ifdef DEBUG
-	uint32 dt = dr_time();
-#endif
-	// recalculate halt connections
+	// recalculate halt connections; rerouting is left to step()
+	pipeline.begin( LOAD_RECONNECT );
 	haltestelle_t::reset_routing();
-	do {
-		haltestelle_t::step_all();
-	} while (  haltestelle_t::get_rerouting_status()==RECONNECTING  );
-#ifdef DEBUG
-	dbg->message("karte_t::load()", "for all haltstellen_t took %ld ms", dr_time()-dt );
-#endif
+	haltestelle_t::start_reconnect_all();
+	world_index_loop( &karte_t::reconnect_halts_loop, haltestelle_t::get_alle_haltestellen().get_count() );
+	haltestelle_t::end_reconnect_all();
+	pipeline.end( LOAD_RECONNECT );
 
 #if 0
 	// reroute goods for benchmarking
@@ -5537,6 +5964,16 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 
 	settings.rdwr(file);
 
+	// width of the handle ids of convoys, halts and lines (needed before anything refers to them)
+	if(  file->get_OTRP_version() >= 35  ) {
+		bool wide_handles = file->has_wide_handles();
+		file->rdwr_bool(wide_handles);
+		file->set_wide_handles(wide_handles);
+	}
+	else {
+		file->set_wide_handles(false);
+	}
+
 	if (file->is_loading()) {
 		// some functions (finish_rd) need to know what version was loaded
 		load_version = file->get_version_int();
@@ -5730,7 +6167,7 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 
 		for (int y = 0; y < get_size().y; y++) {
 			for (int x = 0; x < get_size().x; x++) {
-				plan[x+y*cached_grid_size.x].rdwr(file, koord(x,y) );
+				access_nocheck(x,y)->rdwr(file, koord(x,y) );
 			}
 			if(file->is_eof()) {
 				dbg->fatal("karte_t::rdwr_gamestate()","Savegame file mangled (too short)!");
@@ -5741,7 +6178,7 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 	else {
 		for(int j=0; j<get_size().y; j++) {
 			for(int i=0; i<get_size().x; i++) {
-				plan[i+j*cached_grid_size.x].rdwr(file, koord(i,j) );
+				access_nocheck(i,j)->rdwr(file, koord(i,j) );
 			}
 			if(!ls) {
 				INT_CHECK("saving");
@@ -5862,6 +6299,7 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 		DBG_MESSAGE("karte_t::rdwr_gamestate()", "init minimap");
 		win_set_world( this );
 		minimap_t::get_instance()->init();
+		route_graph_t::reset( get_size() );
 	}
 
 	// rdwr factories
@@ -5940,10 +6378,10 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 	// rdwr convois
 	if (file->is_loading()) {
 		DBG_MESSAGE("karte_t::rdwr_gamestate()", "load convois");
-		uint16 convoi_nr = 65535;
-		uint16 max_convoi = 65535;
+		uint32 convoi_nr = 65535;
+		uint32 max_convoi = 65535;
 		if(  file->is_version_atleast(101, 0)  ) {
-			file->rdwr_short(convoi_nr);
+			file->rdwr_handle_id(convoi_nr);
 			max_convoi = convoi_nr;
 		}
 
@@ -5981,8 +6419,8 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 	else {
 		// save number of convois
 		if(  file->is_version_atleast(101, 0)  ) {
-			uint16 i=convoi_array.get_count();
-			file->rdwr_short(i);
+			uint32 i=convoi_array.get_count();
+			file->rdwr_handle_id(i);
 		}
 		FOR(vector_tpl<convoihandle_t>, const cnv, convoi_array) {
 			// one MUST NOT call INT_CHECK here or else the convoi will be broken during reloading!
@@ -6008,9 +6446,9 @@ void karte_t::update_map_intern(sint16 x_min, sint16 x_max, sint16 y_min, sint16
 			for(  int yy = y_min;  yy < y_max;  yy += LOOP_BLOCK  ) {
 				for(  int y = yy;  y < min(yy + LOOP_BLOCK, y_max);  y++  ) {
 					for(  int x = xx;  x < min(xx + LOOP_BLOCK, x_max);  x++  ) {
-						const int nr = y * cached_grid_size.x + x;
-						for(  uint i = 0;  i < plan[nr].get_boden_count();  i++  ) {
-							plan[nr].get_boden_bei(i)->calc_image();
+						const planquadrat_t *pl = access_nocheck( x, y );
+						for(  uint i = 0;  i < pl->get_boden_count();  i++  ) {
+							pl->get_boden_bei(i)->calc_image();
 						}
 					}
 				}
@@ -6020,9 +6458,9 @@ void karte_t::update_map_intern(sint16 x_min, sint16 x_max, sint16 y_min, sint16
 	else {
 		for(  int y = y_min;  y < y_max;  y++  ) {
 			for(  int x = x_min;  x < x_max;  x++  ) {
-				const int nr = y * cached_grid_size.x + x;
-				for(  uint i = 0;  i < plan[nr].get_boden_count();  i++  ) {
-					plan[nr].get_boden_bei(i)->calc_image();
+				const planquadrat_t *pl = access_nocheck( x, y );
+				for(  uint i = 0;  i < pl->get_boden_count();  i++  ) {
+					pl->get_boden_bei(i)->calc_image();
 				}
 			}
 		}
@@ -6078,8 +6516,7 @@ void karte_t::prepare_tiles(rect_t const &new_area, rect_t const &old_area) {
 
 		for (sint16 y = y_start ; y < y_end ; y++) {
 			for (sint16 x = x_start ; x < x_end ; x++) {
-				const planquadrat_t &tile = plan[y * cached_grid_size.x + x];
-				tile.update_underground();
+				access_nocheck( x, y )->update_underground();
 			}
 		}
 	}
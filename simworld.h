@@ -50,6 +50,8 @@ class memory_rw_t;
 class viewport_t;
 class records_t;
 class loadingscreen_t;
+class schedule_t;
+class player_t;
 
 
 /**
@@ -57,6 +59,11 @@ class loadingscreen_t;
  */
 typedef void (karte_t::*xy_loop_func)(sint16, sint16, sint16, sint16);
 
+/**
+ * Threaded function caller for index ranges; last parameter is the number of the thread.
+ */
+typedef void (karte_t::*index_loop_func)(uint32, uint32, uint8);
+
 
 /**
  * The map is the central part of the simulation. It stores all data and objects.
@@ -393,10 +400,16 @@ private:
 
 	/**
 	 * Array containing all the map tiles.
-	 * @see cached_size
+	 * The tiles are stored chunk by chunk (in rows of chunks), with the tiles of each chunk
+	 * row by row, so tiles close on the map are also close in memory.
+	 * Chunks at the right and lower border may have unused (empty) tiles.
+	 * @see cached_size, plan_index()
 	 */
 	planquadrat_t *plan;
 
+	/// number of chunks of plan in x direction
+	uint32 plan_chunks_x;
+
 	/**
 	 * Array representing the height of each point of the grid.
 	 * @see cached_grid_size
@@ -602,6 +615,29 @@ private:
 	 */
 	uint32 tile_counter;
 
+	/**
+	 * The objects are advanced into a new month during the steps after new_month(),
+	 * see step_month_rollover().
+	 */
+	bool rollover_pending;
+
+	/// cities must update their destinations (changed locality factor)
+	bool rollover_locality_update;
+
+	/// the players are advanced once the factories and cities are done, before the convois
+	bool rollover_players_done;
+
+	/**
+	 * For the vectors of cities, convois and halts: next index and end of the rollover.
+	 * Objects added later are already in the new month.
+	 */
+	enum { ROLLOVER_CITIES = 0, ROLLOVER_CONVOIS, ROLLOVER_HALTS, MAX_ROLLOVER_LISTS };
+	uint32 rollover_next[MAX_ROLLOVER_LISTS];
+	uint32 rollover_end[MAX_ROLLOVER_LISTS];
+
+	/// next factory of the rollover
+	slist_tpl<fabrik_t *>::const_iterator rollover_fab;
+
 	/**
 	 * To identify different stages of the same game.
 	 */
@@ -627,6 +663,16 @@ private:
 	 */
 	void new_month();
 
+	/**
+	 * Advances the next slice of objects into the new month, in the order of the old new_month():
+	 * factories and cities, players, convois and halts. Once all are done, the depots,
+	 * the scenario and (in January) the new year follow.
+	 */
+	void step_month_rollover();
+
+	/// the object at @p index of the vector @p list is about to be removed
+	void rollover_removed(uint8 list, uint32 index);
+
 	/**
 	 * Yearly actions.
 	 */
@@ -690,23 +736,68 @@ private:
 
 	enum {
 		SYNCX_FLAG = 1 << 0,
-		GRIDS_FLAG = 1 << 1
+		GRIDS_FLAG = 1 << 1,
+		CHUNKS_FLAG = 1 << 2  ///< func does each tile on its own, so it can run chunk by chunk (not with SYNCX_FLAG)
 	};
 
 	void world_xy_loop(xy_loop_func func, uint8 flags);
+
+	/// calls @p func for each chunk of plan in the rows @p y_min to @p y_max
+	void world_chunk_loop(xy_loop_func func, sint16 x_max, sint16 y_min, sint16 y_max);
 	static void *world_xy_loop_thread(void *);
 
+	/**
+	 * Calls @p func for the indices 0 ... @p count-1, split into one range per thread.
+	 * Like world_xy_loop(), simrand() must not be used there.
+	 */
+	void world_index_loop(index_loop_func func, uint32 count);
+
+	/**
+	 * Convois, whose routes are searched in the parallel plan phase of step()
+	 */
+	vector_tpl<convoihandle_t> planned_convois;
+
+	/**
+	 * Parallel plan phase of the convoi step: does the read-only work
+	 * (route searches) for all convois that will need it in their step().
+	 */
+	void plan_convois();
+	void plan_convois_loop(uint32 first, uint32 last, uint8 thread_num);
+
+	/**
+	 * Passenger generation of all cities: the cities generate in parallel,
+	 * then their packets are booked in the order of the city list.
+	 */
+	void generate_passengers();
+	void generate_passengers_loop(uint32 first, uint32 last, uint8 thread_num);
+
 	/**
 	 * Loops over plans after load.
 	 */
 	void plans_finish_rd(sint16, sint16, sint16, sint16);
 
+	/**
+	 * The parallel stages of load(): target cities of all cities,
+	 * destinations of the waiting goods and the reconnection of all halts.
+	 */
+	void city_targets_loop(uint32 first, uint32 last, uint8 thread_num);
+	void halt_cargo_loop(uint32 first, uint32 last, uint8 thread_num);
+	void reconnect_halts_loop(uint32 first, uint32 last, uint8 thread_num);
+
 	/**
 	 * Updates all images.
 	 */
 	void update_map_intern(sint16, sint16, sint16, sint16);
 
+	void minimap_rows_loop(uint32 first, uint32 last, uint8 thread_num);
+
 public:
+	/**
+	 * Calculates the colors of @p rows tile rows of the minimap on all threads,
+	 * see minimap_t::calc_map_rows().
+	 */
+	void calc_minimap_rows(uint32 rows);
+
 	enum server_announce_type_t
 	{
 		SERVER_ANNOUNCE_HELLO     = 0, ///< my server is now up
@@ -938,6 +1029,13 @@ public:
 	 */
 	void set_schedule_counter();
 
+	/**
+	 * Like set_schedule_counter(), when only this schedule changed: then only its stops and the
+	 * halts where lines or convoys were (un)registered reconnect, and goods are rerouted only in
+	 * the affected connected components (unless there were also other changes).
+	 */
+	void set_schedule_counter(const schedule_t *schedule, const player_t *owner);
+
 	/**
 	 * @note Often used, therefore found here.
 	 */
@@ -1340,7 +1438,7 @@ private:
 	 */
 	inline grund_t *lookup_kartenboden_nocheck(const sint16 x, const sint16 y) const
 	{
-		return plan[x+y*cached_grid_size.x].get_kartenboden();
+		return plan[plan_index(x, y)].get_kartenboden();
 	}
 
 	inline grund_t *lookup_kartenboden_nocheck(const koord &pos) const { return lookup_kartenboden_nocheck(pos.x, pos.y); }
@@ -1351,7 +1449,7 @@ public:
 	 */
 	inline grund_t *lookup_kartenboden(const sint16 x, const sint16 y) const
 	{
-		return is_within_limits(x, y) ? plan[x+y*cached_grid_size.x].get_kartenboden() : NULL;
+		return is_within_limits(x, y) ? plan[plan_index(x, y)].get_kartenboden() : NULL;
 	}
 
 	inline grund_t *lookup_kartenboden(const koord &pos) const { return lookup_kartenboden(pos.x, pos.y); }
@@ -1490,6 +1588,14 @@ private:
 
 public:
 
+	/**
+	 * Finishes a pending month rollover at once (e.g. before saving).
+	 */
+	void finish_month_rollover();
+
+	/// called by haltestelle_t before @p halt is removed from the halt list
+	void rollover_halt_removed(halthandle_t halt);
+
 	// the convois are also handled each step => thus we keep track of them too
 	void add_convoi(convoihandle_t);
 	void rem_convoi(convoihandle_t);
@@ -1574,15 +1680,33 @@ public:
 	void step();
 
 private:
+	/// number of chunks (see plan) needed for @p tiles tiles
+	static inline uint32 get_plan_chunks(int tiles) {
+		return ((uint32)tiles + (1u << PLAN_CHUNK_SHIFT) - 1) >> PLAN_CHUNK_SHIFT;
+	}
+
+	/// size of plan for a map of @p x times @p y tiles
+	static inline uint32 get_plan_size(int x, int y) {
+		return (get_plan_chunks(x) * get_plan_chunks(y)) << (2*PLAN_CHUNK_SHIFT);
+	}
+
+	/// index of tile (@p x, @p y) in a plan with @p chunks_x chunks per row
+	static inline uint32 get_plan_index(int x, int y, uint32 chunks_x) {
+		const uint32 mask = (1u << PLAN_CHUNK_SHIFT) - 1;
+		return ((((uint32)y >> PLAN_CHUNK_SHIFT) * chunks_x + ((uint32)x >> PLAN_CHUNK_SHIFT)) << (2*PLAN_CHUNK_SHIFT)) | (((uint32)y & mask) << PLAN_CHUNK_SHIFT) | ((uint32)x & mask);
+	}
+
+	inline uint32 plan_index(int x, int y) const { return get_plan_index(x, y, plan_chunks_x); }
+
 	inline planquadrat_t *access_nocheck(int i, int j) const {
-		return &plan[i + j*cached_grid_size.x];
+		return &plan[plan_index(i, j)];
 	}
 
 	inline planquadrat_t *access_nocheck(koord k) const { return access_nocheck(k.x, k.y); }
 
 public:
 	inline planquadrat_t *access(int i, int j) const {
-		return is_within_limits(i, j) ? &plan[i + j*cached_grid_size.x] : NULL;
+		return is_within_limits(i, j) ? &plan[plan_index(i, j)] : NULL;
 	}
 
 	inline planquadrat_t *access(koord k) const { return access(k.x, k.y); }
@@ -46,6 +46,9 @@
 #	include <dirent.h>
 #	if !defined __AMIGA__ && !defined __BEOS__
 #		include <unistd.h>
+#		include <fcntl.h>
+#		include <sys/mman.h>
+#		define USE_MMAP
 #	endif
 #	ifdef __ANDROID__
 #		include <SDL2/SDL.h>
@@ -354,6 +357,90 @@ int dr_stat(const char *path, struct stat *buf)
 #endif
 }
 
+const char *dr_map_file(const char *path, size_t *size)
+{
+	*size = 0;
+#if defined _WIN32
+	HANDLE const file = CreateFileW(U16View(path), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(  file == INVALID_HANDLE_VALUE  ) {
+		return NULL;
+	}
+	LARGE_INTEGER length;
+	if(  !GetFileSizeEx(file, &length)  ||  length.QuadPart == 0  ||  (uint64)length.QuadPart > (size_t)-1  ) {
+		CloseHandle(file);
+		return NULL;
+	}
+	HANDLE const mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if(  mapping == NULL  ) {
+		return NULL;
+	}
+	// the view keeps the mapping alive
+	const char *data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if(  data  ) {
+		*size = (size_t)length.QuadPart;
+	}
+	return data;
+#elif defined USE_MMAP
+	int const fd = open(path, O_RDONLY);
+	if(  fd < 0  ) {
+		return NULL;
+	}
+	struct stat st;
+	if(  fstat(fd, &st) != 0  ||  st.st_size <= 0  ) {
+		close(fd);
+		return NULL;
+	}
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(  data == MAP_FAILED  ) {
+		return NULL;
+	}
+	*size = (size_t)st.st_size;
+	return (const char *)data;
+#else
+	FILE *const fp = dr_fopen(path, "rb");
+	if(  !fp  ) {
+		return NULL;
+	}
+	fseek(fp, 0, SEEK_END);
+	long const length = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	char *data = NULL;
+	if(  length > 0  ) {
+		data = (char *)malloc(length);
+		if(  fread(data, length, 1, fp) != 1  ) {
+			free(data);
+			data = NULL;
+		}
+		else {
+			*size = length;
+		}
+	}
+	fclose(fp);
+	return data;
+#endif
+}
+
+
+void dr_unmap_file(const char *data, size_t size)
+{
+	if(  data == NULL  ) {
+		return;
+	}
+#if defined _WIN32
+	(void)size;
+	UnmapViewOfFile(data);
+#elif defined USE_MMAP
+	munmap(const_cast<char *>(data), size);
+#else
+	(void)size;
+	free(const_cast<char *>(data));
+#endif
+}
+
+
 char const *dr_query_homedir()
 {
 	static char buffer[PATH_MAX + 24];
@@ -140,6 +140,15 @@ gzFile dr_gzopen(const char *path, const char *mode);
 // Functions the same as stat except path must be UTF-8 encoded.
 int dr_stat(const char *path, struct stat *buf);
 
+/**
+ * Maps a whole file read-only into memory (or reads it, where the platform cannot map files).
+ * Path must be UTF-8 encoded.
+ * @param[out] size length of the file
+ * @returns NULL on failure or for empty files, otherwise release with dr_unmap_file()
+ */
+const char *dr_map_file(const char *path, size_t *size);
+void dr_unmap_file(const char *data, size_t size);
+
 /* query home directory */
 char const* dr_query_homedir();
 
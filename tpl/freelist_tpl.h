@@ -0,0 +1,45 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef TPL_FREELIST_TPL_H
+#define TPL_FREELIST_TPL_H
+
+
+#include "../dataobj/freelist.h"
+
+
+/**
+ * Allocates the objects of type T from a pool of their own (see freelist_pool_t).
+ * Meant for operator new and delete of frequently created small objects:
+ *
+ *	void *operator new(size_t) { return freelist_tpl<my_t>::gimme_node("my_t"); }
+ *	void operator delete(void *p) { freelist_tpl<my_t>::putback_node(p); }
+ *
+ * The name is shown in the pool statistics.
+ *
+ * Subclasses of T with a different size need their own operators.
+ * For debugging the memory (DEBUG_FREELIST, USE_VALGRIND_MEMCHECK) the objects come from freelist_t.
+ */
+template<class T> class freelist_tpl
+{
+#if !defined(DEBUG_FREELIST)  &&  !defined(USE_VALGRIND_MEMCHECK)
+	// created on first use (always by gimme_node()), so objects can be allocated during static initialisation
+	static freelist_pool_t &get_pool(const char *name = NULL)
+	{
+		static freelist_pool_t pool( name, sizeof(T) );
+		return pool;
+	}
+
+public:
+	static void *gimme_node(const char *name) { return get_pool(name).gimme_node(); }
+	static void putback_node(void *p) { get_pool().putback_node(p); }
+#else
+public:
+	static void *gimme_node(const char *) { return freelist_t::gimme_node(sizeof(T)); }
+	static void putback_node(void *p) { freelist_t::putback_node(sizeof(T), p); }
+#endif
+};
+
+#endif
@@ -7,79 +7,131 @@
 #define TPL_QUICKSTONE_TPL_H
 
 
+#include <string.h>
+
 #include "../simtypes.h"
 #include "../simdebug.h"
 
+#ifdef HANDLES_32BIT
+/// index into the tombstone table; with HANDLES_32BIT more than 65534 handles of a kind are possible
+typedef uint32 handle_id_t;
+#else
+typedef uint16 handle_id_t;
+#endif
+
+
 /**
  * An implementation of the tombstone pointer checking method.
  * It uses a table of pointers and indices into that table to
  * implement the tombstone system. Unlike real tombstones, this
  * template reuses entries from the tombstone table, but it tries
  * to leave freed tombstones untouched as long as possible, to
- * detect most of the dangling pointers.
+ * detect most of the dangling pointers: free entries are kept in
+ * a first in, first out list, so the entry freed longest ago is
+ * reused first (and allocation needs constant time).
  *
  * This templates goal is to be efficient and fairly safe.
  */
 template <class T> class quickstone_tpl
 {
 private:
+	/// largest table size, also marks entries not in the free list
+	static const handle_id_t MAX_SIZE = (handle_id_t)~(handle_id_t)0;
+
 	/**
 	 * Array of pointers. The first entry is always NULL!
 	 */
 	static T ** data;
 
 	/**
-	 * Next entry to check
+	 * For each entry in the free list the next one (0 at the end of the list),
+	 * MAX_SIZE for entries not in the list.
+	 * Entries taken with a given id (during loading) stay in the list and are skipped later.
 	 */
-	static uint16 next;
+	static handle_id_t *free_next;
+
+	/**
+	 * First and last entry of the free list (0 if empty)
+	 */
+	static handle_id_t free_head;
+	static handle_id_t free_tail;
 
 	/**
 	 * Size of tombstone table
 	 */
-	static uint16 size;
+	static handle_id_t size;
 
 	/**
 	 * The index in the table for this handle.
 	 * (only this variable is actually saved, since the rest is static!)
 	 */
-	uint16 entry;
+	handle_id_t entry;
 
 private:
+	static void append_free(handle_id_t i)
+	{
+		if(  free_next[i] != MAX_SIZE  ) {
+			// still in the list
+			return;
+		}
+		free_next[i] = 0;
+		if(  free_tail  ) {
+			free_next[free_tail] = i;
+		}
+		else {
+			free_head = i;
+		}
+		free_tail = i;
+	}
+
 	/**
-	 * Retrieves next free tombstone index
+	 * Removes entries already in use from the head of the free list
+	 * @returns true, if there is a free entry left
 	 */
-	static uint16 find_next() {
-		uint16 i;
-
-		// scan rest of array
-		for(  i=next;  i<size;  i++  ) {
-			if(  data[i] == 0  ) {
-				next = i+1;
-				return i;
-			}
+	static bool skip_used()
+	{
+		while(  free_head  &&  data[free_head] != 0  ) {
+			const handle_id_t i = free_head;
+			free_head = free_next[i];
+			free_next[i] = MAX_SIZE;
 		}
+		if(  free_head == 0  ) {
+			free_tail = 0;
+		}
+		return free_head != 0;
+	}
 
-		// scan whole array
-		for(  i=1;  i<size;  i++  ) {
-			if(  data[i]==0  ) {
-				next = i+1;
-				return i;
-			}
+	/**
+	 * Retrieves next free tombstone index
+	 */
+	static handle_id_t find_next()
+	{
+		if(  !skip_used()  ) {
+			enlarge();
 		}
-		return enlarge();
+		const handle_id_t i = free_head;
+		free_head = free_next[i];
+		if(  free_head == 0  ) {
+			free_tail = 0;
+		}
+		free_next[i] = MAX_SIZE;
+		return i;
 	}
 
-	static uint16 enlarge()
+	/**
+	 * Extends the array, the new entries are appended to the free list
+	 */
+	static void enlarge()
 	{
 		// no free entry found, extend array if possible
-		uint16 newsize;
-		if (size == 65535) {
+		handle_id_t newsize;
+		if (size == MAX_SIZE) {
 			// completely out of handles
-			dbg->fatal("quickstone<T>::find_next()","no free index found (size=%i)",size);
-			return 0; //dummy for compiler
-		} else if (size >= 32768) {
-			// max out on handles, don't overflow uint16
-			newsize = 65535;
+			dbg->fatal("quickstone<T>::find_next()","no free index found (size=%u)",(unsigned)size);
+			return; //dummy for compiler
+		} else if (size > MAX_SIZE/2) {
+			// max out on handles, don't overflow handle_id_t
+			newsize = MAX_SIZE;
 		} else {
 			newsize = 2*size;
 		}
@@ -87,14 +139,21 @@ private:
 		// Move data to new extended array
 		T ** newdata = new T* [newsize];
 		memcpy( newdata, data, sizeof(T*)*size );
-		for(  uint16 i=size;  i<newsize;  i++  ) {
+		handle_id_t *newfree = new handle_id_t[newsize];
+		memcpy( newfree, free_next, sizeof(handle_id_t)*size );
+		for(  handle_id_t i=size;  i<newsize;  i++  ) {
 			newdata[i] = 0;
+			newfree[i] = MAX_SIZE;
 		}
 		delete [] data;
+		delete [] free_next;
 		data = newdata;
-		next = size+1;
+		free_next = newfree;
+		const handle_id_t oldsize = size;
 		size = newsize;
-		return next-1;
+		for(  handle_id_t i=oldsize;  i<newsize;  i++  ) {
+			append_free(i);
+		}
 	}
 
 public:
@@ -104,17 +163,23 @@ public:
 	 *
 	 * @param n number of elements
 	 */
-	static void init(const uint16 n)
+	static void init(const handle_id_t n)
 	{
 		delete [] data;
+		delete [] free_next;
 		size = n;
 		data = new T* [size];
+		free_next = new handle_id_t[size];
+		free_head = free_tail = 0;
 
 		// all NULL pointers are mapped to entry 0
-		for(int i=0; i<size; i++) {
+		for(  handle_id_t i=0;  i<size;  i++  ) {
 			data[i] = 0;
+			free_next[i] = MAX_SIZE;
+		}
+		for(  handle_id_t i=1;  i<size;  i++  ) {
+			append_free(i);
 		}
-		next = 1;
 	}
 
 	// empty handle (entry 0 is always zero)
@@ -136,50 +201,25 @@ public:
 		}
 	}
 
-	// connects with last handle
-	explicit quickstone_tpl(T* p, bool)
-	{
-		uint16 i;
-
-		// scan rest of array
-		for(  i=size-1;  i>0;  i++  ) {
-			if(  data[i] == 0  ) {
-				entry = i;
-				data[entry] = p;
-				return;
-			}
-		}
-		enlarge();
-		// repeat
-		for(  i=size-1;  i>0;  i++  ) {
-			if(  data[i] == 0  ) {
-				entry = i;
-				data[entry] = p;
-				return;
-			}
-		}
-		dbg->fatal( "quickstone_tpl(bool)", "No more handles!\nShould have already failed with enlarge!" );
-	}
-
 	// creates handle with id, fails if already taken
-	quickstone_tpl(T* p, uint16 id)
+	quickstone_tpl(T* p, handle_id_t id)
 	{
 		if(p) {
 			if(  id == 0  ) {
-				dbg->fatal("quickstone<T>::quickstone_tpl(T*,uint16)","wants to assign non-null pointer to null index");
+				dbg->fatal("quickstone<T>::quickstone_tpl(T*,handle_id_t)","wants to assign non-null pointer to null index");
 			}
 			while(  id >= size  ) {
 				enlarge();
 			}
 			if(  data[id]!=NULL  &&  data[id]!=p  ) {
-				dbg->fatal("quickstone<T>::quickstone_tpl(T*,uint16)","slot (%d) already taken", id);
+				dbg->fatal("quickstone<T>::quickstone_tpl(T*,handle_id_t)","slot (%u) already taken", (unsigned)id);
 			}
 			entry = id;
 			data[entry] = p;
 		}
 		else {
 			if(  id!=0  ) {
-				dbg->fatal("quickstone<T>::quickstone_tpl(T*,uint16)","wants to assign null pointer to non-null index");
+				dbg->fatal("quickstone<T>::quickstone_tpl(T*,handle_id_t)","wants to assign null pointer to non-null index");
 			}
 			// all NULL pointers are mapped to entry 0
 			entry = 0;
@@ -189,19 +229,8 @@ public:
 	// returns true, if no handles left
 	static bool is_exhausted()
 	{
-		if(  size==65535  ) {
-			// scan  array
-			for(  uint16 i = 1; i<size; i++) {
-				if(data[i] == 0) {
-					// still empty handles left
-					return false;
-				}
-			}
-			// no handles left => cannot extent
-			return true;
-		}
 		// can extent in any case => ok
-		return false;
+		return size == MAX_SIZE  &&  !skip_used();
 	}
 
 
@@ -218,6 +247,9 @@ public:
 	{
 		T* p = data[entry];
 		data[entry] = 0;
+		if(  entry  ) {
+			append_free(entry);
+		}
 		return p;
 	}
 
@@ -234,13 +266,13 @@ public:
 	 * @return the index into the tombstone table. May be used as
 	 * an ID for the referenced object.
 	 */
-	uint16 get_id() const { return entry; }
+	handle_id_t get_id() const { return entry; }
 
 	/**
 	 * Sets the current id: Needed to recreate stuff via network.
 	 * ATTENTION: This may be harmful. DO not use unless really really needed!
 	 */
-	void set_id(uint16 e) { entry=e; }
+	void set_id(handle_id_t e) { entry=e; }
 
 	/**
 	 * Overloaded dereference operator. With this, quickstones can
@@ -254,18 +286,20 @@ public:
 
 	bool operator!= (const quickstone_tpl<T> &other) const { return entry != other.entry; }
 
-	static uint16 get_size() { return size; }
+	static handle_id_t get_size() { return size; }
 
 	/**
 	 * For checking the consistency of handle allocation
 	 * among the server and the clients in network mode
 	 */
-	static uint16 get_next_check() { return next; }
+	static handle_id_t get_next_check() { skip_used(); return free_head; }
 };
 
 template <class T> T** quickstone_tpl<T>::data = 0;
 
-template <class T> uint16 quickstone_tpl<T>::next = 1;
-template <class T> uint16 quickstone_tpl<T>::size = 0;
+template <class T> handle_id_t *quickstone_tpl<T>::free_next = 0;
+template <class T> handle_id_t quickstone_tpl<T>::free_head = 0;
+template <class T> handle_id_t quickstone_tpl<T>::free_tail = 0;
+template <class T> handle_id_t quickstone_tpl<T>::size = 0;
 
 #endif
@@ -9,7 +9,7 @@
 
 #include <iterator>
 #include <typeinfo>
-#include "../dataobj/freelist.h"
+#include "freelist_tpl.h"
 #include "../simdebug.h"
 #include <stddef.h> // for ptrdiff_t
 
@@ -34,8 +34,8 @@ private:
 		node_t(const T& data_, node_t* next_) : next(next_), data(data_) {}
 		node_t(node_t* next_) : next(next_), data() {}
 
-		void* operator new(size_t) { return freelist_t::gimme_node(sizeof(node_t)); }
-		void operator delete(void* p) { freelist_t::putback_node(sizeof(node_t), p); }
+		void* operator new(size_t) { return freelist_tpl<node_t>::gimme_node("slist_tpl node"); }
+		void operator delete(void* p) { freelist_tpl<node_t>::putback_node(p); }
 
 		node_t* next;
 		T data;
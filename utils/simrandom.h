@@ -53,6 +53,34 @@ uint16 get_random_mode();
 void init_perlin_map( sint32 w, sint32 h );
 void exit_perlin_map();
 
+/**
+ * A random number stream of its own, independent from simrand().
+ * Objects stepped in parallel draw from their own stream, so the results do not
+ * depend on the number or order of threads. Seed it from simrand() in the serial part
+ * of the step to keep network games in sync.
+ */
+class simrand_stream_t
+{
+	uint32 state;
+
+public:
+	simrand_stream_t() : state(1) {}
+
+	void set_seed(uint32 seed) { state = seed ? seed : 1; } // xorshift must not start from zero
+
+	/* generates a random number on [0,0xFFFFFFFFu]-interval */
+	uint32 rand_plain()
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	/* generates a random number on [0,max-1]-interval */
+	uint32 rand(const uint32 max) { return max<=1 ? 0 : rand_plain() % max; }
+};
+
 /* Randomly select an entry from the given array. */
 template<typename T, size_t N> T const& pick_any(T const (&array)[N])
 {
@@ -71,6 +99,12 @@ template<typename T, template<typename> class U> T const& pick_any_weighted(U<T>
 	return container.at_weight(simrand(container.get_sum_weight()));
 }
 
+/* Randomly select an entry from the given weighted container using a random stream. */
+template<typename T, template<typename> class U> T const& pick_any_weighted(U<T> const& container, simrand_stream_t &stream)
+{
+	return container.at_weight(stream.rand(container.get_sum_weight()));
+}
+
 
 // compute integer log10
 uint32 log10( uint32 v );
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+
+#include "step_profiler.h"
+#include "cbuffer_t.h"
+#include "csv.h"
+#include "../simdebug.h"
+#include "../sys/simsys.h"
+
+
+// number of calls per phase kept for the percentiles
+#define PROFILE_SAMPLES (1024)
+
+
+static const char *const phase_names[step_profiler_t::MAX_PHASES] = {
+	"convoi step",
+	"city step",
+	"factory step",
+	"powernet step",
+	"player step",
+	"halt step",
+	"month rollover",
+	"sync step",
+	"display"
+};
+
+struct phase_data_t
+{
+	uint64 calls;
+	uint64 total_us;
+	uint32 max_us;
+	uint32 samples[PROFILE_SAMPLES]; // ring buffer, the next sample goes to calls%PROFILE_SAMPLES
+};
+
+static phase_data_t phase_data[step_profiler_t::MAX_PHASES];
+
+static std::string report_file;
+
+
+uint64 step_profiler_t::get_time_us()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+void step_profiler_t::add_sample(phase_t phase, uint32 us)
+{
+	phase_data_t &data = phase_data[phase];
+	data.samples[ data.calls % PROFILE_SAMPLES ] = us;
+	data.calls ++;
+	data.total_us += us;
+	if(  us > data.max_us  ) {
+		data.max_us = us;
+	}
+}
+
+
+void step_profiler_t::get_stats(phase_t phase, stats_t &stats)
+{
+	const phase_data_t &data = phase_data[phase];
+	stats.calls = data.calls;
+	stats.total_us = data.total_us;
+	stats.max_us = data.max_us;
+	stats.p50_us = 0;
+	stats.p99_us = 0;
+
+	const uint32 count = data.calls < PROFILE_SAMPLES ? (uint32)data.calls : PROFILE_SAMPLES;
+	if(  count > 0  ) {
+		uint32 sorted[PROFILE_SAMPLES];
+		std::copy( data.samples, data.samples + count, sorted );
+		std::sort( sorted, sorted + count );
+		stats.p50_us = sorted[ ((count - 1) * 50) / 100 ];
+		stats.p99_us = sorted[ ((count - 1) * 99) / 100 ];
+	}
+}
+
+
+const char *step_profiler_t::get_phase_name(phase_t phase)
+{
+	return phase < MAX_PHASES ? phase_names[phase] : "";
+}
+
+
+void step_profiler_t::reset()
+{
+	for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+		phase_data[i].calls = 0;
+		phase_data[i].total_us = 0;
+		phase_data[i].max_us = 0;
+	}
+}
+
+
+void step_profiler_t::print_report(cbuffer_t &buf)
+{
+	CSV_t csv;
+	csv.add_field( "phase" );
+	csv.add_field( "calls" );
+	csv.add_field( "total_ms" );
+	csv.add_field( "avg_us" );
+	csv.add_field( "p50_us" );
+	csv.add_field( "p99_us" );
+	csv.add_field( "max_us" );
+	csv.new_line();
+
+	for(  int i = 0;  i < MAX_PHASES;  i++  ) {
+		stats_t stats;
+		get_stats( (phase_t)i, stats );
+		csv.add_field( get_phase_name( (phase_t)i ) );
+		csv.add_field( (int)stats.calls );
+		csv.add_field( (int)(stats.total_us / 1000) );
+		csv.add_field( stats.calls ? (int)(stats.total_us / stats.calls) : 0 );
+		csv.add_field( (int)stats.p50_us );
+		csv.add_field( (int)stats.p99_us );
+		csv.add_field( (int)stats.max_us );
+		csv.new_line();
+	}
+	buf.append( csv.get_str() );
+}
+
+
+void step_profiler_t::set_report_file(const char *filename)
+{
+	report_file = filename ? filename : "";
+}
+
+
+bool step_profiler_t::write_report()
+{
+	if(  report_file.empty()  ) {
+		return false;
+	}
+
+	FILE *f = dr_fopen( report_file.c_str(), "w" );
+	if(  f == NULL  ) {
+		dbg->warning( "step_profiler_t::write_report()", "Cannot write profile to '%s'", report_file.c_str() );
+		return false;
+	}
+
+	cbuffer_t buf;
+	print_report( buf );
+	fputs( buf.get_str(), f );
+	fclose( f );
+	return true;
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef UTILS_STEP_PROFILER_H
+#define UTILS_STEP_PROFILER_H
+
+
+#include "../simtypes.h"
+
+
+class cbuffer_t;
+
+
+/**
+ * Records the wall time of the phases of karte_t::step() and karte_t::sync_step().
+ * Recording is cheap (two clock reads per phase), so it is always on.
+ * Totals and call counts run since the last reset(); the percentiles
+ * are taken from the last 1024 calls of each phase.
+ * Only to be used from the main thread.
+ */
+class step_profiler_t
+{
+public:
+	enum phase_t {
+		PHASE_CONVOI = 0, // convoi step (including the parallel route planning)
+		PHASE_CITY,       // city step and passenger generation
+		PHASE_FACTORY,
+		PHASE_POWERNET,   // powernet, pumps and consumers
+		PHASE_PLAYER,
+		PHASE_HALT,
+		PHASE_MONTH,      // new month and the month rollover of all objects
+		PHASE_SYNC,       // sync_list stepping
+		PHASE_DISPLAY,
+		MAX_PHASES
+	};
+
+	struct stats_t
+	{
+		uint64 calls;
+		uint64 total_us;
+		uint32 p50_us;
+		uint32 p99_us;
+		uint32 max_us;
+	};
+
+	/**
+	 * Measures one call of a phase, from construction until it goes out of scope.
+	 */
+	class scope_t
+	{
+		phase_t phase;
+		uint64 start;
+	public:
+		explicit scope_t(phase_t p) : phase(p), start(get_time_us()) {}
+		~scope_t() { add_sample( phase, (uint32)(get_time_us() - start) ); }
+	};
+
+	/// @returns a monotonic time in microseconds
+	static uint64 get_time_us();
+
+	static void add_sample(phase_t phase, uint32 us);
+
+	static void get_stats(phase_t phase, stats_t &stats);
+
+	/// @returns the untranslated name of the phase (also used in the report)
+	static const char *get_phase_name(phase_t phase);
+
+	static void reset();
+
+	/// appends all phases as CSV (one line per phase with a header line)
+	static void print_report(cbuffer_t &buf);
+
+	/// sets the file written by write_report(); NULL disables the report
+	static void set_report_file(const char *filename);
+
+	/// (over)writes the report file, if one was set with set_report_file()
+	static bool write_report();
+};
+
+#endif
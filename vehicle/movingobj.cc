@@ -18,6 +18,8 @@
 
 #include "../descriptor/groundobj_desc.h"
 
+#include "../tpl/freelist_tpl.h"
+
 #include "../utils/cbuffer_t.h"
 #include "../utils/simrandom.h"
 #include "../utils/simstring.h"
@@ -421,12 +423,12 @@ void movingobj_t::hop(grund_t* gr)
 
 void *movingobj_t::operator new(size_t /*s*/)
 {
-	return freelist_t::gimme_node(sizeof(movingobj_t));
+	return freelist_tpl<movingobj_t>::gimme_node("movingobj_t");
 }
 
 
 
 void movingobj_t::operator delete(void *p)
 {
-	freelist_t::putback_node(sizeof(movingobj_t),p);
+	freelist_tpl<movingobj_t>::putback_node(p);
 }
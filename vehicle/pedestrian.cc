@@ -14,6 +14,7 @@
 #include "../dataobj/loadsave.h"
 #include "../dataobj/translator.h"
 
+#include "../tpl/freelist_tpl.h"
 #include "../utils/cbuffer_t.h"
 #include "../descriptor/pedestrian_desc.h"
 
@@ -388,11 +389,11 @@ void pedestrian_t::info(cbuffer_t & buf) const
 
 void *pedestrian_t::operator new(size_t /*s*/)
 {
-	return freelist_t::gimme_node(sizeof(pedestrian_t));
+	return freelist_tpl<pedestrian_t>::gimme_node("pedestrian_t");
 }
 
 
 void pedestrian_t::operator delete(void *p)
 {
-	freelist_t::putback_node(sizeof(pedestrian_t),p);
+	freelist_tpl<pedestrian_t>::putback_node(p);
 }
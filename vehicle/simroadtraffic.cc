@@ -35,6 +35,8 @@
 #include "../descriptor/roadsign_desc.h"
 
 
+#include "../tpl/freelist_tpl.h"
+
 #include "../utils/cbuffer_t.h"
 
 /**********************************************************************************************************************/
@@ -328,6 +330,18 @@ private_car_t::~private_car_t()
 }
 
 
+void *private_car_t::operator new(size_t /*s*/)
+{
+	return freelist_tpl<private_car_t>::gimme_node("private_car_t");
+}
+
+
+void private_car_t::operator delete(void *p)
+{
+	freelist_tpl<private_car_t>::putback_node(p);
+}
+
+
 private_car_t::private_car_t(loadsave_t *file) :
 	road_user_t()
 {
@@ -1497,19 +1511,11 @@ bool private_car_t::can_overtake( overtaker_t *other_overtaker, sint32 other_spe
 			}
 			if(  overtaking_mode > oneway_mode  ) {
 				// Check for other vehicles on the next tile
-				const uint8 top = gr->get_top();
-				for(  uint8 j=1;  j<top;  j++  ) {
-					if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j))  ) {
-						// check for other traffic on the road
-						const overtaker_t *ov = v->get_overtaker();
-						if(ov) {
-							if(this!=ov  &&  other_overtaker!=ov) {
-								return false;
-							}
-						}
-						else if(  v->get_waytype()==road_wt  &&  v->get_typ()!=obj_t::pedestrian  ) {
-							return false;
-						}
+				FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+					// check for other traffic on the road
+					const overtaker_t *ov = v->get_overtaker();
+					if(  ov==NULL  ||  (this!=ov  &&  other_overtaker!=ov)  ) {
+						return false;
 					}
 				}
 			}
@@ -1622,29 +1628,28 @@ bool private_car_t::can_overtake( overtaker_t *other_overtaker, sint32 other_spe
 		}
 
 		// Check for other vehicles on the next tile
-		const uint8 top = gr->get_top();
-		for(  uint8 j=1;  j<top;  j++  ) {
-			if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j))  ) {
-				// check for other traffic on the road
-				const overtaker_t *ov = v->get_overtaker();
-				if(ov) {
-					if(this!=ov  &&  other_overtaker!=ov) {
-						if(  static_cast<strasse_t*>(gr->get_weg(road_wt))->get_overtaking_mode() <= oneway_mode  ) {
-							//If ov goes same directory, should not return false
-							if (v && v->get_direction() != direction && v->get_overtaker()) {
-								return false;
-							}
-						}
-						else {
+		const strasse_t *gr_road = (const strasse_t *)gr->get_weg(road_wt);
+		FOR(vector_tpl<vehicle_base_t *>, const v, gr_road->get_occupants()) {
+			// check for other traffic on the road
+			const overtaker_t *ov = v->get_overtaker();
+			if(ov) {
+				if(this!=ov  &&  other_overtaker!=ov) {
+					if(  gr_road->get_overtaking_mode() <= oneway_mode  ) {
+						//If ov goes same directory, should not return false
+						if (v->get_direction() != direction) {
 							return false;
 						}
+					}
+					else {
 						return false;
 					}
-				}
-				else if(  v->get_waytype()==road_wt  &&  v->get_typ()!=obj_t::pedestrian  ) {
 					return false;
 				}
 			}
+			else {
+				// sheep etc.
+				return false;
+			}
 		}
 
 		gr = to;
@@ -1705,10 +1710,8 @@ bool private_car_t::can_overtake( overtaker_t *other_overtaker, sint32 other_spe
 		// Check for other vehicles in facing direction
 		// now only I know direction on this tile ...
 		ribi_t::ribi their_direction = ribi_t::backward(calc_direction( pos_prev_prev, to->get_pos()));
-		const uint8 top = gr->get_top();
-		for(  uint8 j=1;  j<top;  j++ ) {
-			vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(j));
-			if(  v  &&  v->get_direction() == their_direction  ) {
+		FOR(vector_tpl<vehicle_base_t *>, const v, ((const strasse_t *)gr->get_weg(road_wt))->get_occupants()) {
+			if(  v->get_direction() == their_direction  ) {
 				// check for car
 				if(v->get_overtaker()) {
 					return false;
@@ -1776,41 +1779,36 @@ vehicle_base_t* private_car_t::is_there_car (grund_t *gr) const
 	if(  !str  ||  (str->get_overtaking_mode()>=twoway_mode  &&  str->get_overtaking_mode()<inverted_mode)  ) {
 		return NULL;
 	}
-	for(  uint8 pos=1;  pos<(volatile uint8)gr->get_top();  pos++  ) {
-		if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(pos))  ) {
-			if(  v->get_typ()==obj_t::pedestrian  ) {
+	FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+		if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
+			if(  is_overtaking() && at->get_convoi()->is_overtaking()  ){
 				continue;
 			}
-			if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
-				if(  is_overtaking() && at->get_convoi()->is_overtaking()  ){
-					continue;
-				}
-				if(  !is_overtaking() && !(at->get_convoi()->is_overtaking())  ){
-					//Prohibit going on passing lane when facing traffic exists.
-					ribi_t::ribi other_direction = at->get_direction();
-					if(  ribi_t::backward(get_direction()) == other_direction  ) {
-						return v;
-					}
-					continue;
+			if(  !is_overtaking() && !(at->get_convoi()->is_overtaking())  ){
+				//Prohibit going on passing lane when facing traffic exists.
+				ribi_t::ribi other_direction = at->get_direction();
+				if(  ribi_t::backward(get_direction()) == other_direction  ) {
+					return v;
 				}
-				// speed zero check must be done by parent function.
-				return v;
+				continue;
 			}
-			else if(  private_car_t* const caut = obj_cast<private_car_t>(v)  ) {
-				if(  is_overtaking() && caut->is_overtaking()  ){
-					continue;
-				}
-				if(  !is_overtaking() && !(caut->is_overtaking())  ){
-					//Prohibit going on passing lane when facing traffic exists.
-					ribi_t::ribi other_direction = caut->get_direction();
-					if(  ribi_t::backward(get_direction()) == other_direction  ) {
-						return v;
-					}
-					continue;
+			// speed zero check must be done by parent function.
+			return v;
+		}
+		else if(  private_car_t* const caut = obj_cast<private_car_t>(v)  ) {
+			if(  is_overtaking() && caut->is_overtaking()  ){
+				continue;
+			}
+			if(  !is_overtaking() && !(caut->is_overtaking())  ){
+				//Prohibit going on passing lane when facing traffic exists.
+				ribi_t::ribi other_direction = caut->get_direction();
+				if(  ribi_t::backward(get_direction()) == other_direction  ) {
+					return v;
 				}
-				// speed zero check must be done by parent function.
-				return v;
+				continue;
 			}
+			// speed zero check must be done by parent function.
+			return v;
 		}
 	}
 	return NULL;
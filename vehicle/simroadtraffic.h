@@ -138,6 +138,9 @@ public:
 
 	virtual ~private_car_t();
 
+	void * operator new(size_t s);
+	void operator delete(void *p);
+
 	void rotate90() OVERRIDE;
 
 	const citycar_desc_t *get_desc() const { return desc; }
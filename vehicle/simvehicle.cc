@@ -56,6 +56,8 @@
 #include "../dataobj/translator.h"
 #include "../dataobj/loadsave.h"
 #include "../dataobj/environment.h"
+#include "../dataobj/route_graph.h"
+#include "../dataobj/block_graph.h"
 
 #include "../utils/simstring.h"
 #include "../utils/cbuffer_t.h"
@@ -530,84 +532,82 @@ vehicle_base_t *vehicle_base_t::no_cars_blocking( const grund_t *gr, const convo
 		cnv_overtaking = false; //treated as convoi is not
 		break;
 	}
+	const strasse_t *str = (const strasse_t *)gr->get_weg(road_wt);
+	if(  str==NULL  ) {
+		return NULL;
+	}
 	// Search vehicle
-	for(  uint8 pos=1;  pos<(uint8)gr->get_top();  pos++  ) {
-		if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(pos))  ) {
-			if(  v->get_typ()==obj_t::pedestrian  ) {
+	FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+		// check for car
+		uint8 other_direction=255;
+		bool other_moving = false;
+		bool other_overtaking = false; //whether the other convoi is on passing lane.
+		if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
+			// ignore ourself
+			if(  cnv == at->get_convoi()  ) {
 				continue;
 			}
-
-			// check for car
-			uint8 other_direction=255;
-			bool other_moving = false;
-			bool other_overtaking = false; //whether the other convoi is on passing lane.
-			if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
-				// ignore ourself
-				if(  cnv == at->get_convoi()  ) {
-					continue;
-				}
-				other_direction = at->get_direction();
-				other_moving = at->get_convoi()->get_akt_speed() > kmh_to_speed(1);
-				other_overtaking = at->get_convoi()->is_overtaking();
-			}
-			// check for city car
-			else if(  v->get_waytype() == road_wt  ) {
-				other_direction = v->get_direction();
-				if(  private_car_t const* const sa = obj_cast<private_car_t>(v)  ){
-					if(  pcar == sa  ) {
-						continue; // ignore ourself
-					}
-					other_moving = sa->get_current_speed() > 1;
-					other_overtaking = sa->is_overtaking();
+			other_direction = at->get_direction();
+			other_moving = at->get_convoi()->get_akt_speed() > kmh_to_speed(1);
+			other_overtaking = at->get_convoi()->is_overtaking();
+		}
+		// check for city car
+		else if(  v->get_waytype() == road_wt  ) {
+			other_direction = v->get_direction();
+			if(  private_car_t const* const sa = obj_cast<private_car_t>(v)  ){
+				if(  pcar == sa  ) {
+					continue; // ignore ourself
 				}
+				other_moving = sa->get_current_speed() > 1;
+				other_overtaking = sa->is_overtaking();
 			}
+		}
 
-			// ok, there is another car ...
-			if(  other_direction != 255  ) {
-				if(  next_direction == other_direction  &&  !ribi_t::is_threeway(gr->get_weg_ribi(road_wt))  &&  cnv_overtaking == other_overtaking  ) {
-					// only consider cars on same lane.
-					// cars going in the same direction and no crossing => that mean blocking ...
-					return v;
-				}
-
-				const ribi_t::ribi other_90direction = (gr->get_pos().get_2d() == v->get_pos_next().get_2d()) ? other_direction : calc_direction(gr->get_pos(), v->get_pos_next());
-				if(  other_90direction == next_90direction   &&  cnv_overtaking == other_overtaking  ) {
-					// Want to exit in same as other   ~50% of the time
-					return v;
-				}
+		// ok, there is another car ...
+		if(  other_direction != 255  ) {
+			if(  next_direction == other_direction  &&  !ribi_t::is_threeway(gr->get_weg_ribi(road_wt))  &&  cnv_overtaking == other_overtaking  ) {
+				// only consider cars on same lane.
+				// cars going in the same direction and no crossing => that mean blocking ...
+				return v;
+			}
 
-				const bool drives_on_left = welt->get_settings().is_drive_left();
-				const bool across = next_direction == (drives_on_left ? ribi_t::rotate45l(next_90direction) : ribi_t::rotate45(next_90direction)); // turning across the opposite directions lane
-				const bool other_across = other_direction == (drives_on_left ? ribi_t::rotate45l(other_90direction) : ribi_t::rotate45(other_90direction)); // other is turning across the opposite directions lane
-				if(  other_direction == next_direction  &&  !(other_across || across)  &&  cnv_overtaking == other_overtaking) {
-					// only consider cars on same lane.
-					// entering same straight waypoint as other ~18%
-					return v;
-				}
+			const ribi_t::ribi other_90direction = (gr->get_pos().get_2d() == v->get_pos_next().get_2d()) ? other_direction : calc_direction(gr->get_pos(), v->get_pos_next());
+			if(  other_90direction == next_90direction   &&  cnv_overtaking == other_overtaking  ) {
+				// Want to exit in same as other   ~50% of the time
+				return v;
+			}
 
-				const bool straight = next_direction == next_90direction; // driving straight
-				const ribi_t::ribi current_90direction = straight ? ribi_t::backward(next_90direction) : (~(next_direction|ribi_t::backward(next_90direction)))&0x0F;
-				const bool other_straight = other_direction == other_90direction; // other is driving straight
-				const bool other_exit_same_side = current_90direction == other_90direction; // other is exiting same side as we're entering
-				const bool other_exit_opposite_side = ribi_t::backward(current_90direction) == other_90direction; // other is exiting side across from where we're entering
-				if(  across  &&  ((ribi_t::is_perpendicular(current_90direction,other_direction)  &&  other_moving)  ||  (other_across  &&  other_exit_opposite_side)  ||  ((other_across  ||  other_straight)  &&  other_exit_same_side  &&  other_moving) ) )  {
-					// other turning across in front of us from orth entry dir'n   ~4%
-					return v;
-				}
+			const bool drives_on_left = welt->get_settings().is_drive_left();
+			const bool across = next_direction == (drives_on_left ? ribi_t::rotate45l(next_90direction) : ribi_t::rotate45(next_90direction)); // turning across the opposite directions lane
+			const bool other_across = other_direction == (drives_on_left ? ribi_t::rotate45l(other_90direction) : ribi_t::rotate45(other_90direction)); // other is turning across the opposite directions lane
+			if(  other_direction == next_direction  &&  !(other_across || across)  &&  cnv_overtaking == other_overtaking) {
+				// only consider cars on same lane.
+				// entering same straight waypoint as other ~18%
+				return v;
+			}
 
-				const bool headon = ribi_t::backward(current_direction) == other_direction; // we're meeting the other headon
-				const bool other_exit_across = (drives_on_left ? ribi_t::rotate90l(next_90direction) : ribi_t::rotate90(next_90direction)) == other_90direction; // other is exiting by turning across the opposite directions lane
-				if(  straight  &&  (ribi_t::is_perpendicular(current_90direction,other_direction)  ||  (other_across  &&  other_moving  &&  (other_exit_across  ||  (other_exit_same_side  &&  !headon))) ) ) {
-					// other turning across in front of us, but allow if other is stopped - duplicating historic behaviour   ~2%
-					return v;
-				}
-				else if(  other_direction == current_direction  &&  current_90direction == ribi_t::none  &&  cnv_overtaking == other_overtaking  ) {
-					// entering same diagonal waypoint as other   ~1%
-					return v;
-				}
+			const bool straight = next_direction == next_90direction; // driving straight
+			const ribi_t::ribi current_90direction = straight ? ribi_t::backward(next_90direction) : (~(next_direction|ribi_t::backward(next_90direction)))&0x0F;
+			const bool other_straight = other_direction == other_90direction; // other is driving straight
+			const bool other_exit_same_side = current_90direction == other_90direction; // other is exiting same side as we're entering
+			const bool other_exit_opposite_side = ribi_t::backward(current_90direction) == other_90direction; // other is exiting side across from where we're entering
+			if(  across  &&  ((ribi_t::is_perpendicular(current_90direction,other_direction)  &&  other_moving)  ||  (other_across  &&  other_exit_opposite_side)  ||  ((other_across  ||  other_straight)  &&  other_exit_same_side  &&  other_moving) ) )  {
+				// other turning across in front of us from orth entry dir'n   ~4%
+				return v;
+			}
 
-				// else other car is not blocking   ~25%
+			const bool headon = ribi_t::backward(current_direction) == other_direction; // we're meeting the other headon
+			const bool other_exit_across = (drives_on_left ? ribi_t::rotate90l(next_90direction) : ribi_t::rotate90(next_90direction)) == other_90direction; // other is exiting by turning across the opposite directions lane
+			if(  straight  &&  (ribi_t::is_perpendicular(current_90direction,other_direction)  ||  (other_across  &&  other_moving  &&  (other_exit_across  ||  (other_exit_same_side  &&  !headon))) ) ) {
+				// other turning across in front of us, but allow if other is stopped - duplicating historic behaviour   ~2%
+				return v;
+			}
+			else if(  other_direction == current_direction  &&  current_90direction == ribi_t::none  &&  cnv_overtaking == other_overtaking  ) {
+				// entering same diagonal waypoint as other   ~1%
+				return v;
 			}
+
+			// else other car is not blocking   ~25%
 		}
 	}
 
@@ -678,7 +678,7 @@ void vehicle_t::rotate90()
 void vehicle_t::rotate90_freight_destinations(const sint16 y_size)
 {
 	// now rotate the freight
-	FOR(slist_tpl<ware_t>, & tmp, fracht) {
+	FOR(vehicle_cargo_t, & tmp, fracht) {
 		tmp.rotate90(y_size );
 	}
 }
@@ -716,7 +716,7 @@ void vehicle_t::set_convoi(convoi_t *c)
 			}
 		}
 		// just correct freight destinations
-		FOR(slist_tpl<ware_t>, & c, fracht) {
+		FOR(vehicle_cargo_t, & c, fracht) {
 			c.finish_rd(welt);
 		}
 	}
@@ -737,7 +737,7 @@ uint16 vehicle_t::unload_cargo(halthandle_t halt, bool unload_all )
 	if(  halt->is_enabled( get_cargo_type() )  ) {
 		if(  !fracht.empty()  ) {
 
-			for(  slist_tpl<ware_t>::iterator i = fracht.begin(), end = fracht.end();  i != end;  ) {
+			for(  vehicle_cargo_t::iterator i = fracht.begin();  i != fracht.end();  ) {
 				const ware_t& tmp = *i;
 
 				halthandle_t end_halt = tmp.get_ziel();
@@ -823,35 +823,12 @@ uint16 vehicle_t::load_cargo(halthandle_t halt, const vector_tpl<halthandle_t>&
 			return 0;
 		}
 
-		for(  slist_tpl<ware_t>::iterator iter_z = freight_add.begin();  iter_z != freight_add.end();  ) {
-			ware_t &ware = *iter_z;
-
+		FOR( slist_tpl<ware_t>, const& ware, freight_add ) {
 			total_freight += ware.menge;
 			sum_weight += ware.menge * ware.get_desc()->get_weight_per_unit();
 
-			// could this be joined with existing freight?
-			FOR( slist_tpl<ware_t>, & tmp, fracht ) {
-				// for pax: join according next stop
-				// for all others we *must* use target coordinates
-				if(  ware.same_destination(tmp)  ) {
-					tmp.menge += ware.menge;
-					ware.menge = 0;
-					break;
-				}
-			}
-
-			// if != 0 we could not join it to existing => load it
-			if(  ware.menge != 0  ) {
-				++iter_z;
-				// we add list directly
-			}
-			else {
-				iter_z = freight_add.erase(iter_z);
-			}
-		}
-
-		if(  !freight_add.empty()  ) {
-			fracht.append_list(freight_add);
+			// joined with existing freight if possible
+			fracht.add( ware );
 		}
 	}
 	return total_freight - total_freight_start;
@@ -869,11 +846,11 @@ void vehicle_t::remove_stale_cargo()
 	// and now check every piece of ware on board,
 	// if its target is somewhere on
 	// the new schedule, if not -> remove
-	slist_tpl<ware_t> kill_queue;
 	total_freight = 0;
 
 	if (!fracht.empty()) {
-		FOR(slist_tpl<ware_t>, & tmp, fracht) {
+		for(  vehicle_cargo_t::iterator i = fracht.begin();  i != fracht.end();  ) {
+			ware_t &tmp = *i;
 			bool found = false;
 
 			if(  tmp.get_zwischenziel().is_bound()  ) {
@@ -908,7 +885,8 @@ void vehicle_t::remove_stale_cargo()
 			}
 
 			if(  !found  ) {
-				kill_queue.insert(tmp);
+				fabrik_t::update_transit( &tmp, false );
+				i = fracht.erase( i );
 			}
 			else {
 				// since we need to point at factory (0,0), we recheck this too
@@ -917,13 +895,9 @@ void vehicle_t::remove_stale_cargo()
 				tmp.set_zielpos( fab ? fab->get_pos().get_2d() : k );
 
 				total_freight += tmp.menge;
+				++i;
 			}
 		}
-
-		FOR(slist_tpl<ware_t>, const& c, kill_queue) {
-			fabrik_t::update_transit( &c, false );
-			fracht.remove(c);
-		}
 	}
 	sum_weight =  get_cargo_weight() + desc->get_weight();
 }
@@ -1043,9 +1017,20 @@ vehicle_t::vehicle_t() :
 }
 
 
-bool vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route)
+bool vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared)
 {
-	return route->calc_route(welt, start, ziel, this, max_speed, 0 );
+	return route->calc_route(welt, start, ziel, this, max_speed, get_route_max_len(), prepared );
+}
+
+
+void vehicle_t::plan_route(koord3d start, koord3d ziel, sint32 max_speed, route_t::prepared_t &prepared, uint8 thread_num)
+{
+	// calc_route() releases the target stop before searching, and with a target stop
+	// check_next_tile() would look for a free stop instead; so search without it too
+	const halthandle_t old_target_halt = target_halt;
+	target_halt = halthandle_t();
+	route_t::prepare_route( welt, start, ziel, this, max_speed, get_route_max_len(), prepared, thread_num );
+	target_halt = old_target_halt;
 }
 
 
@@ -1152,7 +1137,7 @@ void vehicle_t::leave_tile()
 	vehicle_base_t::leave_tile();
 #ifndef DEBUG_ROUTES
 	if(last  &&  minimap_t::is_visible) {
-			minimap_t::get_instance()->calc_map_pixel(get_pos().get_2d());
+			minimap_t::get_instance()->invalidate_map_pixel(get_pos().get_2d());
 	}
 #endif
 }
@@ -1165,7 +1150,7 @@ void vehicle_t::enter_tile(grund_t* gr)
 	vehicle_base_t::enter_tile(gr);
 
 	if(leading  &&  minimap_t::is_visible  ) {
-		minimap_t::get_instance()->calc_map_pixel( get_pos().get_2d() );
+		minimap_t::get_instance()->invalidate_map_pixel( get_pos().get_2d() );
 	}
 }
 
@@ -1380,7 +1365,7 @@ sint64 vehicle_t::calc_revenue(const koord3d& start, const koord3d& end) const
 		dist = koord_distance( start, end );
 	}
 
-	FOR(slist_tpl<ware_t>, const& ware, fracht) {
+	FOR(vehicle_cargo_t, const& ware, fracht) {
 		if(  ware.menge==0  ) {
 			continue;
 		}
@@ -1441,7 +1426,7 @@ uint32 vehicle_t::get_cargo_weight() const
 {
 	uint32 weight = 0;
 
-	FOR(slist_tpl<ware_t>, const& c, fracht) {
+	FOR(vehicle_cargo_t, const& c, fracht) {
 		weight += c.menge * c.get_desc()->get_weight_per_unit();
 	}
 	return weight;
@@ -1455,7 +1440,7 @@ void vehicle_t::get_cargo_info(cbuffer_t & buf) const
 		buf.append(translator::translate("leer"));
 		buf.append("\n");
 	} else {
-		FOR(slist_tpl<ware_t>, const& ware, fracht) {
+		FOR(vehicle_cargo_t, const& ware, fracht) {
 			const char * name = "Error in Routing";
 
 			halthandle_t halt = ware.get_ziel();
@@ -1474,7 +1459,7 @@ void vehicle_t::get_cargo_info(cbuffer_t & buf) const
  */
 void vehicle_t::discard_cargo()
 {
-	FOR(  slist_tpl<ware_t>, w, fracht ) {
+	FOR(  vehicle_cargo_t, w, fracht ) {
 		fabrik_t::update_transit( &w, false );
 	}
 	fracht.clear();
@@ -1672,7 +1657,7 @@ DBG_MESSAGE("vehicle_t::rdwr_from_convoi()","bought at %i/%i.",(purchase_time%12
 			ware.rdwr(file);
 		}
 		else {
-			FOR(slist_tpl<ware_t>, ware, fracht) {
+			FOR(vehicle_cargo_t, ware, fracht) {
 				ware.rdwr(file);
 			}
 		}
@@ -1745,7 +1730,7 @@ DBG_MESSAGE("vehicle_t::rdwr_from_convoi()","bought at %i/%i.",(purchase_time%12
 		}
 		// recalc total freight
 		total_freight = 0;
-		FOR(slist_tpl<ware_t>, const& c, fracht) {
+		FOR(vehicle_cargo_t, const& c, fracht) {
 			total_freight += c.menge;
 		}
 	}
@@ -1810,7 +1795,7 @@ ribi_t::ribi vehicle_t::get_next_90direction() const {
 vehicle_t::~vehicle_t()
 {
 	// remove vehicle's marker from the minimap
-	minimap_t::get_instance()->calc_map_pixel(get_pos().get_2d());
+	minimap_t::get_instance()->invalidate_map_pixel(get_pos().get_2d());
 }
 
 
@@ -2033,7 +2018,7 @@ road_vehicle_t::road_vehicle_t(loadsave_t *file, bool is_first, bool is_last) :
 			}
 			if(!fracht.empty()  &&  fracht.front().menge == 0) {
 				// this was only there to find a matching vehicle
-				fracht.remove_first();
+				fracht.remove_at(0);
 			}
 		}
 		if(  desc  ) {
@@ -2076,7 +2061,13 @@ void road_vehicle_t::calc_disp_lane()
 }
 
 // need to reset halt reservation (if there was one)
-bool road_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route)
+sint32 road_vehicle_t::get_route_max_len() const
+{
+	return cnv->get_entire_convoy_length();
+}
+
+
+bool road_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared)
 {
 	assert(cnv);
 	// free target reservation
@@ -2087,7 +2078,7 @@ bool road_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, r
 		}
 	}
 	target_halt = halthandle_t(); // no block reserved
-	route_t::route_result_t r = route->calc_route(welt, start, ziel, this, max_speed, cnv->get_entire_convoy_length() );
+	route_t::route_result_t r = route->calc_route(welt, start, ziel, this, max_speed, get_route_max_len(), prepared );
 	if(  r == route_t::valid_route_halt_too_short  ) {
 		cbuffer_t buf;
 		buf.printf( translator::translate("Vehicle %s cannot choose because stop too short!"), cnv->get_name());
@@ -2948,51 +2939,46 @@ vehicle_base_t* road_vehicle_t::other_lane_blocked(const bool only_search_top, s
 
 			bool ignore_stucked = !only_search_top  &&  test_index==end_index;
 
-			for(  uint8 pos=1;  pos<(volatile uint8)gr->get_top();  pos++  ) {
-				if(  vehicle_base_t* const v = obj_cast<vehicle_base_t>(gr->obj_bei(pos))  ) {
-					if(  v->get_typ()==obj_t::pedestrian  ) {
+			FOR(vector_tpl<vehicle_base_t *>, const v, str->get_occupants()) {
+				if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
+					// ignore ourself
+					if(  cnv == at->get_convoi()  ) {
 						continue;
 					}
-					if(  road_vehicle_t const* const at = obj_cast<road_vehicle_t>(v)  ) {
-						// ignore ourself
-						if(  cnv == at->get_convoi()  ) {
-							continue;
-						}
-						if(  cnv->is_overtaking() == at->get_convoi()->is_overtaking()  ){
-							continue;
-						}
-						// Ignore stopping convoi on the tile behind this convoi to change lane in traffic jam.
-						if(  ignore_stucked  &&  at->get_convoi()->get_akt_speed() == 0  ) {
-							continue;
-						}
-						if(  test_index==tail_index-1+offset  ||  test_index==tail_index+offset  ){
-							uint8 tail_offset = 0;
-							if(  test_index==tail_index-1+offset  ) tail_offset = 1;
-							if(  test_index+tail_offset>=1  &&  test_index+tail_offset<(sint32)r.get_count()-1  &&   judge_lane_crossing(calc_direction(r.at(test_index-1u+tail_offset),r.at(test_index+tail_offset)), calc_direction(r.at(test_index+tail_offset),r.at(test_index+1u+tail_offset)),  v->get_90direction(), cnv->is_overtaking(), true)  ){
-								return v;
-							}
-							continue;
-						}
-						return v;
+					if(  cnv->is_overtaking() == at->get_convoi()->is_overtaking()  ){
+						continue;
 					}
-					else if(  private_car_t* const caut = obj_cast<private_car_t>(v)  ) {
-						if(  cnv->is_overtaking() == caut->is_overtaking()  ){
-							continue;
-						}
-						// Ignore stopping convoi on the tile behind this convoi to change lane in traffic jam.
-						if(  ignore_stucked  &&  caut->get_current_speed() == 0  ) {
-							continue;
+					// Ignore stopping convoi on the tile behind this convoi to change lane in traffic jam.
+					if(  ignore_stucked  &&  at->get_convoi()->get_akt_speed() == 0  ) {
+						continue;
+					}
+					if(  test_index==tail_index-1+offset  ||  test_index==tail_index+offset  ){
+						uint8 tail_offset = 0;
+						if(  test_index==tail_index-1+offset  ) tail_offset = 1;
+						if(  test_index+tail_offset>=1  &&  test_index+tail_offset<(sint32)r.get_count()-1  &&   judge_lane_crossing(calc_direction(r.at(test_index-1u+tail_offset),r.at(test_index+tail_offset)), calc_direction(r.at(test_index+tail_offset),r.at(test_index+1u+tail_offset)),  v->get_90direction(), cnv->is_overtaking(), true)  ){
+							return v;
 						}
-						if(  test_index==tail_index-1+offset  ||  test_index==tail_index+offset  ){
-							uint8 tail_offset = 0;
-							if(  test_index==tail_index-1+offset  ) tail_offset = 1;
-							if(  test_index+tail_offset>=1  &&  test_index+tail_offset<(sint32)r.get_count()-1  &&   judge_lane_crossing(calc_direction(r.at(test_index-1u+tail_offset),r.at(test_index+tail_offset)), calc_direction(r.at(test_index+tail_offset),r.at(test_index+1u+tail_offset)),  v->get_90direction(), cnv->is_overtaking(), true)  ){
-								return v;
-							}
-							continue;
+						continue;
+					}
+					return v;
+				}
+				else if(  private_car_t* const caut = obj_cast<private_car_t>(v)  ) {
+					if(  cnv->is_overtaking() == caut->is_overtaking()  ){
+						continue;
+					}
+					// Ignore stopping convoi on the tile behind this convoi to change lane in traffic jam.
+					if(  ignore_stucked  &&  caut->get_current_speed() == 0  ) {
+						continue;
+					}
+					if(  test_index==tail_index-1+offset  ||  test_index==tail_index+offset  ){
+						uint8 tail_offset = 0;
+						if(  test_index==tail_index-1+offset  ) tail_offset = 1;
+						if(  test_index+tail_offset>=1  &&  test_index+tail_offset<(sint32)r.get_count()-1  &&   judge_lane_crossing(calc_direction(r.at(test_index-1u+tail_offset),r.at(test_index+tail_offset)), calc_direction(r.at(test_index+tail_offset),r.at(test_index+1u+tail_offset)),  v->get_90direction(), cnv->is_overtaking(), true)  ){
+							return v;
 						}
-						return v;
+						continue;
 					}
+					return v;
 				}
 			}
 			if(  only_search_top  ) {
@@ -3197,7 +3183,7 @@ DBG_MESSAGE("rail_vehicle_t::rail_vehicle_t()","replaced by %s",desc->get_name()
 			}
 			if (!fracht.empty() && fracht.front().menge == 0) {
 				// this was only there to find a matching vehicle
-				fracht.remove_first();
+				fracht.remove_at(0);
 			}
 		}
 		// update last desc
@@ -3276,7 +3262,13 @@ void rail_vehicle_t::set_convoi(convoi_t *c)
 
 
 // need to reset halt reservation (if there was one)
-bool rail_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route)
+sint32 rail_vehicle_t::get_route_max_len() const
+{
+	return welt->get_settings().get_advance_to_end() ? 8888 : (uint16)cnv->get_entire_convoy_length();
+}
+
+
+bool rail_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared)
 {
 	if(  leading  ) {
 		// free all reserved blocks
@@ -3284,8 +3276,7 @@ bool rail_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, r
 	}
 	cnv->set_next_reservation_index( 0 );	// nothing to reserve
 	target_halt = halthandle_t();	// no block reserved
-	uint16 len = welt->get_settings().get_advance_to_end() ? 8888 : cnv->get_entire_convoy_length();
-	return route->calc_route(welt, start, ziel, this, max_speed, len);
+	return route->calc_route(welt, start, ziel, this, max_speed, get_route_max_len(), prepared);
 }
 
 
@@ -3390,6 +3381,28 @@ int rail_vehicle_t::get_cost(const grund_t *gr, const weg_t *w, const sint32 max
 }
 
 
+// same as check_next_tile() and get_cost() for all inner tiles of the edge
+bool rail_vehicle_t::get_edge_cost(const route_edge_t &edge, const sint32 max_speed, uint32 &cost) const
+{
+	if(  !edge.plain  ||  target_halt.is_bound()  ) {
+		// signs, signals or searching a free stop: check each tile
+		return false;
+	}
+	const bool needs_no_electric = !(cnv!=NULL ? cnv->needs_electrification() : desc->get_engine_type()==vehicle_desc_t::electric);
+	if(  !needs_no_electric  &&  !edge.electrified  ) {
+		// the tile search finds out where it ends
+		return false;
+	}
+
+	cost = 25 * edge.upslopes;
+	for(  uint8 i = 0;  i < edge.speeds;  i++  ) {
+		const sint32 max_tile_speed = edge.speed[i];
+		cost += edge.speed_count[i] * ( (max_speed<=max_tile_speed) ? 1 : 4-(3*max_tile_speed)/max_speed );
+	}
+	return true;
+}
+
+
 // this routine is called by find_route, to determined if we reached a destination
 bool rail_vehicle_t::is_target(const grund_t *gr,const grund_t *prev_gr) const
 {
@@ -3596,6 +3609,7 @@ bool rail_vehicle_t::is_choose_signal_clear(signal_t *sig, const uint16 start_bl
 
 	uint16 next_signal, next_crossing;
 	grund_t const* const target = welt->lookup(cnv->get_route()->back());
+	block_route_tracks_t tracks( cnv->get_route(), get_waytype() );
 
 	if(  cnv->get_schedule_target()!=koord3d::invalid  ) {
 		// destination is a waypoint!
@@ -3647,6 +3661,9 @@ bool rail_vehicle_t::is_choose_signal_clear(signal_t *sig, const uint16 start_bl
 				choose_ok = false;
 			}
 		}
+		// nothing to check on the inner tiles of a segment without stops and signs
+		tracks.get( idx );
+		idx += tracks.get_inner_run( idx, cnv->get_route()->get_count()-1, true );
 	}
 
 skip_choose:
@@ -3660,6 +3677,7 @@ skip_choose:
 		// not free => wait here if directly in front
 		sig->set_state( roadsign_t::STATE_RED );
 		restart_speed = 0;
+		cnv->wait_for_blocking_track();
 		return false;
 	}
 
@@ -3878,6 +3896,7 @@ bool rail_vehicle_t::can_enter_tile(const grund_t *gr, sint32 &restart_speed, ui
 				return cnv->get_next_stop_index()>route_index;
 			} else {
 				restart_speed = 0;
+				cnv->wait_for_blocking_track();
 				return false;
 			}
 		}
@@ -3911,6 +3930,8 @@ bool rail_vehicle_t::can_enter_tile(const grund_t *gr, sint32 &restart_speed, ui
 	 */
 	if(  !w->can_reserve(cnv->self)  ) {
 		restart_speed = 0;
+		cnv->set_blocking_track( gr->get_pos() );
+		cnv->wait_for_blocking_track();
 		return false;
 	}
 
@@ -3932,6 +3953,9 @@ bool rail_vehicle_t::can_enter_tile(const grund_t *gr, sint32 &restart_speed, ui
 			cnv->set_next_coupling(next_coupling, next_c_steps);
 			cnv->set_next_stop_index(min(next_crossing,min(next_signal,next_coupling)));
 		}
+		else {
+			cnv->wait_for_blocking_track();
+		}
 		return ok;
 		// if reservation was not possible the train will wait on the track until block is free
 	}
@@ -4048,11 +4072,11 @@ bool rail_vehicle_t::block_reserver(const route_t *route, uint16 start_index, ui
 	next_signal_index=route_t::INVALID_INDEX;
 	next_crossing_index=route_t::INVALID_INDEX;
 	bool unreserve_now = false;
+	block_route_tracks_t tracks( route, get_waytype() );
 	for ( ; success  &&  count>=0  &&  i<route->get_count(); i++) {
 
 		koord3d pos = route->at(i);
-		grund_t *gr = welt->lookup(pos);
-		schiene_t * sch1 = gr ? (schiene_t *)gr->get_weg(get_waytype()) : NULL;
+		schiene_t * sch1 = tracks.get(i);
 		if(sch1==NULL  &&  reserve) {
 			// reserve until the end of track
 			break;
@@ -4068,13 +4092,14 @@ bool rail_vehicle_t::block_reserver(const route_t *route, uint16 start_index, ui
 		if(reserve) {
 			if(  sch1->has_signal()  &&  i<route->get_count()-1  ) {
 				if(count) {
-					signs.append(gr);
+					signs.append( welt->lookup(pos) );
 				}
 				count --;
 				next_signal_index = i;
 			}
 			if(  !sch1->reserve( cnv->self, ribi_type( route->at(max(1u,i)-1u), route->at(min(route->get_count()-1u,i+1u)) ) )  ) {
 				success = false;
+				cnv->set_blocking_track( pos );
 			}
 			else if(  use_vector  ){
 				// use reserved_tiles instead of next_reservation_index to hold reservations.
@@ -4083,6 +4108,22 @@ bool rail_vehicle_t::block_reserver(const route_t *route, uint16 start_index, ui
 			if(next_crossing_index==route_t::INVALID_INDEX  &&  sch1->is_crossing()) {
 				next_crossing_index = i;
 			}
+			if(  success  &&  count>=0  ) {
+				// the inner tiles of the segment have neither signals nor crossings,
+				// and the way through them is fixed: just reserve them
+				const uint16 run_end = i + tracks.get_inner_run( i, route->get_count()-1 );
+				while(  success  &&  i < run_end  ) {
+					i++;
+					const block_segment_t::tile_t &t = tracks.get_inner( i );
+					if(  !t.sch->reserve( cnv->self, t.dir )  ) {
+						success = false;
+						cnv->set_blocking_track( t.pos );
+					}
+					else if(  use_vector  ) {
+						cnv->reserve_pos( t.pos );
+					}
+				}
+			}
 		}
 		else if(sch1) {
 			if(!sch1->unreserve(cnv->self)) {
@@ -4098,13 +4139,28 @@ bool rail_vehicle_t::block_reserver(const route_t *route, uint16 start_index, ui
 				cnv->unreserve_pos(pos);
 			}
 			if(sch1->has_signal()) {
-				signal_t* signal = gr->find<signal_t>();
+				signal_t* signal = welt->lookup(pos)->find<signal_t>();
 				if(signal) {
 					signal->set_state(roadsign_t::STATE_RED);
 				}
 			}
 			if(sch1->is_crossing()) {
-				gr->find<crossing_t>()->release_crossing(this);
+				welt->lookup(pos)->find<crossing_t>()->release_crossing(this);
+			}
+			// likewise free the inner tiles of the segment
+			const uint16 run_end = i + tracks.get_inner_run( i, route->get_count()-1 );
+			while(  i < run_end  ) {
+				i++;
+				const block_segment_t::tile_t &t = tracks.get_inner( i );
+				if(  !t.sch->unreserve( cnv->self )  ) {
+					if(  unreserve_now  ) {
+						return false;
+					}
+				}
+				else {
+					unreserve_now = !force_unreserve;
+					cnv->unreserve_pos( t.pos );
+				}
 			}
 		}
 	}
@@ -4119,8 +4175,9 @@ bool rail_vehicle_t::block_reserver(const route_t *route, uint16 start_index, ui
 	// free, in case of un-reserve or no success in reservation
 	if(!success) {
 		// free reservation
+		block_route_tracks_t reserved_tracks( route, get_waytype() );
 		for ( int j=start_index; j<i; j++) {
-			schiene_t * sch1 = (schiene_t *)welt->lookup( route->at(j))->get_weg(get_waytype());
+			schiene_t * sch1 = reserved_tracks.get(j);
 			sch1->unreserve(cnv->self);
 			cnv->unreserve_pos(route->at(j));
 		}
@@ -4653,7 +4710,7 @@ DBG_MESSAGE("aircraft_t::find_route_to_stop_position()","found no route to free
 
 // main routine: searches the new route in up to three steps
 // must also take care of stops under traveling and the like
-bool air_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route)
+bool air_vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *)
 {
 //DBG_MESSAGE("aircraft_t::calc_route()","search route from %i,%i,%i to %i,%i,%i",start.x,start.y,start.z,ziel.x,ziel.y,ziel.z);
 
@@ -12,9 +12,11 @@
 #include "../halthandle_t.h"
 #include "../convoihandle_t.h"
 #include "../ifc/simtestdriver.h"
+#include "../dataobj/route.h"
 #include "../boden/grund.h"
 #include "../descriptor/vehicle_desc.h"
 #include "../vehicle/overtaker.h"
+#include "../vehicle/vehicle_cargo.h"
 #include "../tpl/slist_tpl.h"
 #include "../tpl/ptrhashtable_tpl.h"
 
@@ -22,7 +24,6 @@ class convoi_t;
 class schedule_t;
 class signal_t;
 class ware_t;
-class route_t;
 
 /*----------------------- Movables ------------------------------------*/
 
@@ -252,7 +253,7 @@ protected:
 	uint16 route_index;
 
 	uint16 total_freight; // since the sum is needed quite often, it is cached
-	slist_tpl<ware_t> fracht;   // list of goods being transported
+	vehicle_cargo_t fracht;   // list of goods being transported
 
 	const vehicle_desc_t *desc;
 
@@ -306,7 +307,23 @@ public:
 
 	void get_smoke(bool yesno ) { smoke = yesno;}
 
-	virtual bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route);
+	/**
+	 * Calculates a new route for the convoi into @p route.
+	 * @param prepared route searched ahead of time, see route_t::calc_route()
+	 */
+	virtual bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared = NULL);
+
+	/**
+	 * Searches the route calc_route() would find ahead of time into @p prepared.
+	 * Only changes this vehicle temporarily, so other convois can plan in other threads.
+	 * Not for aircraft, which search their route differently.
+	 */
+	void plan_route(koord3d start, koord3d ziel, sint32 max_speed, route_t::prepared_t &prepared, uint8 thread_num);
+
+	/**
+	 * How far the route is advanced into a halt at its end (16 is one tile), see route_t::calc_route()
+	 */
+	virtual sint32 get_route_max_len() const { return 0; }
 	uint16 get_route_index() const {return route_index;}
 
 	/**
@@ -366,7 +383,7 @@ public:
 	// the convoi takes care of the max_speed of the vehicle
 	sint32 get_speed_limit() const { return speed_limit; }
 
-	const slist_tpl<ware_t> & get_cargo() const { return fracht;}   // list of goods being transported
+	const vehicle_cargo_t & get_cargo() const { return fracht;}   // list of goods being transported
 
 	/**
 	 * Rotate freight target coordinates, has to be called after rotating factories.
@@ -520,7 +537,9 @@ public:
 
 	uint32 get_cost_upslope() const OVERRIDE { return 15; }
 
-	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route) OVERRIDE;
+	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared = NULL) OVERRIDE;
+
+	sint32 get_route_max_len() const OVERRIDE;
 
 	bool can_enter_tile(const grund_t *gr_next, sint32 &restart_speed, uint8 second_check_count) OVERRIDE;
 
@@ -573,13 +592,19 @@ public:
 	waytype_t get_waytype() const OVERRIDE { return track_wt; }
 
 	// since we might need to un-reserve previously used blocks, we must do this before calculation a new route
-	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route) OVERRIDE;
+	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared = NULL) OVERRIDE;
+
+	sint32 get_route_max_len() const OVERRIDE;
 
 	// how expensive to go here (for way search)
 	int get_cost(const grund_t *gr, const weg_t *w, const sint32 max_speed, ribi_t::ribi from) const OVERRIDE;
 
 	uint32 get_cost_upslope() const OVERRIDE { return 25; }
 
+	bool has_edge_cost() const OVERRIDE { return true; }
+
+	bool get_edge_cost(const route_edge_t &edge, const sint32 max_speed, uint32 &cost) const OVERRIDE;
+
 	// returns true for the way search to an unknown target.
 	bool is_target(const grund_t *,const grund_t *) const OVERRIDE;
 	bool is_coupling_target(const grund_t *, const grund_t *) const OVERRIDE;
@@ -788,7 +813,7 @@ public:
 
 	void set_convoi(convoi_t *c) OVERRIDE;
 
-	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route) OVERRIDE;
+	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route, route_t::prepared_t *prepared = NULL) OVERRIDE;
 
 	typ get_typ() const OVERRIDE { return air_vehicle; }
 
@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "vehicle_cargo.h"
+
+
+void vehicle_cargo_t::release()
+{
+	if(  data != local  ) {
+		delete [] data;
+		data = local;
+		size = LOCAL_SIZE;
+	}
+	count = 0;
+}
+
+
+bool vehicle_cargo_t::add(const ware_t &ware)
+{
+	for(  uint32 i = 0;  i < count;  i++  ) {
+		// for pax: join according next stop
+		// for all others we *must* use target coordinates
+		if(  ware.same_destination( data[i] )  ) {
+			data[i].menge += ware.menge;
+			return true;
+		}
+	}
+	append( ware );
+	return false;
+}
+
+
+void vehicle_cargo_t::append(const ware_t &ware)
+{
+	if(  count == size  ) {
+		size *= 2;
+		ware_t *new_data = new ware_t[size];
+		for(  uint32 i = 0;  i < count;  i++  ) {
+			new_data[i] = data[i];
+		}
+		if(  data != local  ) {
+			delete [] data;
+		}
+		data = new_data;
+	}
+	data[count++] = ware;
+}
+
+
+void vehicle_cargo_t::remove_at(uint32 i)
+{
+	count--;
+	for(  ;  i < count;  i++  ) {
+		data[i] = data[i+1];
+	}
+}
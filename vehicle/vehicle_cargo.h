@@ -0,0 +1,75 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef VEHICLE_VEHICLE_CARGO_H
+#define VEHICLE_VEHICLE_CARGO_H
+
+
+#include "../simtypes.h"
+#include "../simware.h"
+
+
+/**
+ * The goods loaded into a vehicle.
+ * The packets are stored contiguously; the first few are kept inside the object
+ * itself, since most vehicles carry only packets for a handful of destinations.
+ * Packets with the same destination (ware_t::same_destination) are joined by add().
+ */
+class vehicle_cargo_t
+{
+public:
+	typedef const ware_t* const_iterator;
+	typedef       ware_t* iterator;
+
+	/// packets stored without extra allocation
+	enum { LOCAL_SIZE = 2 };
+
+	vehicle_cargo_t() : data(local), count(0), size(LOCAL_SIZE) {}
+	~vehicle_cargo_t() { release(); }
+
+	uint32 get_count() const { return count; }
+	bool empty() const { return count == 0; }
+
+	ware_t& operator [](uint32 i) { return data[i]; }
+	const ware_t& operator [](uint32 i) const { return data[i]; }
+
+	ware_t& front() { return data[0]; }
+	const ware_t& front() const { return data[0]; }
+
+	iterator begin() { return data; }
+	iterator end() { return data + count; }
+	const_iterator begin() const { return data; }
+	const_iterator end() const { return data + count; }
+
+	/**
+	 * Adds @p ware to the packet with the same destination, or as new packet.
+	 * @returns true, if it was joined
+	 */
+	bool add(const ware_t &ware);
+
+	/// adds @p ware as the last packet, without joining
+	void append(const ware_t &ware);
+
+	/// removes the packet at @p i, the order of the others is kept
+	void remove_at(uint32 i);
+
+	/// removes the packet at @p it and returns an iterator to the next one
+	iterator erase(iterator it) { const uint32 i = (uint32)(it - data); remove_at(i); return data + i; }
+
+	void clear() { release(); }
+
+private:
+	ware_t *data;
+	uint32 count;
+	uint32 size;
+	ware_t local[LOCAL_SIZE];
+
+	void release();
+
+	vehicle_cargo_t(const vehicle_cargo_t &);
+	vehicle_cargo_t &operator=(const vehicle_cargo_t &);
+};
+
+#endif